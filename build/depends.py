@@ -543,7 +543,8 @@ class SoundTouch(Dependence):
 
 class RubberBand(Dependence):
     def sources(self, build):
-        sources = ['engine/enginebufferscalerubberband.cpp', ]
+        sources = ['engine/enginebufferscalerubberband.cpp',
+                   'engine/rubberbandworker.cpp', ]
         return sources
 
     def configure(self, build, conf, env=None):
@@ -736,7 +737,9 @@ class MixxxCore(Feature):
                    "engine/enginebuffer.cpp",
                    "engine/enginebufferscale.cpp",
                    "engine/enginebufferscalelinear.cpp",
+                   "engine/enginebufferscalesinc.cpp",
                    "engine/enginefilterbiquad1.cpp",
+                   "engine/enginefilterdesign.cpp",
                    "engine/enginefiltermoogladder4.cpp",
                    "engine/enginefilterbessel4.cpp",
                    "engine/enginefilterbessel8.cpp",
@@ -895,6 +898,7 @@ class MixxxCore(Feature):
                    "database/schemamanager.cpp",
 
                    "library/trackcollection.cpp",
+                   "library/trackmetadatawriter.cpp",
                    "library/basesqltablemodel.cpp",
                    "library/basetrackcache.cpp",
                    "library/columncache.cpp",
@@ -907,6 +911,7 @@ class MixxxCore(Feature):
                    "library/proxytrackmodel.cpp",
                    "library/coverart.cpp",
                    "library/coverartcache.cpp",
+                   "library/coverthumbnailstore.cpp",
                    "library/coverartutils.cpp",
 
                    "library/crate/cratestorage.cpp",
@@ -918,6 +923,7 @@ class MixxxCore(Feature):
                    "library/libraryfeature.cpp",
                    "library/analysisfeature.cpp",
                    "library/autodj/autodjfeature.cpp",
+                   "library/autodj/autodjcrateselector.cpp",
                    "library/autodj/autodjprocessor.cpp",
                    "library/dao/directorydao.cpp",
                    "library/mixxxlibraryfeature.cpp",
@@ -950,6 +956,7 @@ class MixxxCore(Feature):
                    "library/baseexternallibraryfeature.cpp",
                    "library/baseexternaltrackmodel.cpp",
                    "library/baseexternalplaylistmodel.cpp",
+                   "library/externallibraryupdate.cpp",
                    "library/rhythmbox/rhythmboxfeature.cpp",
 
                    "library/banshee/bansheefeature.cpp",
@@ -967,10 +974,12 @@ class MixxxCore(Feature):
                    "library/scanner/scannertask.cpp",
                    "library/scanner/importfilestask.cpp",
                    "library/scanner/recursivescandirectorytask.cpp",
+                   "library/scanner/librarywatcher.cpp",
 
                    "library/dao/cuedao.cpp",
                    "library/dao/cue.cpp",
                    "library/dao/trackdao.cpp",
+                   "library/dao/weaktrackcache.cpp",
                    "library/dao/playlistdao.cpp",
                    "library/dao/libraryhashdao.cpp",
                    "library/dao/settingsdao.cpp",
@@ -1051,6 +1060,8 @@ class MixxxCore(Feature):
                    "skin/imgcolor.cpp",
                    "skin/skinloader.cpp",
                    "skin/legacyskinparser.cpp",
+                   "skin/compiledskin.cpp",
+                   "skin/skinimagecache.cpp",
                    "skin/colorschemeparser.cpp",
                    "skin/tooltips.cpp",
                    "skin/skincontext.cpp",
@@ -1078,6 +1089,7 @@ class MixxxCore(Feature):
                    "mixer/basetrackplayer.cpp",
                    "mixer/deck.cpp",
                    "mixer/microphone.cpp",
+                   "mixer/offlinerenderer.cpp",
                    "mixer/playerinfo.cpp",
                    "mixer/playermanager.cpp",
                    "mixer/previewdeck.cpp",
@@ -1124,6 +1136,8 @@ class MixxxCore(Feature):
                    "util/tapfilter.cpp",
                    "util/movinginterquartilemean.cpp",
                    "util/console.cpp",
+                   "util/idbitmap.cpp",
+                   "util/startupprofiler.cpp",
                    "util/db/dbconnection.cpp",
                    "util/db/dbconnectionpool.cpp",
                    "util/db/dbconnectionpooler.cpp",
@@ -1132,6 +1146,7 @@ class MixxxCore(Feature):
                    "util/db/fwdsqlquery.cpp",
                    "util/db/fwdsqlqueryselectresult.cpp",
                    "util/db/sqllikewildcardescaper.cpp",
+                   "util/db/sqlmultirowinsert.cpp",
                    "util/db/sqlqueryfinisher.cpp",
                    "util/db/sqlstringformatter.cpp",
                    "util/db/sqltransaction.cpp",
@@ -1,9 +1,13 @@
 #include "database/mixxxdb.h"
 
+#include <QSqlError>
+#include <QSqlQuery>
+
 #include "database/schemamanager.h"
 
 #include "util/assert.h"
 #include "util/logger.h"
+#include "util/performancetimer.h"
 
 
 // The schema XML is baked into the binary via Qt resources.
@@ -11,7 +15,23 @@
 const QString MixxxDb::kDefaultSchemaFile(":/schema.xml");
 
 //static
-const int MixxxDb::kRequiredSchemaVersion = 27;
+const int MixxxDb::kRequiredSchemaVersion = 30;
+
+//static
+const QString MixxxDb::kConfigGroup("[Database]");
+
+// The defaults keep the settings of SQLite until other tunings, e.g.
+// write-ahead logging with synchronous=NORMAL, have been shown to be
+// faster by the benchmarks in dbtuning_test.cpp on the supported
+// platforms: mixxx-test --benchmark --benchmark_filter=BM_Db
+//static
+const QString MixxxDb::kDefaultJournalMode;
+//static
+const QString MixxxDb::kDefaultSynchronous;
+//static
+const int MixxxDb::kDefaultCacheSizeKiB = 0;
+//static
+const int MixxxDb::kDefaultMmapSizeMiB = 0;
 
 namespace {
 
@@ -26,6 +46,18 @@ mixxx::DbConnection::Params dbConnectionParams(
     params.filePath = QDir(pConfig->getSettingsPath()).filePath("mixxxdb.sqlite");
     params.userName = "mixxx";
     params.password = "mixxx";
+    params.sqlite.journalMode = pConfig->getValue(
+            ConfigKey(MixxxDb::kConfigGroup, "JournalMode"),
+            MixxxDb::kDefaultJournalMode);
+    params.sqlite.synchronous = pConfig->getValue(
+            ConfigKey(MixxxDb::kConfigGroup, "Synchronous"),
+            MixxxDb::kDefaultSynchronous);
+    params.sqlite.cacheSizeKiB = pConfig->getValue(
+            ConfigKey(MixxxDb::kConfigGroup, "CacheSizeKiB"),
+            MixxxDb::kDefaultCacheSizeKiB);
+    params.sqlite.mmapSizeBytes = static_cast<qint64>(pConfig->getValue(
+            ConfigKey(MixxxDb::kConfigGroup, "MmapSizeMiB"),
+            MixxxDb::kDefaultMmapSizeMiB)) * 1024 * 1024;
     return params;
 }
 
@@ -40,6 +72,23 @@ bool MixxxDb::initDatabaseSchema(
         const QSqlDatabase& database,
         const QString& schemaFile,
         int schemaVersion) {
+    return checkDatabaseSchemaUpgrade(
+            upgradeDatabaseSchema(database, schemaFile, schemaVersion),
+            schemaVersion);
+}
+
+//static
+SchemaManager::Result MixxxDb::upgradeDatabaseSchema(
+        const QSqlDatabase& database,
+        const QString& schemaFile,
+        int schemaVersion) {
+    return SchemaManager(database).upgradeToSchemaVersion(schemaFile, schemaVersion);
+}
+
+//static
+bool MixxxDb::checkDatabaseSchemaUpgrade(
+        SchemaManager::Result result,
+        int schemaVersion) {
     QString okToExit = tr("Click OK to exit.");
     QString upgradeFailed = tr("Cannot upgrade database schema");
     QString upgradeToVersionFailed =
@@ -48,7 +97,7 @@ bool MixxxDb::initDatabaseSchema(
     QString helpEmail = tr("For help with database issues contact:") + "\n" +
                            "mixxx-devel@lists.sourceforge.net";
 
-    switch (SchemaManager(database).upgradeToSchemaVersion(schemaFile, schemaVersion)) {
+    switch (result) {
         case SchemaManager::Result::CurrentVersion:
         case SchemaManager::Result::UpgradeSucceeded:
         case SchemaManager::Result::NewerVersionBackwardsCompatible:
@@ -84,3 +133,36 @@ bool MixxxDb::initDatabaseSchema(
     DEBUG_ASSERT(!"unhandled switch/case");
     return false;
 }
+
+//static
+void MixxxDb::optimizeDatabase(
+        const QSqlDatabase& database) {
+    PerformanceTimer timer;
+    timer.start();
+    QSqlQuery query(database);
+    query.prepare(
+            "SELECT name FROM sqlite_master "
+            "WHERE type='table' AND name='sqlite_stat1'");
+    if (!query.exec()) {
+        kLogger.warning()
+                << "Failed to query database statistics"
+                << query.lastError();
+        return;
+    }
+    // Without any statistics the query planner has to guess which
+    // index to use. Collect them once, afterwards SQLite decides on
+    // its own if they need to be updated.
+    const bool analyzed = query.next();
+    const QString statement = analyzed ? "PRAGMA optimize" : "ANALYZE";
+    if (!query.exec(statement)) {
+        kLogger.warning()
+                << "Failed to execute"
+                << statement
+                << query.lastError();
+        return;
+    }
+    kLogger.info()
+            << statement
+            << "took"
+            << timer.elapsed().formatMillisWithUnit();
+}
@@ -4,6 +4,7 @@
 
 #include <QSqlDatabase>
 
+#include "database/schemamanager.h"
 #include "preferences/usersettings.h"
 
 #include "util/db/dbconnectionpool.h"
@@ -17,11 +18,36 @@ class MixxxDb : public QObject {
 
     static const int kRequiredSchemaVersion;
 
+    // Tuning parameters for the SQLite connections. All values
+    // can be overridden in the configuration. Empty strings and
+    // zero keep the defaults of SQLite.
+    static const QString kConfigGroup;
+    static const QString kDefaultJournalMode;
+    static const QString kDefaultSynchronous;
+    static const int kDefaultCacheSizeKiB;
+    static const int kDefaultMmapSizeMiB;
+
     static bool initDatabaseSchema(
             const QSqlDatabase& database,
             const QString& schemaFile = kDefaultSchemaFile,
             int schemaVersion = kRequiredSchemaVersion);
 
+    // The two halves of initDatabaseSchema(). The upgrade does not
+    // interact with the user and may run on any thread that owns the
+    // database connection. The result must be checked on the main
+    // thread, which informs the user if the upgrade failed.
+    static SchemaManager::Result upgradeDatabaseSchema(
+            const QSqlDatabase& database,
+            const QString& schemaFile = kDefaultSchemaFile,
+            int schemaVersion = kRequiredSchemaVersion);
+    static bool checkDatabaseSchemaUpgrade(
+            SchemaManager::Result result,
+            int schemaVersion = kRequiredSchemaVersion);
+
+    // Updates the statistics of the query planner if needed.
+    static void optimizeDatabase(
+            const QSqlDatabase& database);
+
     explicit MixxxDb(
             const UserSettingsPointer& pConfig);
 
@@ -24,7 +24,8 @@ class EffectManifest final {
     EffectManifest()
         : m_isMixingEQ(false),
           m_isMasterEQ(false),
-          m_effectRampsFromDry(false) {
+          m_effectRampsFromDry(false),
+          m_processesInPlace(false) {
     }
 
     virtual const QString& id() const {
@@ -114,6 +115,15 @@ class EffectManifest final {
         m_effectRampsFromDry = effectFadesFromDry;
     }
 
+    // True if the effect can process a channel buffer in place, i.e. with the
+    // same buffer as input and output.
+    virtual bool processesInPlace() const {
+        return m_processesInPlace;
+    }
+    virtual void setProcessesInPlace(bool processesInPlace) {
+        m_processesInPlace = processesInPlace;
+    }
+
   private:
     QString debugString() const {
         return QString("EffectManifest(%1)").arg(m_id);
@@ -130,6 +140,7 @@ class EffectManifest final {
     bool m_isMasterEQ;
     QList<EffectManifestParameter> m_parameters;
     bool m_effectRampsFromDry;
+    bool m_processesInPlace;
 };
 
 #endif /* EFFECTMANIFEST_H */
@@ -3,6 +3,7 @@
 #include "effects/effectparameter.h"
 #include "effects/effectsmanager.h"
 #include "effects/effect.h"
+#include "engine/effects/engineeffect.h"
 #include "util/assert.h"
 
 EffectParameter::EffectParameter(Effect* pEffect, EffectsManager* pEffectsManager,
@@ -215,13 +216,10 @@ void EffectParameter::updateEngineState() {
     if (!pEngineEffect) {
         return;
     }
-    EffectsRequest* pRequest = new EffectsRequest();
-    pRequest->type = EffectsRequest::SET_PARAMETER_PARAMETERS;
-    pRequest->pTargetEffect = pEngineEffect;
-    pRequest->SetParameterParameters.iParameter = m_iParameterNumber;
-    pRequest->value = m_value;
-    pRequest->minimum = m_minimum;
-    pRequest->maximum = m_maximum;
-    pRequest->default_value = m_default;
-    m_pEffectsManager->writeRequest(pRequest);
+    EngineEffectParameter::Values values;
+    values.value = m_value;
+    values.defaultValue = m_default;
+    values.minimum = m_minimum;
+    values.maximum = m_maximum;
+    pEngineEffect->setParameterValues(m_iParameterNumber, values);
 }
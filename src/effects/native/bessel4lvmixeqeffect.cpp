@@ -20,6 +20,7 @@ EffectManifest Bessel4LVMixEQEffect::getManifest() {
         "A Bessel 4th-order filter isolator with Lipshitz and Vanderkooy mix (bit perfect unity, roll-off -24 dB/octave).") + " " + EqualizerUtil::adjustFrequencyShelvesTip());
     manifest.setIsMixingEQ(true);
     manifest.setEffectRampsFromDry(true);
+    manifest.setProcessesInPlace(true);
 
     EqualizerUtil::createCommonParameters(&manifest);
     return manifest;
@@ -20,6 +20,7 @@ EffectManifest Bessel8LVMixEQEffect::getManifest() {
         "A Bessel 8th-order filter isolator with Lipshitz and Vanderkooy mix (bit perfect unity, roll-off -48 dB/octave).") + " " + EqualizerUtil::adjustFrequencyShelvesTip());
     manifest.setIsMixingEQ(true);
     manifest.setEffectRampsFromDry(true);
+    manifest.setProcessesInPlace(true);
 
     EqualizerUtil::createCommonParameters(&manifest);
     return manifest;
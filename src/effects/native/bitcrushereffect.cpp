@@ -18,6 +18,7 @@ EffectManifest BitCrusherEffect::getManifest() {
         "The BitCrusher is an effect that adds quantisation noise to the signal "
         "by the reduction of the resolution or bandwidth of the samples."));
     manifest.setEffectRampsFromDry(true);
+    manifest.setProcessesInPlace(true);
 
     EffectManifestParameter* depth = manifest.addParameter();
     depth->setId("bit_depth");
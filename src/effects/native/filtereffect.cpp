@@ -22,6 +22,7 @@ EffectManifest FilterEffect::getManifest() {
                                         "music by allowing only high or low "
                                         "frequencies to pass through."));
     manifest.setEffectRampsFromDry(true);
+    manifest.setProcessesInPlace(true);
 
     EffectManifestParameter* lpf = manifest.addParameter();
     lpf->setId("lpf");
@@ -140,9 +141,17 @@ void FilterEffect::processChannel(const ChannelHandle& handle,
         pState->m_pHighFilter->setFrequencyCorners(1, hpf, clampedQ);
     }
 
+    // processAndPauseFilter() fades to its input after writing the output,
+    // so it must not process in place
+    const bool hpfPausing = hpf <= minCornerNormalized &&
+            pState->m_hiFreq > minCornerNormalized;
+    const bool lpfPausing = lpf >= maxCornerNormalized &&
+            pState->m_loFreq < maxCornerNormalized;
+
     const CSAMPLE* pLpfInput = pState->m_pBuf;
     CSAMPLE* pHpfOutput = pState->m_pBuf;
-    if (lpf >= maxCornerNormalized && pState->m_loFreq >= maxCornerNormalized) {
+    if (lpf >= maxCornerNormalized && pState->m_loFreq >= maxCornerNormalized &&
+            !(hpfPausing && pInput == pOutput)) {
         // Lpf disabled Hpf can write directly to output
         pHpfOutput = pOutput;
         pLpfInput = pHpfOutput;
@@ -151,10 +160,13 @@ void FilterEffect::processChannel(const ChannelHandle& handle,
     if (hpf > minCornerNormalized) {
         // hpf enabled, fade-in is handled in the filter when starting from pause
         pState->m_pHighFilter->process(pInput, pHpfOutput, numSamples);
-    } else if (pState->m_hiFreq > minCornerNormalized) {
+    } else if (hpfPausing) {
             // hpf disabling
             pState->m_pHighFilter->processAndPauseFilter(pInput,
                     pHpfOutput, numSamples);
+    } else if (lpfPausing && pInput == pOutput) {
+        // paused LP needs an untouched copy of the input
+        SampleUtil::copy(pState->m_pBuf, pInput, numSamples);
     } else {
         // paused LP uses input directly
         pLpfInput = pInput;
@@ -163,16 +175,13 @@ void FilterEffect::processChannel(const ChannelHandle& handle,
     if (lpf < maxCornerNormalized) {
         // lpf enabled, fade-in is handled in the filter when starting from pause
         pState->m_pLowFilter->process(pLpfInput, pOutput, numSamples);
-    } else if (pState->m_loFreq < maxCornerNormalized) {
+    } else if (lpfPausing) {
         // hpf disabling
         pState->m_pLowFilter->processAndPauseFilter(pLpfInput,
                 pOutput, numSamples);
-    } else if (pLpfInput == pInput) {
-        // Both disabled
-        if (pOutput != pInput) {
-            // We need to copy pInput pOutput
-            SampleUtil::copy(pOutput, pInput, numSamples);
-        }
+    } else if (pLpfInput != pOutput) {
+        // Both disabled, or the pausing hpf could not write to pOutput
+        SampleUtil::copy(pOutput, pLpfInput, numSamples);
     }
 
     pState->m_loFreq = lpf;
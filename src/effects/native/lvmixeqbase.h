@@ -1,19 +1,26 @@
 #ifndef BESSELLVMIXEQBASE_H
 #define BESSELLVMIXEQBASE_H
 
-#include "engine/enginefilterdelay.h"
+#include "engine/enginefilteriir.h"
+#include "util/assert.h"
 #include "util/defs.h"
 #include "util/math.h"
 #include "util/sample.h"
 #include "util/types.h"
 
-static const int kMaxDelay = 3300; // allows a 30 Hz filter at 97346;
+// The size of the interleaved stereo delay line in samples. It allows a
+// 30 Hz filter at 97346, which delays by 1642 frames with a Bessel8.
+static const int kMaxDelay = 3300;
 static const int kRampDone = -1;
 static const unsigned int kStartupSamplerate = 44100;
 static const double kStartupLoFreq = 246;
 static const double kStartupHiFreq = 2484;
 
 
+// Computes all three bands of the EQ in a single pass over the input.
+// Both low pass filters and both channels are processed together in the
+// four lanes of one EngineFilterIIRLanes, fed from one delay line that
+// provides the delay compensated input for the mid and the high band.
 template<class LPF>
 class LVMixEQEffectGroupState {
   public:
@@ -24,37 +31,50 @@ class LVMixEQEffectGroupState {
           m_rampHoldOff(kRampDone),
           m_oldSampleRate(kStartupSamplerate),
           m_loFreq(kStartupLoFreq),
-          m_hiFreq(kStartupHiFreq) {
-        m_pLowBuf = SampleUtil::alloc(MAX_BUFFER_LEN);
-        m_pBandBuf = SampleUtil::alloc(MAX_BUFFER_LEN);
-        m_pHighBuf = SampleUtil::alloc(MAX_BUFFER_LEN);
-
-        m_low1 = new LPF(kStartupSamplerate, kStartupLoFreq);
-        m_low2 = new LPF(kStartupSamplerate, kStartupHiFreq);
-        m_delay2 = new EngineFilterDelay<kMaxDelay>();
-        m_delay3 = new EngineFilterDelay<kMaxDelay>();
+          m_hiFreq(kStartupHiFreq),
+          m_doRamping(true),
+          m_doStart(true),
+          m_delayPos(0),
+          m_bandDelay(0),
+          m_oldBandDelay(0),
+          m_highDelay(0),
+          m_oldHighDelay(0) {
+        SampleUtil::clear(m_delayBuf, kMaxDelay);
         setFilters(kStartupSamplerate, kStartupLoFreq, kStartupHiFreq);
     }
 
     virtual ~LVMixEQEffectGroupState() {
-        delete m_low1;
-        delete m_low2;
-        delete m_delay2;
-        delete m_delay3;
-        SampleUtil::free(m_pLowBuf);
-        SampleUtil::free(m_pBandBuf);
-        SampleUtil::free(m_pHighBuf);
     }
 
     void setFilters(int sampleRate, double lowFreq, double highFreq) {
-        int delayLow1 = m_low1->setFrequencyCornersForIntDelay(
-                lowFreq / sampleRate, kMaxDelay);
-        int delayLow2 = m_low2->setFrequencyCornersForIntDelay(
-                highFreq / sampleRate, kMaxDelay);
-
-        m_delay2->setDelay((delayLow1 - delayLow2) * 2);
-        m_delay3->setDelay(delayLow1 * 2);
+        // The high band is delayed by the group delay of the lower low pass
+        // in frames, i.e. twice as many interleaved samples, which must fit
+        // into the delay line. This is 1649 frames, above the 1642 frames of
+        // the documented maximum. Lower frequencies are designed for the
+        // clamped delay, so the bands are not perfectly delay compensated.
+        const int maxDelay = kMaxDelay / 2 - 1;
+        double coefLow1[LowPasses::kNumCoefs];
+        double coefLow2[LowPasses::kNumCoefs];
+        int delayLow1 = LPF::designForIntDelay(coefLow1,
+                lowFreq / sampleRate, maxDelay);
+        int delayLow2 = LPF::designForIntDelay(coefLow2,
+                highFreq / sampleRate, maxDelay);
+
+        // Cross fade from the old filters like EngineFilterIIR::setCoefs()
+        m_oldLowPasses = m_lowPasses;
+        m_lowPasses.setCoefs(kLow1Left, coefLow1);
+        m_lowPasses.setCoefs(kLow1Right, coefLow1);
+        m_lowPasses.setCoefs(kLow2Left, coefLow2);
+        m_lowPasses.setCoefs(kLow2Right, coefLow2);
+        m_lowPasses.clearState();
+        m_doRamping = true;
+
+        m_bandDelay = (delayLow1 - delayLow2) * 2;
+        m_highDelay = delayLow1 * 2;
         m_groupDelay = delayLow1 * 2;
+        // The read position of the high band must not wrap around the
+        // write position
+        DEBUG_ASSERT(m_highDelay < kMaxDelay);
     }
 
     void processChannel(const CSAMPLE* pInput, CSAMPLE* pOutput,
@@ -78,37 +98,23 @@ class LVMixEQEffectGroupState {
         fLow = fLow - fMid;
         fMid = fMid - fHigh;
 
+        // The low passes are only needed if the low or the mid band is used,
+        // see finishBuffer() for how they restart
+        const bool lowPasses = fLow || m_oldLow || fMid || m_oldMid;
+
         // Note: We do not call pauseFilter() here because this will introduce a
         // buffer size-dependent start delay. During such start delay some unwanted
         // frequencies are slipping though or wanted frequencies are damped.
         // We know the exact group delay here so we can just hold off the ramping.
-        if (fHigh || m_oldHigh) {
-            m_delay3->process(pInput, m_pHighBuf, numSamples);
-        }
-
-        if (fMid || m_oldMid) {
-            m_delay2->process(pInput, m_pBandBuf, numSamples);
-            m_low2->process(m_pBandBuf, m_pBandBuf, numSamples);
-        }
-
-        if (fLow || m_oldLow) {
-            m_low1->process(pInput, m_pLowBuf, numSamples);
-        }
-
-        // Test code for comparing streams as two stereo channels
-        //for (unsigned int i = 0; i < numSamples; i +=2) {
-        //    pOutput[i] = pState->m_pLowBuf[i];
-        //    pOutput[i + 1] = pState->m_pBandBuf[i];
-        //}
-
         if (fLow == m_oldLow &&
                 fMid == m_oldMid &&
                 fHigh == m_oldHigh) {
-            SampleUtil::copy3WithGain(pOutput,
-                    m_pLowBuf, fLow,
-                    m_pBandBuf, fMid,
-                    m_pHighBuf, fHigh,
-                    numSamples);
+            const CSAMPLE_GAIN gains[3] = { static_cast<CSAMPLE_GAIN>(fLow),
+                    static_cast<CSAMPLE_GAIN>(fMid),
+                    static_cast<CSAMPLE_GAIN>(fHigh) };
+            const CSAMPLE_GAIN gainDeltas[3] = { 0, 0, 0 };
+            processSamples(pInput, pOutput, 0, numSamples, numSamples,
+                    lowPasses, gains, gainDeltas, false);
         } else {
             int copySamples = 0;
             int rampingSamples = numSamples;
@@ -135,110 +141,244 @@ class LVMixEQEffectGroupState {
                 m_rampHoldOff -= copySamples;
                 rampingSamples = numSamples - copySamples;
 
-                SampleUtil::copy3WithGain(pOutput,
-                        m_pLowBuf, m_oldLow,
-                        m_pBandBuf, m_oldMid,
-                        m_pHighBuf, m_oldHigh,
-                        copySamples);
+                const CSAMPLE_GAIN gains[3] = {
+                        static_cast<CSAMPLE_GAIN>(m_oldLow),
+                        static_cast<CSAMPLE_GAIN>(m_oldMid),
+                        static_cast<CSAMPLE_GAIN>(m_oldHigh) };
+                const CSAMPLE_GAIN gainDeltas[3] = { 0, 0, 0 };
+                processSamples(pInput, pOutput, 0, copySamples, numSamples,
+                        lowPasses, gains, gainDeltas, false);
             }
 
             if (rampingSamples) {
-                SampleUtil::copy3WithRampingGain(&pOutput[copySamples],
-                        &m_pLowBuf[copySamples], m_oldLow, fLow,
-                        &m_pBandBuf[copySamples], m_oldMid, fMid,
-                        &m_pHighBuf[copySamples], m_oldHigh, fHigh,
-                        rampingSamples);
+                CSAMPLE_GAIN gains[3];
+                CSAMPLE_GAIN gainDeltas[3];
+                rampGain(&gains[0], &gainDeltas[0], m_oldLow, fLow, rampingSamples);
+                rampGain(&gains[1], &gainDeltas[1], m_oldMid, fMid, rampingSamples);
+                rampGain(&gains[2], &gainDeltas[2], m_oldHigh, fHigh, rampingSamples);
+                processSamples(pInput, pOutput, copySamples, rampingSamples,
+                        numSamples, lowPasses, gains, gainDeltas, false);
 
                 m_oldLow = fLow;
                 m_oldMid = fMid;
                 m_oldHigh = fHigh;
                 m_rampHoldOff = kRampDone;
-
             }
         }
+        finishBuffer(lowPasses);
     }
 
     void processChannelAndPause(
             const CSAMPLE* pInput, CSAMPLE* pOutput, const int numSamples) {
+        // Ramp the delay line to zero delay and the low passes to silence,
+        // then restart from scratch like EngineFilterIIR::processAndPauseFilter()
+        // and EngineFilterDelay::processAndPauseFilter().
+        const int bandDelay = m_bandDelay;
+        const int highDelay = m_highDelay;
+        m_bandDelay = 0;
+        m_highDelay = 0;
+
+        const bool lowPasses = m_oldLow || m_oldMid;
+        CSAMPLE_GAIN gains[3];
+        CSAMPLE_GAIN gainDeltas[3];
+        rampGain(&gains[0], &gainDeltas[0], m_oldLow, 0.0, numSamples);
+        rampGain(&gains[1], &gainDeltas[1], m_oldMid, 0.0, numSamples);
+        rampGain(&gains[2], &gainDeltas[2], m_oldHigh, 1.0, numSamples);
+        processSamples(pInput, pOutput, 0, numSamples, numSamples,
+                lowPasses, gains, gainDeltas, true);
+        finishBuffer(lowPasses);
+
+        m_bandDelay = bandDelay;
+        m_highDelay = highDelay;
+        m_oldBandDelay = 0;
+        m_oldHighDelay = 0;
+        SampleUtil::clear(m_delayBuf, kMaxDelay);
+        m_lowPasses.clearState();
+        m_doRamping = true;
+        m_doStart = true;
+    }
 
-        // Note: We do not call pauseFilter() here because this will introduce a
-        // buffer size-dependent start delay. During such start delay some unwanted
-        // frequencies are slipping though or wanted frequencies are damped.
-        // We know the exact group delay here so we can just hold off the ramping.
-        m_delay3->processAndPauseFilter(pInput, m_pHighBuf, numSamples);
+  private:
+    typedef typename LPF::template Lanes<4> LowPasses;
+
+    enum Lane {
+        kLow1Left,
+        kLow1Right,
+        kLow2Left,
+        kLow2Right,
+    };
+
+    // The gain of the first frame and its increment per frame, like
+    // SampleUtil::copy3WithRampingGain()
+    static void rampGain(CSAMPLE_GAIN* pGain, CSAMPLE_GAIN* pGainDelta,
+            double gainIn, double gainOut, int numSamples) {
+        *pGainDelta = static_cast<CSAMPLE_GAIN>(gainOut - gainIn) /
+                (numSamples / 2);
+        *pGain = static_cast<CSAMPLE_GAIN>(gainIn) + *pGainDelta;
+    }
 
-        if (m_oldMid) {
-            m_delay2->processAndPauseFilter(pInput, m_pBandBuf, numSamples);
-            m_low2->processAndPauseFilter(m_pBandBuf, m_pBandBuf, numSamples);
+    static int wrapDelayPos(int pos) {
+        if (pos < 0) {
+            return pos + kMaxDelay;
         }
-
-        if (m_oldLow) {
-            m_low1->processAndPauseFilter(pInput, m_pLowBuf, numSamples);
+        if (pos >= kMaxDelay) {
+            return pos - kMaxDelay;
         }
+        return pos;
+    }
 
-        SampleUtil::copy3WithRampingGain(pOutput,
-                m_pLowBuf, m_oldLow, 0.0,
-                m_pBandBuf, m_oldMid, 0.0,
-                m_pHighBuf, m_oldHigh, 1.0,
-                numSamples);
+    void processSamples(const CSAMPLE* pInput, CSAMPLE* pOutput,
+            int firstSample, int numSamples, int bufferSize, bool lowPasses,
+            const CSAMPLE_GAIN (&gains)[3], const CSAMPLE_GAIN (&gainDeltas)[3],
+            bool fadeOutLowPasses) {
+        if (numSamples <= 0) {
+            return;
+        }
+        const bool settled = !fadeOutLowPasses &&
+                m_bandDelay == m_oldBandDelay &&
+                m_highDelay == m_oldHighDelay &&
+                !(lowPasses && m_doRamping);
+        if (lowPasses) {
+            if (settled) {
+                processFrames<true, false>(pInput, pOutput, firstSample,
+                        numSamples, bufferSize, gains, gainDeltas, false);
+            } else {
+                processFrames<true, true>(pInput, pOutput, firstSample,
+                        numSamples, bufferSize, gains, gainDeltas,
+                        fadeOutLowPasses);
+            }
+        } else {
+            if (settled) {
+                processFrames<false, false>(pInput, pOutput, firstSample,
+                        numSamples, bufferSize, gains, gainDeltas, false);
+            } else {
+                processFrames<false, true>(pInput, pOutput, firstSample,
+                        numSamples, bufferSize, gains, gainDeltas,
+                        fadeOutLowPasses);
+            }
+        }
     }
 
-    /*
-
-        int copySamples = 0;
-        int rampingSamples = numSamples;
-        if ((fLow && !m_oldLow) ||
-                (fMid && !m_oldMid) ||
-                (fHigh && !m_oldHigh)) {
-            // we have just switched at least one filter on
-            // Hold off ramping for the group delay
-            if (m_rampHoldOff == kRampDone) {
-                // multiply the group delay * 2 to ensure that the filter is
-                // settled it is actually at a factor of 1,8 at default setting
-                m_rampHoldOff = m_groupDelay * 2;
-                // ensure that we have at least 128 samples for ramping
-                // (the smallest buffer, that suits for de-clicking)
-                int rampingSamples = numSamples - (m_rampHoldOff % numSamples);
-                if (rampingSamples < 128) {
-                    m_rampHoldOff += rampingSamples;
+    // Processes the frames of one gain segment of the buffer. While
+    // RAMPING, the delay line and the low passes cross fade in the second
+    // half of the buffer like EngineFilterDelay and EngineFilterIIR.
+    // pInput may be equal to pOutput.
+    template<bool LOWPASSES, bool RAMPING>
+    void processFrames(const CSAMPLE* pInput, CSAMPLE* pOutput,
+            int firstSample, int numSamples, int bufferSize,
+            const CSAMPLE_GAIN (&gains)[3], const CSAMPLE_GAIN (&gainDeltas)[3],
+            bool fadeOutLowPasses) {
+        const int halfBuffer = bufferSize / 2;
+        // The low passes start cross fading at the first full frame
+        const int halfBufferFrame = (halfBuffer + 1) & ~1;
+        const double crossInc = 2 / static_cast<double>(bufferSize);
+        const CSAMPLE_GAIN fadeDelta = -CSAMPLE_GAIN_ONE / (bufferSize / 2);
+
+        int pos = m_delayPos;
+        int bandPos = wrapDelayPos(pos - m_bandDelay);
+        int highPos = wrapDelayPos(pos - m_highDelay);
+        int oldBandPos = wrapDelayPos(pos - m_oldBandDelay);
+        int oldHighPos = wrapDelayPos(pos - m_oldHighDelay);
+        const bool rampBand = RAMPING && m_bandDelay != m_oldBandDelay;
+        const bool rampHigh = RAMPING && m_highDelay != m_oldHighDelay;
+        const bool rampLowPasses = RAMPING && m_doRamping;
+
+        const int lastSample = firstSample + numSamples;
+        for (int i = firstSample, frame = 0; i < lastSample; i += 2, ++frame) {
+            // put the samples into the delay line
+            const CSAMPLE inLeft = pInput[i];
+            const CSAMPLE inRight = pInput[i + 1];
+            m_delayBuf[pos] = inLeft;
+            m_delayBuf[pos + 1] = inRight;
+
+            // take the delay compensated samples of the mid and high band
+            CSAMPLE band[2] = { m_delayBuf[bandPos], m_delayBuf[bandPos + 1] };
+            CSAMPLE high[2] = { m_delayBuf[highPos], m_delayBuf[highPos + 1] };
+            if (RAMPING) {
+                for (int channel = 0; channel < 2; ++channel) {
+                    const int sample = i + channel;
+                    const double crossMix = (sample - halfBuffer) * crossInc;
+                    if (rampBand) {
+                        const CSAMPLE oldBand = m_delayBuf[oldBandPos + channel];
+                        band[channel] = sample < halfBuffer ? oldBand :
+                                oldBand * (1.0 - crossMix) + band[channel] * crossMix;
+                    }
+                    if (rampHigh) {
+                        const CSAMPLE oldHigh = m_delayBuf[oldHighPos + channel];
+                        high[channel] = sample < halfBuffer ? oldHigh :
+                                oldHigh * (1.0 - crossMix) + high[channel] * crossMix;
+                    }
                 }
+                oldBandPos = oldBandPos + 2 < kMaxDelay ? oldBandPos + 2 : 0;
+                oldHighPos = oldHighPos + 2 < kMaxDelay ? oldHighPos + 2 : 0;
+            }
+            pos = pos + 2 < kMaxDelay ? pos + 2 : 0;
+            bandPos = bandPos + 2 < kMaxDelay ? bandPos + 2 : 0;
+            highPos = highPos + 2 < kMaxDelay ? highPos + 2 : 0;
+
+            const CSAMPLE_GAIN gainLow = gains[0] + gainDeltas[0] * frame;
+            const CSAMPLE_GAIN gainMid = gains[1] + gainDeltas[1] * frame;
+            const CSAMPLE_GAIN gainHigh = gains[2] + gainDeltas[2] * frame;
+            if (LOWPASSES) {
+                double lanes[4] = { inLeft, inRight, band[0], band[1] };
+                if (rampLowPasses) {
+                    double oldLanes[4] = { 0, 0, 0, 0 };
+                    if (!m_doStart) {
+                        // Process old filter, but only if we do not do a fresh start
+                        std::copy(lanes, lanes + 4, oldLanes);
+                        m_oldLowPasses.processFrame(oldLanes);
+                    }
+                    m_lowPasses.processFrame(lanes);
+                    const double crossMix = (i - halfBufferFrame) * crossInc;
+                    for (int lane = 0; lane < 4; ++lane) {
+                        lanes[lane] = i < halfBuffer ? oldLanes[lane] :
+                                lanes[lane] * crossMix +
+                                        oldLanes[lane] * (1.0 - crossMix);
+                    }
+                } else {
+                    m_lowPasses.processFrame(lanes);
+                }
+                if (RAMPING && fadeOutLowPasses) {
+                    const CSAMPLE_GAIN fade = CSAMPLE_GAIN_ONE +
+                            fadeDelta * (frame + 1);
+                    for (int lane = 0; lane < 4; ++lane) {
+                        lanes[lane] = static_cast<CSAMPLE>(lanes[lane]) * fade;
+                    }
+                }
+                pOutput[i] = static_cast<CSAMPLE>(lanes[kLow1Left]) * gainLow +
+                        static_cast<CSAMPLE>(lanes[kLow2Left]) * gainMid +
+                        high[0] * gainHigh;
+                pOutput[i + 1] = static_cast<CSAMPLE>(lanes[kLow1Right]) * gainLow +
+                        static_cast<CSAMPLE>(lanes[kLow2Right]) * gainMid +
+                        high[1] * gainHigh;
+            } else {
+                pOutput[i] = high[0] * gainHigh;
+                pOutput[i + 1] = high[1] * gainHigh;
             }
-
-            // ramping is done in one of the following calls if
-            // pState->m_rampHoldOff >= numSamples;
-            copySamples = math_min<int>(m_rampHoldOff, numSamples);
-            m_rampHoldOff -= copySamples;
-            rampingSamples = numSamples - copySamples;
-
-            SampleUtil::copy3WithGain(pOutput,
-                    m_pLowBuf, m_oldLow,
-                    m_pBandBuf, m_oldMid,
-                    m_pHighBuf, m_oldHigh,
-                    copySamples);
         }
+        m_delayPos = pos;
+    }
 
-        if (rampingSamples) {
-            SampleUtil::copy3WithRampingGain(&pOutput[copySamples],
-                    &m_pLowBuf[copySamples], m_oldLow, fLow,
-                    &m_pBandBuf[copySamples], m_oldMid, fMid,
-                    &m_pHighBuf[copySamples], m_oldHigh, fHigh,
-                    rampingSamples);
-
-            m_oldLow = fLow;
-            m_oldMid = fMid;
-            m_oldHigh = fHigh;
-            m_rampHoldOff = kRampDone;
-
+    void finishBuffer(bool lowPasses) {
+        if (lowPasses) {
+            m_doRamping = false;
+            m_doStart = false;
+        } else if (!m_doStart) {
+            // Both bands are killed. Instead of resuming from the state
+            // they had back then, the low passes restart from silence and
+            // settle during the ramp hold-off once a band is used again.
+            m_lowPasses.clearState();
+            m_doRamping = true;
+            m_doStart = true;
         }
+        m_oldBandDelay = m_bandDelay;
+        m_oldHighDelay = m_highDelay;
     }
 
-*/
-
-  private:
-    LPF* m_low1;
-    LPF* m_low2;
-    EngineFilterDelay<kMaxDelay>* m_delay2;
-    EngineFilterDelay<kMaxDelay>* m_delay3;
+    // Lanes: see enum Lane
+    LowPasses m_lowPasses;
+    // Old filters needed for ramping
+    LowPasses m_oldLowPasses;
 
     double m_oldLow;
     double m_oldMid;
@@ -251,9 +391,18 @@ class LVMixEQEffectGroupState {
     double m_loFreq;
     double m_hiFreq;
 
-    CSAMPLE* m_pLowBuf;
-    CSAMPLE* m_pBandBuf;
-    CSAMPLE* m_pHighBuf;
+    // Flag set to true if the low passes need to cross fade
+    bool m_doRamping;
+    // Flag set to true if the old low passes are invalid
+    bool m_doStart;
+
+    // Interleaved input samples of both channels
+    CSAMPLE m_delayBuf[kMaxDelay];
+    int m_delayPos;
+    int m_bandDelay;
+    int m_oldBandDelay;
+    int m_highDelay;
+    int m_oldHighDelay;
 };
 
 #endif // BESSELLVMIXEQBASE_H
@@ -34,6 +34,7 @@ CachingReader::CachingReader(QString group,
           m_lruCachingReaderChunk(nullptr),
           m_sampleBuffer(CachingReaderChunk::kSamples * maximumCachingReaderChunksInMemory),
           m_maxReadableFrameIndex(mixxx::AudioSource::getMinFrameIndex()),
+          m_chunksReadPending(0),
           m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO) {
 
     m_allocatedCachingReaderChunks.reserve(maximumCachingReaderChunksInMemory);
@@ -188,6 +189,7 @@ void CachingReader::process() {
             // This has to be done before freeing all chunks
             // after a new track has been loaded (see below)!
             pChunk->takeFromWorker();
+            --m_chunksReadPending;
             if (status.status != CHUNK_READ_SUCCESS) {
                 // Discard chunks that are empty (EOF) or invalid
                 freeChunk(pChunk);
@@ -417,6 +419,8 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                     // Revoke the chunk from the worker and free it
                     pChunk->takeFromWorker();
                     freeChunk(pChunk);
+                } else {
+                    ++m_chunksReadPending;
                 }
                 //qDebug() << "Checking chunk " << current << " shouldWake:" << shouldWake << " chunksToRead" << m_chunksToRead.size();
             } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
@@ -98,6 +98,13 @@ class CachingReader : public QObject {
     // for this to take effect.
     virtual void newTrack(TrackPointer pTrack);
 
+    // Returns true while chunks requested by hintAndMaybeWake() have not been
+    // taken over from the worker by process(). Must only be called from the
+    // engine callback.
+    bool isReadPending() const {
+        return m_chunksReadPending > 0;
+    }
+
     void setScheduler(EngineWorkerScheduler* pScheduler) {
         m_worker.setScheduler(pScheduler);
     }
@@ -167,6 +174,9 @@ class CachingReader : public QObject {
     // frame with sample data.
     SINT m_maxReadableFrameIndex;
 
+    // The chunks that have been handed over to the worker for reading
+    int m_chunksReadPending;
+
     CachingReaderWorker m_worker;
 };
 
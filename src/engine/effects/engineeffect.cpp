@@ -7,7 +7,8 @@ EngineEffect::EngineEffect(const EffectManifest& manifest,
                            EffectInstantiatorPointer pInstantiator)
         : m_manifest(manifest),
           m_enableState(EffectProcessor::DISABLED),
-          m_parameters(manifest.parameters().size()) {
+          m_parameters(manifest.parameters().size()),
+          m_parameterBlock(manifest.parameters().size()) {
     const QList<EffectManifestParameter>& parameters = m_manifest.parameters();
     for (int i = 0; i < parameters.size(); ++i) {
         const EffectManifestParameter& parameter = parameters.at(i);
@@ -15,12 +16,18 @@ EngineEffect::EngineEffect(const EffectManifest& manifest,
                 new EngineEffectParameter(parameter);
         m_parameters[i] = pParameter;
         m_parametersById[parameter.id()] = pParameter;
+        m_parameterBlock.setValues(i, pParameter->values());
     }
+    // Nothing to update yet
+    m_parameterBlock.takeChanges();
 
     // Creating the processor must come last.
     m_pProcessor = pInstantiator->instantiate(this, manifest);
     m_pProcessor->initialize(registeredChannels);
     m_effectRampsFromDry = manifest.effectRampsFromDry();
+    // Fading an effect that does not ramp from dry by itself needs the
+    // original input after the effect has written its output.
+    m_processesInPlace = manifest.processesInPlace() && m_effectRampsFromDry;
 }
 
 EngineEffect::~EngineEffect() {
@@ -38,7 +45,6 @@ EngineEffect::~EngineEffect() {
 
 bool EngineEffect::processEffectsRequest(const EffectsRequest& message,
                                          EffectsResponsePipe* pResponsePipe) {
-    EngineEffectParameter* pParameter = NULL;
     EffectsResponse response(message);
 
     switch (message.type) {
@@ -58,35 +64,32 @@ bool EngineEffect::processEffectsRequest(const EffectsRequest& message,
             pResponsePipe->writeMessages(&response, 1);
             return true;
             break;
-        case EffectsRequest::SET_PARAMETER_PARAMETERS:
-            if (kEffectDebugOutput) {
-                qDebug() << debugString() << "SET_PARAMETER_PARAMETERS"
-                         << "parameter" << message.SetParameterParameters.iParameter
-                         << "minimum" << message.minimum
-                         << "maximum" << message.maximum
-                         << "default_value" << message.default_value
-                         << "value" << message.value;
-            }
-            pParameter = m_parameters.value(
-                message.SetParameterParameters.iParameter, NULL);
-            if (pParameter) {
-                pParameter->setMinimum(message.minimum);
-                pParameter->setMaximum(message.maximum);
-                pParameter->setDefaultValue(message.default_value);
-                pParameter->setValue(message.value);
-                response.success = true;
-            } else {
-                response.success = false;
-                response.status = EffectsResponse::NO_SUCH_PARAMETER;
-            }
-            pResponsePipe->writeMessages(&response, 1);
-            return true;
         default:
             break;
     }
     return false;
 }
 
+bool EngineEffect::setParameterValues(int iParameter,
+        const EngineEffectParameter::Values& values) {
+    if (iParameter < 0 || iParameter >= m_parameterBlock.size()) {
+        return false;
+    }
+    m_parameterBlock.setValues(iParameter, values);
+    return true;
+}
+
+void EngineEffect::updateParameters() {
+    if (!m_parameterBlock.takeChanges()) {
+        return;
+    }
+    // Unchanged parameters are copied as well, that is cheaper than keeping
+    // track of them
+    for (int i = 0; i < m_parameters.size(); ++i) {
+        m_parameters[i]->setValues(m_parameterBlock.getValues(i));
+    }
+}
+
 void EngineEffect::process(const ChannelHandle& handle,
                            const CSAMPLE* pInput, CSAMPLE* pOutput,
                            const unsigned int numSamples,
@@ -96,7 +99,9 @@ void EngineEffect::process(const ChannelHandle& handle,
     EffectProcessor::EnableState effectiveEnableState = m_enableState;
     if (enableState == EffectProcessor::DISABLING) {
         effectiveEnableState = EffectProcessor::DISABLING;
-    } else if (enableState == EffectProcessor::ENABLING) {
+    } else if (enableState == EffectProcessor::ENABLING &&
+            m_enableState != EffectProcessor::DISABLING) {
+        // The effect may have been disabled while the chain was dry
         effectiveEnableState = EffectProcessor::ENABLING;
     }
 
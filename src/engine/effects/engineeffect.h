@@ -13,6 +13,7 @@
 #include "effects/effectinstantiator.h"
 #include "engine/channelhandle.h"
 #include "engine/effects/engineeffectparameter.h"
+#include "engine/effects/engineeffectparameterblock.h"
 #include "engine/effects/message.h"
 #include "engine/effects/groupfeaturestate.h"
 
@@ -35,6 +36,14 @@ class EngineEffect : public EffectsRequestHandler {
         const EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
+    // Called from the main thread, takes effect at the start of the next
+    // callback. Returns false if there is no such parameter.
+    bool setParameterValues(int iParameter,
+            const EngineEffectParameter::Values& values);
+
+    // Called from the engine thread at the start of each callback
+    void updateParameters();
+
     void process(const ChannelHandle& handle,
                  const CSAMPLE* pInput, CSAMPLE* pOutput,
                  const unsigned int numSamples,
@@ -46,6 +55,11 @@ class EngineEffect : public EffectsRequestHandler {
         return m_enableState == EffectProcessor::DISABLED;
     }
 
+    // True if pInput may be equal to pOutput in process()
+    bool processesInPlace() const {
+        return m_processesInPlace;
+    }
+
   private:
     QString debugString() const {
         return QString("EngineEffect(%1)").arg(m_manifest.name());
@@ -55,9 +69,11 @@ class EngineEffect : public EffectsRequestHandler {
     EffectProcessor* m_pProcessor;
     EffectProcessor::EnableState m_enableState;
     bool m_effectRampsFromDry;
+    bool m_processesInPlace;
     // Must not be modified after construction.
     QVector<EngineEffectParameter*> m_parameters;
     QMap<QString, EngineEffectParameter*> m_parametersById;
+    EngineEffectParameterBlock m_parameterBlock;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffect);
 };
@@ -4,13 +4,22 @@
 #include "util/defs.h"
 #include "util/sample.h"
 
+namespace {
+
+// Longer than the longest delay of an effect, e.g. EchoEffect has up to 3
+// seconds between an echo and its repetition.
+const unsigned int kSleepAfterSeconds = 4;
+
+} // anonymous namespace
+
 EngineEffectChain::EngineEffectChain(const QString& id)
         : m_id(id),
           m_enableState(EffectProcessor::ENABLED),
           m_insertionType(EffectChain::INSERT),
           m_dMix(0),
           m_buffer1(MAX_BUFFER_LEN),
-          m_buffer2(MAX_BUFFER_LEN) {
+          m_buffer2(MAX_BUFFER_LEN),
+          m_skippedProcessCounter("EngineEffectChain::process skipped") {
     // Try to prevent memory allocation.
     m_effects.reserve(256);
 }
@@ -188,37 +197,86 @@ void EngineEffectChain::process(const ChannelHandle& handle,
         // Tell the effects that this is the last call before disabling
         effectiveEnableState = EffectProcessor::DISABLING;
     }
+    // The effects keep processing while the chain is fully dry, so that
+    // e.g. the tail of an echo is up to date when the mix is raised again.
+    // Only the mixing is skipped.
+    const bool fullyDry = wet_gain == 0.0 && wet_gain_old == 0.0;
+
+    // If only the effected signal is heard, the effects may write to pInOut
+    // and the dry/wet mix is not needed.
+    const bool fullyWet = m_insertionType == EffectChain::INSERT &&
+            wet_gain == 1.0 && wet_gain_old == 1.0;
+
+    int lastEnabledEffect = -1;
+    for (int i = 0; i < m_effects.size(); ++i) {
+        EngineEffect* pEffect = m_effects[i];
+        if (pEffect != nullptr && !pEffect->disabled()) {
+            lastEnabledEffect = i;
+        }
+    }
+    if (lastEnabledEffect < 0) {
+        channel_info.old_gain = wet_gain;
+        return;
+    }
+
+    // Once the input and the tail of the effects have been silent for a
+    // while, the chain sleeps until the input gets audible again. The effects
+    // then process that whole buffer, so no sample of the new input is lost.
+    const bool inputSilent = SampleUtil::isSilent(pInOut, numSamples);
+    if (!inputSilent) {
+        channel_info.silent_samples = 0;
+    } else if (channel_info.silent_samples >=
+            kSleepAfterSeconds * sampleRate * 2) {
+        m_skippedProcessCounter.increment();
+        channel_info.old_gain = wet_gain;
+        return;
+    }
 
     // Ramping code inside the effects need to access the original samples
-    // after writing to the output buffer. This requires not to use the same buffer
-    // for in and output:
-    int enabledEffectCount = 0;
+    // after writing to the output buffer. This requires not to use the same
+    // buffer for in and output, unless the effect is able to process in place.
+    // pInOut is only overwritten if the dry signal is not needed for mixing.
     CSAMPLE* pIntermediateInput = pInOut;
-    CSAMPLE* pIntermediateOutput = m_buffer1.data();
-
-    for (EngineEffect* pEffect: m_effects) {
+    for (int i = 0; i <= lastEnabledEffect; ++i) {
+        EngineEffect* pEffect = m_effects[i];
         if (pEffect == nullptr || pEffect->disabled()) {
             continue;
         }
+
+        CSAMPLE* pIntermediateOutput;
+        if (pEffect->processesInPlace() &&
+                (fullyWet || pIntermediateInput != pInOut)) {
+            pIntermediateOutput = pIntermediateInput;
+        } else if (fullyWet && i == lastEnabledEffect &&
+                pIntermediateInput != pInOut) {
+            // The input is one of our buffers, so the last effect may
+            // write to pInOut
+            pIntermediateOutput = pInOut;
+        } else if (pIntermediateInput == m_buffer1.data()) {
+            pIntermediateOutput = m_buffer2.data();
+        } else {
+            pIntermediateOutput = m_buffer1.data();
+        }
+
         pEffect->process(
                 handle,
                 pIntermediateInput, pIntermediateOutput,
                 numSamples, sampleRate,
                 effectiveEnableState, groupFeatures);
+        pIntermediateInput = pIntermediateOutput;
+    }
 
-        ++enabledEffectCount;
-        if (enabledEffectCount % 2) {
-            pIntermediateInput = m_buffer1.data();
-            pIntermediateOutput = m_buffer2.data();
+    if (inputSilent) {
+        if (SampleUtil::isSilent(pIntermediateInput, numSamples)) {
+            channel_info.silent_samples += numSamples;
         } else {
-            pIntermediateInput = m_buffer2.data();
-            pIntermediateOutput = m_buffer1.data();
+            channel_info.silent_samples = 0;
         }
     }
 
-    // Mix the effected signal, unless no effects are enabled
-    // or the chain is fully dry and not ramping.
-    if (enabledEffectCount > 0 && !(wet_gain == 0.0 && wet_gain_old == 0.0)) {
+    // Mix the effected signal, unless it has already been written to pInOut
+    // or would not be heard
+    if (pIntermediateInput != pInOut && !fullyDry) {
         if (m_insertionType == EffectChain::INSERT) {
             // INSERT mode: output = input * (1-wet) + effect(input) * wet
             SampleUtil::copy2WithRampingGain(
@@ -6,6 +6,7 @@
 #include <QLinkedList>
 
 #include "util/class.h"
+#include "util/counter.h"
 #include "util/types.h"
 #include "util/samplebuffer.h"
 #include "util/memory.h"
@@ -41,10 +42,14 @@ class EngineEffectChain : public EffectsRequestHandler {
     struct ChannelStatus {
         ChannelStatus()
                 : old_gain(0),
-                  enable_state(EffectProcessor::DISABLED) {
+                  enable_state(EffectProcessor::DISABLED),
+                  silent_samples(0) {
         }
         CSAMPLE old_gain;
         EffectProcessor::EnableState enable_state;
+        // The number of samples since the input or the output of the
+        // effects was last audible
+        unsigned int silent_samples;
     };
 
     QString debugString() const {
@@ -69,6 +74,8 @@ class EngineEffectChain : public EffectsRequestHandler {
     SampleBuffer m_buffer1;
     SampleBuffer m_buffer2;
     ChannelHandleMap<ChannelStatus> m_channelStatus;
+    // Counts the calls of process() for a sleeping channel
+    Counter m_skippedProcessCounter;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffectChain);
 };
@@ -9,6 +9,15 @@
 
 class EngineEffectParameter {
   public:
+    // All settings of a parameter, they are changed together so the value
+    // is never outside of the range it was set with.
+    struct Values {
+        double value;
+        double defaultValue;
+        double minimum;
+        double maximum;
+    };
+
     EngineEffectParameter(const EffectManifestParameter& parameter)
             : m_parameter(parameter) {
         // NOTE(rryan): This is just to set the parameter values to sane
@@ -76,6 +85,21 @@ class EngineEffectParameter {
         m_maximum = maximum;
     }
 
+    inline Values values() const {
+        Values values;
+        values.value = m_value;
+        values.defaultValue = m_defaultValue;
+        values.minimum = m_minimum;
+        values.maximum = m_maximum;
+        return values;
+    }
+    inline void setValues(const Values& values) {
+        m_value = values.value;
+        m_defaultValue = values.defaultValue;
+        m_minimum = values.minimum;
+        m_maximum = values.maximum;
+    }
+
   private:
     EffectManifestParameter m_parameter;
     double m_value;
@@ -0,0 +1,62 @@
+#ifndef ENGINEEFFECTPARAMETERBLOCK_H
+#define ENGINEEFFECTPARAMETERBLOCK_H
+
+#include <QAtomicInt>
+
+#include "control/controlvalue.h"
+#include "engine/effects/engineeffectparameter.h"
+#include "util/class.h"
+#include "util/memory.h"
+
+// The parameters of an EngineEffect as they were last set by the main thread.
+// Setting and reading are wait-free, so the main thread does not need to send
+// a message to the engine for each turn of a knob. The engine copies the
+// parameters that changed once at the start of each callback, so an effect
+// sees the same values throughout a callback.
+class EngineEffectParameterBlock {
+  public:
+    explicit EngineEffectParameterBlock(int numParameters)
+            : m_numParameters(numParameters),
+              m_pValues(new ControlValueAtomic<EngineEffectParameter::Values>[
+                      numParameters]),
+              m_changes(0),
+              m_changesTaken(0) {
+    }
+
+    int size() const {
+        return m_numParameters;
+    }
+
+    // Called from the main thread
+    void setValues(int iParameter,
+            const EngineEffectParameter::Values& values) {
+        m_pValues[iParameter].setValue(values);
+        m_changes.fetchAndAddRelease(1);
+    }
+
+    // Called from the engine thread. Returns false if no parameter was set
+    // since the last call.
+    bool takeChanges() {
+        const int changes = m_changes.fetchAndAddAcquire(0);
+        if (changes == m_changesTaken) {
+            return false;
+        }
+        m_changesTaken = changes;
+        return true;
+    }
+
+    // Called from the engine thread
+    EngineEffectParameter::Values getValues(int iParameter) const {
+        return m_pValues[iParameter].getValue();
+    }
+
+  private:
+    const int m_numParameters;
+    std::unique_ptr<ControlValueAtomic<EngineEffectParameter::Values>[]> m_pValues;
+    QAtomicInt m_changes;
+    int m_changesTaken;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineEffectParameterBlock);
+};
+
+#endif /* ENGINEEFFECTPARAMETERBLOCK_H */
@@ -97,7 +97,6 @@ void EngineEffectsManager::onCallbackStart() {
                 }
                 break;
             case EffectsRequest::SET_EFFECT_PARAMETERS:
-            case EffectsRequest::SET_PARAMETER_PARAMETERS:
                 if (!m_effects.contains(request->pTargetEffect)) {
                     if (kEffectDebugOutput) {
                         qDebug() << debugString()
@@ -128,6 +127,13 @@ void EngineEffectsManager::onCallbackStart() {
             m_pResponsePipe->writeMessages(&response, 1);
         }
     }
+
+    // The parameters don't go through the pipe. Taking them here, after
+    // the effects that were added, gives each effect the same parameters
+    // for the whole callback.
+    for (EngineEffect* pEffect : m_effects) {
+        pEffect->updateParameters();
+    }
 }
 
 void EngineEffectsManager::process(const ChannelHandle& handle,
@@ -32,9 +32,9 @@ struct EffectsRequest {
         ENABLE_EFFECT_CHAIN_FOR_CHANNEL,
         DISABLE_EFFECT_CHAIN_FOR_CHANNEL,
 
-        // Messages for EngineEffect
+        // Messages for EngineEffect. The parameters of an effect are not set
+        // with messages but through EngineEffect::setParameterValues().
         SET_EFFECT_PARAMETERS,
-        SET_PARAMETER_PARAMETERS,
 
         // Must come last.
         NUM_REQUEST_TYPES
@@ -42,11 +42,7 @@ struct EffectsRequest {
 
     EffectsRequest()
             : type(NUM_REQUEST_TYPES),
-              request_id(-1),
-              minimum(0.0),
-              maximum(0.0),
-              default_value(0.0),
-              value(0.0) {
+              request_id(-1) {
         pTargetRack = NULL;
         pTargetChain = NULL;
         pTargetEffect = NULL;
@@ -59,7 +55,6 @@ struct EffectsRequest {
         CLEAR_STRUCT(RemoveEffectFromChain);
         CLEAR_STRUCT(SetEffectChainParameters);
         CLEAR_STRUCT(SetEffectParameters);
-        CLEAR_STRUCT(SetParameterParameters);
 #undef CLEAR_STRUCT
     }
 
@@ -80,7 +75,7 @@ struct EffectsRequest {
         // - DISABLE_EFFECT_CHAIN_FOR_CHANNEL
         EngineEffectChain* pTargetChain;
         // Used by:
-        // - SET_EFFECT_PARAMETER
+        // - SET_EFFECT_PARAMETERS
         EngineEffect* pTargetEffect;
     };
 
@@ -116,9 +111,6 @@ struct EffectsRequest {
         struct {
             bool enabled;
         } SetEffectParameters;
-        struct {
-            int iParameter;
-        } SetParameterParameters;
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -127,12 +119,6 @@ struct EffectsRequest {
 
     // Used by ENABLE_EFFECT_CHAIN_FOR_CHANNEL and DISABLE_EFFECT_CHAIN_FOR_CHANNEL.
     ChannelHandle channel;
-
-    // Used by SET_EFFECT_PARAMETER.
-    double minimum;
-    double maximum;
-    double default_value;
-    double value;
 };
 
 struct EffectsResponse {
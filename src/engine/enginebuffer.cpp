@@ -14,6 +14,7 @@
 #include "engine/cuecontrol.h"
 #include "engine/enginebufferscalelinear.h"
 #include "engine/enginebufferscalerubberband.h"
+#include "engine/enginebufferscalesinc.h"
 #include "engine/enginebufferscalest.h"
 #include "engine/enginechannel.h"
 #include "engine/enginecontrol.h"
@@ -47,6 +48,11 @@ const double kLinearScalerElipsis = 1.00058; // 2^(0.01/12): changes < 1 cent al
 
 const SINT kSamplesPerFrame = 2; // Engine buffer uses Stereo frames only
 
+// The sinc scaler is used between these rates, once used it is kept until
+// the rate leaves the range by kSincRateHysteresis
+const double kSincMinRate = 0.1;
+const double kSincRateHysteresis = 1.1;
+
 } // anonymous namespace
 
 EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
@@ -79,6 +85,9 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
           m_pRepeat(NULL),
           m_startButton(NULL),
           m_endButton(NULL),
+          m_pScaleRBWorker(NULL),
+          m_pScaleRBWorkerInCallback(NULL),
+          m_pWorkerScheduler(NULL),
           m_bScalerOverride(false),
           m_iSeekQueued(SEEK_NONE),
           m_iSeekPhaseQueued(0),
@@ -180,6 +189,12 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
     m_pKeylock = new ControlPushButton(ConfigKey(m_group, "keylock"), true);
     m_pKeylock->setButtonMode(ControlPushButton::TOGGLE);
 
+    // 0: linear interpolation, 1-3: sinc resampler of increasing quality
+    m_pResamplerQuality = new ControlPushButton(
+            ConfigKey(m_group, "resampler_quality"), true);
+    m_pResamplerQuality->setButtonMode(ControlPushButton::TOGGLE);
+    m_pResamplerQuality->setStates(4);
+
     m_pEject = new ControlPushButton(ConfigKey(m_group, "eject"));
     connect(m_pEject, SIGNAL(valueChanged(double)),
             this, SLOT(slotEjectTrack(double)),
@@ -243,13 +258,10 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
 
     // Construct scaling objects
     m_pScaleLinear = new EngineBufferScaleLinear(m_pReadAheadManager);
+    m_pScaleSinc = new EngineBufferScaleSinc(m_pReadAheadManager);
     m_pScaleST = new EngineBufferScaleST(m_pReadAheadManager);
     m_pScaleRB = new EngineBufferScaleRubberBand(m_pReadAheadManager);
-    if (m_pKeylockEngine->get() == SOUNDTOUCH) {
-        m_pScaleKeylock = m_pScaleST;
-    } else {
-        m_pScaleKeylock = m_pScaleRB;
-    }
+    slotKeylockEngineChanged(m_pKeylockEngine->get());
     m_pScaleVinyl = m_pScaleLinear;
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
@@ -300,10 +312,13 @@ EngineBuffer::~EngineBuffer() {
     delete m_pTrackSampleRate;
 
     delete m_pScaleLinear;
+    delete m_pScaleSinc;
     delete m_pScaleST;
     delete m_pScaleRB;
+    delete m_pScaleRBWorker.fetchAndStoreOrdered(NULL);
 
     delete m_pKeylock;
+    delete m_pResamplerQuality;
     delete m_pEject;
 
     SampleUtil::free(m_pCrossfadeBuffer);
@@ -332,6 +347,13 @@ void EngineBuffer::enableIndependentPitchTempoScaling(bool bEnable,
     // so cache it.
     EngineBufferScale* keylock_scale = m_pScaleKeylock;
     EngineBufferScale* vinyl_scale = m_pScaleVinyl;
+    if (!m_bScalerOverride && keylock_scale != m_pScaleST &&
+            keylock_scale != m_pScaleRB &&
+            keylock_scale != m_pScaleRBWorkerInCallback) {
+        // The worker scaler has just been created and is acquired by the
+        // next callback
+        keylock_scale = m_pScaleRB;
+    }
 
     if (bEnable && m_pScale != keylock_scale) {
         if (m_speed_old != 0.0) {
@@ -355,6 +377,32 @@ void EngineBuffer::enableIndependentPitchTempoScaling(bool bEnable,
     }
 }
 
+void EngineBuffer::updateVinylScaler(double rate, bool is_scratching) {
+    // MUST ACQUIRE THE PAUSE MUTEX BEFORE CALLING THIS METHOD
+
+    // The sinc resampler can't ramp through zero and has filters only up to
+    // EngineBufferScaleSinc::kMaxRate, so scratching, slow speeds and speeds
+    // above kMaxRate, like fast searching, fall back to the linear scaler.
+    // The switch is crossfaded by enableIndependentPitchTempoScaling(), the
+    // hysteresis avoids crossfading back and forth around the limits.
+    const int quality = static_cast<int>(m_pResamplerQuality->get());
+    double minRate = kSincMinRate;
+    double maxRate = EngineBufferScaleSinc::kMaxRate;
+    if (m_pScaleVinyl == m_pScaleSinc) {
+        minRate /= kSincRateHysteresis;
+        maxRate *= kSincRateHysteresis;
+    }
+    if (quality > 0 && !is_scratching &&
+            fabs(rate) >= minRate &&
+            fabs(rate) <= maxRate) {
+        m_pScaleSinc->setQuality(
+                static_cast<EngineBufferScaleSinc::Quality>(quality - 1));
+        m_pScaleVinyl = m_pScaleSinc;
+    } else {
+        m_pScaleVinyl = m_pScaleLinear;
+    }
+}
+
 double EngineBuffer::getBpm()
 {
     return m_pBpmControl->getBpm();
@@ -711,11 +759,33 @@ void EngineBuffer::slotKeylockEngineChanged(double dIndex) {
     KeylockEngine engine = static_cast<KeylockEngine>(iEngine);
     if (engine == SOUNDTOUCH) {
         m_pScaleKeylock = m_pScaleST;
+    } else if (engine == RUBBERBAND_WORKER) {
+        m_pScaleKeylock = createScaleRBWorker();
     } else {
         m_pScaleKeylock = m_pScaleRB;
     }
 }
 
+EngineBufferScaleRubberBand* EngineBuffer::createScaleRBWorker() {
+    EngineBufferScaleRubberBand* pScale = m_pScaleRBWorker.fetchAndAddAcquire(0);
+    if (pScale) {
+        return pScale;
+    }
+    // Allocates and starts the worker thread outside of the callback
+    pScale = new EngineBufferScaleRubberBand(m_pReadAheadManager, true);
+    pScale->setScheduler(m_pWorkerScheduler);
+    const int sampleRate = static_cast<int>(m_pSampleRate->get());
+    if (sampleRate > 0) {
+        pScale->setSampleRate(sampleRate);
+    }
+    // Publishes the constructed scaler to the callback, see process()
+    if (!m_pScaleRBWorker.testAndSetOrdered(NULL, pScale)) {
+        delete pScale;
+        pScale = m_pScaleRBWorker.fetchAndAddAcquire(0);
+    }
+    return pScale;
+}
+
 void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     // Bail if we receive a buffer size with incomplete sample frames. Assert in debug builds.
     VERIFY_OR_DEBUG_ASSERT((iBufferSize % kSamplesPerFrame) == 0) {
@@ -741,11 +811,21 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     // We do this even if rubberband is not active.
     if (sample_rate != m_iSampleRate) {
         m_pScaleLinear->setSampleRate(sample_rate);
+        m_pScaleSinc->setSampleRate(sample_rate);
         m_pScaleST->setSampleRate(sample_rate);
         m_pScaleRB->setSampleRate(sample_rate);
         m_iSampleRate = sample_rate;
     }
 
+    // The worker scaler is created by slotKeylockEngineChanged() in another
+    // thread. It may only be used by the callback after it has been acquired.
+    m_pScaleRBWorkerInCallback = m_pScaleRBWorker.fetchAndAddAcquire(0);
+    if (m_pScaleRBWorkerInCallback &&
+            m_pScaleRBWorkerInCallback->getAudioSignal().getSamplingRate() !=
+                    sample_rate) {
+        m_pScaleRBWorkerInCallback->setSampleRate(sample_rate);
+    }
+
     bool bTrackLoading = load_atomic(m_iTrackLoading) != 0;
     if (!bTrackLoading && m_pause.tryLock()) {
         ScopedTimer t("EngineBuffer::process_pauselock");
@@ -838,6 +918,10 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             }
         }
 
+        if (!m_bScalerOverride) {
+            updateVinylScaler(baserate * speed, is_scratching);
+        }
+
         if (speed != 0.0) {
             // Do not switch scaler when we have no transport
             enableIndependentPitchTempoScaling(useIndependentPitchAndTempoScaling,
@@ -912,6 +996,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             // For the other, crossfade forward and backward samples
             if ((m_speed_old * speed < 0) &&  // Direction has changed!
                     (m_pScale != m_pScaleVinyl || // only m_pScaleLinear supports going though 0
+                           m_pScale == m_pScaleSinc ||
                            m_reverse_old != is_reverse)) { // no pitch change when reversing
                 //XXX: Trying to force RAMAN to read from correct
                 //     playpos when rate changes direction - Albert
@@ -1284,6 +1369,12 @@ void EngineBuffer::addControl(EngineControl* pControl) {
 
 void EngineBuffer::bindWorkers(EngineWorkerScheduler* pWorkerScheduler) {
     m_pReader->setScheduler(pWorkerScheduler);
+    m_pWorkerScheduler = pWorkerScheduler;
+    EngineBufferScaleRubberBand* pScaleRBWorker =
+            m_pScaleRBWorker.fetchAndAddAcquire(0);
+    if (pScaleRBWorker) {
+        pScaleRBWorker->setScheduler(pWorkerScheduler);
+    }
 }
 
 bool EngineBuffer::isTrackLoaded() {
@@ -1293,6 +1384,11 @@ bool EngineBuffer::isTrackLoaded() {
     return false;
 }
 
+bool EngineBuffer::collectReaderChunks() {
+    m_pReader->process();
+    return !m_pReader->isReadPending();
+}
+
 void EngineBuffer::slotEjectTrack(double v) {
     if (v > 0) {
         // Don't allow rejections while playing a track. We don't need to lock to
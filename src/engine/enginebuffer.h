@@ -20,6 +20,7 @@
 
 #include <QMutex>
 #include <QAtomicInt>
+#include <QAtomicPointer>
 #include <gtest/gtest_prod.h>
 
 #include "engine/cachingreader.h"
@@ -28,6 +29,7 @@
 #include "engine/engineobject.h"
 #include "engine/sync/syncable.h"
 #include "track/track.h"
+#include "util/compatibility.h"
 #include "util/rotary.h"
 #include "util/types.h"
 
@@ -57,6 +59,7 @@ class ControlTTRotary;
 class ControlPotmeter;
 class EngineBufferScale;
 class EngineBufferScaleLinear;
+class EngineBufferScaleSinc;
 class EngineBufferScaleST;
 class EngineBufferScaleRubberBand;
 class EngineSync;
@@ -100,6 +103,7 @@ class EngineBuffer : public EngineObject {
     enum KeylockEngine {
         SOUNDTOUCH,
         RUBBERBAND,
+        RUBBERBAND_WORKER,
         KEYLOCK_ENGINE_COUNT,
     };
 
@@ -132,8 +136,19 @@ class EngineBuffer : public EngineObject {
 
     QString getGroup();
     bool isTrackLoaded();
+    // True while the reader loads a track. The trackLoaded() signal has been
+    // emitted once this becomes false again.
+    bool isTrackLoading() const {
+        return load_atomic(m_iTrackLoading) != 0;
+    }
     TrackPointer getLoadedTrack() const;
 
+    // Takes over the chunks the reader has read since the last callback and
+    // returns true if all requested chunks are available. OfflineRenderer
+    // waits for this before each callback instead of playing silence for
+    // chunks that could not be read in time.
+    bool collectReaderChunks();
+
     double getVisualPlayPos();
     double getTrackSamples();
 
@@ -155,6 +170,8 @@ class EngineBuffer : public EngineObject {
             return tr("Soundtouch (faster)");
         case RUBBERBAND:
             return tr("Rubberband (better)");
+        case RUBBERBAND_WORKER:
+            return tr("Rubberband on a worker thread (lower audio load, more latency)");
         default:
             return tr("Unknown (bad value)");
         }
@@ -200,6 +217,8 @@ class EngineBuffer : public EngineObject {
 
     void enableIndependentPitchTempoScaling(bool bEnable,
                                             const int iBufferSize);
+    // Selects the sinc resampler as vinyl scaler where it can be used
+    void updateVinylScaler(double rate, bool is_scratching);
 
     void updateIndicators(double rate, int iBufferSize);
 
@@ -217,6 +236,10 @@ class EngineBuffer : public EngineObject {
     // to prevent pops.
     void readToCrossfadeBuffer(const int iBufferSize);
 
+    // Returns the scaler of RUBBERBAND_WORKER, which is created on first use.
+    // Not called by the callback.
+    EngineBufferScaleRubberBand* createScaleRBWorker();
+
     // Reset buffer playpos and set file playpos.
     void setNewPlaypos(double playpos);
 
@@ -242,6 +265,7 @@ class EngineBuffer : public EngineObject {
     FRIEND_TEST(EngineSyncTest, HalfDoubleThenPlay);
     FRIEND_TEST(EngineSyncTest, UserTweakBeatDistance);
     FRIEND_TEST(EngineBufferTest, ScalerNoTransport);
+    FRIEND_TEST(EngineBufferE2ETest, RubberbandWorkerSeekTest);
     EngineSync* m_pEngineSync;
     SyncControl* m_pSyncControl;
     VinylControlControl* m_pVinylControlControl;
@@ -328,6 +352,7 @@ class EngineBuffer : public EngineObject {
     ControlProxy* m_pSampleRate;
     ControlProxy* m_pKeylockEngine;
     ControlPushButton* m_pKeylock;
+    ControlPushButton* m_pResamplerQuality;
 
     // This ControlProxys is created as parent to this and deleted by
     // the Qt object tree. This helps that they are deleted by the creating
@@ -358,9 +383,17 @@ class EngineBuffer : public EngineObject {
 
     // Object used for vinyl-style interpolation scaling of the audio
     EngineBufferScaleLinear* m_pScaleLinear;
+    // High quality alternative to m_pScaleLinear for playing at a rate
+    EngineBufferScaleSinc* m_pScaleSinc;
     // Objects used for pitch-indep time stretch (key lock) scaling of the audio
     EngineBufferScaleST* m_pScaleST;
     EngineBufferScaleRubberBand* m_pScaleRB;
+    // Created when RUBBERBAND_WORKER is selected for the first time, so
+    // only the players that use it start a worker thread
+    QAtomicPointer<EngineBufferScaleRubberBand> m_pScaleRBWorker;
+    // m_pScaleRBWorker as acquired by the current callback
+    EngineBufferScaleRubberBand* m_pScaleRBWorkerInCallback;
+    EngineWorkerScheduler* m_pWorkerScheduler;
 
     // Indicates whether the scaler has changed since the last process()
     bool m_bScalerChanged;
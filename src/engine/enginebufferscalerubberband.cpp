@@ -6,6 +6,7 @@
 
 #include "control/controlobject.h"
 #include "engine/readaheadmanager.h"
+#include "engine/rubberbandworker.h"
 #include "track/keyutils.h"
 #include "util/counter.h"
 #include "util/defs.h"
@@ -19,35 +20,65 @@ namespace {
 // This is the default increment from RubberBand 1.8.1.
 size_t kRubberBandBlockSize = 256;
 
+std::unique_ptr<RubberBandStretcher> makeRubberBand(
+        const mixxx::AudioSignal& audioSignal) {
+    return RubberBandWorker::makeStretcher(
+            audioSignal.getSamplingRate(),
+            audioSignal.getChannelCount());
+}
+
 }  // namespace
 
 EngineBufferScaleRubberBand::EngineBufferScaleRubberBand(
-        ReadAheadManager* pReadAheadManager)
+        ReadAheadManager* pReadAheadManager,
+        bool bWorkerThread)
         : m_pReadAheadManager(pReadAheadManager),
           m_buffer_back(SampleUtil::alloc(MAX_BUFFER_LEN)),
-          m_bBackwards(false) {
+          m_bBackwards(false),
+          m_dTimeRatio(1.0),
+          m_dPitchScale(1.0),
+          m_buffer_lookahead(nullptr),
+          m_lookaheadBlockFrames(0),
+          m_dLookaheadBlockInputFramesPerFrame(0.0),
+          m_bWorkerScheduled(false),
+          m_bWorkerRunning(false),
+          m_bWorkerStopping(false),
+          m_bWorkerParametersPending(false),
+          m_bWorkerRubberBandOutdated(false),
+          m_bWorkerRubberBandRequested(false) {
     m_retrieve_buffer[0] = SampleUtil::alloc(MAX_BUFFER_LEN);
     m_retrieve_buffer[1] = SampleUtil::alloc(MAX_BUFFER_LEN);
+    if (bWorkerThread) {
+        m_pWorker = std::make_unique<RubberBandWorker>();
+        m_pWorker->start(QThread::HighPriority);
+        m_buffer_lookahead = SampleUtil::alloc(MAX_BUFFER_LEN);
+    }
     initRubberBand();
 }
 
 EngineBufferScaleRubberBand::~EngineBufferScaleRubberBand() {
+    if (m_pWorker) {
+        m_pWorker->quitWait();
+    }
     SampleUtil::free(m_buffer_back);
+    SampleUtil::free(m_buffer_lookahead);
     SampleUtil::free(m_retrieve_buffer[0]);
     SampleUtil::free(m_retrieve_buffer[1]);
 }
 
+void EngineBufferScaleRubberBand::setScheduler(
+        EngineWorkerScheduler* pScheduler) {
+    if (m_pWorker) {
+        m_pWorker->setScheduler(pScheduler);
+        m_bWorkerScheduled = pScheduler != nullptr;
+    }
+}
+
 void EngineBufferScaleRubberBand::initRubberBand() {
-    m_pRubberBand = std::make_unique<RubberBandStretcher>(
-            getAudioSignal().getSamplingRate(),
-            getAudioSignal().getChannelCount(),
-            RubberBandStretcher::OptionProcessRealTime);
-    m_pRubberBand->setMaxProcessSize(kRubberBandBlockSize);
-    // Setting the time ratio to a very high value will cause RubberBand
-    // to preallocate buffers large enough to (almost certainly)
-    // avoid memory reallocations during playback.
-    m_pRubberBand->setTimeRatio(2.0);
-    m_pRubberBand->setTimeRatio(1.0);
+    m_pRubberBand = makeRubberBand(getAudioSignal());
+    if (m_pWorker) {
+        m_pWorkerRubberBand = makeRubberBand(getAudioSignal());
+    }
 }
 
 void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
@@ -78,6 +109,7 @@ void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
     if (pitchScale > 0) {
         //qDebug() << "EngineBufferScaleRubberBand setPitchScale" << *pitch << pitchScale;
         m_pRubberBand->setPitchScale(pitchScale);
+        m_dPitchScale = pitchScale;
     }
 
     // RubberBand handles checking for whether the change in timeRatio is a
@@ -105,18 +137,45 @@ void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
         *pTempoRatio = m_bBackwards ? -speed_abs : speed_abs;
     }
 
+    if (timeRatioInverse > 0) {
+        m_dTimeRatio = 1.0 / timeRatioInverse;
+    }
+
     // Used by other methods so we need to keep them up to date.
     m_dBaseRate = base_rate;
     m_dTempoRatio = speed_abs;
     m_dPitchRatio = *pPitchRatio;
+
+    if (m_bWorkerRunning) {
+        postWorkerParameters();
+    }
 }
 
 void EngineBufferScaleRubberBand::setSampleRate(SINT iSampleRate) {
     EngineBufferScale::setSampleRate(iSampleRate);
-    initRubberBand();
+    if (!m_pWorker) {
+        initRubberBand();
+        return;
+    }
+    m_pRubberBand = makeRubberBand(getAudioSignal());
+    if (m_bWorkerRunning) {
+        stopWorker();
+    } else if (isWorkerIdle()) {
+        // We stretch synchronously until the new stretcher of the worker
+        // is ready, so the lookahead would be out of date
+        clearLookahead();
+    }
+    // The stretcher of the worker may still be in use, it is replaced
+    // by the worker thread once the worker has become idle.
+    m_bWorkerRubberBandOutdated = true;
 }
 
 void EngineBufferScaleRubberBand::clear() {
+    if (m_bWorkerRunning) {
+        stopWorker();
+    } else if (m_pWorker && isWorkerIdle()) {
+        clearLookahead();
+    }
     m_pRubberBand->reset();
 }
 
@@ -155,10 +214,36 @@ double EngineBufferScaleRubberBand::scaleBuffer(
         return 0.0;
     }
 
+    const SINT frames = getAudioSignal().samples2frames(iOutputBufferSize);
+    if (m_bWorkerRunning) {
+        return scaleBufferFromWorker(pOutputBuffer, frames);
+    }
+    if (m_bWorkerScheduled && isWorkerReady()) {
+        return scaleBufferAndFillLookahead(pOutputBuffer, frames);
+    }
+
+    SINT total_received_frames = stretch(pOutputBuffer, frames);
+
+    // framesRead is interpreted as the total number of virtual sample frames
+    // consumed to produce the scaled buffer. Due to this, we do not take into
+    // account directionality or starting point.
+    // NOTE(rryan): Why no m_dPitchAdjust here? Pitch does not change the time
+    // ratio. m_dSpeedAdjust is the ratio of unstretched time to stretched
+    // time. So, if we used total_received_frames in stretched time, then
+    // multiplying that by the ratio of unstretched time to stretched time
+    // will get us the unstretched sample frames read.
+    double framesRead = m_dBaseRate * m_dTempoRatio * total_received_frames;
+
+    return framesRead;
+}
+
+SINT EngineBufferScaleRubberBand::stretch(
+        CSAMPLE* pOutputBuffer,
+        SINT frames) {
     SINT total_received_frames = 0;
     SINT total_read_frames = 0;
 
-    SINT remaining_frames = getAudioSignal().samples2frames(iOutputBufferSize);
+    SINT remaining_frames = frames;
     CSAMPLE* read = pOutputBuffer;
     bool last_read_failed = false;
     bool break_out_after_retrieve_and_reset_rubberband = false;
@@ -227,15 +312,204 @@ double EngineBufferScaleRubberBand::scaleBuffer(
         counter.increment();
     }
 
-    // framesRead is interpreted as the total number of virtual sample frames
-    // consumed to produce the scaled buffer. Due to this, we do not take into
-    // account directionality or starting point.
-    // NOTE(rryan): Why no m_dPitchAdjust here? Pitch does not change the time
-    // ratio. m_dSpeedAdjust is the ratio of unstretched time to stretched
-    // time. So, if we used total_received_frames in stretched time, then
-    // multiplying that by the ratio of unstretched time to stretched time
-    // will get us the unstretched sample frames read.
-    double framesRead = m_dBaseRate * m_dTempoRatio * total_received_frames;
+    return total_received_frames;
+}
 
+SINT EngineBufferScaleRubberBand::getLookaheadFrames(SINT frames) const {
+    // The worker is woken after each callback, so it has to stay more than
+    // one buffer ahead.
+    return 2 * frames + 2 * static_cast<SINT>(kRubberBandBlockSize);
+}
+
+void EngineBufferScaleRubberBand::postWorkerParameters() {
+    const RubberBandWorkerParameters parameters = {
+        m_dTimeRatio, m_dPitchScale, m_dBaseRate * m_dTempoRatio };
+    // Retried with the next buffer if the worker is behind
+    m_bWorkerParametersPending = !m_pWorker->setParameters(parameters);
+}
+
+bool EngineBufferScaleRubberBand::isWorkerIdle() {
+    if (!m_pWorker->isIdle()) {
+        return false;
+    }
+    if (m_bWorkerStopping) {
+        // The worker does not write anymore
+        clearLookahead();
+        m_bWorkerStopping = false;
+    }
+    return true;
+}
+
+bool EngineBufferScaleRubberBand::isWorkerReady() {
+    if (!isWorkerIdle()) {
+        return false;
+    }
+    if (m_bWorkerRubberBandRequested) {
+        RubberBandStretcher* pStretcher = m_pWorker->takeStretcher();
+        if (!pStretcher) {
+            return false;
+        }
+        m_pWorkerRubberBand.reset(pStretcher);
+        m_bWorkerRubberBandRequested = false;
+    }
+    if (m_bWorkerRubberBandOutdated) {
+        // Allocating and freeing a stretcher is too slow for the callback,
+        // the worker does it and we stretch synchronously meanwhile.
+        m_pWorker->requestStretcher(getAudioSignal().getSamplingRate(),
+                m_pWorkerRubberBand.release());
+        m_pWorker->workReady();
+        m_bWorkerRubberBandOutdated = false;
+        m_bWorkerRubberBandRequested = true;
+        return false;
+    }
+    return true;
+}
+
+void EngineBufferScaleRubberBand::clearLookahead() {
+    FIFO<CSAMPLE>& output = m_pWorker->outputFifo();
+    output.flushReadData(output.readAvailable());
+    FIFO<RubberBandWorkerBlock>& blocks = m_pWorker->blockFifo();
+    blocks.flushReadData(blocks.readAvailable());
+    m_lookaheadBlockFrames = 0;
+}
+
+void EngineBufferScaleRubberBand::stopWorker() {
+    // Stretch synchronously with the stretcher of the callback until
+    // the worker has reset its stretcher.
+    m_pWorker->stopStretching();
+    m_pWorker->workReady();
+    m_bWorkerRunning = false;
+    m_bWorkerStopping = true;
+}
+
+double EngineBufferScaleRubberBand::scaleBufferAndFillLookahead(
+        CSAMPLE* pOutputBuffer,
+        SINT frames) {
+    // The worker is idle, so the callback writes the output FIFO itself.
+    // Stretching one extra buffer per callback fills the lookahead without
+    // doubling the load of a single callback for long.
+    FIFO<CSAMPLE>& output = m_pWorker->outputFifo();
+    const SINT lookaheadFrames = getLookaheadFrames(frames);
+    // Large buffers give the callback enough time to stretch by itself
+    const bool bHandOver = lookaheadFrames <= RubberBandWorker::kMaxLookaheadFrames;
+    const SINT bufferedFrames = getAudioSignal().samples2frames<SINT>(
+            output.readAvailable());
+    SINT fillFrames = frames - bufferedFrames;
+    if (bHandOver) {
+        fillFrames = math_min(lookaheadFrames + frames - bufferedFrames,
+                2 * frames);
+    }
+    fillFrames = math_min(fillFrames, math_min(
+            getAudioSignal().samples2frames<SINT>(output.writeAvailable()),
+            getAudioSignal().samples2frames<SINT>(MAX_BUFFER_LEN)));
+    if (fillFrames > 0 && m_pWorker->blockFifo().writeAvailable() > 0) {
+        const SINT receivedFrames = stretch(m_buffer_lookahead, fillFrames);
+        const RubberBandWorkerBlock block = {
+            receivedFrames, m_dBaseRate * m_dTempoRatio };
+        m_pWorker->blockFifo().write(&block, 1);
+        output.write(m_buffer_lookahead,
+                getAudioSignal().frames2samples(receivedFrames));
+    }
+
+    const double framesRead = readFromLookahead(pOutputBuffer, frames);
+
+    if (bHandOver && getAudioSignal().samples2frames<SINT>(
+            output.readAvailable()) >= lookaheadFrames) {
+        // The worker continues with the state of our stretcher, we continue
+        // with its reset one.
+        m_pRubberBand.swap(m_pWorkerRubberBand);
+        m_pRubberBand->setPitchScale(m_dPitchScale);
+        m_pRubberBand->setTimeRatio(m_dTimeRatio);
+        const RubberBandWorkerParameters parameters = {
+            m_dTimeRatio, m_dPitchScale, m_dBaseRate * m_dTempoRatio };
+        m_pWorker->startStretching(m_pWorkerRubberBand.get(), parameters);
+        m_bWorkerRunning = true;
+        m_bWorkerParametersPending = false;
+        feedWorker(frames);
+        m_pWorker->workReady();
+    }
+    return framesRead;
+}
+
+double EngineBufferScaleRubberBand::scaleBufferFromWorker(
+        CSAMPLE* pOutputBuffer,
+        SINT frames) {
+    if (m_bWorkerParametersPending) {
+        postWorkerParameters();
+    }
+    const double framesRead = readFromLookahead(pOutputBuffer, frames);
+    feedWorker(frames);
+    m_pWorker->workReady();
     return framesRead;
 }
+
+double EngineBufferScaleRubberBand::readFromLookahead(
+        CSAMPLE* pOutputBuffer,
+        SINT frames) {
+    FIFO<CSAMPLE>& output = m_pWorker->outputFifo();
+    const SINT readFrames = math_min(frames,
+            getAudioSignal().samples2frames<SINT>(output.readAvailable()));
+    output.read(pOutputBuffer, getAudioSignal().frames2samples(readFrames));
+
+    // The frames were stretched with the parameters of their block, which
+    // may be older than the current ones. Consuming the input with these
+    // keeps the play position in line with what is heard.
+    double framesRead = 0.0;
+    SINT remainingFrames = readFrames;
+    while (remainingFrames > 0) {
+        if (m_lookaheadBlockFrames == 0) {
+            RubberBandWorkerBlock block;
+            if (m_pWorker->blockFifo().read(&block, 1) != 1) {
+                // The block is always written before its frames
+                DEBUG_ASSERT(false);
+                break;
+            }
+            m_lookaheadBlockFrames = block.frames;
+            m_dLookaheadBlockInputFramesPerFrame = block.inputFramesPerFrame;
+        }
+        const SINT blockFrames = math_min(remainingFrames, m_lookaheadBlockFrames);
+        framesRead += blockFrames * m_dLookaheadBlockInputFramesPerFrame;
+        m_lookaheadBlockFrames -= blockFrames;
+        remainingFrames -= blockFrames;
+    }
+
+    if (readFrames < frames) {
+        SampleUtil::clear(
+                pOutputBuffer + getAudioSignal().frames2samples(readFrames),
+                getAudioSignal().frames2samples(frames - readFrames));
+        Counter counter("EngineBufferScaleRubberBand::getScaled underflow");
+        counter.increment();
+    }
+    return framesRead;
+}
+
+void EngineBufferScaleRubberBand::feedWorker(SINT frames) {
+    // Keep the stretched and the pending input frames at the lookahead
+    FIFO<CSAMPLE>& input = m_pWorker->inputFifo();
+    const double inputFramesPerFrame = m_dBaseRate * m_dTempoRatio;
+    const double bufferedFrames =
+            getAudioSignal().samples2frames<SINT>(
+                    m_pWorker->outputFifo().readAvailable()) +
+            getAudioSignal().samples2frames<SINT>(input.readAvailable()) /
+                    inputFramesPerFrame;
+    const SINT lookaheadFrames = math_min(getLookaheadFrames(frames),
+            RubberBandWorker::kMaxLookaheadFrames);
+    if (bufferedFrames >= lookaheadFrames) {
+        return;
+    }
+    const SINT readFrames = math_min(
+            static_cast<SINT>(ceil((lookaheadFrames - bufferedFrames) *
+                    inputFramesPerFrame)),
+            math_min(getAudioSignal().samples2frames<SINT>(input.writeAvailable()),
+                    getAudioSignal().samples2frames<SINT>(MAX_BUFFER_LEN)));
+    if (readFrames <= 0) {
+        return;
+    }
+    const SINT readSamples = m_pReadAheadManager->getNextSamples(
+            // The value doesn't matter here. All that matters is we
+            // are going forward or backward.
+            (m_bBackwards ? -1.0 : 1.0) * inputFramesPerFrame,
+            m_buffer_back,
+            getAudioSignal().frames2samples(readFrames));
+    input.write(m_buffer_back, readSamples);
+}
@@ -8,16 +8,30 @@ namespace RubberBand {
 class RubberBandStretcher;
 }  // namespace RubberBand
 
+class EngineWorkerScheduler;
 class ReadAheadManager;
+class RubberBandWorker;
 
 // Uses librubberband to scale audio.  This class is not thread safe.
+//
+// With bWorkerThread the stretching runs on a RubberBandWorker a few blocks
+// ahead of the callback, which still reads the unscaled samples from the
+// ReadAheadManager. Each callback without a running worker stretches one
+// extra buffer into the lookahead until the worker takes over. After a
+// clear() or a sample rate change the callback stretches synchronously until
+// the worker has returned its stretcher, so seeks are not delayed by the
+// lookahead and the callback never waits for the worker.
 class EngineBufferScaleRubberBand : public EngineBufferScale {
     Q_OBJECT
   public:
     explicit EngineBufferScaleRubberBand(
-            ReadAheadManager* pReadAheadManager);
+            ReadAheadManager* pReadAheadManager,
+            bool bWorkerThread = false);
     ~EngineBufferScaleRubberBand() override;
 
+    // Stretching ahead starts once the worker can be scheduled
+    void setScheduler(EngineWorkerScheduler* pScheduler);
+
     void setScaleParameters(double base_rate,
                             double* pTempoRatio,
                             double* pPitchRatio) override;
@@ -37,10 +51,30 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
 
     void deinterleaveAndProcess(const CSAMPLE* pBuffer, SINT frames, bool flush);
     SINT retrieveAndDeinterleave(CSAMPLE* pBuffer, SINT frames);
+    // Stretches synchronously and returns the received frames
+    SINT stretch(CSAMPLE* pOutputBuffer, SINT frames);
+
+    // Returns the frames to stretch ahead for the given buffer size
+    SINT getLookaheadFrames(SINT frames) const;
+    void postWorkerParameters();
+    // Drains the FIFOs of the worker once it has become idle again
+    bool isWorkerIdle();
+    // Returns true if the worker is idle and has an up to date stretcher.
+    // An outdated stretcher is replaced by the worker thread.
+    bool isWorkerReady();
+    // Drops the stretched frames that have not been read
+    void clearLookahead();
+    // Returns immediately, the worker becomes idle after its current block
+    void stopWorker();
+    double scaleBufferAndFillLookahead(CSAMPLE* pOutputBuffer, SINT frames);
+    double scaleBufferFromWorker(CSAMPLE* pOutputBuffer, SINT frames);
+    double readFromLookahead(CSAMPLE* pOutputBuffer, SINT frames);
+    void feedWorker(SINT frames);
 
     // The read-ahead manager that we use to fetch samples
     ReadAheadManager* m_pReadAheadManager;
 
+    // Owned by the callback, also while the worker is running
     std::unique_ptr<RubberBand::RubberBandStretcher> m_pRubberBand;
 
     CSAMPLE* m_retrieve_buffer[2];
@@ -48,6 +82,28 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
 
     // Holds the playback direction
     bool m_bBackwards;
+
+    // The parameters of the last setScaleParameters() call
+    double m_dTimeRatio;
+    double m_dPitchScale;
+
+    // Only used with bWorkerThread
+    std::unique_ptr<RubberBandWorker> m_pWorker;
+    // The stretcher of the worker, handed over with the state of the
+    // stretcher of the callback
+    std::unique_ptr<RubberBand::RubberBandStretcher> m_pWorkerRubberBand;
+    CSAMPLE* m_buffer_lookahead;
+    // The part of the block in the output FIFO that is not read yet
+    SINT m_lookaheadBlockFrames;
+    double m_dLookaheadBlockInputFramesPerFrame;
+    bool m_bWorkerScheduled;
+    bool m_bWorkerRunning;
+    bool m_bWorkerStopping;
+    bool m_bWorkerParametersPending;
+    // Set by a sample rate change until the worker is idle
+    bool m_bWorkerRubberBandOutdated;
+    // Set until the worker has created the replacement stretcher
+    bool m_bWorkerRubberBandRequested;
 };
 
 
@@ -0,0 +1,320 @@
+#include "engine/enginebufferscalesinc.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include <QtDebug>
+#include <vector>
+
+#include "util/assert.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// The phases of the polyphase table, the coefficients between two phases
+// are interpolated linearly.
+const int kPhases = 128;
+
+// The half length of the longest filter. Enough history for it is always
+// kept, so the quality can change without gaps.
+const SINT kMaxHalfTaps = 16;
+
+// The frames of m_input
+const SINT kInputFrames = 8192;
+
+struct QualityParameters {
+    int taps;
+    // The cutoff at rates up to 1 as a ratio of the Nyquist frequency
+    double rolloff;
+    double kaiserBeta;
+};
+
+const QualityParameters kQualityParameters[] = {
+    { 8, 0.80, 5.0 },
+    { 16, 0.88, 7.0 },
+    { 32, 0.94, 9.0 },
+};
+
+// The modified Bessel function of the first kind of order zero
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = x / 2;
+    for (int k = 1; k < 50; ++k) {
+        term *= halfX / k;
+        const double squaredTerm = term * term;
+        sum += squaredTerm;
+        if (squaredTerm < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+inline void convolve(const CSAMPLE* pRow0, const CSAMPLE* pRow1,
+        CSAMPLE frac, const CSAMPLE* pLeft, const CSAMPLE* pRight,
+        int taps, CSAMPLE* pOutput) {
+#ifdef __SSE__
+    // All tap counts are multiples of 4
+    const __m128 vFrac = _mm_set1_ps(frac);
+    __m128 sumLeft = _mm_setzero_ps();
+    __m128 sumRight = _mm_setzero_ps();
+    for (int k = 0; k < taps; k += 4) {
+        const __m128 coef0 = _mm_loadu_ps(pRow0 + k);
+        const __m128 coef1 = _mm_loadu_ps(pRow1 + k);
+        const __m128 coef = _mm_add_ps(coef0,
+                _mm_mul_ps(vFrac, _mm_sub_ps(coef1, coef0)));
+        sumLeft = _mm_add_ps(sumLeft,
+                _mm_mul_ps(coef, _mm_loadu_ps(pLeft + k)));
+        sumRight = _mm_add_ps(sumRight,
+                _mm_mul_ps(coef, _mm_loadu_ps(pRight + k)));
+    }
+    // [l0 + l2, r0 + r2, l1 + l3, r1 + r3]
+    __m128 sum = _mm_add_ps(_mm_unpacklo_ps(sumLeft, sumRight),
+            _mm_unpackhi_ps(sumLeft, sumRight));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    _mm_storel_pi(reinterpret_cast<__m64*>(pOutput), sum);
+#else
+    CSAMPLE sumLeft = 0;
+    CSAMPLE sumRight = 0;
+    for (int k = 0; k < taps; ++k) {
+        const CSAMPLE coef = pRow0[k] + frac * (pRow1[k] - pRow0[k]);
+        sumLeft += coef * pLeft[k];
+        sumRight += coef * pRight[k];
+    }
+    pOutput[0] = sumLeft;
+    pOutput[1] = sumRight;
+#endif
+}
+
+}  // anonymous namespace
+
+constexpr double EngineBufferScaleSinc::kMaxRate;
+
+// The polyphase tables of a quality for all rate steps
+struct EngineBufferScaleSinc::Kernel {
+    explicit Kernel(const QualityParameters& parameters)
+            : taps(parameters.taps),
+              halfTaps(parameters.taps / 2) {
+        const int rateSteps = static_cast<int>(
+                (kMaxRate - 1.0) * kRateStepsPerOctave) + 1;
+        coefs.resize(rateSteps * (kPhases + 1) * taps);
+        const double windowScale = 1.0 / besselI0(parameters.kaiserBeta);
+        std::vector<double> row(taps);
+        for (int step = 0; step < rateSteps; ++step) {
+            const double rate = 1.0 + static_cast<double>(step) / kRateStepsPerOctave;
+            const double cutoff = parameters.rolloff / rate;
+            for (int phase = 0; phase <= kPhases; ++phase) {
+                const double frac = static_cast<double>(phase) / kPhases;
+                double sum = 0.0;
+                for (int k = 0; k < taps; ++k) {
+                    // The distance of the tap from the output frame
+                    const double t = k - halfTaps + 1 - frac;
+                    const double x = t / halfTaps;
+                    double value = 0.0;
+                    if (fabs(x) < 1.0) {
+                        const double window = besselI0(
+                                parameters.kaiserBeta * sqrt(1.0 - x * x)) *
+                                windowScale;
+                        const double arg = M_PI * cutoff * t;
+                        const double sinc = arg == 0.0 ? 1.0 : sin(arg) / arg;
+                        value = cutoff * sinc * window;
+                    }
+                    row[k] = value;
+                    sum += value;
+                }
+                // Normalize to unity gain at DC
+                CSAMPLE* pRow = getRow(step, phase);
+                for (int k = 0; k < taps; ++k) {
+                    pRow[k] = static_cast<CSAMPLE>(row[k] / sum);
+                }
+            }
+        }
+    }
+
+    CSAMPLE* getRow(int rateStep, int phase) {
+        return &coefs[(rateStep * (kPhases + 1) + phase) * taps];
+    }
+    const CSAMPLE* getRow(int rateStep, int phase) const {
+        return &coefs[(rateStep * (kPhases + 1) + phase) * taps];
+    }
+
+    // The filter with the lowest cutoff that is needed for the rate
+    int getRateStep(double rate) const {
+        const int maxRateStep = static_cast<int>(
+                (kMaxRate - 1.0) * kRateStepsPerOctave);
+        return math_clamp(
+                static_cast<int>(ceil((rate - 1.0) * kRateStepsPerOctave)),
+                0, maxRateStep);
+    }
+
+    const int taps;
+    const int halfTaps;
+    std::vector<CSAMPLE> coefs;
+};
+
+// static
+const EngineBufferScaleSinc::Kernel& EngineBufferScaleSinc::getKernel(
+        Quality quality) {
+    // Designed once and shared by all decks
+    static const Kernel kFast(kQualityParameters[0]);
+    static const Kernel kMedium(kQualityParameters[1]);
+    static const Kernel kHigh(kQualityParameters[2]);
+    switch (quality) {
+    case Quality::Fast:
+        return kFast;
+    case Quality::High:
+        return kHigh;
+    case Quality::Medium:
+    default:
+        return kMedium;
+    }
+}
+
+EngineBufferScaleSinc::EngineBufferScaleSinc(
+        ReadAheadManager* pReadAheadManager,
+        Quality quality)
+        : m_pReadAheadManager(pReadAheadManager),
+          m_quality(quality),
+          m_pKernel(&getKernel(quality)),
+          m_inputFrames(0),
+          m_dPosition(0.0),
+          m_readBuffer(SampleUtil::alloc(kInputFrames * 2)),
+          m_bClear(false),
+          m_dRate(1.0),
+          m_dOldRate(1.0) {
+    m_input[0] = SampleUtil::alloc(kInputFrames);
+    m_input[1] = SampleUtil::alloc(kInputFrames);
+    clear();
+}
+
+EngineBufferScaleSinc::~EngineBufferScaleSinc() {
+    SampleUtil::free(m_input[0]);
+    SampleUtil::free(m_input[1]);
+    SampleUtil::free(m_readBuffer);
+}
+
+void EngineBufferScaleSinc::setQuality(Quality quality) {
+    m_quality = quality;
+    m_pKernel = &getKernel(quality);
+}
+
+void EngineBufferScaleSinc::setScaleParameters(double base_rate,
+                                               double* pTempoRatio,
+                                               double* pPitchRatio) {
+    Q_UNUSED(pPitchRatio);
+
+    m_dOldRate = m_dRate;
+    m_dRate = base_rate * *pTempoRatio;
+}
+
+void EngineBufferScaleSinc::clear() {
+    m_bClear = true;
+    // Start with silence as history of the first input frame
+    SampleUtil::clear(m_input[0], kMaxHalfTaps - 1);
+    SampleUtil::clear(m_input[1], kMaxHalfTaps - 1);
+    m_inputFrames = kMaxHalfTaps - 1;
+    m_dPosition = kMaxHalfTaps - 1;
+}
+
+SINT EngineBufferScaleSinc::readInput(SINT firstFrameNeeded,
+        SINT framesNeeded) {
+    if (firstFrameNeeded > 0) {
+        // Drop the frames that are not needed anymore
+        const SINT keepFrames = m_inputFrames - firstFrameNeeded;
+        memmove(m_input[0], m_input[0] + firstFrameNeeded,
+                keepFrames * sizeof(CSAMPLE));
+        memmove(m_input[1], m_input[1] + firstFrameNeeded,
+                keepFrames * sizeof(CSAMPLE));
+        m_inputFrames = keepFrames;
+        m_dPosition -= firstFrameNeeded;
+    }
+    const SINT framesToRead = math_min(framesNeeded,
+            kInputFrames - m_inputFrames);
+    const SINT samplesRead = m_pReadAheadManager->getNextSamples(
+            m_dRate == 0 ? m_dOldRate : m_dRate,
+            m_readBuffer,
+            getAudioSignal().frames2samples(framesToRead));
+    const SINT framesRead = getAudioSignal().samples2frames(samplesRead);
+    SampleUtil::deinterleaveBuffer(
+            m_input[0] + m_inputFrames, m_input[1] + m_inputFrames,
+            m_readBuffer, framesRead);
+    m_inputFrames += framesRead;
+    return framesRead;
+}
+
+double EngineBufferScaleSinc::scaleBuffer(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize) {
+    if (m_bClear) {
+        m_dOldRate = m_dRate;  // If cleared, don't interpolate rate.
+        m_bClear = false;
+    }
+    // EngineBuffer clears us when the direction changes, the history of
+    // the other direction would be wrong.
+    VERIFY_OR_DEBUG_ASSERT(m_dRate * m_dOldRate >= 0) {
+        qDebug() << "EngineBufferScaleSinc can't change direction";
+        clear();
+        m_dOldRate = m_dRate;
+        m_bClear = false;
+    }
+
+    const SINT frames = getAudioSignal().samples2frames(iOutputBufferSize);
+    const double rateOld = fabs(m_dOldRate);
+    const double rateNew = fabs(m_dRate);
+    // Smooth the change of the rate over the buffer like
+    // EngineBufferScaleLinear
+    const double rateDelta = (rateNew - rateOld) / frames;
+    m_dOldRate = m_dRate;
+
+    const Kernel& kernel = *m_pKernel;
+    const int rateStep = kernel.getRateStep(math_max(rateOld, rateNew));
+    const int halfTaps = kernel.halfTaps;
+
+    SINT framesRead = 0;
+    int readFailedCount = 0;
+    double rate = rateOld;
+    SINT frame = 0;
+    CSAMPLE* pOutput = pOutputBuffer;
+    // Hot frame loop
+    while (frame < frames) {
+        const SINT index = static_cast<SINT>(m_dPosition);
+        if (index + halfTaps >= m_inputFrames) {
+            // Read what is needed for the rest of the buffer at once
+            const double remainingFrames = (frames - frame) *
+                    math_max(rate, rateNew) + 2 * kMaxHalfTaps;
+            const SINT read = readInput(index - kMaxHalfTaps + 1,
+                    static_cast<SINT>(ceil(remainingFrames)));
+            if (read == 0) {
+                // Protection against infinite read loops when (for example)
+                // we are reading from a broken file.
+                if (++readFailedCount > 1) {
+                    break;
+                }
+            } else {
+                framesRead += read;
+            }
+            continue;
+        }
+
+        const double phase = (m_dPosition - index) * kPhases;
+        const int phaseIndex = static_cast<int>(phase);
+        convolve(kernel.getRow(rateStep, phaseIndex),
+                kernel.getRow(rateStep, phaseIndex + 1),
+                static_cast<CSAMPLE>(phase - phaseIndex),
+                m_input[0] + index - halfTaps + 1,
+                m_input[1] + index - halfTaps + 1,
+                kernel.taps, pOutput);
+
+        m_dPosition += rate;
+        rate += rateDelta;
+        pOutput += 2;
+        ++frame;
+    }
+
+    SampleUtil::clear(pOutput,
+            getAudioSignal().frames2samples(frames - frame));
+    return framesRead;
+}
@@ -0,0 +1,76 @@
+#ifndef ENGINEBUFFERSCALESINC_H
+#define ENGINEBUFFERSCALESINC_H
+
+#include "engine/enginebufferscale.h"
+#include "engine/readaheadmanager.h"
+
+// Resamples with a Kaiser windowed sinc filter from a polyphase table.
+//
+// The number of taps only depends on the quality, so the cost per frame is
+// the same for all rates. For rates above 1 the cutoff of the filter is
+// lowered to avoid aliasing, the table holds filters for rates up to
+// kMaxRate in steps of 1/kRateStepsPerOctave. Faster rates use the filter
+// of kMaxRate and alias a little.
+//
+// Unlike EngineBufferScaleLinear the rate cannot ramp through zero, so
+// EngineBuffer uses EngineBufferScaleLinear for scratching and slow rates.
+class EngineBufferScaleSinc : public EngineBufferScale {
+  public:
+    enum class Quality {
+        Fast,    // 8 taps
+        Medium,  // 16 taps
+        High,    // 32 taps
+    };
+
+    // The highest rate including the base rate with its own filter
+    static constexpr double kMaxRate = 2.0;
+    static const int kRateStepsPerOctave = 8;
+
+    explicit EngineBufferScaleSinc(
+            ReadAheadManager* pReadAheadManager,
+            Quality quality = Quality::Medium);
+    ~EngineBufferScaleSinc() override;
+
+    // May be changed while playing without clicks
+    void setQuality(Quality quality);
+    Quality getQuality() const {
+        return m_quality;
+    }
+
+    void setScaleParameters(double base_rate,
+                            double* pTempoRatio,
+                            double* pPitchRatio) override;
+
+    double scaleBuffer(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize) override;
+
+    void clear() override;
+
+  private:
+    struct Kernel;
+    static const Kernel& getKernel(Quality quality);
+
+    // Reads the next samples from the ReadAheadManager behind the frames
+    // that are still needed. Returns the frames read.
+    SINT readInput(SINT firstFrameNeeded, SINT framesNeeded);
+
+    // The read-ahead manager that we use to fetch samples
+    ReadAheadManager* m_pReadAheadManager;
+
+    Quality m_quality;
+    const Kernel* m_pKernel;
+
+    // The deinterleaved input, m_dPosition is the position of the next
+    // output frame in it.
+    CSAMPLE* m_input[2];
+    SINT m_inputFrames;
+    double m_dPosition;
+    CSAMPLE* m_readBuffer;
+
+    bool m_bClear;
+    double m_dRate;
+    double m_dOldRate;
+};
+
+#endif /* ENGINEBUFFERSCALESINC_H */
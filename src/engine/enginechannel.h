@@ -21,6 +21,7 @@
 #include "engine/engineobject.h"
 #include "engine/channelhandle.h"
 #include "preferences/usersettings.h"
+#include "util/sample.h"
 
 class ControlObject;
 class EngineBuffer;
@@ -70,6 +71,12 @@ class EngineChannel : public EngineObject {
         return NULL;
     }
 
+    // The levels of the last processed buffer as measured by the VU meter of
+    // the channel, or NULL if the channel is not metered
+    virtual const SampleUtil::Levels* getLevels() const {
+        return NULL;
+    }
+
   private slots:
     void slotOrientationLeft(double v);
     void slotOrientationRight(double v);
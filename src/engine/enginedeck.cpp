@@ -39,7 +39,8 @@ EngineDeck::EngineDeck(const ChannelHandleAndGroup& handle_group,
           // Need a +1 here because the CircularBuffer only allows its size-1
           // items to be held at once (it keeps a blank spot open persistently)
           m_sampleBuffer(NULL),
-          m_wasActive(false) {
+          m_wasActive(false),
+          m_silentProcessCounter("EngineDeck::process silent") {
     if (pEffectsManager != NULL) {
         pEffectsManager->registerChannel(handle_group);
     }
@@ -98,8 +99,16 @@ void EngineDeck::process(CSAMPLE* pOut, const int iBufferSize) {
         m_bPassthroughWasActive = false;
     }
 
-    // Apply pregain
-    m_pPregain->process(pOut, iBufferSize);
+    // A paused deck plays silence, which needs neither gain nor metering.
+    // The effect chains go to sleep on their own after their tails.
+    const bool silent = SampleUtil::isSilent(pOut, iBufferSize);
+    if (silent) {
+        m_silentProcessCounter.increment();
+        m_pPregain->processSilence();
+    } else {
+        // Apply pregain
+        m_pPregain->process(pOut, iBufferSize);
+    }
     // Process effects enabled for this channel
     if (m_pEngineEffectsManager != NULL) {
         // This is out of date by a callback but some effects will want the RMS
@@ -109,8 +118,16 @@ void EngineDeck::process(CSAMPLE* pOut, const int iBufferSize) {
                 getHandle(), pOut, iBufferSize,
                 static_cast<unsigned int>(m_pSampleRate->get()), features);
     }
-    // Update VU meter
-    m_pVUMeter->process(pOut, iBufferSize);
+    // Update VU meter, the effects may have added a tail to the silence
+    if (silent && SampleUtil::isSilent(pOut, iBufferSize)) {
+        m_pVUMeter->processSilence(iBufferSize);
+    } else {
+        m_pVUMeter->process(pOut, iBufferSize);
+    }
+}
+
+const SampleUtil::Levels* EngineDeck::getLevels() const {
+    return &m_pVUMeter->getLevels();
 }
 
 void EngineDeck::postProcess(const int iBufferSize) {
@@ -26,6 +26,7 @@
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
 #include "util/circularbuffer.h"
+#include "util/counter.h"
 
 #include "soundio/soundmanagerutil.h"
 
@@ -52,6 +53,8 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     // TODO(XXX) This hack needs to be removed.
     virtual EngineBuffer* getEngineBuffer();
 
+    const SampleUtil::Levels* getLevels() const override;
+
     virtual bool isActive();
 
     // This is called by SoundManager whenever there are new samples from the
@@ -91,6 +94,8 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     bool m_bPassthroughIsActive;
     bool m_bPassthroughWasActive;
     bool m_wasActive;
+    // Counts the callbacks in which the deck was silent
+    Counter m_silentProcessCounter;
 };
 
 #endif
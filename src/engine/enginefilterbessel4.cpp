@@ -9,12 +9,23 @@ EngineFilterBessel4Low::EngineFilterBessel4Low(int sampleRate,
 
 void EngineFilterBessel4Low::setFrequencyCorners(int sampleRate,
                                                  double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs("LpBe4", sampleRate, freqCorner1);
+    double coef[5];
+    EngineFilterDesign::lowPass(coef, EngineFilterDesign::Prototype::Bessel, 4,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 int EngineFilterBessel4Low::setFrequencyCornersForIntDelay(
         double desiredCorner1Ratio, int maxDelay) {
+    double coef[5];
+    int iDelay = designForIntDelay(coef, desiredCorner1Ratio, maxDelay);
+    setCoefs(coef);
+    return iDelay;
+}
+
+// static
+int EngineFilterBessel4Low::designForIntDelay(double (&coef)[5],
+        double desiredCorner1Ratio, int maxDelay) {
     // these values are calculated using the phase returned by
     // fid_response_pha() at corner / 20
 
@@ -53,7 +64,8 @@ int EngineFilterBessel4Low::setFrequencyCornersForIntDelay(
         quantizedRatio = delayRatioTable[iDelay];
     }
 
-    setCoefs("LpBe4", 1, quantizedRatio);
+    EngineFilterDesign::lowPass(coef, EngineFilterDesign::Prototype::Bessel, 4,
+            quantizedRatio);
     return iDelay;
 }
 
@@ -66,7 +78,10 @@ EngineFilterBessel4Band::EngineFilterBessel4Band(int sampleRate,
 void EngineFilterBessel4Band::setFrequencyCorners(int sampleRate,
                                                   double freqCorner1,
                                                   double freqCorner2) {
-    setCoefs("BpBe4", sampleRate, freqCorner1, freqCorner2);
+    double coef[9];
+    EngineFilterDesign::bandPass(coef, EngineFilterDesign::Prototype::Bessel, 4,
+            freqCorner1 / sampleRate, freqCorner2 / sampleRate);
+    setCoefs(coef);
 }
 
 
@@ -77,5 +92,8 @@ EngineFilterBessel4High::EngineFilterBessel4High(int sampleRate,
 
 void EngineFilterBessel4High::setFrequencyCorners(int sampleRate,
                                                   double freqCorner1) {
-    setCoefs("HpBe4", sampleRate, freqCorner1);
+    double coef[5];
+    EngineFilterDesign::highPass(coef, EngineFilterDesign::Prototype::Bessel, 4,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
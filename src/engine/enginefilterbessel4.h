@@ -13,6 +13,10 @@ class EngineFilterBessel4Low : public EngineFilterIIR<4, IIR_LP> {
     // the produces an integer group delay at the passband
     // Optimized for freqCorner / 20
     int setFrequencyCornersForIntDelay(double desiredCorner1Ratio, int maxDelay);
+    // Designs the coefficients of setFrequencyCornersForIntDelay() without
+    // applying them, for processing the filter in EngineFilterIIRLanes
+    static int designForIntDelay(double (&coef)[5],
+            double desiredCorner1Ratio, int maxDelay);
 };
 
 class EngineFilterBessel4Band : public EngineFilterIIR<8, IIR_BP> {
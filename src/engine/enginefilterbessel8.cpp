@@ -9,13 +9,24 @@ EngineFilterBessel8Low::EngineFilterBessel8Low(int sampleRate,
 
 void EngineFilterBessel8Low::setFrequencyCorners(int sampleRate,
                                                  double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs("LpBe8", sampleRate, freqCorner1);
+    double coef[9];
+    EngineFilterDesign::lowPass(coef, EngineFilterDesign::Prototype::Bessel, 8,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 
 int EngineFilterBessel8Low::setFrequencyCornersForIntDelay(
         double desiredCorner1Ratio, int maxDelay) {
+    double coef[9];
+    int iDelay = designForIntDelay(coef, desiredCorner1Ratio, maxDelay);
+    setCoefs(coef);
+    return iDelay;
+}
+
+// static
+int EngineFilterBessel8Low::designForIntDelay(double (&coef)[9],
+        double desiredCorner1Ratio, int maxDelay) {
     // these values are calculated using the phase returned by
     // fid_response_pha() at corner / 20
 
@@ -61,7 +72,8 @@ int EngineFilterBessel8Low::setFrequencyCornersForIntDelay(
         quantizedRatio = delayRatioTable[iDelay];
     }
 
-    setCoefs("LpBe8", 1, quantizedRatio);
+    EngineFilterDesign::lowPass(coef, EngineFilterDesign::Prototype::Bessel, 8,
+            quantizedRatio);
     return iDelay;
 }
 
@@ -74,7 +86,10 @@ EngineFilterBessel8Band::EngineFilterBessel8Band(int sampleRate,
 void EngineFilterBessel8Band::setFrequencyCorners(int sampleRate,
                                                   double freqCorner1,
                                                   double freqCorner2) {
-    setCoefs("BpBe8", sampleRate, freqCorner1, freqCorner2);
+    double coef[17];
+    EngineFilterDesign::bandPass(coef, EngineFilterDesign::Prototype::Bessel, 8,
+            freqCorner1 / sampleRate, freqCorner2 / sampleRate);
+    setCoefs(coef);
 }
 
 
@@ -85,5 +100,8 @@ EngineFilterBessel8High::EngineFilterBessel8High(int sampleRate,
 
 void EngineFilterBessel8High::setFrequencyCorners(int sampleRate,
                                                   double freqCorner1) {
-    setCoefs("HpBe8", sampleRate, freqCorner1);
+    double coef[9];
+    EngineFilterDesign::highPass(coef, EngineFilterDesign::Prototype::Bessel, 8,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
@@ -13,6 +13,10 @@ class EngineFilterBessel8Low : public EngineFilterIIR<8, IIR_LP> {
     // the produces an integer group delay at the passband
     // Optimized for freqCorner / 20
     int setFrequencyCornersForIntDelay(double desiredCorner1Ratio, int maxDelay);
+    // Designs the coefficients of setFrequencyCornersForIntDelay() without
+    // applying them, for processing the filter in EngineFilterIIRLanes
+    static int designForIntDelay(double (&coef)[9],
+            double desiredCorner1Ratio, int maxDelay);
 };
 
 class EngineFilterBessel8Band : public EngineFilterIIR<16, IIR_BP> {
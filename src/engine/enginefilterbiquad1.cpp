@@ -1,4 +1,3 @@
-#include <stdio.h>
 #include "engine/enginefilterbiquad1.h"
 
 EngineFilterBiquad1LowShelving::EngineFilterBiquad1LowShelving(int sampleRate,
@@ -12,8 +11,9 @@ void EngineFilterBiquad1LowShelving::setFrequencyCorners(int sampleRate,
                                                          double centerFreq,
                                                          double Q,
                                                          double dBgain) {
-    format_fidspec(m_spec, sizeof(m_spec), "LsBq/%.10f/%.10f", Q, dBgain);
-    setCoefs(m_spec, sampleRate, centerFreq);
+    double coef[6];
+    EngineFilterDesign::lowShelvingBiquad(coef, centerFreq / sampleRate, Q, dBgain);
+    setCoefs(coef);
 }
 
 EngineFilterBiquad1Peaking::EngineFilterBiquad1Peaking(int sampleRate,
@@ -26,8 +26,9 @@ void EngineFilterBiquad1Peaking::setFrequencyCorners(int sampleRate,
                                                      double centerFreq,
                                                      double Q,
                                                      double dBgain) {
-    format_fidspec(m_spec, sizeof(m_spec), "PkBq/%.10f/%.10f", Q, dBgain);
-    setCoefs(m_spec, sampleRate, centerFreq);
+    double coef[6];
+    EngineFilterDesign::peakingBiquad(coef, centerFreq / sampleRate, Q, dBgain);
+    setCoefs(coef);
 }
 
 EngineFilterBiquad1HighShelving::EngineFilterBiquad1HighShelving(int sampleRate,
@@ -41,8 +42,9 @@ void EngineFilterBiquad1HighShelving::setFrequencyCorners(int sampleRate,
                                                           double centerFreq,
                                                           double Q,
                                                           double dBgain) {
-    format_fidspec(m_spec, sizeof(m_spec), "HsBq/%.10f/%.10f", Q, dBgain);
-    setCoefs(m_spec, sampleRate, centerFreq);
+    double coef[6];
+    EngineFilterDesign::highShelvingBiquad(coef, centerFreq / sampleRate, Q, dBgain);
+    setCoefs(coef);
 }
 
 EngineFilterBiquad1Low::EngineFilterBiquad1Low(int sampleRate,
@@ -56,8 +58,9 @@ EngineFilterBiquad1Low::EngineFilterBiquad1Low(int sampleRate,
 void EngineFilterBiquad1Low::setFrequencyCorners(int sampleRate,
                                                  double centerFreq,
                                                  double Q) {
-    format_fidspec(m_spec, sizeof(m_spec), "LpBq/%.10f", Q);
-    setCoefs(m_spec, sampleRate, centerFreq);
+    double coef[3];
+    EngineFilterDesign::lowPassBiquad(coef, centerFreq / sampleRate, Q);
+    setCoefs(coef);
 }
 
 EngineFilterBiquad1Band::EngineFilterBiquad1Band(int sampleRate,
@@ -69,8 +72,9 @@ EngineFilterBiquad1Band::EngineFilterBiquad1Band(int sampleRate,
 void EngineFilterBiquad1Band::setFrequencyCorners(int sampleRate,
                                                   double centerFreq,
                                                   double Q) {
-    format_fidspec(m_spec, sizeof(m_spec), "BpBq/%.10f", Q);
-    setCoefs(m_spec, sampleRate, centerFreq);
+    double coef[3];
+    EngineFilterDesign::bandPassBiquad(coef, centerFreq / sampleRate, Q);
+    setCoefs(coef);
 }
 
 EngineFilterBiquad1High::EngineFilterBiquad1High(int sampleRate,
@@ -84,6 +88,7 @@ EngineFilterBiquad1High::EngineFilterBiquad1High(int sampleRate,
 void EngineFilterBiquad1High::setFrequencyCorners(int sampleRate,
                                                   double centerFreq,
                                                   double Q) {
-    format_fidspec(m_spec, sizeof(m_spec), "HpBq/%.10f", Q);
-    setCoefs(m_spec, sampleRate, centerFreq);
+    double coef[3];
+    EngineFilterDesign::highPassBiquad(coef, centerFreq / sampleRate, Q);
+    setCoefs(coef);
 }
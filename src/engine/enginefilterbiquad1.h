@@ -16,9 +16,6 @@ class EngineFilterBiquad1LowShelving : public EngineFilterIIR<5, IIR_BP> {
     EngineFilterBiquad1LowShelving(int sampleRate, double centerFreq, double Q);
     void setFrequencyCorners(int sampleRate, double centerFreq,
                              double Q, double dBgain);
-
-  private:
-    char m_spec[FIDSPEC_LENGTH];
 };
 
 class EngineFilterBiquad1Peaking : public EngineFilterIIR<5, IIR_BP> {
@@ -27,9 +24,6 @@ class EngineFilterBiquad1Peaking : public EngineFilterIIR<5, IIR_BP> {
     EngineFilterBiquad1Peaking(int sampleRate, double centerFreq, double Q);
     void setFrequencyCorners(int sampleRate, double centerFreq,
                              double Q, double dBgain);
-
-  private:
-    char m_spec[FIDSPEC_LENGTH];
 };
 
 class EngineFilterBiquad1HighShelving : public EngineFilterIIR<5, IIR_BP> {
@@ -38,9 +32,6 @@ class EngineFilterBiquad1HighShelving : public EngineFilterIIR<5, IIR_BP> {
     EngineFilterBiquad1HighShelving(int sampleRate, double centerFreq, double Q);
     void setFrequencyCorners(int sampleRate, double centerFreq,
                              double Q, double dBgain);
-
-  private:
-    char m_spec[FIDSPEC_LENGTH];
 };
 
 class EngineFilterBiquad1Low : public EngineFilterIIR<2, IIR_LP> {
@@ -49,9 +40,6 @@ class EngineFilterBiquad1Low : public EngineFilterIIR<2, IIR_LP> {
     EngineFilterBiquad1Low(int sampleRate, double centerFreq, double Q,
                            bool startFromDry);
     void setFrequencyCorners(int sampleRate, double centerFreq, double Q);
-
-  private:
-    char m_spec[FIDSPEC_LENGTH];
 };
 
 class EngineFilterBiquad1Band : public EngineFilterIIR<2, IIR_BP> {
@@ -59,9 +47,6 @@ class EngineFilterBiquad1Band : public EngineFilterIIR<2, IIR_BP> {
   public:
     EngineFilterBiquad1Band(int sampleRate, double centerFreq, double Q);
     void setFrequencyCorners(int sampleRate, double centerFreq, double Q);
-
-  private:
-    char m_spec[FIDSPEC_LENGTH];
 };
 
 class EngineFilterBiquad1High : public EngineFilterIIR<2, IIR_HP> {
@@ -70,9 +55,6 @@ class EngineFilterBiquad1High : public EngineFilterIIR<2, IIR_HP> {
     EngineFilterBiquad1High(int sampleRate, double centerFreq, double Q,
                             bool startFromDry);
     void setFrequencyCorners(int sampleRate, double centerFreq, double Q);
-
-  private:
-    char m_spec[FIDSPEC_LENGTH];
 };
 
 #endif // ENGINEFILTERBIQUAD1_H
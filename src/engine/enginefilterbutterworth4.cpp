@@ -7,8 +7,10 @@ EngineFilterButterworth4Low::EngineFilterButterworth4Low(int sampleRate, double
 
 void EngineFilterButterworth4Low::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs("LpBu4", sampleRate, freqCorner1);
+    double coef[5];
+    EngineFilterDesign::lowPass(coef, EngineFilterDesign::Prototype::Butterworth, 4,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 
@@ -20,7 +22,10 @@ EngineFilterButterworth4Band::EngineFilterButterworth4Band(int sampleRate, doubl
 void EngineFilterButterworth4Band::setFrequencyCorners(int sampleRate,
                                              double freqCorner1,
                                              double freqCorner2) {
-    setCoefs("BpBu4", sampleRate, freqCorner1, freqCorner2);
+    double coef[9];
+    EngineFilterDesign::bandPass(coef, EngineFilterDesign::Prototype::Butterworth, 4,
+            freqCorner1 / sampleRate, freqCorner2 / sampleRate);
+    setCoefs(coef);
 }
 
 
@@ -30,5 +35,8 @@ EngineFilterButterworth4High::EngineFilterButterworth4High(int sampleRate, doubl
 
 void EngineFilterButterworth4High::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    setCoefs("HpBu4", sampleRate, freqCorner1);
+    double coef[5];
+    EngineFilterDesign::highPass(coef, EngineFilterDesign::Prototype::Butterworth, 4,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
@@ -6,8 +6,10 @@ EngineFilterButterworth8Low::EngineFilterButterworth8Low(int sampleRate, double
 
 void EngineFilterButterworth8Low::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs("LpBu8", sampleRate, freqCorner1);
+    double coef[9];
+    EngineFilterDesign::lowPass(coef, EngineFilterDesign::Prototype::Butterworth, 8,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 
@@ -19,7 +21,10 @@ EngineFilterButterworth8Band::EngineFilterButterworth8Band(int sampleRate, doubl
 void EngineFilterButterworth8Band::setFrequencyCorners(int sampleRate,
                                              double freqCorner1,
                                              double freqCorner2) {
-    setCoefs("BpBu8", sampleRate, freqCorner1, freqCorner2);
+    double coef[17];
+    EngineFilterDesign::bandPass(coef, EngineFilterDesign::Prototype::Butterworth, 8,
+            freqCorner1 / sampleRate, freqCorner2 / sampleRate);
+    setCoefs(coef);
 }
 
 EngineFilterButterworth8High::EngineFilterButterworth8High(int sampleRate, double freqCorner1) {
@@ -28,5 +33,8 @@ EngineFilterButterworth8High::EngineFilterButterworth8High(int sampleRate, doubl
 
 void EngineFilterButterworth8High::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    setCoefs("HpBu8", sampleRate, freqCorner1);
+    double coef[9];
+    EngineFilterDesign::highPass(coef, EngineFilterDesign::Prototype::Butterworth, 8,
+            freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
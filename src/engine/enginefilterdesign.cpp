@@ -0,0 +1,410 @@
+#include "engine/enginefilterdesign.h"
+
+#include <complex>
+
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+typedef std::complex<double> Complex;
+
+// The normalized poles of the Bessel prototypes, taken from fidlib.
+// Each complex pole is given by its real and imaginary part and stands
+// for a conjugate pair. Odd orders end with a single real pole.
+const double kBesselPoles1[] = {
+    -1.00000000000e+00,
+};
+const double kBesselPoles2[] = {
+    -1.10160133059e+00, 6.36009824757e-01,
+};
+const double kBesselPoles3[] = {
+    -1.04740916101e+00, 9.99264436281e-01,
+    -1.32267579991e+00,
+};
+const double kBesselPoles4[] = {
+    -9.95208764350e-01, 1.25710573945e+00,
+    -1.37006783055e+00, 4.10249717494e-01,
+};
+const double kBesselPoles5[] = {
+    -9.57676548563e-01, 1.47112432073e+00,
+    -1.38087732586e+00, 7.17909587627e-01,
+    -1.50231627145e+00,
+};
+const double kBesselPoles6[] = {
+    -9.30656522947e-01, 1.66186326894e+00,
+    -1.38185809760e+00, 9.71471890712e-01,
+    -1.57149040362e+00, 3.20896374221e-01,
+};
+const double kBesselPoles7[] = {
+    -9.09867780623e-01, 1.83645135304e+00,
+    -1.37890321680e+00, 1.19156677780e+00,
+    -1.61203876622e+00, 5.89244506931e-01,
+    -1.68436817927e+00,
+};
+const double kBesselPoles8[] = {
+    -8.92869718847e-01, 1.99832584364e+00,
+    -1.37384121764e+00, 1.38835657588e+00,
+    -1.63693941813e+00, 8.22795625139e-01,
+    -1.75740840040e+00, 2.72867575103e-01,
+};
+const double* const kBesselPoles[EngineFilterDesign::kMaxOrder] = {
+    kBesselPoles1, kBesselPoles2, kBesselPoles3, kBesselPoles4,
+    kBesselPoles5, kBesselPoles6, kBesselPoles7, kBesselPoles8,
+};
+
+// A band pass doubles the order of the prototype
+const int kMaxPoles = 2 * EngineFilterDesign::kMaxOrder;
+const int kMaxSections = kMaxPoles / 2;
+
+// The poles of an analog filter in the s-plane. Complex poles stand
+// for a conjugate pair. A real pole may only follow the complex poles.
+struct AnalogPoles {
+    AnalogPoles()
+            : numComplex(0),
+              hasReal(false),
+              real(0.0) {
+    }
+
+    int numComplex;
+    Complex complex[kMaxSections];
+    bool hasReal;
+    double real;
+};
+
+// A section of the digital filter with the transfer function
+// (1 - zero0 z^-1) (1 - zero1 z^-1) / (1 + a1 z^-1 + a2 z^-2).
+// First order sections have a2 = 0 and zero1 = 0.
+struct Section {
+    bool firstOrder;
+    double a1;
+    double a2;
+    double zero0;
+    double zero1;
+};
+
+struct DigitalFilter {
+    DigitalFilter()
+            : numSections(0) {
+    }
+
+    int numSections;
+    Section sections[kMaxSections];
+};
+
+AnalogPoles prototypePoles(EngineFilterDesign::Prototype prototype,
+        int order) {
+    VERIFY_OR_DEBUG_ASSERT(order >= 1 && order <= EngineFilterDesign::kMaxOrder) {
+        order = math_clamp(order, 1, EngineFilterDesign::kMaxOrder);
+    }
+    AnalogPoles poles;
+    switch (prototype) {
+    case EngineFilterDesign::Prototype::Bessel: {
+        const double* pPoles = kBesselPoles[order - 1];
+        for (int i = 0; i < order / 2; ++i) {
+            poles.complex[poles.numComplex++] =
+                    Complex(pPoles[2 * i], pPoles[2 * i + 1]);
+        }
+        if (order % 2) {
+            poles.hasReal = true;
+            poles.real = pPoles[order - 1];
+        }
+        break;
+    }
+    case EngineFilterDesign::Prototype::Butterworth:
+        for (int i = 0; i < order - 1; i += 2) {
+            poles.complex[poles.numComplex++] = std::polar(1.0,
+                    M_PI - (order - i - 1) * 0.5 * M_PI / order);
+        }
+        if (order % 2) {
+            poles.hasReal = true;
+            poles.real = -1.0;
+        }
+        break;
+    }
+    return poles;
+}
+
+// Compensates the frequency warping of the bilinear transform
+inline double prewarp(double freq) {
+    return tan(freq * M_PI) / M_PI;
+}
+
+inline Complex bilinear(Complex pole) {
+    return (2.0 + pole) / (2.0 - pole);
+}
+
+inline double bilinear(double pole) {
+    return (2.0 + pole) / (2.0 - pole);
+}
+
+void appendSection(DigitalFilter* pFilter, Complex analogPole, double zero) {
+    DEBUG_ASSERT(pFilter->numSections < kMaxSections);
+    const Complex pole = bilinear(analogPole);
+    Section& section = pFilter->sections[pFilter->numSections++];
+    section.firstOrder = false;
+    section.a1 = -2.0 * pole.real();
+    section.a2 = std::norm(pole);
+    section.zero0 = zero;
+    section.zero1 = zero;
+}
+
+void appendSection(DigitalFilter* pFilter, double analogPole, double zero) {
+    DEBUG_ASSERT(pFilter->numSections < kMaxSections);
+    Section& section = pFilter->sections[pFilter->numSections++];
+    section.firstOrder = true;
+    section.a1 = -bilinear(analogPole);
+    section.a2 = 0.0;
+    section.zero0 = zero;
+    section.zero1 = 0.0;
+}
+
+// The squared magnitude of the frequency response with unity gain
+double squaredMagnitudeResponse(const DigitalFilter& filter, double freq) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cos1 = cos(omega);
+    const double sin1 = sin(omega);
+    const double cos2 = cos1 * cos1 - sin1 * sin1;
+    const double sin2 = 2.0 * cos1 * sin1;
+    double numerator = 1.0;
+    double denominator = 1.0;
+    for (int i = 0; i < filter.numSections; ++i) {
+        const Section& section = filter.sections[i];
+        const double zeroSum = section.zero0 + section.zero1;
+        const double zeroProduct = section.zero0 * section.zero1;
+        const double numRe = 1.0 - zeroSum * cos1 + zeroProduct * cos2;
+        const double numIm = zeroSum * sin1 - zeroProduct * sin2;
+        const double denRe = 1.0 + section.a1 * cos1 + section.a2 * cos2;
+        const double denIm = section.a1 * sin1 + section.a2 * sin2;
+        numerator *= numRe * numRe + numIm * numIm;
+        denominator *= denRe * denRe + denIm * denIm;
+    }
+    return numerator / denominator;
+}
+
+inline double magnitudeResponse(const DigitalFilter& filter, double freq) {
+    return sqrt(squaredMagnitudeResponse(filter, freq));
+}
+
+// Searches the peak of a band pass between the two frequencies in the
+// same way as fidlib, which assumes a single maximum in between.
+double searchPeak(const DigitalFilter& filter, double freq0, double freq3) {
+    for (int i = 0; i < 20; ++i) {
+        const double freq1 = 0.51 * freq0 + 0.49 * freq3;
+        const double freq2 = 0.49 * freq0 + 0.51 * freq3;
+        if (freq1 == freq2) {
+            break;
+        }
+        if (squaredMagnitudeResponse(filter, freq1) >
+                squaredMagnitudeResponse(filter, freq2)) {
+            freq3 = freq2;
+        } else {
+            freq0 = freq1;
+        }
+    }
+    return (freq0 + freq3) * 0.5;
+}
+
+void writeCoefficients(double* pCoef, const DigitalFilter& filter,
+        double gain) {
+    *pCoef++ = gain;
+    for (int i = 0; i < filter.numSections; ++i) {
+        const Section& section = filter.sections[i];
+        if (!section.firstOrder) {
+            *pCoef++ = section.a2;
+        }
+        *pCoef++ = section.a1;
+    }
+}
+
+} // anonymous namespace
+
+// static
+void EngineFilterDesign::lowPass(double* pCoef, Prototype prototype,
+        int order, double freq) {
+    AnalogPoles poles = prototypePoles(prototype, order);
+    const double omega = 2.0 * M_PI * prewarp(freq);
+    DigitalFilter filter;
+    for (int i = 0; i < poles.numComplex; ++i) {
+        appendSection(&filter, poles.complex[i] * omega, -1.0);
+    }
+    if (poles.hasReal) {
+        appendSection(&filter, poles.real * omega, -1.0);
+    }
+    writeCoefficients(pCoef, filter, 1.0 / magnitudeResponse(filter, 0.0));
+}
+
+// static
+void EngineFilterDesign::highPass(double* pCoef, Prototype prototype,
+        int order, double freq) {
+    AnalogPoles poles = prototypePoles(prototype, order);
+    const double omega = 2.0 * M_PI * prewarp(freq);
+    DigitalFilter filter;
+    for (int i = 0; i < poles.numComplex; ++i) {
+        appendSection(&filter, omega / poles.complex[i], 1.0);
+    }
+    if (poles.hasReal) {
+        appendSection(&filter, omega / poles.real, 1.0);
+    }
+    writeCoefficients(pCoef, filter, 1.0 / magnitudeResponse(filter, 0.5));
+}
+
+// static
+void EngineFilterDesign::bandPass(double* pCoef, Prototype prototype,
+        int order, double freq0, double freq1) {
+    AnalogPoles poles = prototypePoles(prototype, order);
+    const double prewarped0 = prewarp(freq0);
+    const double prewarped1 = prewarp(freq1);
+    const double omega0 = 2.0 * M_PI * sqrt(prewarped0 * prewarped1);
+    const double bandwidth = M_PI * (prewarped1 - prewarped0);
+
+    // Each pole p of the prototype is split into the two poles
+    // h * (1 +/- sqrt(1 - (omega0 / h)^2)) with h = p * bandwidth.
+    AnalogPoles bandPassPoles;
+    for (int i = 0; i < poles.numComplex; ++i) {
+        const Complex hba = poles.complex[i] * bandwidth;
+        const Complex temp = hba * std::sqrt(
+                1.0 - (omega0 / hba) * (omega0 / hba));
+        bandPassPoles.complex[bandPassPoles.numComplex++] = hba + temp;
+        bandPassPoles.complex[bandPassPoles.numComplex++] = hba - temp;
+    }
+    if (poles.hasReal) {
+        // A real pole turns into a conjugate pair
+        const double hba = poles.real * bandwidth;
+        const Complex temp = std::sqrt(
+                Complex(1.0 - (omega0 / hba) * (omega0 / hba), 0.0));
+        bandPassPoles.complex[bandPassPoles.numComplex++] = hba * (1.0 + temp);
+    }
+
+    // The zeros at DC are in the first half of the sections and the
+    // zeros at Nyquist in the second half.
+    DigitalFilter filter;
+    for (int i = 0; i < bandPassPoles.numComplex; ++i) {
+        const Complex pole = bandPassPoles.complex[i];
+        appendSection(&filter, pole, 0.0);
+        Section& section = filter.sections[filter.numSections - 1];
+        section.zero0 = (2 * i < order) ? 1.0 : -1.0;
+        section.zero1 = (2 * i + 1 < order) ? 1.0 : -1.0;
+    }
+    const double peak = searchPeak(filter, freq0, freq1);
+    writeCoefficients(pCoef, filter, 1.0 / magnitudeResponse(filter, peak));
+}
+
+// static
+void EngineFilterDesign::lowPassLinkwitzRiley(double* pCoef, int order,
+        double freq) {
+    DEBUG_ASSERT(order % 2 == 0);
+    const int halfOrder = order / 2;
+    lowPass(pCoef, Prototype::Butterworth, halfOrder, freq);
+    for (int i = 1; i <= halfOrder; ++i) {
+        pCoef[halfOrder + i] = pCoef[i];
+    }
+    pCoef[0] *= pCoef[0];
+}
+
+// static
+void EngineFilterDesign::highPassLinkwitzRiley(double* pCoef, int order,
+        double freq) {
+    DEBUG_ASSERT(order % 2 == 0);
+    const int halfOrder = order / 2;
+    highPass(pCoef, Prototype::Butterworth, halfOrder, freq);
+    for (int i = 1; i <= halfOrder; ++i) {
+        pCoef[halfOrder + i] = pCoef[i];
+    }
+    pCoef[0] *= pCoef[0];
+}
+
+// static
+void EngineFilterDesign::lowPassBiquad(double* pCoef, double freq, double Q) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cosv = cos(omega);
+    const double alpha = sin(omega) / 2.0 / Q;
+    const double a0 = 1.0 + alpha;
+    pCoef[0] = (1.0 - cosv) * 0.5 / a0;
+    pCoef[1] = (1.0 - alpha) / a0;
+    pCoef[2] = -2.0 * cosv / a0;
+}
+
+// static
+void EngineFilterDesign::bandPassBiquad(double* pCoef, double freq, double Q) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cosv = cos(omega);
+    const double alpha = sin(omega) / 2.0 / Q;
+    const double a0 = 1.0 + alpha;
+    pCoef[0] = alpha / a0;
+    pCoef[1] = (1.0 - alpha) / a0;
+    pCoef[2] = -2.0 * cosv / a0;
+}
+
+// static
+void EngineFilterDesign::highPassBiquad(double* pCoef, double freq, double Q) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cosv = cos(omega);
+    const double alpha = sin(omega) / 2.0 / Q;
+    const double a0 = 1.0 + alpha;
+    pCoef[0] = (1.0 + cosv) * 0.5 / a0;
+    pCoef[1] = (1.0 - alpha) / a0;
+    pCoef[2] = -2.0 * cosv / a0;
+}
+
+namespace {
+
+// Stores the coefficients of a biquad with a non-constant numerator
+void writeBiquad(double* pCoef,
+        double a0, double a1, double a2,
+        double b0, double b1, double b2) {
+    pCoef[0] = 1.0 / a0;
+    pCoef[1] = a2 / a0;
+    pCoef[2] = b2;
+    pCoef[3] = a1 / a0;
+    pCoef[4] = b1;
+    pCoef[5] = b0;
+}
+
+} // anonymous namespace
+
+// static
+void EngineFilterDesign::peakingBiquad(double* pCoef, double freq, double Q,
+        double dBgain) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cosv = cos(omega);
+    const double alpha = sin(omega) / 2.0 / Q;
+    const double A = pow(10.0, dBgain / 40.0);
+    writeBiquad(pCoef,
+            1.0 + alpha / A, -2.0 * cosv, 1.0 - alpha / A,
+            1.0 + alpha * A, -2.0 * cosv, 1.0 - alpha * A);
+}
+
+// static
+void EngineFilterDesign::lowShelvingBiquad(double* pCoef, double freq,
+        double Q, double dBgain) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cosv = cos(omega);
+    const double sinv = sin(omega);
+    const double A = pow(10.0, dBgain / 40.0);
+    const double beta = sqrt((A * A + 1.0) / Q - (A - 1.0) * (A - 1.0));
+    writeBiquad(pCoef,
+            (A + 1.0) + (A - 1.0) * cosv + beta * sinv,
+            -2.0 * ((A - 1.0) + (A + 1.0) * cosv),
+            (A + 1.0) + (A - 1.0) * cosv - beta * sinv,
+            A * ((A + 1.0) - (A - 1.0) * cosv + beta * sinv),
+            2.0 * A * ((A - 1.0) - (A + 1.0) * cosv),
+            A * ((A + 1.0) - (A - 1.0) * cosv - beta * sinv));
+}
+
+// static
+void EngineFilterDesign::highShelvingBiquad(double* pCoef, double freq,
+        double Q, double dBgain) {
+    const double omega = 2.0 * M_PI * freq;
+    const double cosv = cos(omega);
+    const double sinv = sin(omega);
+    const double A = pow(10.0, dBgain / 40.0);
+    const double beta = sqrt((A * A + 1.0) / Q - (A - 1.0) * (A - 1.0));
+    writeBiquad(pCoef,
+            (A + 1.0) - (A - 1.0) * cosv + beta * sinv,
+            2.0 * ((A - 1.0) - (A + 1.0) * cosv),
+            (A + 1.0) - (A - 1.0) * cosv - beta * sinv,
+            A * ((A + 1.0) + (A - 1.0) * cosv + beta * sinv),
+            -2.0 * A * ((A - 1.0) + (A + 1.0) * cosv),
+            A * ((A + 1.0) + (A - 1.0) * cosv - beta * sinv));
+}
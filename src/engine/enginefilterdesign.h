@@ -0,0 +1,59 @@
+#ifndef ENGINEFILTERDESIGN_H
+#define ENGINEFILTERDESIGN_H
+
+// Designs the coefficients of the filters that are processed by
+// EngineFilterIIR.
+//
+// The coefficients are calculated in closed form with the same analog
+// prototypes, bilinear transform and gain normalization as fidlib, and
+// they are stored in the layout of fid_design_coef(): The overall gain,
+// followed by the non-constant coefficients of each section in reverse
+// order. Unlike fid_design_coef() the functions neither parse a filter
+// spec nor allocate memory and they are reentrant, so filters may be
+// redesigned from the engine thread whenever a parameter changes.
+//
+// All frequencies are given as a ratio of the sample rate.
+class EngineFilterDesign {
+  public:
+    enum class Prototype {
+        Bessel,
+        Butterworth,
+    };
+
+    // The maximum order of Bessel and Butterworth filters
+    static const int kMaxOrder = 8;
+
+    // order + 1 coefficients, like "LpBe<order>" or "LpBu<order>"
+    static void lowPass(double* pCoef, Prototype prototype, int order,
+            double freq);
+    // order + 1 coefficients, like "HpBe<order>" or "HpBu<order>"
+    static void highPass(double* pCoef, Prototype prototype, int order,
+            double freq);
+    // 2 * order + 1 coefficients, like "BpBe<order>" or "BpBu<order>"
+    static void bandPass(double* pCoef, Prototype prototype, int order,
+            double freq0, double freq1);
+
+    // Two cascaded Butterworth filters of half the order with the
+    // coefficients of the second filter following the first one.
+    // order + 1 coefficients, like fid_design_coef() for each half
+    // with the product of both gains.
+    static void lowPassLinkwitzRiley(double* pCoef, int order, double freq);
+    static void highPassLinkwitzRiley(double* pCoef, int order, double freq);
+
+    // Biquads from the Audio EQ Cookbook by Robert Bristow-Johnson.
+    // 3 coefficients, like "LpBq/<Q>", "BpBq/<Q>" and "HpBq/<Q>"
+    static void lowPassBiquad(double* pCoef, double freq, double Q);
+    static void bandPassBiquad(double* pCoef, double freq, double Q);
+    static void highPassBiquad(double* pCoef, double freq, double Q);
+    // 6 coefficients, like "PkBq/<Q>/<dBgain>", "LsBq/<Q>/<dBgain>" and
+    // "HsBq/<Q>/<dBgain>". The Q of the shelving filters is the shelf
+    // slope as defined by fidlib.
+    static void peakingBiquad(double* pCoef, double freq, double Q,
+            double dBgain);
+    static void lowShelvingBiquad(double* pCoef, double freq, double Q,
+            double dBgain);
+    static void highShelvingBiquad(double* pCoef, double freq, double Q,
+            double dBgain);
+};
+
+#endif // ENGINEFILTERDESIGN_H
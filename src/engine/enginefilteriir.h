@@ -3,8 +3,14 @@
 
 #define MIXXX
 #include <cstdio>
+#include <cstring>
+#include <type_traits>
 #include <fidlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
+#include "engine/enginefilterdesign.h"
 #include "engine/engineobject.h"
 #include "util/sample.h"
 
@@ -34,9 +40,166 @@ class EngineFilterIIRBase : public EngineObjectConstIn {
 // length of the 3rd argument to fid_design_coef
 #define FIDSPEC_LENGTH 40
 
+
+// The numerators 1 + b1 * z^-1 + b2 * z^-2 of the second order sections
+// of the fidlib filters, as hard coded in the specializations of
+// EngineFilterIIR::processSample() below. Only filters that are made of
+// such sections can be processed by EngineFilterIIRLanes.
+template<unsigned int SIZE, enum IIRPass PASS>
+struct EngineFilterIIRSections {
+    static const bool kSupported = false;
+};
+
+template<unsigned int SIZE>
+struct EngineFilterIIRSections<SIZE, IIR_LP> {
+    static const bool kSupported = SIZE % 2 == 0;
+    static constexpr double b1(unsigned int) { return 2.0; }
+    static constexpr double b2(unsigned int) { return 1.0; }
+};
+
+template<unsigned int SIZE>
+struct EngineFilterIIRSections<SIZE, IIR_HP> {
+    static const bool kSupported = SIZE % 2 == 0;
+    static constexpr double b1(unsigned int) { return -2.0; }
+    static constexpr double b2(unsigned int) { return 1.0; }
+};
+
+// The biquad band pass has zeros at DC and Nyquist, the higher order band
+// passes start with the high pass sections followed by the low pass sections.
+// The 5 coefficient biquads with explicit numerators are not supported.
+template<unsigned int SIZE>
+struct EngineFilterIIRSections<SIZE, IIR_BP> {
+    static const bool kSupported = SIZE % 2 == 0;
+    static constexpr double b1(unsigned int section) {
+        return SIZE == 2 ? 0.0 : (section < SIZE / 4 ? -2.0 : 2.0);
+    }
+    static constexpr double b2(unsigned int) {
+        return SIZE == 2 ? -1.0 : 1.0;
+    }
+};
+
+
+// Processes the same kind of filter for LANES signals at once, for example
+// both channels of a stereo signal or several filters of an EQ. Each lane
+// may use its own coefficients.
+// Every coefficient and state variable is stored for all lanes next to each
+// other, so two neighboring lanes are processed together in one SSE2
+// register. Without SSE2 the lanes are processed one after another; the
+// compiler interleaves them because they are independent.
+// The sections are processed in direct form II like
+// EngineFilterIIR::processSample(), so the state can be exchanged with
+// EngineFilterIIR at any time.
+template<unsigned int SIZE, enum IIRPass PASS, int LANES>
+class EngineFilterIIRLanes {
+  public:
+    typedef EngineFilterIIRSections<SIZE, PASS> Sections;
+    static_assert(Sections::kSupported,
+            "The filter is not made of second order sections");
+
+    static const unsigned int kNumCoefs = SIZE + 1;
+
+    EngineFilterIIRLanes() {
+        memset(m_coef, 0, sizeof(m_coef));
+        clearState();
+    }
+
+    // Sets the kNumCoefs coefficients of a lane in the layout of
+    // EngineFilterIIR: The gain followed by a2 and a1 of each section.
+    void setCoefs(int lane, const double* pCoef) {
+        for (unsigned int i = 0; i < kNumCoefs; ++i) {
+            m_coef[i][lane] = pCoef[i];
+        }
+    }
+
+    // Exchanges the SIZE state variables of a lane with a channel
+    // buffer of EngineFilterIIR
+    void setState(int lane, const double* pBuf) {
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            m_state[i][lane] = pBuf[i];
+        }
+    }
+    void getState(int lane, double* pBuf) const {
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            pBuf[i] = m_state[i][lane];
+        }
+    }
+
+    void clearState() {
+        memset(m_state, 0, sizeof(m_state));
+    }
+
+    // Filters one sample of each lane in place
+    inline void processFrame(double* pVal) {
+        int lane = 0;
+#ifdef __SSE2__
+        for (; lane + 1 < LANES; lane += 2) {
+            processLanePair(pVal, lane);
+        }
+#endif
+        for (; lane < LANES; ++lane) {
+            processLane(pVal, lane);
+        }
+    }
+
+  private:
+    inline void processLane(double* pVal, int lane) {
+        double val = pVal[lane] * m_coef[0][lane];
+        for (unsigned int section = 0; section < SIZE / 2; ++section) {
+            double* w2 = &m_state[2 * section][lane];
+            double* w1 = &m_state[2 * section + 1][lane];
+            // Only two additions depend on the output of the previous
+            // section, which keeps the latency per sample low
+            const double feedback = m_coef[2 * section + 1][lane] * *w2 +
+                    m_coef[2 * section + 2][lane] * *w1;
+            const double feedforward = Sections::b2(section) * *w2 +
+                    Sections::b1(section) * *w1;
+            const double iir = val - feedback;
+            val = feedforward + iir;
+            *w2 = *w1;
+            *w1 = iir;
+        }
+        pVal[lane] = val;
+    }
+
+#ifdef __SSE2__
+    // The same as processLane() for two lanes in one SSE2 register
+    inline void processLanePair(double* pVal, int lane) {
+        __m128d val = _mm_mul_pd(_mm_loadu_pd(pVal + lane),
+                _mm_loadu_pd(m_coef[0] + lane));
+        for (unsigned int section = 0; section < SIZE / 2; ++section) {
+            double* w2 = m_state[2 * section] + lane;
+            double* w1 = m_state[2 * section + 1] + lane;
+            const __m128d w2Val = _mm_loadu_pd(w2);
+            const __m128d w1Val = _mm_loadu_pd(w1);
+            const __m128d feedback = _mm_add_pd(
+                    _mm_mul_pd(_mm_loadu_pd(m_coef[2 * section + 1] + lane), w2Val),
+                    _mm_mul_pd(_mm_loadu_pd(m_coef[2 * section + 2] + lane), w1Val));
+            const __m128d feedforward = _mm_add_pd(
+                    _mm_mul_pd(_mm_set1_pd(Sections::b2(section)), w2Val),
+                    _mm_mul_pd(_mm_set1_pd(Sections::b1(section)), w1Val));
+            const __m128d iir = _mm_sub_pd(val, feedback);
+            val = _mm_add_pd(feedforward, iir);
+            _mm_storeu_pd(w2, w1Val);
+            _mm_storeu_pd(w1, iir);
+        }
+        _mm_storeu_pd(pVal + lane, val);
+    }
+#endif
+
+    // m_coef[i][lane] and m_state[i][lane] correspond to coef[i] and
+    // buf[i] of EngineFilterIIR::processSample()
+    double m_coef[kNumCoefs][LANES];
+    double m_state[SIZE][LANES];
+};
+
+
 template<unsigned int SIZE, enum IIRPass PASS>
 class EngineFilterIIR : public EngineFilterIIRBase {
   public:
+    // The same filter for several signals at once
+    template<int LANES>
+    using Lanes = EngineFilterIIRLanes<SIZE, PASS, LANES>;
+
     EngineFilterIIR()
             : m_doRamping(false),
               m_doStart(false),
@@ -95,6 +258,7 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
             m_coef[0] = fid_design_coef(m_coef + 1, SIZE,
                     spec_d, sampleRate, freq0, freq1, adj);
+            setLaneCoefs(SupportsLanes());
 
             initBuffers();
 
@@ -145,6 +309,7 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                     spec1, sampleRate, freq01, freq11, adj1) *
                         fid_design_coef(m_coef + 1 + n_coef1, SIZE - n_coef1,
                     spec2, sampleRate, freq02, freq12, adj2);
+            setLaneCoefs(SupportsLanes());
 
             initBuffers();
 
@@ -188,6 +353,18 @@ class EngineFilterIIR : public EngineFilterIIRBase {
         }
     }
 
+    // Replaces the coefficients by coefficients from EngineFilterDesign.
+    // Unlike the fidlib based functions above this neither allocates
+    // memory nor parses a filter spec, so it is safe to call from the
+    // engine thread whenever a parameter changes.
+    void setCoefs(const double (&coef)[SIZE + 1]) {
+        // Copy the old coefficients into m_oldCoef
+        memcpy(m_oldCoef, m_coef, sizeof(m_coef));
+        memcpy(m_coef, coef, sizeof(m_coef));
+        setLaneCoefs(SupportsLanes());
+        initBuffers();
+    }
+
     virtual void assumeSettled() {
         m_doRamping = false;
         m_doStart = false;
@@ -196,10 +373,7 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     virtual void process(const CSAMPLE* pIn, CSAMPLE* pOutput,
                          const int iBufferSize) {
         if (!m_doRamping) {
-            for (int i = 0; i < iBufferSize; i += 2) {
-                pOutput[i] = processSample(m_coef, m_buf1, pIn[i]);
-                pOutput[i+1] = processSample(m_coef, m_buf2, pIn[i + 1]);
-            }
+            processSettled(pIn, pOutput, iBufferSize, SupportsLanes());
         } else {
             double cross_mix = 0.0;
             double cross_inc = 4.0 / static_cast<double>(iBufferSize);
@@ -250,6 +424,42 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     }
 
   protected:
+    typedef std::integral_constant<bool,
+            EngineFilterIIRSections<SIZE, PASS>::kSupported> SupportsLanes;
+    struct NoLanes {};
+
+    void setLaneCoefs(std::true_type) {
+        m_lanes.setCoefs(0, m_coef);
+        m_lanes.setCoefs(1, m_coef);
+    }
+
+    void setLaneCoefs(std::false_type) {
+    }
+
+    // Processes both channels in the lanes of EngineFilterIIRLanes. Only
+    // the state is exchanged, because the ramping uses the channel buffers.
+    void processSettled(const CSAMPLE* pIn, CSAMPLE* pOutput,
+            const int iBufferSize, std::true_type) {
+        m_lanes.setState(0, m_buf1);
+        m_lanes.setState(1, m_buf2);
+        for (int i = 0; i < iBufferSize; i += 2) {
+            double frame[2] = { pIn[i], pIn[i + 1] };
+            m_lanes.processFrame(frame);
+            pOutput[i] = frame[0];
+            pOutput[i + 1] = frame[1];
+        }
+        m_lanes.getState(0, m_buf1);
+        m_lanes.getState(1, m_buf2);
+    }
+
+    void processSettled(const CSAMPLE* pIn, CSAMPLE* pOutput,
+            const int iBufferSize, std::false_type) {
+        for (int i = 0; i < iBufferSize; i += 2) {
+            pOutput[i] = processSample(m_coef, m_buf1, pIn[i]);
+            pOutput[i+1] = processSample(m_coef, m_buf2, pIn[i + 1]);
+        }
+    }
+
     inline double processSample(double* coef, double* buf, double val);
     inline void pauseFilterInner() {
         // Set the current buffers to 0
@@ -262,6 +472,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     double m_coef[SIZE + 1];
     // Old coefficients needed for ramping
     double m_oldCoef[SIZE + 1];
+    // Both channels with m_coef, used once the filter has settled
+    typename std::conditional<SupportsLanes::value,
+            Lanes<2>, NoLanes>::type m_lanes;
 
     // Channel 1 state
     double m_buf1[SIZE];
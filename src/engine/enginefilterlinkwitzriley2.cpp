@@ -7,10 +7,9 @@ EngineFilterLinkwitzRiley2Low::EngineFilterLinkwitzRiley2Low(int sampleRate, dou
 
 void EngineFilterLinkwitzRiley2Low::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs2(sampleRate, 1,
-            "LpBu1", freqCorner1, 0, 0,
-            "LpBu1", freqCorner1, 0, 0);
+    double coef[3];
+    EngineFilterDesign::lowPassLinkwitzRiley(coef, 2, freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 EngineFilterLinkwitzRiley2High::EngineFilterLinkwitzRiley2High(int sampleRate, double freqCorner1) {
@@ -19,7 +18,7 @@ EngineFilterLinkwitzRiley2High::EngineFilterLinkwitzRiley2High(int sampleRate, d
 
 void EngineFilterLinkwitzRiley2High::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    setCoefs2(sampleRate, 1,
-            "HpBu1", freqCorner1, 0, 0,
-            "HpBu1", freqCorner1, 0, 0);
+    double coef[3];
+    EngineFilterDesign::highPassLinkwitzRiley(coef, 2, freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
@@ -7,10 +7,9 @@ EngineFilterLinkwitzRiley4Low::EngineFilterLinkwitzRiley4Low(int sampleRate, dou
 
 void EngineFilterLinkwitzRiley4Low::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs2(sampleRate, 2,
-            "LpBu2", freqCorner1, 0, 0,
-            "LpBu2", freqCorner1, 0, 0);
+    double coef[5];
+    EngineFilterDesign::lowPassLinkwitzRiley(coef, 4, freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 EngineFilterLinkwitzRiley4High::EngineFilterLinkwitzRiley4High(int sampleRate, double freqCorner1) {
@@ -19,7 +18,7 @@ EngineFilterLinkwitzRiley4High::EngineFilterLinkwitzRiley4High(int sampleRate, d
 
 void EngineFilterLinkwitzRiley4High::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    setCoefs2(sampleRate, 2,
-            "HpBu2", freqCorner1, 0, 0,
-            "HpBu2", freqCorner1, 0, 0);
+    double coef[5];
+    EngineFilterDesign::highPassLinkwitzRiley(coef, 4, freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
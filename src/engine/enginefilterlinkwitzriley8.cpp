@@ -7,10 +7,9 @@ EngineFilterLinkwitzRiley8Low::EngineFilterLinkwitzRiley8Low(int sampleRate, dou
 
 void EngineFilterLinkwitzRiley8Low::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    // Copy the old coefficients into m_oldCoef
-    setCoefs2(sampleRate, 4,
-            "LpBu4", freqCorner1, 0, 0,
-            "LpBu4", freqCorner1, 0, 0);
+    double coef[9];
+    EngineFilterDesign::lowPassLinkwitzRiley(coef, 8, freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
 
 EngineFilterLinkwitzRiley8High::EngineFilterLinkwitzRiley8High(int sampleRate, double freqCorner1) {
@@ -19,7 +18,7 @@ EngineFilterLinkwitzRiley8High::EngineFilterLinkwitzRiley8High(int sampleRate, d
 
 void EngineFilterLinkwitzRiley8High::setFrequencyCorners(int sampleRate,
                                              double freqCorner1) {
-    setCoefs2(sampleRate, 4,
-            "HpBu4", freqCorner1, 0, 0,
-            "HpBu4", freqCorner1, 0, 0);
+    double coef[9];
+    EngineFilterDesign::highPassLinkwitzRiley(coef, 8, freqCorner1 / sampleRate);
+    setCoefs(coef);
 }
@@ -441,7 +441,21 @@ void EngineMaster::process(const int iBufferSize) {
     // Clear talkover compressor for the next round of gain calculation.
     m_pTalkoverDucking->clearKeys();
     if (m_pTalkoverDucking->getMode() != EngineTalkoverDucking::OFF) {
-        m_pTalkoverDucking->processKey(m_pTalkover, iBufferSize);
+        // Key on the talkover channels, which their VU meters have measured
+        // already, instead of scanning the talkover mix once more
+        for (int i = 0; i < m_activeTalkoverChannels.size(); ++i) {
+            ChannelInfo* pChannelInfo = m_activeTalkoverChannels[i];
+            // Channels that are fading out are still part of the talkover
+            // mix and keep ducking the master until they have faded out
+            const SampleUtil::Levels* pLevels =
+                    pChannelInfo->m_pChannel->getLevels();
+            if (pLevels != NULL) {
+                m_pTalkoverDucking->processKey(*pLevels);
+            } else {
+                m_pTalkoverDucking->processKey(pChannelInfo->m_pBuffer,
+                        iBufferSize);
+            }
+        }
     }
 
     // Calculate the crossfader gains for left and right side of the crossfader
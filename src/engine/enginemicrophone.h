@@ -33,6 +33,10 @@ class EngineMicrophone : public EngineChannel, public AudioDestination {
     virtual void process(CSAMPLE* pOutput, const int iBufferSize);
     virtual void postProcess(const int iBufferSize) { Q_UNUSED(iBufferSize) }
 
+    const SampleUtil::Levels* getLevels() const override {
+        return &m_vuMeter.getLevels();
+    }
+
     // This is called by SoundManager whenever there are new samples from the
     // configured input to be processed. This is run in the callback thread of
     // the soundcard this AudioDestination was registered for! Beware, in the
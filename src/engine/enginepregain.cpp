@@ -57,6 +57,29 @@ void EnginePregain::setSpeedAndScratching(double speed, bool scratching) {
 }
 
 void EnginePregain::process(CSAMPLE* pInOut, const int iBufferSize) {
+    const CSAMPLE_GAIN totalGain = updateTotalGain();
+
+    if ((m_dSpeed * m_dOldSpeed < 0) && m_scratching) {
+        // direction changed, go though zero if scratching
+        SampleUtil::applyRampingGain(&pInOut[0], m_fPrevGain, 0, iBufferSize / 2);
+        SampleUtil::applyRampingGain(&pInOut[iBufferSize / 2], 0, totalGain, iBufferSize / 2);
+    } else if (totalGain != m_fPrevGain) {
+        // Prevent sound wave discontinuities by interpolating from old to new gain.
+        SampleUtil::applyRampingGain(pInOut, m_fPrevGain, totalGain, iBufferSize);
+    } else {
+        // SampleUtil deals with aliased buffers and gains of 1 or 0.
+        SampleUtil::applyGain(pInOut, totalGain, iBufferSize);
+    }
+    m_fPrevGain = totalGain;
+}
+
+void EnginePregain::processSilence() {
+    // There is nothing to ramp, but the gain and its controls follow the
+    // knobs and the ReplayGain fade like when processing audio
+    m_fPrevGain = updateTotalGain();
+}
+
+CSAMPLE_GAIN EnginePregain::updateTotalGain() {
     const float fReplayGain = m_pCOReplayGain->get();
     float fReplayGainCorrection;
     if (!s_pEnableReplayGain->toBool() || m_pPassthroughEnabled->toBool()) {
@@ -123,19 +146,7 @@ void EnginePregain::process(CSAMPLE* pInOut, const int iBufferSize) {
     // So we apply a curve here that emulates the gain change up to x 2.5 natural
     // to 3.5 dB and then limits the gain towards <= 5.5 dB at am maximum of x5.
     totalGain *= log10((math_min(fabs(m_dSpeed), 5.0) * 4) + 1) / log10((1 * 4) + 1);
-
-    if ((m_dSpeed * m_dOldSpeed < 0) && m_scratching) {
-        // direction changed, go though zero if scratching
-        SampleUtil::applyRampingGain(&pInOut[0], m_fPrevGain, 0, iBufferSize / 2);
-        SampleUtil::applyRampingGain(&pInOut[iBufferSize / 2], 0, totalGain, iBufferSize / 2);
-    } else if (totalGain != m_fPrevGain) {
-        // Prevent sound wave discontinuities by interpolating from old to new gain.
-        SampleUtil::applyRampingGain(pInOut, m_fPrevGain, totalGain, iBufferSize);
-    } else {
-        // SampleUtil deals with aliased buffers and gains of 1 or 0.
-        SampleUtil::applyGain(pInOut, totalGain, iBufferSize);
-    }
-    m_fPrevGain = totalGain;
+    return totalGain;
 }
 
 void EnginePregain::collectFeatures(GroupFeatureState* pGroupFeatures) const {
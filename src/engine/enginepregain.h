@@ -25,10 +25,15 @@ class EnginePregain : public EngineObject {
     void setSpeedAndScratching(double speed, bool scratching);
 
     void process(CSAMPLE* pInOut, const int iBufferSize) override;
+    // Like process() for a silent buffer, without touching it
+    void processSilence();
 
     void collectFeatures(GroupFeatureState* pGroupFeatures) const override;
 
   private:
+    // Returns the gain for the current buffer and updates the controls
+    CSAMPLE_GAIN updateTotalGain();
+
     double m_dSpeed;
     double m_dOldSpeed;
     double m_dNonScratchSpeed;
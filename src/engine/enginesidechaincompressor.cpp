@@ -43,12 +43,14 @@ void EngineSideChainCompressor::clearKeys() {
 }
 
 void EngineSideChainCompressor::processKey(const CSAMPLE* pIn, const int iBufferSize) {
-    for (int i = 0; i + 1 < iBufferSize; i += 2) {
-        CSAMPLE val = (pIn[i] + pIn[i + 1]) / 2;
-        if (val > m_threshold) {
-            m_bAboveThreshold = true;
-            return;
-        }
+    SampleUtil::Levels levels;
+    SampleUtil::measureLevels(&levels, pIn, iBufferSize);
+    processKey(levels);
+}
+
+void EngineSideChainCompressor::processKey(const SampleUtil::Levels& levels) {
+    if (levels.peakMid > m_threshold) {
+        m_bAboveThreshold = true;
     }
 }
 
@@ -1,6 +1,7 @@
 #ifndef ENGINECOMPRESSOR_H
 #define ENGINECOMPRESSOR_H
 
+#include "util/sample.h"
 #include "util/types.h"
 
 class EngineSideChainCompressor {
@@ -50,7 +51,11 @@ class EngineSideChainCompressor {
     // multiple times for multiple keys, however they will not be summed together
     // so compression will not be triggered unless at least one buffer would
     // have triggered alone.
+    // The key is above the threshold if its mid signal (L + R) / 2 is.
     void processKey(const CSAMPLE* pIn, const int iBufferSize);
+    // Like above, for a buffer that has already been measured, e.g. by a
+    // meter of the same bus.
+    void processKey(const SampleUtil::Levels& levels);
 
     // Calculates a new gain value based on the current compression ratio
     // over the given number of frames and whether the current input is above threshold.
@@ -21,6 +21,13 @@
 #include "util/math.h"
 #include "util/sample.h"
 
+namespace {
+
+// Below the change that is sent to the controls
+const CSAMPLE kSilenceVolume = .0001;
+
+} // anonymous namespace
+
 EngineVuMeter::EngineVuMeter(QString group) {
     // The VUmeter widget is controlled via a controlpotmeter, which means
     // that it should react on the setValue(int) signal.
@@ -56,12 +63,32 @@ EngineVuMeter::~EngineVuMeter()
 }
 
 void EngineVuMeter::process(CSAMPLE* pIn, const int iBufferSize) {
-    CSAMPLE fVolSumL, fVolSumR;
+    SampleUtil::CLIP_STATUS clipped = SampleUtil::measureLevels(&m_levels,
+            pIn, iBufferSize);
+    update(m_levels.sumAbsL, m_levels.sumAbsR, clipped, iBufferSize);
+}
+
+void EngineVuMeter::processSilence(const int iBufferSize) {
+    m_levels = SampleUtil::Levels();
+    if (m_fRMSvolumeL == 0 && m_fRMSvolumeR == 0 &&
+            m_peakDurationL <= 0 && m_peakDurationR <= 0 &&
+            m_ctrlPeakIndicator->get() == 0) {
+        // Nothing left to decay
+        return;
+    }
+    update(0, 0, SampleUtil::NO_CLIPPING, iBufferSize);
+    if (m_fRMSvolumeL < kSilenceVolume && m_fRMSvolumeR < kSilenceVolume &&
+            m_iSamplesCalculated == 0 &&
+            m_peakDurationL <= 0 && m_peakDurationR <= 0) {
+        // The decay only approaches zero
+        reset();
+    }
+}
 
+void EngineVuMeter::update(CSAMPLE fVolSumL, CSAMPLE fVolSumR,
+        SampleUtil::CLIP_STATUS clipped, const int iBufferSize) {
     int sampleRate = (int)m_pSampleRate->get();
 
-    SampleUtil::CLIP_STATUS clipped = SampleUtil::sumAbsPerChannel(&fVolSumL,
-            &fVolSumR, pIn, iBufferSize);
     m_fRMSvolumeSumL += fVolSumL;
     m_fRMSvolumeSumR += fVolSumR;
 
@@ -145,4 +172,5 @@ void EngineVuMeter::reset() {
     m_fRMSvolumeSumR = 0;
     m_peakDurationL = 0;
     m_peakDurationR = 0;
+    m_levels = SampleUtil::Levels();
 }
@@ -18,6 +18,7 @@
 #define ENGINEVUMETER_H
 
 #include "engine/engineobject.h"
+#include "util/sample.h"
 
 // Rate at which the vumeter is updated (using a sample rate of 44100 Hz):
 #define VU_UPDATE_RATE 30 // in 1/s, fits to display frame rate
@@ -38,10 +39,20 @@ class EngineVuMeter : public EngineObject {
     virtual ~EngineVuMeter();
 
     virtual void process(CSAMPLE* pInOut, const int iBufferSize);
+    // Like process() for a silent buffer, without reading it. Does nothing
+    // once the meter has decayed to zero.
+    void processSilence(const int iBufferSize);
 
     void reset();
 
+    // The levels of the last buffer, zero if it was silent
+    const SampleUtil::Levels& getLevels() const {
+        return m_levels;
+    }
+
   private:
+    void update(CSAMPLE fVolSumL, CSAMPLE fVolSumR,
+            SampleUtil::CLIP_STATUS clipped, const int iBufferSize);
     void doSmooth(CSAMPLE &currentVolume, CSAMPLE newVolume);
 
     ControlPotmeter* m_ctrlVuMeter;
@@ -60,6 +71,8 @@ class EngineVuMeter : public EngineObject {
     int m_peakDurationR;
 
     ControlProxy* m_pSampleRate;
+
+    SampleUtil::Levels m_levels;
 };
 
 #endif
@@ -0,0 +1,203 @@
+#include "engine/rubberbandworker.h"
+
+#include <rubberband/RubberBandStretcher.h>
+
+#include "util/compatibility.h"
+#include "util/event.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+using RubberBand::RubberBandStretcher;
+
+namespace {
+
+// The max process size of the stretchers of EngineBufferScaleRubberBand
+const SINT kBlockFrames = 256;
+
+const int kInputFifoFrames = 4 * RubberBandWorker::kMaxLookaheadFrames;
+const int kOutputFifoFrames = 2 * RubberBandWorker::kMaxLookaheadFrames;
+// A block is written for each retrieval of at least a few frames
+const int kBlockFifoSize = 1024;
+const int kParametersFifoSize = 64;
+
+}  // anonymous namespace
+
+RubberBandWorker::RubberBandWorker()
+        : m_inputFifo(kInputFifoFrames * kChannels),
+          m_outputFifo(kOutputFifoFrames * kChannels),
+          m_blockFifo(kBlockFifoSize),
+          m_parametersFifo(kParametersFifoSize),
+          m_pStretcher(nullptr),
+          m_parameters{1.0, 1.0, 1.0},
+          m_interleavedBuffer(SampleUtil::alloc(kBlockFrames * kChannels)),
+          m_pOldStretcher(nullptr),
+          m_requestedSampleRate(0),
+          m_pNewStretcher(nullptr),
+          m_state(STATE_IDLE),
+          m_stop(0) {
+    for (int i = 0; i < kChannels; ++i) {
+        m_buffer[i] = SampleUtil::alloc(kBlockFrames);
+    }
+}
+
+RubberBandWorker::~RubberBandWorker() {
+    delete m_pOldStretcher;
+    delete m_pNewStretcher.fetchAndStoreOrdered(nullptr);
+    for (int i = 0; i < kChannels; ++i) {
+        SampleUtil::free(m_buffer[i]);
+    }
+    SampleUtil::free(m_interleavedBuffer);
+}
+
+// static
+std::unique_ptr<RubberBandStretcher> RubberBandWorker::makeStretcher(
+        SINT sampleRate, int channels) {
+    auto pStretcher = std::make_unique<RubberBandStretcher>(
+            sampleRate, channels, RubberBandStretcher::OptionProcessRealTime);
+    pStretcher->setMaxProcessSize(kBlockFrames);
+    // Setting the time ratio to a very high value will cause RubberBand
+    // to preallocate buffers large enough to (almost certainly)
+    // avoid memory reallocations during playback.
+    pStretcher->setTimeRatio(2.0);
+    pStretcher->setTimeRatio(1.0);
+    return pStretcher;
+}
+
+bool RubberBandWorker::isIdle() {
+    // Acquires the reset stretcher and the drained FIFOs of the worker
+    return m_state.testAndSetAcquire(STATE_IDLE, STATE_IDLE);
+}
+
+void RubberBandWorker::startStretching(RubberBandStretcher* pStretcher,
+        const RubberBandWorkerParameters& parameters) {
+    m_pStretcher = pStretcher;
+    m_parameters = parameters;
+    m_state.fetchAndStoreRelease(STATE_STRETCHING);
+}
+
+void RubberBandWorker::stopStretching() {
+    m_state.testAndSetOrdered(STATE_STRETCHING, STATE_STOPPING);
+}
+
+bool RubberBandWorker::setParameters(
+        const RubberBandWorkerParameters& parameters) {
+    return m_parametersFifo.write(&parameters, 1) == 1;
+}
+
+void RubberBandWorker::requestStretcher(SINT sampleRate,
+        RubberBandStretcher* pOldStretcher) {
+    m_pOldStretcher = pOldStretcher;
+    m_requestedSampleRate.fetchAndStoreRelease(static_cast<int>(sampleRate));
+}
+
+RubberBandStretcher* RubberBandWorker::takeStretcher() {
+    return m_pNewStretcher.fetchAndStoreAcquire(nullptr);
+}
+
+void RubberBandWorker::run() {
+    unsigned static id = 0; //the id of this thread, for debugging purposes
+    QThread::currentThread()->setObjectName(QString("RubberBandWorker %1").arg(++id));
+
+    while (!load_atomic(m_stop)) {
+        if (m_state.testAndSetAcquire(STATE_STRETCHING, STATE_STRETCHING)) {
+            Event::start("RubberBandWorker");
+            stretch();
+            Event::end("RubberBandWorker");
+        }
+        if (m_state.testAndSetAcquire(STATE_STOPPING, STATE_STOPPING)) {
+            reset();
+            m_state.fetchAndStoreRelease(STATE_IDLE);
+        }
+        createStretcher();
+        m_semaRun.acquire();
+    }
+}
+
+void RubberBandWorker::quitWait() {
+    m_stop = 1;
+    m_semaRun.release();
+    wait();
+}
+
+void RubberBandWorker::applyParameters() {
+    bool changed = false;
+    while (m_parametersFifo.read(&m_parameters, 1) == 1) {
+        changed = true;
+    }
+    if (changed) {
+        // RubberBand ignores parameters that did not change
+        m_pStretcher->setPitchScale(m_parameters.pitchScale);
+        m_pStretcher->setTimeRatio(m_parameters.timeRatio);
+    }
+}
+
+void RubberBandWorker::stretch() {
+    while (m_state.testAndSetAcquire(STATE_STRETCHING, STATE_STRETCHING)) {
+        applyParameters();
+
+        bool progress = false;
+        const SINT writeFrames = m_outputFifo.writeAvailable() / kChannels;
+        const SINT retrieveFrames = math_min(kBlockFrames,
+                math_min(writeFrames, static_cast<SINT>(m_pStretcher->available())));
+        if (retrieveFrames > 0 && m_blockFifo.writeAvailable() > 0) {
+            const SINT frames = m_pStretcher->retrieve(
+                    (float* const*)m_buffer, retrieveFrames);
+            SampleUtil::interleaveBuffer(m_interleavedBuffer,
+                    m_buffer[0], m_buffer[1], frames);
+            // The block goes first, so the callback never reads frames
+            // without knowing their input.
+            const RubberBandWorkerBlock block = {
+                frames, m_parameters.inputFramesPerFrame };
+            m_blockFifo.write(&block, 1);
+            m_outputFifo.write(m_interleavedBuffer, frames * kChannels);
+            progress = frames > 0;
+        }
+
+        // Only feed more input if there is room for the output
+        SINT requiredFrames = m_pStretcher->getSamplesRequired();
+        if (requiredFrames == 0 && m_pStretcher->available() == 0) {
+            // Work around the rubberband 1.3 bug like
+            // EngineBufferScaleRubberBand::scaleBuffer()
+            requiredFrames = kBlockFrames;
+        }
+        const SINT processFrames = math_min(math_min(requiredFrames, kBlockFrames),
+                static_cast<SINT>(m_inputFifo.readAvailable() / kChannels));
+        if (processFrames > 0 &&
+                m_pStretcher->available() < m_outputFifo.writeAvailable() / kChannels) {
+            m_inputFifo.read(m_interleavedBuffer, processFrames * kChannels);
+            SampleUtil::deinterleaveBuffer(m_buffer[0], m_buffer[1],
+                    m_interleavedBuffer, processFrames);
+            m_pStretcher->process((const float* const*)m_buffer,
+                    processFrames, false);
+            progress = true;
+        }
+
+        if (!progress) {
+            // Wait for the callback
+            return;
+        }
+    }
+}
+
+void RubberBandWorker::createStretcher() {
+    const int sampleRate = m_requestedSampleRate.fetchAndStoreAcquire(0);
+    if (sampleRate <= 0) {
+        return;
+    }
+    delete m_pOldStretcher;
+    m_pOldStretcher = nullptr;
+    m_pNewStretcher.fetchAndStoreRelease(
+            makeStretcher(sampleRate, kChannels).release());
+}
+
+void RubberBandWorker::reset() {
+    // The callback drains the output FIFOs after the worker has become idle
+    m_inputFifo.flushReadData(m_inputFifo.readAvailable());
+    RubberBandWorkerParameters parameters;
+    while (m_parametersFifo.read(&parameters, 1) == 1) {
+    }
+    if (m_pStretcher) {
+        m_pStretcher->reset();
+        m_pStretcher = nullptr;
+    }
+}
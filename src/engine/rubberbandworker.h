@@ -0,0 +1,122 @@
+#ifndef ENGINE_RUBBERBANDWORKER_H
+#define ENGINE_RUBBERBANDWORKER_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+
+#include "engine/engineworker.h"
+#include "util/fifo.h"
+#include "util/memory.h"
+#include "util/types.h"
+
+namespace RubberBand {
+class RubberBandStretcher;
+}  // namespace RubberBand
+
+// The stretching parameters the worker applies before each block
+struct RubberBandWorkerParameters {
+    double timeRatio;
+    double pitchScale;
+    // The unscaled frames that are consumed by each stretched frame
+    double inputFramesPerFrame;
+};
+
+// Describes the following stretched frames in the output FIFO, so the
+// callback reports the input consumed with the parameters that were used
+// for stretching instead of the current ones.
+struct RubberBandWorkerBlock {
+    SINT frames;
+    double inputFramesPerFrame;
+};
+
+// Runs a RubberBandStretcher on a worker thread a few blocks ahead of the
+// audio callback. The callback writes the unscaled interleaved input into
+// the input FIFO and reads the stretched interleaved output from the
+// output FIFO. Each FIFO has a single writer and a single reader.
+//
+// While the worker is idle it neither touches a stretcher nor the FIFOs,
+// so the callback may use them itself. The callback hands a stretcher over
+// with startStretching() and asks for it back with stopStretching(). Once
+// isIdle() returns true again the worker has reset the stretcher and
+// drained the input FIFO.
+//
+// After a sample rate change the worker also replaces the stretcher of the
+// callback, so the callback neither allocates nor frees it.
+class RubberBandWorker : public EngineWorker {
+    Q_OBJECT
+  public:
+    static const int kChannels = 2;
+    // The maximum frames the worker stretches ahead of the callback
+    static const SINT kMaxLookaheadFrames = 8192;
+
+    RubberBandWorker();
+    ~RubberBandWorker() override;
+
+    // Creates a stretcher with buffers large enough to avoid reallocations
+    // during playback
+    static std::unique_ptr<RubberBand::RubberBandStretcher> makeStretcher(
+            SINT sampleRate, int channels);
+
+    // Callback thread
+    bool isIdle();
+    void startStretching(RubberBand::RubberBandStretcher* pStretcher,
+            const RubberBandWorkerParameters& parameters);
+    void stopStretching();
+    // Returns false if the parameters could not be queued
+    bool setParameters(const RubberBandWorkerParameters& parameters);
+    // Hands over pOldStretcher for deletion and requests a new stretcher,
+    // which is returned by takeStretcher() once it has been created. Only
+    // one stretcher may be requested at a time.
+    void requestStretcher(SINT sampleRate,
+            RubberBand::RubberBandStretcher* pOldStretcher);
+    // Returns nullptr while the requested stretcher is not ready
+    RubberBand::RubberBandStretcher* takeStretcher();
+
+    FIFO<CSAMPLE>& inputFifo() {
+        return m_inputFifo;
+    }
+    FIFO<CSAMPLE>& outputFifo() {
+        return m_outputFifo;
+    }
+    FIFO<RubberBandWorkerBlock>& blockFifo() {
+        return m_blockFifo;
+    }
+
+    // Stretches the pending input. Run by the EngineWorkerScheduler.
+    void run() override;
+    void quitWait();
+
+  private:
+    enum State {
+        STATE_IDLE,
+        STATE_STRETCHING,
+        STATE_STOPPING,
+    };
+
+    // Worker thread
+    void applyParameters();
+    void stretch();
+    void reset();
+    void createStretcher();
+
+    FIFO<CSAMPLE> m_inputFifo;
+    FIFO<CSAMPLE> m_outputFifo;
+    FIFO<RubberBandWorkerBlock> m_blockFifo;
+    FIFO<RubberBandWorkerParameters> m_parametersFifo;
+
+    // Only accessed by the worker thread while not idle
+    RubberBand::RubberBandStretcher* m_pStretcher;
+    RubberBandWorkerParameters m_parameters;
+    CSAMPLE* m_buffer[kChannels];
+    CSAMPLE* m_interleavedBuffer;
+
+    // Exchanged with requestStretcher() and takeStretcher()
+    RubberBand::RubberBandStretcher* m_pOldStretcher;
+    QAtomicInt m_requestedSampleRate;
+    QAtomicPointer<RubberBand::RubberBandStretcher> m_pNewStretcher;
+
+    QAtomicInt m_state;
+    QAtomicInt m_stop;
+};
+
+#endif /* ENGINE_RUBBERBANDWORKER_H */
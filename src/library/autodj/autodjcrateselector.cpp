@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <limits>
+
+#include "library/autodj/autodjcrateselector.h"
+
+#include "util/assert.h"
+
+namespace {
+
+// Tracks that have never been played are ranked before all other tracks
+const qint64 kNeverPlayed = std::numeric_limits<qint64>::min();
+
+} // anonymous namespace
+
+AutoDJCrateSelector::AutoDJCrateSelector()
+        : m_rankByLastPlayed(false),
+          m_activeTracks(0),
+          m_activeUnplayedTracks(0),
+          m_rankingValid(false) {
+}
+
+void AutoDJCrateSelector::clear() {
+    m_tracks.clear();
+    m_activeTracks = 0;
+    m_activeUnplayedTracks = 0;
+    m_rankingValid = false;
+    m_ranking.clear();
+    m_activeTree.clear();
+}
+
+void AutoDJCrateSelector::setRankByLastPlayed(bool rankByLastPlayed) {
+    if (m_rankByLastPlayed != rankByLastPlayed) {
+        m_rankByLastPlayed = rankByLastPlayed;
+        m_rankingValid = false;
+    }
+}
+
+// static
+qint64 AutoDJCrateSelector::toLastPlayed(const QDateTime& dateTime) {
+    if (dateTime.isValid()) {
+        return dateTime.toMSecsSinceEpoch();
+    } else {
+        return kNeverPlayed;
+    }
+}
+
+void AutoDJCrateSelector::insertTrack(TrackId trackId, int crateRefs,
+        int timesPlayed, int autoDjRefs, const QDateTime& lastPlayed) {
+    DEBUG_ASSERT(trackId.isValid());
+    DEBUG_ASSERT(crateRefs > 0);
+    const auto i = m_tracks.find(trackId);
+    if (i != m_tracks.end()) {
+        countEntry(i.value(), -1);
+    }
+    Entry entry;
+    entry.crateRefs = crateRefs;
+    entry.timesPlayed = timesPlayed;
+    entry.autoDjRefs = autoDjRefs;
+    entry.lastPlayed = toLastPlayed(lastPlayed);
+    m_tracks.insert(trackId, entry);
+    countEntry(entry, 1);
+    m_rankingValid = false;
+}
+
+bool AutoDJCrateSelector::addCrateRef(TrackId trackId) {
+    const auto i = m_tracks.find(trackId);
+    if (i == m_tracks.end()) {
+        return false;
+    }
+    ++i.value().crateRefs;
+    return true;
+}
+
+void AutoDJCrateSelector::removeCrateRef(TrackId trackId) {
+    const auto i = m_tracks.find(trackId);
+    if (i == m_tracks.end()) {
+        return;
+    }
+    if (--i.value().crateRefs > 0) {
+        return;
+    }
+    countEntry(i.value(), -1);
+    m_tracks.erase(i);
+    m_rankingValid = false;
+}
+
+void AutoDJCrateSelector::addAutoDjRef(TrackId trackId) {
+    const auto i = m_tracks.find(trackId);
+    if (i == m_tracks.end()) {
+        return;
+    }
+    countEntry(i.value(), -1);
+    ++i.value().autoDjRefs;
+    countEntry(i.value(), 1);
+}
+
+void AutoDJCrateSelector::removeAutoDjRef(TrackId trackId) {
+    const auto i = m_tracks.find(trackId);
+    if (i == m_tracks.end()) {
+        return;
+    }
+    countEntry(i.value(), -1);
+    --i.value().autoDjRefs;
+    countEntry(i.value(), 1);
+}
+
+int AutoDJCrateSelector::autoDjRefs(TrackId trackId) const {
+    const auto i = m_tracks.constFind(trackId);
+    if (i == m_tracks.constEnd()) {
+        return 0;
+    }
+    return i.value().autoDjRefs;
+}
+
+void AutoDJCrateSelector::setTimesPlayed(TrackId trackId, int timesPlayed) {
+    const auto i = m_tracks.find(trackId);
+    if ((i == m_tracks.end()) || (i.value().timesPlayed == timesPlayed)) {
+        return;
+    }
+    countEntry(i.value(), -1);
+    i.value().timesPlayed = timesPlayed;
+    countEntry(i.value(), 1);
+    if (!m_rankByLastPlayed) {
+        m_rankingValid = false;
+    }
+}
+
+void AutoDJCrateSelector::setLastPlayed(TrackId trackId, const QDateTime& lastPlayed) {
+    const auto i = m_tracks.find(trackId);
+    if (i == m_tracks.end()) {
+        return;
+    }
+    const qint64 newLastPlayed = toLastPlayed(lastPlayed);
+    if (i.value().lastPlayed != newLastPlayed) {
+        i.value().lastPlayed = newLastPlayed;
+        m_rankingValid = false;
+    }
+}
+
+int AutoDJCrateSelector::countActiveTracksLastPlayedBefore(const QDateTime& dateTime) {
+    const qint64 lastPlayed = toLastPlayed(dateTime);
+    if (!m_rankByLastPlayed) {
+        int count = 0;
+        for (const auto& entry: m_tracks) {
+            if (entry.isActive() && (entry.lastPlayed < lastPlayed)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+    // All tracks that have been played before are ranked first
+    updateRanking();
+    const auto firstPlayedAfter = std::partition_point(
+            m_ranking.begin(), m_ranking.end(),
+            [this, lastPlayed](TrackId trackId) {
+                return m_tracks.value(trackId).lastPlayed < lastPlayed;
+            });
+    return countActiveBefore(firstPlayedAfter - m_ranking.begin());
+}
+
+TrackId AutoDJCrateSelector::activeTrackAt(int rank) {
+    VERIFY_OR_DEBUG_ASSERT((rank >= 0) && (rank < m_activeTracks)) {
+        return TrackId();
+    }
+    updateRanking();
+    // Descend the Fenwick tree to find the smallest position with
+    // rank + 1 active tracks up to and including that position.
+    const int size = m_ranking.size();
+    int step = 1;
+    while ((step << 1) <= size) {
+        step <<= 1;
+    }
+    int pos = 0;
+    int remaining = rank + 1;
+    for (; step > 0; step >>= 1) {
+        if ((pos + step <= size) && (m_activeTree[pos + step] < remaining)) {
+            pos += step;
+            remaining -= m_activeTree[pos];
+        }
+    }
+    DEBUG_ASSERT(pos < size);
+    return m_ranking[pos];
+}
+
+void AutoDJCrateSelector::countEntry(const Entry& entry, int delta) {
+    if (!entry.isActive()) {
+        return;
+    }
+    m_activeTracks += delta;
+    if (entry.timesPlayed == 0) {
+        m_activeUnplayedTracks += delta;
+    }
+    if (m_rankingValid && (entry.rank >= 0)) {
+        addActiveAt(entry.rank, delta);
+    }
+}
+
+bool AutoDJCrateSelector::isRankedBefore(TrackId lhs, TrackId rhs) const {
+    const Entry& lhsEntry = m_tracks.find(lhs).value();
+    const Entry& rhsEntry = m_tracks.find(rhs).value();
+    if (!m_rankByLastPlayed && (lhsEntry.timesPlayed != rhsEntry.timesPlayed)) {
+        return lhsEntry.timesPlayed < rhsEntry.timesPlayed;
+    }
+    if (lhsEntry.lastPlayed != rhsEntry.lastPlayed) {
+        return lhsEntry.lastPlayed < rhsEntry.lastPlayed;
+    }
+    return lhs < rhs;
+}
+
+void AutoDJCrateSelector::updateRanking() {
+    if (m_rankingValid) {
+        return;
+    }
+    m_ranking.clear();
+    m_ranking.reserve(m_tracks.size());
+    for (auto i = m_tracks.constBegin(); i != m_tracks.constEnd(); ++i) {
+        m_ranking.push_back(i.key());
+    }
+    std::sort(m_ranking.begin(), m_ranking.end(),
+            [this](TrackId lhs, TrackId rhs) {
+                return isRankedBefore(lhs, rhs);
+            });
+
+    // Build the Fenwick tree in linear time
+    const int size = m_ranking.size();
+    m_activeTree.assign(size + 1, 0);
+    for (int rank = 0; rank < size; ++rank) {
+        Entry& entry = m_tracks[m_ranking[rank]];
+        entry.rank = rank;
+        m_activeTree[rank + 1] += entry.isActive() ? 1 : 0;
+        const int parent = (rank + 1) + ((rank + 1) & -(rank + 1));
+        if (parent <= size) {
+            m_activeTree[parent] += m_activeTree[rank + 1];
+        }
+    }
+    m_rankingValid = true;
+}
+
+void AutoDJCrateSelector::addActiveAt(int rank, int delta) {
+    const int size = m_ranking.size();
+    for (int pos = rank + 1; pos <= size; pos += pos & -pos) {
+        m_activeTree[pos] += delta;
+    }
+}
+
+int AutoDJCrateSelector::countActiveBefore(int rank) const {
+    int count = 0;
+    for (int pos = rank; pos > 0; pos -= pos & -pos) {
+        count += m_activeTree[pos];
+    }
+    return count;
+}
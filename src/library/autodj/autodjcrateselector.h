@@ -0,0 +1,118 @@
+#ifndef AUTODJCRATESELECTOR_H
+#define AUTODJCRATESELECTOR_H
+
+#include <QDateTime>
+#include <QHash>
+
+#include <vector>
+
+#include "track/trackid.h"
+
+// The tracks of all auto-DJ crates together with the properties that
+// are needed for picking the next track of the auto-DJ queue.
+//
+// A track is active if it is neither queued in the auto-DJ playlist nor
+// loaded into a deck. The active tracks are ranked by the number of
+// times they have been played and the last time they have been played.
+// Looking up the n-th active track or counting the active tracks takes
+// O(log n), so that refilling the auto-DJ queue does not depend on the
+// size of the library.
+//
+// The ranking is recalculated lazily after the play statistics of a
+// track have been modified or tracks have been added or removed. Queuing
+// and unqueuing tracks is cheap and does not affect the ranking.
+class AutoDJCrateSelector {
+  public:
+    AutoDJCrateSelector();
+
+    void clear();
+
+    // If enabled the tracks are ranked by the last time they have been
+    // played only, i.e. ignoring the number of times they have been
+    // played.
+    void setRankByLastPlayed(bool rankByLastPlayed);
+    bool isRankedByLastPlayed() const {
+        return m_rankByLastPlayed;
+    }
+
+    bool contains(TrackId trackId) const {
+        return m_tracks.contains(trackId);
+    }
+    int size() const {
+        return m_tracks.size();
+    }
+
+    // Inserts or replaces a track. A track that has never been played
+    // has an invalid last played date/time.
+    void insertTrack(TrackId trackId, int crateRefs, int timesPlayed,
+            int autoDjRefs, const QDateTime& lastPlayed);
+
+    // Adds a reference from another auto-DJ crate to a track. Returns
+    // false if the track has not been inserted yet.
+    bool addCrateRef(TrackId trackId);
+    // Removes a crate reference. The track is removed if it is no longer
+    // referenced by any auto-DJ crate.
+    void removeCrateRef(TrackId trackId);
+
+    // References from the auto-DJ playlist or from decks. Tracks that are
+    // not contained are ignored.
+    void addAutoDjRef(TrackId trackId);
+    void removeAutoDjRef(TrackId trackId);
+    int autoDjRefs(TrackId trackId) const;
+
+    void setTimesPlayed(TrackId trackId, int timesPlayed);
+    void setLastPlayed(TrackId trackId, const QDateTime& lastPlayed);
+
+    int countActiveTracks() const {
+        return m_activeTracks;
+    }
+    int countActiveUnplayedTracks() const {
+        return m_activeUnplayedTracks;
+    }
+    // Counts the active tracks that have not been played since the
+    // given date/time, including those that have never been played.
+    int countActiveTracksLastPlayedBefore(const QDateTime& dateTime);
+
+    // Returns the active track with the given rank in the range
+    // [0, countActiveTracks()).
+    TrackId activeTrackAt(int rank);
+
+  private:
+    struct Entry {
+        int crateRefs = 0;
+        int timesPlayed = 0;
+        int autoDjRefs = 0;
+        // Milliseconds since epoch, kNeverPlayed if never played
+        qint64 lastPlayed = 0;
+        // Index into m_ranking
+        int rank = -1;
+
+        bool isActive() const {
+            return autoDjRefs == 0;
+        }
+    };
+
+    static qint64 toLastPlayed(const QDateTime& dateTime);
+
+    // Adds (delta = 1) or subtracts (delta = -1) the entry from
+    // the counters of active tracks.
+    void countEntry(const Entry& entry, int delta);
+    void updateRanking();
+    bool isRankedBefore(TrackId lhs, TrackId rhs) const;
+
+    // Fenwick tree that counts the active tracks by rank
+    void addActiveAt(int rank, int delta);
+    int countActiveBefore(int rank) const;
+
+    QHash<TrackId, Entry> m_tracks;
+    bool m_rankByLastPlayed;
+
+    int m_activeTracks;
+    int m_activeUnplayedTracks;
+
+    bool m_rankingValid;
+    std::vector<TrackId> m_ranking;
+    std::vector<int> m_activeTree;
+};
+
+#endif // AUTODJCRATESELECTOR_H
@@ -17,10 +17,10 @@ BansheeFeature::BansheeFeature(QObject* parent,
                                TrackCollection* pTrackCollection,
                                UserSettingsPointer pConfig)
         : BaseExternalLibraryFeature(parent, pTrackCollection),
+          m_pBansheePlaylistModel(nullptr),
           m_pTrackCollection(pTrackCollection),
           m_cancelImport(false) {
     Q_UNUSED(pConfig);
-    m_pBansheePlaylistModel = new BansheePlaylistModel(this, m_pTrackCollection, &m_connection);
     m_isActivated = false;
     m_title = tr("Banshee");
 }
@@ -52,6 +52,10 @@ void BansheeFeature::prepareDbPath(UserSettingsPointer pConfig) {
     }
 }
 
+void BansheeFeature::initialize() {
+    m_pBansheePlaylistModel = new BansheePlaylistModel(this, m_pTrackCollection, &m_connection);
+}
+
 QVariant BansheeFeature::title() {
     return m_title;
 }
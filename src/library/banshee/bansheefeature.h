@@ -30,6 +30,9 @@ class BansheeFeature : public BaseExternalLibraryFeature {
 
     virtual TreeItemModel* getChildModel();
 
+  protected:
+    void initialize() override;
+
   public slots:
     virtual void activate();
     virtual void activateChild(const QModelIndex& index);
@@ -170,8 +170,9 @@ bool BaseTrackCache::updateIndexWithTrackpointer(TrackPointer pTrack) {
         QVector<QVariant>& record = m_trackInfo[trackId];
         // prealocate memory for all columns at once
         record.resize(numColumns);
+        const TrackSnapshotPointer pSnapshot = pTrack->getSnapshot();
         for (int i = 0; i < numColumns; ++i) {
-            getTrackValueForColumn(pTrack, i, record[i]);
+            getTrackValueForColumn(*pSnapshot, i, record[i]);
         }
     }
     return true;
@@ -278,72 +279,72 @@ void BaseTrackCache::updateTracksInIndex(QSet<TrackId> trackIds) {
     emit(tracksChanged(trackIds));
 }
 
-void BaseTrackCache::getTrackValueForColumn(TrackPointer pTrack,
+void BaseTrackCache::getTrackValueForColumn(const TrackSnapshot& track,
                                             int column,
                                             QVariant& trackValue) const {
-    if (!pTrack || column < 0) {
+    if (column < 0) {
         return;
     }
 
     // TODO(XXX) Qt properties could really help here.
     // TODO(rryan) this is all TrackDAO specific. What about iTunes/RB/etc.?
     if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_ARTIST) == column) {
-        trackValue.setValue(pTrack->getArtist());
+        trackValue.setValue(track.metadata.getArtist());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TITLE) == column) {
-        trackValue.setValue(pTrack->getTitle());
+        trackValue.setValue(track.metadata.getTitle());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_ALBUM) == column) {
-        trackValue.setValue(pTrack->getAlbum());
+        trackValue.setValue(track.metadata.getAlbum());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_ALBUMARTIST) == column) {
-        trackValue.setValue(pTrack->getAlbumArtist());
+        trackValue.setValue(track.metadata.getAlbumArtist());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) == column) {
-        trackValue.setValue(pTrack->getYear());
+        trackValue.setValue(track.metadata.getYear());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DATETIMEADDED) == column) {
-        trackValue.setValue(pTrack->getDateAdded());
+        trackValue.setValue(track.dateAdded);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_GENRE) == column) {
-        trackValue.setValue(pTrack->getGenre());
+        trackValue.setValue(track.metadata.getGenre());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COMPOSER) == column) {
-        trackValue.setValue(pTrack->getComposer());
+        trackValue.setValue(track.metadata.getComposer());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_GROUPING) == column) {
-        trackValue.setValue(pTrack->getGrouping());
+        trackValue.setValue(track.metadata.getGrouping());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_FILETYPE) == column) {
-        trackValue.setValue(pTrack->getType());
+        trackValue.setValue(track.type);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) == column) {
-        trackValue.setValue(pTrack->getTrackNumber());
+        trackValue.setValue(track.metadata.getTrackNumber());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION) == column) {
-        trackValue.setValue(QDir::toNativeSeparators(pTrack->getLocation()));
+        trackValue.setValue(QDir::toNativeSeparators(track.location));
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COMMENT) == column) {
-        trackValue.setValue(pTrack->getComment());
+        trackValue.setValue(track.metadata.getComment());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DURATION) == column) {
-        trackValue.setValue(pTrack->getDuration());
+        trackValue.setValue(track.metadata.getDuration());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE) == column) {
-        trackValue.setValue(pTrack->getBitrate());
+        trackValue.setValue(track.metadata.getBitrate());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM) == column) {
-        trackValue.setValue(pTrack->getBpm());
+        trackValue.setValue(track.bpm);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN) == column) {
-        trackValue.setValue(pTrack->getReplayGain().getRatio());
+        trackValue.setValue(track.metadata.getReplayGain().getRatio());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_PLAYED) == column) {
-        trackValue.setValue(pTrack->getPlayCounter().isPlayed());
+        trackValue.setValue(track.playCounter.isPlayed());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED) == column) {
-        trackValue.setValue(pTrack->getPlayCounter().getTimesPlayed());
+        trackValue.setValue(track.playCounter.getTimesPlayed());
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_RATING) == column) {
-        trackValue.setValue(pTrack->getRating());
+        trackValue.setValue(track.rating);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY) == column) {
-        trackValue.setValue(pTrack->getKeyText());
+        trackValue.setValue(track.keyText);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID) == column) {
-        trackValue.setValue(static_cast<int>(pTrack->getKey()));
+        trackValue.setValue(static_cast<int>(track.key));
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM_LOCK) == column) {
-        trackValue.setValue(pTrack->isBpmLocked());
+        trackValue.setValue(track.bpmLocked);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_LOCATION) == column) {
-        trackValue.setValue(pTrack->getCoverInfo().coverLocation);
+        trackValue.setValue(track.coverInfo.coverLocation);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_HASH) == column ||
                fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART) == column) {
         // For sorting, we give COLUMN_LIBRARYTABLE_COVERART the same value as
         // the cover hash.
-        trackValue.setValue(pTrack->getCoverHash());
+        trackValue.setValue(track.coverInfo.hash);
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_SOURCE) == column) {
-        trackValue.setValue(static_cast<int>(pTrack->getCoverInfo().source));
+        trackValue.setValue(static_cast<int>(track.coverInfo.source));
     } else if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_COVERART_TYPE) == column) {
-        trackValue.setValue(static_cast<int>(pTrack->getCoverInfo().type));
+        trackValue.setValue(static_cast<int>(track.coverInfo.type));
     }
 }
 
@@ -357,7 +358,7 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
 
     TrackPointer pTrack = lookupCachedTrack(trackId);
     if (pTrack) {
-        getTrackValueForColumn(pTrack, column, result);
+        getTrackValueForColumn(*pTrack->getSnapshot(), column, result);
     }
 
     // If the track lookup failed (could happen for track properties we don't
@@ -390,9 +391,7 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         return;
     }
 
-    if (!m_bIndexBuilt) {
-        buildIndex();
-    }
+    ensureIndexBuilt();
 
     QStringList idStrings;
     // TODO(rryan) consider making this the data passed in and a separate
@@ -548,9 +547,10 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
     if (sortColumns.isEmpty()) {
         return 0;
     }
+    const TrackSnapshotPointer pSnapshot = pTrack->getSnapshot();
     for (const auto& sc: sortColumns) {
         QVariant trackValue;
-        getTrackValueForColumn(pTrack, sc.m_column - columnOffset, trackValue);
+        getTrackValueForColumn(*pSnapshot, sc.m_column - columnOffset, trackValue);
         trackValues.append(trackValue);
     }
 
@@ -53,6 +53,12 @@ class BaseTrackCache : public QObject {
     // Rebuild the BaseTrackCache index from the SQL table. This can be
     // expensive on large tables.
     virtual void buildIndex();
+    // Builds the index on first use
+    void ensureIndexBuilt() {
+        if (!m_bIndexBuilt) {
+            buildIndex();
+        }
+    }
 
     ////////////////////////////////////////////////////////////////////////////
     // Data access methods
@@ -93,7 +99,7 @@ class BaseTrackCache : public QObject {
     bool updateIndexWithTrackpointer(TrackPointer pTrack);
     void updateTrackInIndex(TrackId trackId);
     void updateTracksInIndex(QSet<TrackId> trackIds);
-    void getTrackValueForColumn(TrackPointer pTrack, int column,
+    void getTrackValueForColumn(const TrackSnapshot& track, int column,
                                 QVariant& trackValue) const;
 
     std::unique_ptr<QueryNode> parseQuery(QString query, QString extraFilter,
@@ -6,6 +6,7 @@
 
 #include "library/coverartcache.h"
 #include "library/coverartutils.h"
+#include "util/assert.h"
 #include "util/logger.h"
 
 
@@ -13,9 +14,10 @@ namespace {
 
 mixxx::Logger kLogger("CoverArtCache");
 
-QString pixmapCacheKey(quint16 hash, int width) {
+// Keyed like the thumbnail store, the hash alone is not unique
+QString pixmapCacheKey(const CoverInfo& info, int width) {
     return QString("CoverArtCache_%1_%2")
-            .arg(QString::number(hash)).arg(width);
+            .arg(CoverThumbnailStore::coverKey(info)).arg(width);
 }
 
 // The transformation mode when scaling images
@@ -26,11 +28,21 @@ inline QImage resizeImageWidth(const QImage& image, int width) {
     return image.scaledToWidth(width, kTransformationMode);
 }
 
+// Loading covers is I/O bound and decoding full size covers needs a lot
+// of memory. Don't flood the global thread pool when scrolling through
+// the library.
+const int kMaxConcurrentLoads = 2;
+
+// Thumbnails of covers that are no longer used are deleted at startup
+// when the store exceeds this size
+const qint64 kMaxThumbnailStoreSize = 256 * 1024 * 1024;
+
 } // anonymous namespace
 
 const bool sDebug = false;
 
-CoverArtCache::CoverArtCache() {
+CoverArtCache::CoverArtCache()
+        : m_activeLoads(0) {
     // The initial QPixmapCache limit is 10MB.
     // But it is not used just by the coverArt stuff,
     // it is also used by Qt to handle other things behind the scenes.
@@ -76,7 +88,7 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
     // column). It's very important to keep the cropped covers in cache because
     // it avoids having to rescale+crop it ALWAYS (which brings a lot of
     // performance issues).
-    QString cacheKey = pixmapCacheKey(requestInfo.hash, desiredWidth);
+    QString cacheKey = pixmapCacheKey(requestInfo, desiredWidth);
 
     QPixmap pixmap;
     if (QPixmapCache::find(cacheKey, &pixmap)) {
@@ -86,6 +98,25 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
         return pixmap;
     }
 
+    // Reading a stored thumbnail from a memory-mapped file is cheap enough
+    // to be done in the GUI thread, even if only cached covers have been
+    // requested.
+    const int thumbnailSize = CoverThumbnailStore::thumbnailSize(desiredWidth);
+    if (desiredWidth > 0 && thumbnailSize > 0) {
+        QImage image = m_thumbnailStore.load(requestInfo, thumbnailSize);
+        if (!image.isNull()) {
+            if (thumbnailSize != desiredWidth) {
+                image = resizeImageWidth(image, desiredWidth);
+            }
+            pixmap = QPixmap::fromImage(image);
+            QPixmapCache::insert(cacheKey, pixmap);
+            if (signalWhenDone) {
+                emit(coverFound(pRequestor, requestInfo, pixmap, true));
+            }
+            return pixmap;
+        }
+    }
+
     if (onlyCached) {
         if (sDebug) {
             kLogger.debug() << "requestCover cache miss";
@@ -94,15 +125,48 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
     }
 
     m_runningRequests.insert(requestId);
-    QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
-    QFuture<FutureResult> future = QtConcurrent::run(
-            this, &CoverArtCache::loadCover, requestInfo, pRequestor,
-            desiredWidth, signalWhenDone);
-    connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
-    watcher->setFuture(future);
+    Request request;
+    request.info = requestInfo;
+    request.pRequestor = pRequestor;
+    request.desiredWidth = desiredWidth;
+    request.signalWhenDone = signalWhenDone;
+    m_pendingRequests.append(request);
+    startPendingRequests();
     return QPixmap();
 }
 
+void CoverArtCache::startPendingRequests() {
+    while (m_activeLoads < kMaxConcurrentLoads && !m_pendingRequests.isEmpty()) {
+        const Request request = m_pendingRequests.takeLast();
+        ++m_activeLoads;
+        QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
+        QFuture<FutureResult> future = QtConcurrent::run(
+                this, &CoverArtCache::loadCover, request.info, request.pRequestor,
+                request.desiredWidth, request.signalWhenDone);
+        connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
+        watcher->setFuture(future);
+    }
+}
+
+void CoverArtCache::cancelPendingRequests(const QObject* pRequestor) {
+    QMutableListIterator<Request> it(m_pendingRequests);
+    while (it.hasNext()) {
+        const Request& request = it.next();
+        if (request.pRequestor == pRequestor) {
+            m_runningRequests.remove(qMakePair(pRequestor, request.info.hash));
+            it.remove();
+        }
+    }
+}
+
+void CoverArtCache::setThumbnailDirectory(const QString& directoryPath) {
+    DEBUG_ASSERT(m_activeLoads == 0);
+    m_thumbnailStore = CoverThumbnailStore(directoryPath);
+    // Listing the store takes a while for large libraries
+    QtConcurrent::run(m_thumbnailStore, &CoverThumbnailStore::prune,
+            kMaxThumbnailStoreSize);
+}
+
 //static
 void CoverArtCache::requestCover(const Track& track,
                          const QObject* pRequestor) {
@@ -123,16 +187,29 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
                  << info << desiredWidth << signalWhenDone;
     }
 
-    QImage image = CoverArtUtils::loadCover(info);
+    // Another request might have stored the thumbnail in the meantime
+    const int thumbnailSize = CoverThumbnailStore::thumbnailSize(desiredWidth);
+    QImage image;
+    if (desiredWidth > 0 && thumbnailSize > 0) {
+        image = m_thumbnailStore.load(info, thumbnailSize);
+    }
 
-    // TODO(XXX) Should we re-hash here? If the cover file (or track metadata)
-    // has changed then info.hash may be incorrect. The fix
-    // will also require noticing a hash mis-match at higher levels and
-    // recording the hash change in the database.
+    if (image.isNull()) {
+        image = CoverArtUtils::loadCover(info);
+
+        // TODO(XXX) Should we re-hash here? If the cover file (or track metadata)
+        // has changed then info.hash may be incorrect. The fix
+        // will also require noticing a hash mis-match at higher levels and
+        // recording the hash change in the database.
+
+        if (!image.isNull() && desiredWidth > 0 && thumbnailSize > 0) {
+            image = m_thumbnailStore.store(info, thumbnailSize, image);
+        }
+    }
 
     // Adjust the cover size according to the request or downsize the image for
     // efficiency.
-    if (!image.isNull() && desiredWidth > 0) {
+    if (!image.isNull() && desiredWidth > 0 && image.width() != desiredWidth) {
         image = resizeImageWidth(image, desiredWidth);
     }
 
@@ -165,14 +242,17 @@ void CoverArtCache::coverLoaded() {
     // Create pixmap, GUI thread only
     QPixmap pixmap = QPixmap::fromImage(res.cover.image);
     if (!pixmap.isNull() && res.cover.resizedToWidth != 0) {
-        // we have to be sure that res.cover.hash is unique
+        // we have to be sure that the key is unique
         // because insert replaces the images with the same key
         QString cacheKey = pixmapCacheKey(
-                res.cover.hash, res.cover.resizedToWidth);
+                res.cover, res.cover.resizedToWidth);
         QPixmapCache::insert(cacheKey, pixmap);
     }
 
     m_runningRequests.remove(qMakePair(res.pRequestor, res.cover.hash));
+    --m_activeLoads;
+    watcher->deleteLater();
+    startPendingRequests();
 
     if (res.signalWhenDone) {
         emit(coverFound(res.pRequestor, res.cover, pixmap, false));
@@ -1,10 +1,12 @@
 #ifndef COVERARTCACHE_H
 #define COVERARTCACHE_H
 
+#include <QList>
 #include <QObject>
 #include <QPixmap>
 
 #include "library/coverart.h"
+#include "library/coverthumbnailstore.h"
 #include "util/singleton.h"
 #include "track/track.h"
 
@@ -32,6 +34,16 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     static void requestCover(const Track& track,
                              const QObject* pRequestor);
 
+    // Drops all requests of pRequestor that are still waiting for a
+    // worker, e.g. for rows that have been scrolled out of view. No
+    // coverFound signal will be emitted for them.
+    void cancelPendingRequests(const QObject* pRequestor);
+
+    // Enables the persistent store of pre-scaled thumbnails that are
+    // used for all requests with a desired width and prunes it in the
+    // background. Must be called before the first request.
+    void setThumbnailDirectory(const QString& directoryPath);
+
     // Guesses the cover art for the provided tracks by searching the tracks'
     // metadata and folders for image files. All I/O is done in a separate
     // thread.
@@ -74,7 +86,23 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     void guessCover(TrackPointer pTrack);
 
   private:
+    struct Request {
+        CoverInfo info;
+        const QObject* pRequestor;
+        int desiredWidth;
+        bool signalWhenDone;
+    };
+
+    // Starts pending requests until all workers are busy
+    void startPendingRequests();
+
+    CoverThumbnailStore m_thumbnailStore;
+
     QSet<QPair<const QObject*, quint16> > m_runningRequests;
+    // Requests that are waiting for a worker. The most recent request
+    // is started first, because it is most likely still visible.
+    QList<Request> m_pendingRequests;
+    int m_activeLoads;
 };
 
 #endif // COVERARTCACHE_H
@@ -58,6 +58,24 @@ CoverArtDelegate::~CoverArtDelegate() {
 void CoverArtDelegate::slotOnlyCachedCoverArt(bool b) {
     m_bOnlyCachedCover = b;
 
+    if (m_bOnlyCachedCover) {
+        // The user started scrolling. Most of the queued covers will be
+        // out of view once loaded, so drop them. The rows are requested
+        // again as cache misses when scrolling stops, but only repainted
+        // if still visible.
+        CoverArtCache* pCache = CoverArtCache::instance();
+        if (pCache) {
+            pCache->cancelPendingRequests(this);
+        }
+        for (QHash<quint16, QLinkedList<int> >::const_iterator it =
+                m_hashToRow.constBegin(); it != m_hashToRow.constEnd(); ++it) {
+            foreach (int row, it.value()) {
+                m_cacheMissRows.append(row);
+            }
+        }
+        m_hashToRow.clear();
+    }
+
     // If we can request non-cache covers now, request updates for all rows that
     // were cache misses since the last time.
     if (!m_bOnlyCachedCover) {
@@ -144,14 +144,12 @@ CoverInfo CoverArtUtils::selectCoverArtForTrack(
 }
 
 //static
-CoverInfoRelative CoverArtUtils::selectCoverArtForTrack(
+const QFileInfo* CoverArtUtils::selectCoverFile(
         const QString& trackBaseName,
         const QString& albumName,
         const QLinkedList<QFileInfo>& covers) {
-    CoverInfoRelative coverInfoRelative;
-    coverInfoRelative.source = CoverInfo::GUESSED;
     if (covers.isEmpty()) {
-        return coverInfoRelative;
+        return NULL;
     }
 
     PreferredCoverType bestType = NONE;
@@ -206,6 +204,18 @@ CoverInfoRelative CoverArtUtils::selectCoverArtForTrack(
         }
     }
 
+    return bestInfo;
+}
+
+//static
+CoverInfoRelative CoverArtUtils::selectCoverArtForTrack(
+        const QString& trackBaseName,
+        const QString& albumName,
+        const QLinkedList<QFileInfo>& covers) {
+    CoverInfoRelative coverInfoRelative;
+    coverInfoRelative.source = CoverInfo::GUESSED;
+
+    const QFileInfo* bestInfo = selectCoverFile(trackBaseName, albumName, covers);
     if (bestInfo != NULL) {
         QImage image(bestInfo->filePath());
         if (!image.isNull()) {
@@ -220,3 +230,44 @@ CoverInfoRelative CoverArtUtils::selectCoverArtForTrack(
 
     return coverInfoRelative;
 }
+
+CoverArtFolder::CoverArtFolder(const QString& folder)
+        : m_folder(folder),
+          m_possibleCovers(CoverArtUtils::findPossibleCoversInFolder(folder)) {
+}
+
+CoverInfoRelative CoverArtFolder::selectCoverArtForTrack(
+        const QString& trackBaseName,
+        const QString& albumName,
+        QImage* pLoadedImage) {
+    const QFileInfo* bestInfo = CoverArtUtils::selectCoverFile(
+            trackBaseName, albumName, m_possibleCovers);
+    if (bestInfo == NULL) {
+        CoverInfoRelative coverInfoRelative;
+        coverInfoRelative.source = CoverInfo::GUESSED;
+        return coverInfoRelative;
+    }
+
+    const QString filePath = bestInfo->filePath();
+    QHash<QString, CoverInfoRelative>::const_iterator it =
+            m_loadedCovers.constFind(filePath);
+    if (it != m_loadedCovers.constEnd()) {
+        return it.value();
+    }
+
+    CoverInfoRelative coverInfoRelative;
+    coverInfoRelative.source = CoverInfo::GUESSED;
+    QImage image(filePath);
+    if (!image.isNull()) {
+        coverInfoRelative.type = CoverInfo::FILE;
+        // TODO() here we may introduce a duplicate hash code
+        coverInfoRelative.hash = CoverArtUtils::calculateHash(image);
+        coverInfoRelative.coverLocation = bestInfo->fileName();
+        if (pLoadedImage) {
+            *pLoadedImage = image;
+        }
+    }
+    // Also remember images that failed to load
+    m_loadedCovers.insert(filePath, coverInfoRelative);
+    return coverInfoRelative;
+}
@@ -6,8 +6,10 @@
 #include <QStringList>
 #include <QSize>
 #include <QFileInfo>
+#include <QHash>
 #include <QLinkedList>
 
+#include "library/coverart.h"
 #include "track/track.h"
 #include "util/sandbox.h"
 
@@ -64,9 +66,44 @@ class CoverArtUtils {
             const QString& albumName,
             const QLinkedList<QFileInfo>& covers);
 
+    // Selects the preferred cover file from the provided list of image
+    // files without loading it. Returns NULL if none is suitable.
+    static const QFileInfo* selectCoverFile(
+            const QString& trackBaseName,
+            const QString& albumName,
+            const QLinkedList<QFileInfo>& covers);
 
   private:
     CoverArtUtils() {}
 };
 
+// The image files in a folder that may contain the cover art of the
+// tracks in this folder. The folder is only listed once and each image
+// file is only loaded and hashed once, no matter how many tracks select
+// it. Useful when guessing the cover art for all tracks of a folder in
+// a row, e.g. while scanning the library.
+class CoverArtFolder {
+  public:
+    CoverArtFolder() {}
+    explicit CoverArtFolder(const QString& folder);
+
+    const QString& folder() const {
+        return m_folder;
+    }
+
+    // Like CoverArtUtils::selectCoverArtForTrack(). If pLoadedImage is
+    // provided it receives the selected image if and only if it has been
+    // loaded by this invocation.
+    CoverInfoRelative selectCoverArtForTrack(
+            const QString& trackBaseName,
+            const QString& albumName,
+            QImage* pLoadedImage = nullptr);
+
+  private:
+    QString m_folder;
+    QLinkedList<QFileInfo> m_possibleCovers;
+    // Keyed by file path
+    QHash<QString, CoverInfoRelative> m_loadedCovers;
+};
+
 #endif /* COVERARTUTILS_H */
@@ -0,0 +1,283 @@
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QTemporaryFile>
+#include <QVector>
+
+#include <algorithm>
+
+#include "library/coverthumbnailstore.h"
+
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CoverThumbnailStore");
+
+// "MXTH"
+const quint32 kThumbnailMagic = 0x4D585448;
+// Increment when changing the file format or how thumbnails are scaled
+const quint32 kThumbnailVersion = 1;
+
+// magic, version, encoding, width, height, bytesPerLine, dataSize
+const int kHeaderSize = 7 * sizeof(quint32);
+
+enum class Encoding {
+    Raw = 0,
+    Jpeg = 1,
+};
+
+// Ascending. Thumbnails up to kMaxRawSize are stored uncompressed.
+const int kThumbnailSizes[] = { 32, 64, 256 };
+const int kMaxRawSize = 64;
+
+const int kJpegQuality = 90;
+
+// prune() deletes thumbnails until the store is 3/4 of its maximum size,
+// so that it does not need to prune again right after the next few
+// thumbnails have been stored.
+const int kPruneTargetPercent = 75;
+
+const QImage::Format kRawFormat = QImage::Format_ARGB32_Premultiplied;
+
+// The transformation mode when scaling images
+const Qt::TransformationMode kTransformationMode = Qt::SmoothTransformation;
+
+QByteArray encodeThumbnail(const QImage& image, int size) {
+    QByteArray data;
+    Encoding encoding;
+    int bytesPerLine = 0;
+    if (size <= kMaxRawSize) {
+        encoding = Encoding::Raw;
+        const QImage raw = image.convertToFormat(kRawFormat);
+        bytesPerLine = raw.bytesPerLine();
+        data = QByteArray(reinterpret_cast<const char*>(raw.constBits()),
+                raw.byteCount());
+    } else {
+        encoding = Encoding::Jpeg;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (!image.save(&buffer, "JPG", kJpegQuality)) {
+            return QByteArray();
+        }
+    }
+
+    QByteArray thumbnail;
+    thumbnail.reserve(kHeaderSize + data.size());
+    QDataStream out(&thumbnail, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_8);
+    out << kThumbnailMagic << kThumbnailVersion
+        << static_cast<qint32>(encoding)
+        << static_cast<qint32>(image.width())
+        << static_cast<qint32>(image.height())
+        << static_cast<qint32>(bytesPerLine)
+        << static_cast<qint32>(data.size());
+    DEBUG_ASSERT(thumbnail.size() == kHeaderSize);
+    thumbnail.append(data);
+    return thumbnail;
+}
+
+QImage decodeThumbnail(const uchar* pThumbnail, qint64 thumbnailSize) {
+    if (thumbnailSize < kHeaderSize) {
+        return QImage();
+    }
+    QDataStream in(QByteArray::fromRawData(
+            reinterpret_cast<const char*>(pThumbnail), kHeaderSize));
+    in.setVersion(QDataStream::Qt_4_8);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 encoding = 0;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 bytesPerLine = 0;
+    qint32 dataSize = 0;
+    in >> magic >> version >> encoding >> width >> height
+       >> bytesPerLine >> dataSize;
+    if ((in.status() != QDataStream::Ok) ||
+            (magic != kThumbnailMagic) ||
+            (version != kThumbnailVersion) ||
+            (width <= 0) || (height <= 0) ||
+            (thumbnailSize != kHeaderSize + dataSize)) {
+        return QImage();
+    }
+    const uchar* pData = pThumbnail + kHeaderSize;
+    switch (static_cast<Encoding>(encoding)) {
+    case Encoding::Raw:
+        if ((bytesPerLine < width * 4) ||
+                (static_cast<qint64>(bytesPerLine) * height != dataSize)) {
+            return QImage();
+        }
+        // Detach from the mapped file, which is closed afterwards
+        return QImage(pData, width, height, bytesPerLine, kRawFormat).copy();
+    case Encoding::Jpeg:
+        return QImage::fromData(pData, dataSize, "JPG");
+    }
+    return QImage();
+}
+
+// The 16-bit cover hash alone is not unique within a large library.
+// The location of the cover disambiguates colliding hashes.
+QString locationDigest(const CoverInfo& info) {
+    QString coverLocation;
+    if (info.type == CoverInfo::FILE && !info.trackLocation.isEmpty()) {
+        // See CoverArtUtils::loadCover()
+        coverLocation = QFileInfo(QFileInfo(info.trackLocation).dir(),
+                info.coverLocation).filePath();
+    } else {
+        coverLocation = info.trackLocation + "|" + info.coverLocation;
+    }
+    const QByteArray location = QString("%1|%2").arg(
+            QString::number(info.type), coverLocation).toUtf8();
+    return QString::fromLatin1(
+            QCryptographicHash::hash(location, QCryptographicHash::Sha1)
+                    .toHex().left(16));
+}
+
+} // anonymous namespace
+
+CoverThumbnailStore::CoverThumbnailStore() {
+}
+
+CoverThumbnailStore::CoverThumbnailStore(const QString& directoryPath)
+        : m_directoryPath(directoryPath) {
+    if (!QDir().mkpath(m_directoryPath)) {
+        kLogger.warning() << "Failed to create directory" << m_directoryPath;
+        m_directoryPath.clear();
+    }
+}
+
+// static
+QString CoverThumbnailStore::directoryPath(const UserSettingsPointer& pConfig) {
+    return QDir(pConfig->getSettingsPath()).filePath("covercache");
+}
+
+// static
+int CoverThumbnailStore::thumbnailSize(int desiredWidth) {
+    for (int size: kThumbnailSizes) {
+        if (desiredWidth <= size) {
+            return size;
+        }
+    }
+    return 0;
+}
+
+// static
+QString CoverThumbnailStore::coverKey(const CoverInfo& info) {
+    return QString("%1_%2").arg(
+            QString::number(info.hash, 16), locationDigest(info));
+}
+
+QString CoverThumbnailStore::filePath(const CoverInfo& info, int size) const {
+    return QDir(m_directoryPath).filePath(QString("%1_%2_%3.thumb").arg(
+            QString::number(info.hash, 16), QString::number(size),
+            locationDigest(info)));
+}
+
+QImage CoverThumbnailStore::load(const CoverInfo& info, int size) const {
+    if (!isEnabled() || (info.type == CoverInfo::NONE)) {
+        return QImage();
+    }
+    QFile file(filePath(info, size));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+    const qint64 fileSize = file.size();
+    uchar* pThumbnail = file.map(0, fileSize);
+    if (pThumbnail == nullptr) {
+        return QImage();
+    }
+    const QImage image = decodeThumbnail(pThumbnail, fileSize);
+    file.unmap(pThumbnail);
+    return image;
+}
+
+QImage CoverThumbnailStore::store(const CoverInfo& info, int size,
+        const QImage& image) const {
+    if (image.isNull()) {
+        return QImage();
+    }
+    const QImage thumbnail = (image.width() == size) ?
+            image : image.scaledToWidth(size, kTransformationMode);
+    if (!isEnabled()) {
+        return thumbnail;
+    }
+
+    const QByteArray data = encodeThumbnail(thumbnail, size);
+    if (data.isEmpty()) {
+        return thumbnail;
+    }
+    QTemporaryFile tempFile(QDir(m_directoryPath).filePath("XXXXXX.tmp"));
+    if (!tempFile.open() || (tempFile.write(data) != data.size())) {
+        kLogger.warning() << "Failed to write thumbnail" << tempFile.fileName();
+        return thumbnail;
+    }
+    tempFile.close();
+    const QString thumbnailPath = filePath(info, size);
+    // QFile::rename() does not replace existing files
+    QFile::remove(thumbnailPath);
+    if (tempFile.rename(thumbnailPath)) {
+        tempFile.setAutoRemove(false);
+    }
+    return thumbnail;
+}
+
+void CoverThumbnailStore::storeSmallThumbnails(const CoverInfo& info,
+        const QImage& image) const {
+    if (!isEnabled() || image.isNull()) {
+        return;
+    }
+    // Scale down step by step, starting with the largest raw size
+    QImage thumbnail = image;
+    for (int i = sizeof(kThumbnailSizes) / sizeof(kThumbnailSizes[0]) - 1; i >= 0; --i) {
+        const int size = kThumbnailSizes[i];
+        if (size <= kMaxRawSize) {
+            thumbnail = store(info, size, thumbnail);
+        }
+    }
+}
+
+void CoverThumbnailStore::prune(qint64 maxSize) const {
+    if (!isEnabled()) {
+        return;
+    }
+    const QFileInfoList files = QDir(m_directoryPath).entryInfoList(
+            QStringList() << "*.thumb", QDir::Files);
+    qint64 totalSize = 0;
+    // Not all file systems update the access time, in that case the
+    // time the thumbnail has been stored is used
+    QVector<QPair<QDateTime, QFileInfo>> filesByLastUse;
+    filesByLastUse.reserve(files.size());
+    for (const QFileInfo& file : files) {
+        totalSize += file.size();
+        filesByLastUse.append(qMakePair(
+                qMax(file.lastRead(), file.lastModified()), file));
+    }
+    if (totalSize <= maxSize) {
+        return;
+    }
+    std::sort(filesByLastUse.begin(), filesByLastUse.end(),
+            [](const QPair<QDateTime, QFileInfo>& lhs,
+                    const QPair<QDateTime, QFileInfo>& rhs) {
+                return lhs.first < rhs.first;
+            });
+
+    const qint64 targetSize = maxSize / 100 * kPruneTargetPercent;
+    int removedFiles = 0;
+    for (const auto& file : filesByLastUse) {
+        if (totalSize <= targetSize) {
+            break;
+        }
+        // A thumbnail that is deleted while being read is stored again
+        if (QFile::remove(file.second.filePath())) {
+            totalSize -= file.second.size();
+            ++removedFiles;
+        }
+    }
+    kLogger.debug() << "Removed" << removedFiles << "thumbnails,"
+                    << totalSize << "bytes are left";
+}
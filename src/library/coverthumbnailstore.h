@@ -0,0 +1,70 @@
+#ifndef COVERTHUMBNAILSTORE_H
+#define COVERTHUMBNAILSTORE_H
+
+#include <QDir>
+#include <QImage>
+#include <QString>
+
+#include "library/coverart.h"
+#include "preferences/usersettings.h"
+
+// Persistent store of pre-scaled cover art thumbnails.
+//
+// Thumbnails are only created in a few fixed sizes. A request for any
+// other width is served from the next larger thumbnail, so that resizing
+// the cover art column does not invalidate the store. Each thumbnail is
+// stored in a file that is named after the cover hash, the size and a
+// digest of the cover location. Cover files that are shared by all tracks
+// of a folder are stored only once. Small thumbnails are stored as raw pixels
+// that are read from a memory-mapped file without decoding. The largest
+// size is JPEG compressed to keep the files small.
+//
+// A store may be used concurrently from multiple threads. Files are
+// written to a temporary file first and renamed afterwards, so readers
+// never see a partially written thumbnail. The store does not know which
+// covers are still in the library, so prune() limits its size instead.
+class CoverThumbnailStore {
+  public:
+    // Creates a disabled store that neither finds nor stores anything.
+    CoverThumbnailStore();
+    explicit CoverThumbnailStore(const QString& directoryPath);
+
+    // The default location within the settings directory
+    static QString directoryPath(const UserSettingsPointer& pConfig);
+
+    bool isEnabled() const {
+        return !m_directoryPath.isEmpty();
+    }
+
+    // Returns the size of the thumbnail that is used to draw a cover
+    // with the given width, or 0 if the width exceeds the largest size.
+    static int thumbnailSize(int desiredWidth);
+
+    // Returns a null image if no thumbnail has been stored yet.
+    QImage load(const CoverInfo& info, int size) const;
+
+    // Scales the cover image to the width of the given thumbnail size and
+    // stores it. Returns the scaled image even if it could not be stored.
+    QImage store(const CoverInfo& info, int size, const QImage& image) const;
+
+    // Stores the small thumbnails that are drawn in the library table.
+    // Used to create them while the cover image is at hand anyway, e.g.
+    // when parsing the file tags of a new track.
+    void storeSmallThumbnails(const CoverInfo& info, const QImage& image) const;
+
+    // Deletes the least recently used thumbnails until the store is
+    // well below maxSize bytes. Nothing is deleted below maxSize.
+    void prune(qint64 maxSize) const;
+
+    // Identifies a cover by its hash and a digest of its location, since
+    // the 16-bit hash alone is not unique within a large library. Used for
+    // the file names and by caches that are keyed on covers.
+    static QString coverKey(const CoverInfo& info);
+
+    QString filePath(const CoverInfo& info, int size) const;
+
+  private:
+    QString m_directoryPath;
+};
+
+#endif // COVERTHUMBNAILSTORE_H
@@ -186,14 +186,13 @@ namespace {
 void updateTreeItemForTrackSelection(
         TreeItem* pTreeItem,
         TrackId selectedTrackId,
-        const std::vector<CrateId>& sortedTrackCrates) {
+        const CrateStorage& crateStorage) {
     DEBUG_ASSERT(pTreeItem != nullptr);
     bool crateContainsSelectedTrack =
             selectedTrackId.isValid() &&
-            std::binary_search(
-                    sortedTrackCrates.begin(),
-                    sortedTrackCrates.end(),
-                    CrateId(pTreeItem->getData()));
+            crateStorage.isCrateTrack(
+                    CrateId(pTreeItem->getData()),
+                    selectedTrackId);
     pTreeItem->setBold(crateContainsSelectedTrack);
 }
 
@@ -465,10 +464,11 @@ QModelIndex CrateFeature::rebuildChildModel(CrateId selectedCrateId) {
     modelRows.reserve(m_pTrackCollection->crates().countCrates());
 
     int selectedRow = -1;
-    CrateSummarySelectResult crateSummaries(
-            m_pTrackCollection->crates().selectCrateSummaries());
-    CrateSummary crateSummary;
-    while (crateSummaries.populateNext(&crateSummary)) {
+    CrateSelectResult crates(m_pTrackCollection->crates().selectCrates());
+    Crate crate;
+    while (crates.populateNext(&crate)) {
+        const CrateSummary crateSummary(
+                m_pTrackCollection->summarizeCrate(crate));
         auto pTreeItem = newTreeItemForCrateSummary(crateSummary);
         modelRows.append(pTreeItem.get());
         pTreeItem.release();
@@ -498,11 +498,12 @@ void CrateFeature::updateChildModel(const QSet<CrateId>& updatedCrateIds) {
         VERIFY_OR_DEBUG_ASSERT(index.isValid()) {
             continue;
         }
-        CrateSummary crateSummary;
-        VERIFY_OR_DEBUG_ASSERT(crateStorage.readCrateSummaryById(crateId, &crateSummary)) {
+        Crate crate;
+        VERIFY_OR_DEBUG_ASSERT(crateStorage.readCrateById(crateId, &crate)) {
             continue;
         }
-        updateTreeItemForCrateSummary(m_childModel.getItem(index), crateSummary);
+        updateTreeItemForCrateSummary(m_childModel.getItem(index),
+                m_pTrackCollection->summarizeCrate(crate));
         m_childModel.triggerRepaint(index);
     }
     if (m_pSelectedTrack) {
@@ -785,20 +786,15 @@ void CrateFeature::slotTrackSelected(TrackPointer pTrack) {
     }
 
     TrackId selectedTrackId;
-    std::vector<CrateId> sortedTrackCrates;
     if (pTrack) {
         selectedTrackId = pTrack->getId();
-        CrateTrackSelectResult trackCratesIter(
-                m_pTrackCollection->crates().selectTrackCratesSorted(selectedTrackId));
-        while (trackCratesIter.next()) {
-            sortedTrackCrates.push_back(trackCratesIter.crateId());
-        }
     }
 
     // Set all crates the track is in bold (or if there is no track selected,
     // clear all the bolding).
     for (TreeItem* pTreeItem: pRootItem->children()) {
-        updateTreeItemForTrackSelection(pTreeItem, selectedTrackId, sortedTrackCrates);
+        updateTreeItemForTrackSelection(
+                pTreeItem, selectedTrackId, m_pTrackCollection->crates());
     }
 
     m_childModel.triggerRepaint();
@@ -57,6 +57,18 @@ const QString kCrateSummaryViewQuery = QString(
                     CRATETABLE_ID);
 
 
+const QString kCrateSummaryByIdQuery = QString(
+            "%1 %2 WHERE %3.%4=:id GROUP BY %3.%4").arg(
+                    kCrateSummaryViewSelect,
+                    kLibraryTracksJoin,
+                    CRATE_TABLE,
+                    CRATETABLE_ID);
+
+inline IdBitmap::value_type crateTrackIndexValue(TrackId trackId) {
+    DEBUG_ASSERT(trackId.isValid());
+    return static_cast<IdBitmap::value_type>(trackId.toInt());
+}
+
 class CrateQueryBinder {
   public:
     explicit CrateQueryBinder(FwdSqlQuery& query)
@@ -213,6 +225,7 @@ void CrateStorage::repairDatabase(QSqlDatabase database) {
 void CrateStorage::connectDatabase(QSqlDatabase database) {
     m_database = database;
     createViews();
+    loadCrateTrackIndex();
 }
 
 
@@ -220,6 +233,7 @@ void CrateStorage::disconnectDatabase() {
     // Ensure that we don't use the current database connection
     // any longer.
     m_database = QSqlDatabase();
+    m_crateTrackIndex.clear();
 }
 
 
@@ -231,6 +245,31 @@ void CrateStorage::createViews() {
 }
 
 
+void CrateStorage::loadCrateTrackIndex() {
+    m_crateTrackIndex.clear();
+    FwdSqlQuery query(m_database, QString(
+            "SELECT %1,%2 FROM %3").arg(
+                    CRATETRACKSTABLE_CRATEID,
+                    CRATETRACKSTABLE_TRACKID,
+                    CRATE_TRACKS_TABLE));
+    VERIFY_OR_DEBUG_ASSERT(query.execPrepared()) {
+        kLogger.critical()
+                << "Failed to load crate tracks!";
+        return;
+    }
+    CrateTrackSelectResult crateTracks(std::move(query));
+    int count = 0;
+    while (crateTracks.next()) {
+        m_crateTrackIndex[crateTracks.crateId()].insert(
+                crateTrackIndexValue(crateTracks.trackId()));
+        ++count;
+    }
+    kLogger.debug()
+            << "Loaded" << count << "tracks of"
+            << m_crateTrackIndex.size() << "crates";
+}
+
+
 uint CrateStorage::countCrates() const {
     FwdSqlQuery query(m_database, QString(
             "SELECT COUNT(*) FROM %1").arg(
@@ -376,10 +415,9 @@ CrateSummarySelectResult CrateStorage::selectCrateSummaries() const {
 }
 
 bool CrateStorage::readCrateSummaryById(CrateId id, CrateSummary* pCrateSummary) const {
-    FwdSqlQuery query(m_database, QString(
-            "SELECT * FROM %1 WHERE %2=:id").arg(
-                    CRATE_SUMMARY_VIEW,
-                    CRATETABLE_ID));
+    // Aggregate only the tracks of this crate instead of
+    // selecting from the view that groups all crates.
+    FwdSqlQuery query(m_database, kCrateSummaryByIdQuery);
     query.bindValue(":id", id);
     if (query.execPrepared()) {
         CrateSummarySelectResult crateSummaries(std::move(query));
@@ -399,18 +437,43 @@ bool CrateStorage::readCrateSummaryById(CrateId id, CrateSummary* pCrateSummary)
 
 
 uint CrateStorage::countCrateTracks(CrateId crateId) const {
-    FwdSqlQuery query(m_database, QString(
-            "SELECT COUNT(*) FROM %1 WHERE %2=:crateId").arg(
-                    CRATE_TRACKS_TABLE,
-                    CRATETRACKSTABLE_CRATEID));
-    query.bindValue(":crateId", crateId);
-    if (query.execPrepared() && query.next()) {
-        uint result = query.fieldValue(0).toUInt();
-        DEBUG_ASSERT(!query.next());
-        return result;
-    } else {
+    const auto i = m_crateTrackIndex.constFind(crateId);
+    if (i == m_crateTrackIndex.constEnd()) {
         return 0;
     }
+    return i.value().size();
+}
+
+
+bool CrateStorage::isCrateTrack(
+        CrateId crateId,
+        TrackId trackId) const {
+    const auto i = m_crateTrackIndex.constFind(crateId);
+    if (i == m_crateTrackIndex.constEnd()) {
+        return false;
+    }
+    return i.value().contains(crateTrackIndexValue(trackId));
+}
+
+
+IdBitmap CrateStorage::collectTrackIdsByCrateNameLike(
+        const QString& crateNameLike) const {
+    FwdSqlQuery query(m_database, QString(
+            "SELECT %1 FROM %2 WHERE %3 LIKE :crateNameLike").arg(
+                    CRATETABLE_ID,
+                    CRATE_TABLE,
+                    CRATETABLE_NAME));
+    query.bindValue(":crateNameLike", kSqlLikeMatchAll + crateNameLike + kSqlLikeMatchAll);
+    IdBitmap trackIds;
+    if (query.execPrepared()) {
+        while (query.next()) {
+            const auto i = m_crateTrackIndex.constFind(CrateId(query.fieldValue(0)));
+            if (i != m_crateTrackIndex.constEnd()) {
+                trackIds.unite(i.value());
+            }
+        }
+    }
+    return trackIds;
 }
 
 
@@ -490,18 +553,13 @@ CrateTrackSelectResult CrateStorage::selectTracksSortedByCrateNameLike(const QSt
 
 
 QSet<CrateId> CrateStorage::collectCrateIdsOfTracks(const QList<TrackId>& trackIds) const {
-    // NOTE(uklotzde): One query per track id. This could be optimized
-    // by querying for chunks of track ids and collecting the results.
     QSet<CrateId> trackCrates;
-    for (const auto& trackId: trackIds) {
-        // NOTE(uklotzde): The query result does not need to be sorted by crate id
-        // here. But since the coresponding FK column is indexed the impact on the
-        // performance should be negligible. By reusing an existing query we reduce
-        // the amount of code and the number of prepared SQL queries.
-        CrateTrackSelectResult crateTracks(selectTrackCratesSorted(trackId));
-        while (crateTracks.next()) {
-            DEBUG_ASSERT(crateTracks.trackId() == trackId);
-            trackCrates.insert(crateTracks.crateId());
+    for (auto i = m_crateTrackIndex.constBegin(); i != m_crateTrackIndex.constEnd(); ++i) {
+        for (const auto& trackId: trackIds) {
+            if (i.value().contains(crateTrackIndexValue(trackId))) {
+                trackCrates.insert(i.key());
+                break;
+            }
         }
     }
     return trackCrates;
@@ -717,3 +775,50 @@ bool CrateStorage::onPurgingTracks(
     }
     return true;
 }
+
+
+void CrateStorage::afterDeletingCrate(
+        CrateId crateId) {
+    m_crateTrackIndex.remove(crateId);
+}
+
+
+void CrateStorage::afterAddingCrateTracks(
+        CrateId crateId,
+        const QList<TrackId>& trackIds) {
+    IdBitmap& crateTracks = m_crateTrackIndex[crateId];
+    for (const auto& trackId: trackIds) {
+        crateTracks.insert(crateTrackIndexValue(trackId));
+    }
+}
+
+
+void CrateStorage::afterRemovingCrateTracks(
+        CrateId crateId,
+        const QList<TrackId>& trackIds) {
+    const auto i = m_crateTrackIndex.find(crateId);
+    if (i == m_crateTrackIndex.end()) {
+        return;
+    }
+    for (const auto& trackId: trackIds) {
+        i.value().remove(crateTrackIndexValue(trackId));
+    }
+    if (i.value().isEmpty()) {
+        m_crateTrackIndex.erase(i);
+    }
+}
+
+
+void CrateStorage::afterPurgingTracks(
+        const QList<TrackId>& trackIds) {
+    for (auto i = m_crateTrackIndex.begin(); i != m_crateTrackIndex.end();) {
+        for (const auto& trackId: trackIds) {
+            i.value().remove(crateTrackIndexValue(trackId));
+        }
+        if (i.value().isEmpty()) {
+            i = m_crateTrackIndex.erase(i);
+        } else {
+            ++i;
+        }
+    }
+}
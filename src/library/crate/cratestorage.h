@@ -3,6 +3,7 @@
 
 
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QSet>
 
@@ -12,6 +13,7 @@
 #include "util/db/fwdsqlqueryselectresult.h"
 #include "util/db/sqlsubselectmode.h"
 #include "util/db/sqlstorage.h"
+#include "util/idbitmap.h"
 
 
 class CrateQueryFields {
@@ -226,6 +228,20 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
     bool onPurgingTracks(
             const QList<TrackId>& trackIds);
 
+    void afterDeletingCrate(
+            CrateId crateId);
+
+    void afterAddingCrateTracks(
+            CrateId crateId,
+            const QList<TrackId>& trackIds);
+
+    void afterRemovingCrateTracks(
+            CrateId crateId,
+            const QList<TrackId>& trackIds);
+
+    void afterPurgingTracks(
+            const QList<TrackId>& trackIds);
+
 
     /////////////////////////////////////////////////////////////////////////
     // Crate read operations (read-only, const)
@@ -260,7 +276,41 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
     CrateSelectResult selectAutoDjCrates(bool autoDjSource = true) const;
 
     // Crate content, i.e. the crate's tracks referenced by id
-    uint countCrateTracks(CrateId crateId) const;
+    uint countCrateTracks(CrateId crateId) const; // no db access
+
+    bool isCrateTrack(
+            CrateId crateId,
+            TrackId trackId) const; // no db access
+
+    // Sets the track count and duration of the summary from the tracks
+    // of its crate in the index. The duration of each track is provided
+    // by the caller, e.g. from the library cache, and is negative for
+    // tracks that are hidden and excluded from the summary.
+    template<typename TrackDuration>
+    void summarizeCrateTracks(
+            CrateSummary* pCrateSummary,
+            TrackDuration trackDuration) const { // no db access
+        uint trackCount = 0;
+        double totalDuration = 0.0;
+        const auto i = m_crateTrackIndex.constFind(pCrateSummary->getId());
+        if (i != m_crateTrackIndex.constEnd()) {
+            i.value().forEach([&](IdBitmap::value_type id) {
+                const double duration = trackDuration(
+                        TrackId(static_cast<TrackId::value_type>(id)));
+                if (duration >= 0) {
+                    ++trackCount;
+                    totalDuration += duration;
+                }
+            });
+        }
+        pCrateSummary->setTrackCount(trackCount);
+        pCrateSummary->setTrackDuration(totalDuration);
+    }
+
+    // The ids of all tracks that are contained in any crate with
+    // a name that matches the pattern.
+    IdBitmap collectTrackIdsByCrateNameLike(
+            const QString& crateNameLike) const;
 
     // Format a subselect query for the tracks contained in crate.
     static QString formatSubselectQueryForCrateTrackIds(
@@ -282,14 +332,15 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
     // Returns the set of crate ids for crates that contain any of the
     // provided track ids.
     QSet<CrateId> collectCrateIdsOfTracks(
-            const QList<TrackId>& trackIds) const;
+            const QList<TrackId>& trackIds) const; // no db access
 
 
     /////////////////////////////////////////////////////////////////////////
     // CrateSummary view operations (read-only, const)
     /////////////////////////////////////////////////////////////////////////
 
-    // Track summaries of all crates:
+    // Track summaries of all crates, aggregated in the database. Use
+    // TrackCollection::summarizeCrate() that reads the index instead.
     //  - Hidden tracks are excluded from the crate summary statistics
     //  - The result list is ordered by crate name:
     //     - case-insensitive
@@ -301,8 +352,15 @@ class CrateStorage: public virtual /*implements*/ SqlStorage {
 
   private:
     void createViews();
+    void loadCrateTrackIndex();
 
     QSqlDatabase m_database;
+
+    // The track ids of each crate, mirroring the table crate_tracks.
+    // Answers membership queries without accessing the database and
+    // is updated after the corresponding transaction has been
+    // committed.
+    QHash<CrateId, IdBitmap> m_crateTrackIndex;
 };
 
 
@@ -1,6 +1,8 @@
 #include <QtDebug>
 #include <QtSql>
 
+#include <algorithm>
+
 #include "library/dao/autodjcratesdao.h"
 
 #include "mixer/playerinfo.h"
@@ -12,30 +14,34 @@
 #include "library/queryutil.h"
 #include "library/trackcollection.h"
 
-#define AUTODJCRATESTABLE_TRACKID "track_id"
-#define AUTODJCRATESTABLE_CRATEREFS "craterefs"
-#define AUTODJCRATESTABLE_TIMESPLAYED "timesplayed"
-#define AUTODJCRATESTABLE_AUTODJREFS "autodjrefs"
-#define AUTODJCRATESTABLE_LASTPLAYED "lastplayed"
-
-#define AUTODJCRATES_TABLE "temp_autodj_crates"
-// A table of all tracks that are assigned to the AutoDJ via a crate
-// Columns:
-// INTEGER AUTODJCRATESTABLE_TRACKID -> Tracks that are member of crate assigned to AutoDj
-// INTEGER AUTODJCRATESTABLE_CRATEREFS -> counts the occurrences of track in auto dj crates
-// INTEGER AUTODJCRATESTABLE_TIMESPLAYED -> library played counter
-// INTEGER AUTODJCRATESTABLE_AUTODJREFS -> counts the occurrences of the track in the AutoDj queue
-// DATETIME AUTODJCRATESTABLE_LASTPLAYED -> from the history feature
-
-#define AUTODJACTIVETRACKS_TABLE "temp_autodj_activetracks"
-// The same table like above, but of all tracks that not already queued into Auto DJ
-// ordered by TimesPlayed.
-
 namespace {
 // Percentage of most and least played tracks to ignore [0,50)
 const int kLeastPreferredPercent = 15;
 const int kLeastPreferredPercentMin = 0;
 const int kLeastPreferredPercentMax = 50;
+
+// The format of PlaylistTracks.pl_datetime_added, i.e. of
+// CURRENT_TIMESTAMP in SQLite. The time is in UTC.
+const QString kPlaylistDateTimeFormat = "yyyy-MM-dd hh:mm:ss";
+
+QDateTime lastPlayedFromPlaylistDateTime(const QVariant& value) {
+    QDateTime dateTime = QDateTime::fromString(
+            value.toString(), kPlaylistDateTimeFormat);
+    dateTime.setTimeSpec(Qt::UTC);
+    return dateTime;
+}
+
+// A random number in the range [0, count). qrand() might only
+// provide 15 random bits, e.g. on Windows, which is not enough
+// for large crates.
+int randomIndex(int count) {
+    DEBUG_ASSERT(count > 0);
+    const quint64 random =
+            (static_cast<quint64>(qrand()) << 32) ^
+            (static_cast<quint64>(qrand()) << 16) ^
+            static_cast<quint64>(qrand());
+    return static_cast<int>(random % count);
+}
 } // anonymous namespace
 
 AutoDJCratesDAO::AutoDJCratesDAO(
@@ -46,8 +52,8 @@ AutoDJCratesDAO::AutoDJCratesDAO(
           m_pTrackCollection(pTrackCollection),
           m_database(pTrackCollection->database()),
           m_pConfig(pConfig),
-          // The database has not been created yet.
-          m_bAutoDjCratesDbCreated(false),
+          // The tracks have not been loaded yet.
+          m_bAutoDjCrateTracksLoaded(false),
           // By default, active tracks are not tracks that haven't been played in
           // a while.
           m_bUseIgnoreTime(false) {
@@ -56,130 +62,30 @@ AutoDJCratesDAO::AutoDJCratesDAO(
 AutoDJCratesDAO::~AutoDJCratesDAO() {
 }
 
-// Create the temporary auto-DJ-crates table.
+// Load the tracks of all auto-DJ crates.
 // Done the first time it's used, since the user might not even make
 // use of this feature.
-void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
+void AutoDJCratesDAO::loadAndConnectAutoDjCrateTracks() {
     // If the use of tracks that haven't been played in a while has changed,
-    // then the active-tracks view must be recreated.
-    bool bUseIgnoreTime = m_pConfig->getValue(
+    // then the active tracks must be ranked differently.
+    m_bUseIgnoreTime = m_pConfig->getValue(
             ConfigKey("[Auto DJ]", "UseIgnoreTime"), false);
-    if (m_bAutoDjCratesDbCreated) {
-        if (m_bUseIgnoreTime != bUseIgnoreTime) {
-            // Do all this in a single transaction.
-            ScopedTransaction oTransaction(m_database);
-
-            // Get rid of the old active-tracks view.
-            QSqlQuery oQuery(m_database);
-            oQuery.exec ("DROP VIEW IF EXISTS " AUTODJACTIVETRACKS_TABLE);
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return;
-            }
-
-            // Create the new active-tracks view.
-            if (!createActiveTracksView(bUseIgnoreTime)) {
-                return;
-            }
-
-            // Remember the new setting.
-            m_bUseIgnoreTime = bUseIgnoreTime;
-
-            // Commit these changes.
-            oTransaction.commit();
-        }
-    } else {
-        m_bUseIgnoreTime = bUseIgnoreTime;
-    }
+    m_autoDjCrateTracks.setRankByLastPlayed(m_bUseIgnoreTime);
 
-    // If this database has already been created, skip this.
-    if (m_bAutoDjCratesDbCreated) {
-        return;
-    }
-
-    // Do all of this in a single transaction.
-    ScopedTransaction oTransaction(m_database);
-
-    // The auto-DJ-crates table contains the track ID, the number of references
-    // to that track ID in all of the auto-DJ crates, the number of times that
-    // track has been played, and the number of references to the track in the
-    // auto-DJ playlist (or in loaded decks).  It filters out tracks that have
-    // been deleted from the database (i.e. "hidden" tracks).
-
-    // Create an empty table.
-    QSqlQuery oQuery(m_database);
-    // CREATE TEMP TABLE temp_autodj_crates (track_id INTEGER UNIQUE, craterefs INTEGER, timesplayed INTEGER, autodjrefs INTEGER, lastplayed DATETIME);
-    //oQuery.exec ("DROP TABLE IF EXISTS " AUTODJCRATES_TABLE);
-    QString strQuery("CREATE TEMP TABLE " AUTODJCRATES_TABLE
-        " (" AUTODJCRATESTABLE_TRACKID " INTEGER UNIQUE, "
-        AUTODJCRATESTABLE_CRATEREFS " INTEGER, "
-        AUTODJCRATESTABLE_TIMESPLAYED " INTEGER, "
-        AUTODJCRATESTABLE_AUTODJREFS " INTEGER, "
-        AUTODJCRATESTABLE_LASTPLAYED " DATETIME)");
-    oQuery.prepare(strQuery);
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Fill out the first three columns.
-    // Supply default values for the last two.
-    // INSERT INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
-    // SELECT crate_tracks.track_id, COUNT (*), library.timesplayed, 0, ""
-    // FROM crate_tracks, library
-    // WHERE crate_tracks.crate_id IN (
-    //     SELECT id
-    //     FROM crates
-    //     WHERE autodj = 1)
-    // AND crate_tracks.track_id = library.id
-    // AND library.mixxx_deleted = 0
-    // GROUP BY crate_tracks.track_id, library.timesplayed;
-    strQuery = QString("INSERT INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
-            AUTODJCRATESTABLE_LASTPLAYED ") SELECT " CRATE_TRACKS_TABLE
-            ".%1 , COUNT (*), " LIBRARY_TABLE ".%2, 0, \"\" FROM "
-            CRATE_TRACKS_TABLE ", " LIBRARY_TABLE " WHERE " CRATE_TRACKS_TABLE
-            ".%4 IN (SELECT %5 FROM " CRATE_TABLE " WHERE %6 = 1) AND "
-            CRATE_TRACKS_TABLE ".%1 = " LIBRARY_TABLE ".%7 AND " LIBRARY_TABLE
-            ".%3 == 0 GROUP BY " CRATE_TRACKS_TABLE ".%1, " LIBRARY_TABLE ".%2")
-                .arg(CRATETRACKSTABLE_TRACKID, // %1
-                     LIBRARYTABLE_TIMESPLAYED, // %2
-                     LIBRARYTABLE_MIXXXDELETED, // %3
-                     CRATETRACKSTABLE_CRATEID, // %4
-                     CRATETABLE_ID, // %5
-                     CRATETABLE_AUTODJ_SOURCE, // %6
-                     LIBRARYTABLE_ID); // %7
-    oQuery.prepare(strQuery);
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Fill out the number of auto-DJ-playlist references.
-    if (!updateAutoDjPlaylistReferences()) {
-        return;
-    }
-
-    // Fill out the last-played date/time.
-    if (!updateLastPlayedDateTime()) {
-        return;
-    }
-
-    // Create the active-tracks view.
-    //oQuery.exec ("DROP VIEW IF EXISTS " AUTODJACTIVETRACKS_TABLE);
-    if (!createActiveTracksView (m_bUseIgnoreTime)) {
+    // If the tracks have already been loaded, skip this.
+    if (m_bAutoDjCrateTracksLoaded) {
         return;
     }
 
     // Make a list of the IDs of every set-log playlist.
     // SELECT id FROM Playlists WHERE hidden = 2;
+    QSqlQuery oQuery(m_database);
     oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TABLE " WHERE %2 = %3")
             .arg(PLAYLISTTABLE_ID, // %1
                  PLAYLISTTABLE_HIDDEN, // %2
                  QString::number(PlaylistDAO::PLHT_SET_LOG))); // %3
     if (oQuery.exec()) {
+        m_lstSetLogPlaylistIds.clear();
         while (oQuery.next())
             m_lstSetLogPlaylistIds.append(oQuery.value(0).toInt());
     } else {
@@ -187,10 +93,11 @@ void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
         return;
     }
 
-    // Now the auto-DJ crates database is initialized.
-    // Externally-driven updates to the database from now on are driven by
-    // signals.
-    oTransaction.commit();
+    if (!loadAutoDjCrateTracks()) {
+        return;
+    }
+
+    // Externally-driven updates from now on are driven by signals.
 
     // Be notified when a track is modified.
     // We only care when the number of times it's been played changes.
@@ -230,306 +137,228 @@ void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
             SIGNAL(trackUnloaded(QString,TrackPointer)),
             this, SLOT(slotPlayerInfoTrackUnloaded(QString,TrackPointer)));
 
-    // Remember that the auto-DJ-crates database has been created.
-    m_bAutoDjCratesDbCreated = true;
+    // Remember that the auto-DJ-crate tracks have been loaded.
+    m_bAutoDjCrateTracksLoaded = true;
 }
 
-// Create the active-tracks view.
-bool AutoDJCratesDAO::createActiveTracksView (bool a_bUseIgnoreTime) {
-    // Create the active-tracks view.  This is a list of all tracks loaded into
-    // the auto-DJ-crates database, excluding all tracks already in the auto-DJ
-    // playlist, sorted by the number of times the track has been played, and
-    // limited by either the active percentage or by the number of tracks that
-    // have never been played, whichever is larger.
-    //
-    // At one point, I hoped that I could create this table in a single SQL
-    // statement, with a "limit" clause that dynamically updated the size of the
-    // view as the state of the system changed.  Unfortunately, that limit
-    // clause is only evaluated once.  For posterity, though, here's the monster
-    // SQL query that attempted to create that version:
-    //
-    // CREATE TEMP VIEW temp_autodj_activetracks AS
-    //     SELECT * FROM temp_autodj_crates
-    //     WHERE autodjrefs = 0
-    //     ORDER BY timesplayed, lastplayed LIMIT (
-    //         SELECT MAX(count)
-    //         FROM (
-    //             SELECT COUNT(*) AS count
-    //             FROM temp_autodj_crates WHERE timesplayed = 0
-    //             UNION ALL SELECT (
-    //                 count * (
-    //                     SELECT value
-    //                     FROM settings WHERE
-    //                     name="mixxx.db.model.autodjcrates.active_percentage")
-    //                 / 100) AS count
-    //                 FROM (
-    //                     SELECT COUNT(*) AS count
-    //                     FROM temp_autodj_crates)));
-
-    // CREATE TEMP VIEW temp_autodj_activetracks AS
-    // SELECT *
-    // FROM temp_autodj_crates
-    // WHERE autodjrefs = 0
-    // ORDER BY timesplayed, lastplayed;
+bool AutoDJCratesDAO::loadAutoDjCrateTracks() {
+    m_autoDjCrateTracks.clear();
+    m_autoDjCrateIds.clear();
+
+    // SELECT id FROM crates WHERE autodj = 1;
     QSqlQuery oQuery(m_database);
-    QString strTimesPlayed;
-    if (!a_bUseIgnoreTime) {
-        strTimesPlayed = AUTODJCRATESTABLE_TIMESPLAYED ", ";
-    }
-    oQuery.prepare(QString("CREATE TEMP VIEW " AUTODJACTIVETRACKS_TABLE
-            " AS SELECT * FROM " AUTODJCRATES_TABLE " WHERE "
-            AUTODJCRATESTABLE_AUTODJREFS " = 0 ORDER BY %1"
-            AUTODJCRATESTABLE_LASTPLAYED)
-            .arg(strTimesPlayed)); // %1
+    oQuery.prepare(QString("SELECT %1 FROM " CRATE_TABLE " WHERE %2 = 1")
+            .arg(CRATETABLE_ID, // %1
+                 CRATETABLE_AUTODJ_SOURCE)); // %2
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return false;
     }
-    return true;
-}
-
-// Update the number of auto-DJ-playlist references to each track in the
-// auto-DJ-crates database.
-bool AutoDJCratesDAO::updateAutoDjPlaylistReferences() {
-    QSqlQuery oQuery(m_database);
+    while (oQuery.next()) {
+        m_autoDjCrateIds.insert(CrateId(oQuery.value(0)));
+    }
 
-    // Rebuild the auto-DJ-playlist reference count.
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT *
-    // FROM (
-    //     SELECT PlaylistTracks.track_id, craterefs, timesplayed, COUNT (*) AS newautodjrefs
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id FROM Playlists WHERE hidden = PLHT_AUTO_DJ)
-    //     AND PlaylistTracks.track_id = temp_autodj_crates.track_id
-    //     GROUP BY PlaylistTracks.track_id)
-    // WHERE newautodjrefs > 0;
-    QString strHidden;
-    strHidden.setNum(PlaylistDAO::PLHT_AUTO_DJ);
-    QString strQuery(QString ("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ")"
-            " SELECT * FROM (SELECT " PLAYLIST_TRACKS_TABLE ".%1, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED
-            ", COUNT (*) AS new" AUTODJCRATESTABLE_AUTODJREFS " FROM "
-            PLAYLIST_TRACKS_TABLE ", " AUTODJCRATES_TABLE " WHERE "
-            PLAYLIST_TRACKS_TABLE ".%2 IN (SELECT %3 FROM " PLAYLIST_TABLE
-            " WHERE %4 = %5) AND " PLAYLIST_TRACKS_TABLE ".%1 = "
-            AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID " GROUP BY "
-            PLAYLIST_TRACKS_TABLE ".%1) WHERE new" AUTODJCRATESTABLE_AUTODJREFS
-            " > 0")
-            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
-                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
-                 PLAYLISTTABLE_ID, // %3
-                 PLAYLISTTABLE_HIDDEN, // %4
-                 strHidden)); // %5
-    oQuery.prepare(strQuery);
+    // Load the track ID, the number of references to that track ID in all
+    // of the auto-DJ crates and the number of times that track has been
+    // played. Tracks that have been deleted from the database (i.e. "hidden"
+    // tracks) are filtered out.
+    // SELECT crate_tracks.track_id, COUNT (*), library.timesplayed
+    // FROM crate_tracks, library
+    // WHERE crate_tracks.crate_id IN (
+    //     SELECT id
+    //     FROM crates
+    //     WHERE autodj = 1)
+    // AND crate_tracks.track_id = library.id
+    // AND library.mixxx_deleted = 0
+    // GROUP BY crate_tracks.track_id, library.timesplayed;
+    oQuery.prepare(QString("SELECT " CRATE_TRACKS_TABLE ".%1, COUNT (*), "
+            LIBRARY_TABLE ".%2 FROM " CRATE_TRACKS_TABLE ", " LIBRARY_TABLE
+            " WHERE " CRATE_TRACKS_TABLE ".%4 IN (SELECT %5 FROM " CRATE_TABLE
+            " WHERE %6 = 1) AND " CRATE_TRACKS_TABLE ".%1 = " LIBRARY_TABLE
+            ".%7 AND " LIBRARY_TABLE ".%3 == 0 GROUP BY " CRATE_TRACKS_TABLE
+            ".%1, " LIBRARY_TABLE ".%2")
+            .arg(CRATETRACKSTABLE_TRACKID, // %1
+                 LIBRARYTABLE_TIMESPLAYED, // %2
+                 LIBRARYTABLE_MIXXXDELETED, // %3
+                 CRATETRACKSTABLE_CRATEID, // %4
+                 CRATETABLE_ID, // %5
+                 CRATETABLE_AUTODJ_SOURCE, // %6
+                 LIBRARYTABLE_ID)); // %7
+    oQuery.setForwardOnly(true);
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return false;
     }
+    const QHash<TrackId, int> autoDjPlaylistRefs = queryAutoDjPlaylistRefs();
+    const QHash<TrackId, QDateTime> lastPlayedDateTimes = queryLastPlayedDateTimes();
+    while (oQuery.next()) {
+        const TrackId trackId(oQuery.value(0));
+        m_autoDjCrateTracks.insertTrack(
+                trackId,
+                oQuery.value(1).toInt(),
+                oQuery.value(2).toInt(),
+                autoDjPlaylistRefs.value(trackId),
+                lastPlayedDateTimes.value(trackId));
+    }
 
     // Incorporate all tracks loaded into decks.
-    // Each track has to be done as a separate database query, in case the same
-    // track is loaded into multiple decks.
     int iDecks = (int) PlayerManager::numDecks();
     for (int i = 0; i < iDecks; ++i) {
         QString group = PlayerManager::groupForDeck(i);
         TrackPointer pTrack = PlayerInfo::instance().getTrackInfo(group);
         if (pTrack) {
-            TrackId trackId(pTrack->getId());
-            // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1 WHERE track_id IN (:track_id);
-            oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-                    AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-                    " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (:track_id)");
-            oQuery.bindValue(":track_id", trackId.toVariant());
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return false;
-            }
+            m_autoDjCrateTracks.addAutoDjRef(pTrack->getId());
         }
     }
+
+    qDebug() << "Loaded" << m_autoDjCrateTracks.size()
+             << "tracks of" << m_autoDjCrateIds.size() << "auto-DJ crates";
     return true;
 }
 
-// Update the number of auto-DJ-playlist references to the given track in the
-// auto-DJ-crates database.
-bool AutoDJCratesDAO::updateAutoDjPlaylistReferencesForTrack(TrackId trackId) {
+// The number of references to each track in the auto-DJ playlist.
+QHash<TrackId, int> AutoDJCratesDAO::queryAutoDjPlaylistRefs() {
+    QHash<TrackId, int> autoDjPlaylistRefs;
+    // SELECT PlaylistTracks.track_id, COUNT (*)
+    // FROM PlaylistTracks
+    // WHERE PlaylistTracks.playlist_id IN (
+    //     SELECT id FROM Playlists WHERE hidden = PLHT_AUTO_DJ)
+    // GROUP BY PlaylistTracks.track_id;
     QSqlQuery oQuery(m_database);
+    oQuery.prepare(QString("SELECT %1, COUNT (*) FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 IN (SELECT %3 FROM " PLAYLIST_TABLE " WHERE %4 = %5)"
+            " GROUP BY %1")
+            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
+                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
+                 PLAYLISTTABLE_ID, // %3
+                 PLAYLISTTABLE_HIDDEN, // %4
+                 QString::number(PlaylistDAO::PLHT_AUTO_DJ))); // %5
+    oQuery.setForwardOnly(true);
+    if (!oQuery.exec()) {
+        LOG_FAILED_QUERY(oQuery);
+        return autoDjPlaylistRefs;
+    }
+    while (oQuery.next()) {
+        autoDjPlaylistRefs.insert(
+                TrackId(oQuery.value(0)), oQuery.value(1).toInt());
+    }
+    return autoDjPlaylistRefs;
+}
 
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT *
-    // FROM (
-    //     SELECT :track_id AS new_track_id, craterefs, timesplayed, COUNT (*) AS newautodjrefs
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id
-    //         FROM Playlists
-    //         WHERE hidden = 1)
-    //     AND PlaylistTracks.track_id = :track_id
-    //     AND temp_autodj_crates.track_id = :track_id
-    //     GROUP BY new_track_id)
-    // WHERE newautodjrefs > 0;
-    QString strHidden;
-    strHidden.setNum(PlaylistDAO::PLHT_AUTO_DJ);
-    oQuery.prepare(QString("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE " ("
-            AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-            ") SELECT * FROM (SELECT :track_id_1 AS new_track_id, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED
-            ", COUNT (*) AS new" AUTODJCRATESTABLE_AUTODJREFS " FROM "
-            PLAYLIST_TRACKS_TABLE ", " AUTODJCRATES_TABLE " WHERE "
-            PLAYLIST_TRACKS_TABLE ".%1 IN (SELECT %4 FROM " PLAYLIST_TABLE
-            " WHERE %2 = %5) AND " PLAYLIST_TRACKS_TABLE ".%3 = :track_id_2 AND "
-            AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID
-            " = :track_id_3 GROUP BY new_track_id) WHERE new"
-            AUTODJCRATESTABLE_AUTODJREFS " > 0")
-            .arg(PLAYLISTTRACKSTABLE_PLAYLISTID, // %1
-                 PLAYLISTTABLE_HIDDEN, // %2
-                 PLAYLISTTRACKSTABLE_TRACKID, // %3
-                 PLAYLISTTABLE_ID, // %4
-                 strHidden)); // %5
-    oQuery.bindValue(":track_id_1", trackId.toVariant());
-    oQuery.bindValue(":track_id_2", trackId.toVariant());
-    oQuery.bindValue(":track_id_3", trackId.toVariant());
+int AutoDJCratesDAO::queryAutoDjPlaylistRefsForTrack(TrackId trackId) {
+    // SELECT COUNT (*)
+    // FROM PlaylistTracks
+    // WHERE PlaylistTracks.playlist_id IN (
+    //     SELECT id FROM Playlists WHERE hidden = PLHT_AUTO_DJ)
+    // AND PlaylistTracks.track_id = :track_id;
+    QSqlQuery oQuery(m_database);
+    oQuery.prepare(QString("SELECT COUNT (*) FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 IN (SELECT %3 FROM " PLAYLIST_TABLE " WHERE %4 = %5)"
+            " AND %1 = :track_id")
+            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
+                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
+                 PLAYLISTTABLE_ID, // %3
+                 PLAYLISTTABLE_HIDDEN, // %4
+                 QString::number(PlaylistDAO::PLHT_AUTO_DJ))); // %5
+    oQuery.bindValue(":track_id", trackId.toVariant());
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
-        return false;
+        return 0;
     }
+    if (oQuery.next()) {
+        return oQuery.value(0).toInt();
+    }
+    return 0;
+}
 
-    // The update was successful.
-    return true;
+// The number of decks the given track is loaded into.
+int AutoDJCratesDAO::countDeckRefs(TrackId trackId) {
+    int deckRefs = 0;
+    int iDecks = (int) PlayerManager::numDecks();
+    for (int i = 0; i < iDecks; ++i) {
+        QString group = PlayerManager::groupForDeck(i);
+        TrackPointer pTrack = PlayerInfo::instance().getTrackInfo(group);
+        if (pTrack && (pTrack->getId() == trackId)) {
+            ++deckRefs;
+        }
+    }
+    return deckRefs;
 }
 
-// Update the last-played date/time for each track in the auto-DJ-crates
-// database.
-bool AutoDJCratesDAO::updateLastPlayedDateTime() {
+// The last-played date/time of each track in the set-log playlists.
+QHash<TrackId, QDateTime> AutoDJCratesDAO::queryLastPlayedDateTimes() {
+    QHash<TrackId, QDateTime> lastPlayedDateTimes;
+    // SELECT PlaylistTracks.track_id, MAX(pl_datetime_added)
+    // FROM PlaylistTracks
+    // WHERE PlaylistTracks.playlist_id IN (
+    //     SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
+    // GROUP BY PlaylistTracks.track_id;
     QSqlQuery oQuery(m_database);
-
-    // Rebuild the auto-DJ-playlist last-played date/time.
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
-    // SELECT *
-    // FROM (
-    //     SELECT PlaylistTracks.track_id, craterefs, timesplayed, autodjrefs, MAX(pl_datetime_added) AS newlastplayed
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
-    //     AND PlaylistTracks.track_id = temp_autodj_crates.track_id
-    //     GROUP BY PlaylistTracks.track_id)
-    // WHERE newlastplayed != "";
-    QString strSetLog;
-    strSetLog.setNum(PlaylistDAO::PLHT_SET_LOG);
-    QString strQuery(QString ("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
-            AUTODJCRATESTABLE_LASTPLAYED ")"
-            " SELECT * FROM (SELECT " PLAYLIST_TRACKS_TABLE ".%1, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED ", "
-            AUTODJCRATESTABLE_AUTODJREFS ", MAX(%3) AS new"
-            AUTODJCRATESTABLE_LASTPLAYED " FROM " PLAYLIST_TRACKS_TABLE ", "
-            AUTODJCRATES_TABLE " WHERE " PLAYLIST_TRACKS_TABLE
-            ".%2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6) AND "
-            PLAYLIST_TRACKS_TABLE ".%1 = " AUTODJCRATES_TABLE "."
-            AUTODJCRATESTABLE_TRACKID " GROUP BY " PLAYLIST_TRACKS_TABLE
-            ".%1) WHERE new" AUTODJCRATESTABLE_LASTPLAYED " != \"\"")
+    oQuery.prepare(QString("SELECT %1, MAX(%3) FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6)"
+            " GROUP BY %1")
             .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
                  PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
                  PLAYLISTTRACKSTABLE_DATETIMEADDED, // %3
                  PLAYLISTTABLE_ID, // %4
                  PLAYLISTTABLE_HIDDEN, // %5
-                 strSetLog)); // %6
-    oQuery.prepare(strQuery);
+                 QString::number(PlaylistDAO::PLHT_SET_LOG))); // %6
+    oQuery.setForwardOnly(true);
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
-        return false;
+        return lastPlayedDateTimes;
     }
-
-    return true;
+    while (oQuery.next()) {
+        lastPlayedDateTimes.insert(TrackId(oQuery.value(0)),
+                lastPlayedFromPlaylistDateTime(oQuery.value(1)));
+    }
+    return lastPlayedDateTimes;
 }
 
-// Update the last-played date/time for the given track in the auto-DJ-crates
-// database.
-bool AutoDJCratesDAO::updateLastPlayedDateTimeForTrack(TrackId trackId) {
+QDateTime AutoDJCratesDAO::queryLastPlayedDateTimeForTrack(TrackId trackId) {
+    // SELECT MAX(pl_datetime_added)
+    // FROM PlaylistTracks
+    // WHERE PlaylistTracks.playlist_id IN (
+    //     SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
+    // AND PlaylistTracks.track_id = :track_id;
     QSqlQuery oQuery(m_database);
-
-    // Update the last-played date/time for this track.
-    // INSERT OR REPLACE INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
-    // SELECT *
-    // FROM (
-    //     SELECT PlaylistTracks.track_id, craterefs, timesplayed, autodjrefs, MAX(pl_datetime_added) AS newlastplayed
-    //     FROM PlaylistTracks, temp_autodj_crates
-    //     WHERE PlaylistTracks.playlist_id IN (
-    //         SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)
-    //     AND PlaylistTracks.track_id = :track_id
-    //     AND PlaylistTracks.track_id = temp_autodj_crates.track_id
-    //     GROUP BY PlaylistTracks.track_id)
-    // WHERE newlastplayed != "";
-    QString strSetLog;
-    strSetLog.setNum(PlaylistDAO::PLHT_SET_LOG);
-    oQuery.prepare(QString ("INSERT OR REPLACE INTO " AUTODJCRATES_TABLE
-            " (" AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
-            AUTODJCRATESTABLE_LASTPLAYED ")"
-            " SELECT * FROM (SELECT " PLAYLIST_TRACKS_TABLE ".%1, "
-            AUTODJCRATESTABLE_CRATEREFS ", " AUTODJCRATESTABLE_TIMESPLAYED ", "
-            AUTODJCRATESTABLE_AUTODJREFS ", MAX(%3) AS new"
-            AUTODJCRATESTABLE_LASTPLAYED " FROM " PLAYLIST_TRACKS_TABLE ", "
-            AUTODJCRATES_TABLE " WHERE " PLAYLIST_TRACKS_TABLE
-            ".%2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6) AND "
-            PLAYLIST_TRACKS_TABLE ".%1 = :track_id AND " PLAYLIST_TRACKS_TABLE
-            ".%1 = " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID
-            " GROUP BY " PLAYLIST_TRACKS_TABLE ".%1) WHERE new"
-            AUTODJCRATESTABLE_LASTPLAYED " != \"\"")
+    oQuery.prepare(QString("SELECT MAX(%3) FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 IN (SELECT %4 FROM " PLAYLIST_TABLE " WHERE %5 = %6)"
+            " AND %1 = :track_id")
             .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
                  PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
                  PLAYLISTTRACKSTABLE_DATETIMEADDED, // %3
                  PLAYLISTTABLE_ID, // %4
                  PLAYLISTTABLE_HIDDEN, // %5
-                 strSetLog)); // %6
+                 QString::number(PlaylistDAO::PLHT_SET_LOG))); // %6
     oQuery.bindValue(":track_id", trackId.toVariant());
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
-        return false;
+        return QDateTime();
     }
+    if (oQuery.next()) {
+        return lastPlayedFromPlaylistDateTime(oQuery.value(0));
+    }
+    return QDateTime();
+}
 
-    // The update was successful.
-    return true;
+// Update the last-played date/time of all auto-DJ-crate tracks.
+bool AutoDJCratesDAO::updateLastPlayedDateTimes() {
+    // The tracks need to be reloaded to reset the last-played
+    // date/time of tracks that are no longer in any set log.
+    return loadAutoDjCrateTracks();
 }
 
 // Get the ID, i.e. one that references library.id, of a random track.
 // Returns an invalid track id if there was an error.
 TrackId AutoDJCratesDAO::getRandomTrackId() {
-    // If necessary, create the temporary auto-DJ-crates database.
-    createAndConnectAutoDjCratesDatabase();
+    // If necessary, load the auto-DJ-crate tracks.
+    loadAndConnectAutoDjCrateTracks();
 
     // Calculate the number of active-tracks that have never been played, and
     // the total number of active-tracks.
-    QSqlQuery oQuery(m_database);
-    // SELECT COUNT(*) AS count
-    // FROM temp_autodj_activetracks
-    // WHERE timesplayed = 0
-    // UNION ALL SELECT COUNT(*) AS count
-    // FROM temp_autodj_activetracks;
-    oQuery.prepare("SELECT COUNT(*) AS count FROM " AUTODJACTIVETRACKS_TABLE
-        " WHERE " AUTODJCRATESTABLE_TIMESPLAYED
-        " = 0 UNION ALL SELECT COUNT(*) AS count FROM "
-        AUTODJACTIVETRACKS_TABLE);
-    VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return TrackId();
-    }
-    int iUnplayedTracks = 0;
-    int iTotalTracks = 0;
-    if (oQuery.next()) {
-        iUnplayedTracks = oQuery.value(0).toInt();
-        if (oQuery.next()) {
-            iTotalTracks = oQuery.value(0).toInt();
-        }
-    }
+    int iUnplayedTracks = m_autoDjCrateTracks.countActiveUnplayedTracks();
+    int iTotalTracks = m_autoDjCrateTracks.countActiveTracks();
 
     // Get the active percentage (default 20%).
     int minimumAvailablePercentage = m_pConfig->getValue(
@@ -564,24 +393,9 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
         timeCurrent = timeCurrent.addSecs(-(timIgnoreTime.hour() * 3600
             + timIgnoreTime.minute() * 60));
 
-        // Convert the time to sqlite's format, which is similar to ISO date,
-        // but not quite.
-        QString strDateTime = timeCurrent.toString("yyyy-MM-dd hh:mm:ss");
-
         // Count the number of tracks that haven't been played since this time.
-        // SELECT COUNT(*) FROM temp_autodj_activetracks WHERE lastplayed < :lastplayed;
-        int iIgnoreTimeTracks = 0;
-        oQuery.prepare("SELECT COUNT(*) FROM " AUTODJACTIVETRACKS_TABLE
-            " WHERE " AUTODJCRATESTABLE_LASTPLAYED " < :lastplayed");
-        oQuery.bindValue (":lastplayed", strDateTime);
-        if (oQuery.exec()) {
-            if (oQuery.next()) {
-                iIgnoreTimeTracks = oQuery.value(0).toInt();
-            }
-        } else {
-            LOG_FAILED_QUERY(oQuery);
-            return TrackId();
-        }
+        int iIgnoreTimeTracks =
+                m_autoDjCrateTracks.countActiveTracksLastPlayedBefore(timeCurrent);
 
         // Allow that to be a new maximum.
         iActiveTracks = qMax(iActiveTracks, iIgnoreTimeTracks);
@@ -594,25 +408,10 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
         qDebug() << "No random track available for Auto DJ";
         return TrackId();
     }
+    DEBUG_ASSERT(iActiveTracks <= iTotalTracks);
 
-    // Pick a random track.
-    // SELECT track_id
-    // FROM temp_autodj_activetracks LIMIT 1 OFFSET ABS (RANDOM() % :active);
-    oQuery.prepare("SELECT " AUTODJCRATESTABLE_TRACKID " FROM "
-        AUTODJACTIVETRACKS_TABLE " LIMIT 1 OFFSET ABS (RANDOM() % :active)");
-    oQuery.bindValue (":active", iActiveTracks);
-    VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return TrackId();
-    }
-    if (oQuery.next()) {
-        // Give our caller the randomly-selected track.
-        return TrackId(oQuery.value(0));
-    } else {
-        DEBUG_ASSERT(false); // We should have exit earlier
-        qDebug() << "No random track available for Auto DJ";
-        return TrackId();
-    }
+    // Pick a random track among the best-ranked active tracks.
+    return m_autoDjCrateTracks.activeTrackAt(randomIndex(iActiveTracks));
 }
 
 TrackId AutoDJCratesDAO::getRandomTrackIdFromAutoDj(int percentActive) {
@@ -623,98 +422,66 @@ TrackId AutoDJCratesDAO::getRandomTrackIdFromAutoDj(int percentActive) {
         return TrackId();
     }
 
-    // Calculate the number of tracks in the AutoDJ playlist
-    // that are already queued up from the crates
+    // Collect the crate tracks that are queued up in the AutoDJ playlist
+    // in the order of the playlist.
+    // SELECT track_id
+    // FROM PlaylistTracks
+    // WHERE playlist_id = m_iAutoDjPlaylistId
+    // ORDER BY position;
     QSqlQuery oQuery(m_database);
-    // SELECT COUNT(*) AS count
-    // FROM temp_autodj_crates
-    // WHERE autodjrefs > 0;
-    oQuery.prepare("SELECT COUNT(*) AS count FROM " AUTODJCRATES_TABLE
-        " WHERE " AUTODJCRATESTABLE_AUTODJREFS " > 0" );
+    oQuery.prepare(QString("SELECT %1 FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE %2 = :playlist_id ORDER BY %3")
+            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
+                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
+                 PLAYLISTTRACKSTABLE_POSITION)); // %3
+    oQuery.bindValue(":playlist_id", m_iAutoDjPlaylistId);
+    oQuery.setForwardOnly(true);
     VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return TrackId();
     }
-    VERIFY_OR_DEBUG_ASSERT(oQuery.next()) {
-        return TrackId();
+    QList<TrackId> queuedTrackIds;
+    QSet<TrackId> queuedTrackIdSet;
+    while (oQuery.next()) {
+        const TrackId trackId(oQuery.value(0));
+        if (m_autoDjCrateTracks.autoDjRefs(trackId) > 0 &&
+                !queuedTrackIdSet.contains(trackId)) {
+            queuedTrackIdSet.insert(trackId);
+            queuedTrackIds.append(trackId);
+        }
     }
-    int queuedTracks = oQuery.value(0).toInt();
 
     // If there are no tracks, let our caller know.
-    if (queuedTracks == 0) {
+    if (queuedTrackIds.isEmpty()) {
         qDebug() << "No tracks for re-add to Auto DJ";
         return TrackId();
     }
 
+    // Prefer the tracks that are queued up the least times and then
+    // those at the top of the AutoDJ playlist.
+    std::stable_sort(queuedTrackIds.begin(), queuedTrackIds.end(),
+            [this](TrackId lhs, TrackId rhs) {
+                return m_autoDjCrateTracks.autoDjRefs(lhs) <
+                        m_autoDjCrateTracks.autoDjRefs(rhs);
+            });
+
     // Use the top percentage of the AutoDJ to re-add
-    int iActiveTracks = qMax((queuedTracks * percentActive / 100), 1);
-
-    // Pick a random track.
-    // SELECT DISTINCT track_id
-    // FROM temp_autodj_crates INNER JOIN Playlists
-    // ON temp_autodj_crates.track_id = PlaylistsTracks.track_id
-    // AND PlaylistsTracks.playlist_id = m_iAutoDjPlaylistId
-    // ORDER BY temp_autodj_crates.autodjrefs, PlaylistsTracks.position
-    // LIMIT 1 OFFSET ABS (RANDOM() % :active);
-    oQuery.prepare(QString("SELECT DISTINCT " AUTODJCRATES_TABLE "."
-            AUTODJCRATESTABLE_TRACKID " FROM "
-            AUTODJCRATES_TABLE " INNER JOIN " PLAYLIST_TRACKS_TABLE
-            " ON " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID
-            " = " PLAYLIST_TRACKS_TABLE ".%1"
-            " AND " PLAYLIST_TRACKS_TABLE ".%2 = %3"
-            " ORDER BY " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_AUTODJREFS ", "
-            PLAYLIST_TRACKS_TABLE ".%4"
-            " LIMIT 1 OFFSET ABS (RANDOM() % :active)")
-            .arg(PLAYLISTTRACKSTABLE_TRACKID, // %1
-                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %2
-                 QString::number(m_iAutoDjPlaylistId), // %3
-                 PLAYLISTTABLE_POSITION)); // %4
-    oQuery.bindValue (":active", iActiveTracks);
-    VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return TrackId();
-    }
-    if (oQuery.next()) {
-        // Give our caller the randomly-selected track.
-        return TrackId(oQuery.value(0));
-    } else {
-        DEBUG_ASSERT(false); // We should have exit earlier
-        qDebug() << "No random track available for Auto DJ";
-        return TrackId();
-    }
+    int iActiveTracks = qMax((queuedTrackIds.size() * percentActive / 100), 1);
+    return queuedTrackIds.at(randomIndex(iActiveTracks));
 }
 
-
-
 // Signaled by the track DAO when a track's information is updated.
 void AutoDJCratesDAO::slotTrackDirty(TrackId trackId) {
     // Update our record of the number of times played, if that changed.
+    if (!m_autoDjCrateTracks.contains(trackId)) {
+        return;
+    }
     TrackPointer pTrack = m_pTrackCollection->getTrackDAO().getTrack(trackId);
     if (pTrack == NULL) {
         return;
     }
     const PlayCounter playCounter(pTrack->getPlayCounter());
-    if (playCounter.getTimesPlayed() == 0) {
-        return;
-    }
-
-    // Update our record of how many times this track has been played.
-    // UPDATE temp_autodj_crates
-    // SET timesplayed = :newplayed
-    // WHERE track_id = :track_id
-    // AND timesplayed = :oldplayed;
-    QSqlQuery oQuery(m_database);
-    oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_TIMESPLAYED " = :newplayed WHERE "
-            AUTODJCRATESTABLE_TRACKID " = :track_id AND "
-            AUTODJCRATESTABLE_TIMESPLAYED " = :oldplayed");
-    oQuery.bindValue(":track_id", trackId.toVariant());
-    oQuery.bindValue(":oldplayed", playCounter.getTimesPlayed() - 1);
-    oQuery.bindValue(":newplayed", playCounter.getTimesPlayed());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
+    m_autoDjCrateTracks.setTimesPlayed(trackId, playCounter.getTimesPlayed());
 }
 
 void AutoDJCratesDAO::slotCrateInserted(CrateId crateId) {
@@ -722,245 +489,158 @@ void AutoDJCratesDAO::slotCrateInserted(CrateId crateId) {
     Crate crate;
     if (m_pTrackCollection->crates().readCrateById(crateId, &crate)) {
         if (crate.isAutoDjSource()) {
-            updateAutoDjCrate(crateId);
+            addAutoDjCrate(crateId);
         }
     }
 }
 
 void AutoDJCratesDAO::slotCrateUpdated(CrateId crateId) {
+    // Only changes of the auto-DJ source flag are relevant,
+    // e.g. renaming an auto-DJ crate doesn't change anything.
     Crate crate;
     if (m_pTrackCollection->crates().readCrateById(crateId, &crate)) {
         if (crate.isAutoDjSource()) {
-            updateAutoDjCrate(crateId);
+            if (!m_autoDjCrateIds.contains(crateId)) {
+                addAutoDjCrate(crateId);
+            }
         } else {
-            deleteAutoDjCrate(crateId);
+            if (m_autoDjCrateIds.contains(crateId)) {
+                removeAutoDjCrate(crateId);
+            }
         }
     }
 }
 
 void AutoDJCratesDAO::slotCrateDeleted(CrateId crateId) {
-    // The crate doesn't exist any more. It might have been an AutoDJ
-    // crate or not. But that doesn't matter, simply try to delete it.
-    deleteAutoDjCrate(crateId);
+    // The crate doesn't exist any more, i.e. its tracks are unknown.
+    // Reload all tracks if it was an auto-DJ crate.
+    if (m_autoDjCrateIds.contains(crateId)) {
+        loadAutoDjCrateTracks();
+    }
 }
 
-void AutoDJCratesDAO::updateAutoDjCrate(CrateId crateId) {
-    // Handle a crate that's entered the auto-DJ queue differently than one that
-    // is leaving it.  (Obviously.)
-    ScopedTransaction oTransaction(m_database);
+void AutoDJCratesDAO::addAutoDjCrate(CrateId crateId) {
+    m_autoDjCrateIds.insert(crateId);
 
-    // Add a crate-reference to every track in this crate, if that track is
-    // already in the auto-DJ-crates table.
-    QSqlQuery oQuery(m_database);
-    // UPDATE temp_autodj_crates SET craterefs = craterefs + 1
-    // WHERE track_id IN (
-    //     SELECT temp_autodj_crates.track_id
-    //     FROM crate_tracks, temp_autodj_crates
-    //     WHERE crate_tracks.crate_id = :crate_id
-    //     AND crate_tracks.track_id = temp_autodj_crates.track_id);
-    oQuery.prepare(QString ("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (SELECT "
-            AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID " FROM "
-            CRATE_TRACKS_TABLE ", " AUTODJCRATES_TABLE " WHERE "
-            CRATE_TRACKS_TABLE ".%2 = :crate_id AND " CRATE_TRACKS_TABLE
-            ".%1 = " AUTODJCRATES_TABLE "." AUTODJCRATESTABLE_TRACKID ")")
-            .arg(CRATETRACKSTABLE_TRACKID, // %1
-                 CRATETRACKSTABLE_CRATEID)); // %2
-    oQuery.bindValue(":crate_id", crateId.toVariant());
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
-    }
-
-    // Create an entry for all tracks that weren't in the auto-DJ-crates
-    // table already.
-    // The number of crate references is known to be 1 for such tracks.
-    // The number of references to each track in the auto-DJ playlist isn't
-    // set yet; it defaults to zero.
-    // If no records were modified by this query, then there's no reason to
-    // update the number of auto-DJ-playlist references to each track.
-
-    // INSERT INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT crate_tracks.track_id, 1, library.timesplayed, 0
+    // Add a crate-reference to every track in this crate that is
+    // already an auto-DJ-crate track and collect the other tracks.
+    // SELECT crate_tracks.track_id, library.timesplayed
     // FROM crate_tracks, library
     // WHERE crate_tracks.crate_id = :crate_id
-    // AND crate_tracks.track_id NOT IN (
-    //     SELECT track_id FROM temp_autodj_crates)
     // AND crate_tracks.track_id = library.id
     // AND library.mixxx_deleted = 0;
-    oQuery.prepare(QString("INSERT INTO " AUTODJCRATES_TABLE " ("
-            AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-            ") SELECT " CRATE_TRACKS_TABLE ".%1, 1, " LIBRARY_TABLE
-            ".timesplayed, 0 FROM " CRATE_TRACKS_TABLE ", " LIBRARY_TABLE
+    QSqlQuery oQuery(m_database);
+    oQuery.prepare(QString("SELECT " CRATE_TRACKS_TABLE ".%1, " LIBRARY_TABLE
+            ".%5 FROM " CRATE_TRACKS_TABLE ", " LIBRARY_TABLE
             " WHERE " CRATE_TRACKS_TABLE ".%2 = :crate_id AND "
-            CRATE_TRACKS_TABLE ".%1 NOT IN (SELECT " AUTODJCRATESTABLE_TRACKID
-            " FROM " AUTODJCRATES_TABLE" ) AND " CRATE_TRACKS_TABLE ".%1 = "
-            LIBRARY_TABLE ".%3 AND " LIBRARY_TABLE ".%4 = 0")
+            CRATE_TRACKS_TABLE ".%1 = " LIBRARY_TABLE ".%3 AND "
+            LIBRARY_TABLE ".%4 = 0")
             .arg(CRATETRACKSTABLE_TRACKID, // %1
                  CRATETRACKSTABLE_CRATEID, // %2
                  LIBRARYTABLE_ID, // %3
-                 LIBRARYTABLE_MIXXXDELETED)); // %4
+                 LIBRARYTABLE_MIXXXDELETED, // %4
+                 LIBRARYTABLE_TIMESPLAYED)); // %5
     oQuery.bindValue(":crate_id", crateId.toVariant());
+    oQuery.setForwardOnly(true);
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return;
     }
-    if (oQuery.numRowsAffected() == 0) {
-        oTransaction.commit();
-        return;
+    QHash<TrackId, int> newTracks;
+    while (oQuery.next()) {
+        const TrackId trackId(oQuery.value(0));
+        if (!m_autoDjCrateTracks.addCrateRef(trackId)) {
+            newTracks.insert(trackId, oQuery.value(1).toInt());
+        }
     }
-
-    // Update the number of auto-DJ-playlist references to each track.
-    // There's no way to avoid updating the number of references to tracks
-    // that were already in the database, but the auto-DJ-playlist is likely
-    // to be small compared to the number of tracks in auto-DJ crates, so
-    // this isn't so bad.
-    if (!updateAutoDjPlaylistReferences()) {
+    if (newTracks.isEmpty()) {
         return;
     }
 
-    // Update the last-played date/time for each track.
-    // Similarly, there's no way to avoid updating the last-played date/time
-    // of tracks that were already in the database.
-    if (!updateLastPlayedDateTime()) {
-        return;
+    // Create an entry for all tracks that weren't auto-DJ-crate
+    // tracks already. The number of crate references is known to
+    // be 1 for such tracks.
+    const QHash<TrackId, int> autoDjPlaylistRefs = queryAutoDjPlaylistRefs();
+    const QHash<TrackId, QDateTime> lastPlayedDateTimes = queryLastPlayedDateTimes();
+    for (auto i = newTracks.constBegin(); i != newTracks.constEnd(); ++i) {
+        const TrackId trackId = i.key();
+        m_autoDjCrateTracks.insertTrack(
+                trackId,
+                1,
+                i.value(),
+                autoDjPlaylistRefs.value(trackId) + countDeckRefs(trackId),
+                lastPlayedDateTimes.value(trackId));
     }
-
-    // The transaction was successful.
-    oTransaction.commit();
 }
 
-void AutoDJCratesDAO::deleteAutoDjCrate(CrateId crateId) {
-    // Handle a crate that's entered the auto-DJ queue differently than one that
-    // is leaving it.  (Obviously.)
-    ScopedTransaction oTransaction(m_database);
+void AutoDJCratesDAO::removeAutoDjCrate(CrateId crateId) {
+    m_autoDjCrateIds.remove(crateId);
 
     // Remove a crate-reference from every track in this crate.
+    // SELECT track_id
+    // FROM crate_tracks
+    // WHERE crate_tracks.crate_id = :crate_id;
     QSqlQuery oQuery(m_database);
-    // UPDATE temp_autodj_crates SET craterefs = craterefs - 1
-    // WHERE track_id IN (
-    //     SELECT track_id
-    //     FROM crate_tracks
-    //     WHERE crate_tracks.crate_id = :crate_id);
-    oQuery.prepare(QString("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (SELECT %1 FROM "
-            CRATE_TRACKS_TABLE " WHERE " CRATE_TRACKS_TABLE ".%2 = :crate_id)")
+    oQuery.prepare(QString("SELECT %1 FROM " CRATE_TRACKS_TABLE
+            " WHERE %2 = :crate_id")
             .arg(CRATETRACKSTABLE_TRACKID, // %1
                  CRATETRACKSTABLE_CRATEID)); // %2
     oQuery.bindValue(":crate_id", crateId.toVariant());
+    oQuery.setForwardOnly(true);
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return;
     }
-
-    // Remove all tracks that no longer have crate references.
-    //DELETE FROM temp_autodj_crates WHERE craterefs = 0;
-    oQuery.prepare("DELETE FROM " AUTODJCRATES_TABLE " WHERE "
-        AUTODJCRATESTABLE_CRATEREFS " = 0");
-    if (!oQuery.exec()) {
-        LOG_FAILED_QUERY(oQuery);
-        return;
+    while (oQuery.next()) {
+        m_autoDjCrateTracks.removeCrateRef(TrackId(oQuery.value(0)));
     }
-
-    // The transaction was successful.
-    oTransaction.commit();
 }
 
 void AutoDJCratesDAO::slotCrateTracksChanged(
         CrateId crateId, const QList<TrackId>& addedTrackIds,
         const QList<TrackId>& removedTrackIds) {
     // Skip this if it's not an auto-DJ crate.
-    Crate crate;
-    if (!m_pTrackCollection->crates().readCrateById(crateId, &crate)
-            || !crate.isAutoDjSource()) {
+    if (!m_autoDjCrateIds.contains(crateId)) {
         return;
     }
 
-    ScopedTransaction oTransaction(m_database);
     QSqlQuery oQuery(m_database);
+    // SELECT library.timesplayed FROM library WHERE library.id = :track_id AND library.mixxx_deleted = 0;
+    oQuery.prepare(QString("SELECT " LIBRARY_TABLE ".%1 FROM " LIBRARY_TABLE
+            " WHERE " LIBRARY_TABLE ".%2 = :track_id AND " LIBRARY_TABLE
+            ".%3 = 0")
+            .arg(LIBRARYTABLE_TIMESPLAYED, // %1
+                 LIBRARYTABLE_ID, // %2
+                 LIBRARYTABLE_MIXXXDELETED)); // %3
     for (const auto& trackId: addedTrackIds) {
-        // Add a crate-reference to this track, if it's already in the
-        // auto-DJ-crates table (in which case, we're done).
-        // UPDATE temp_autodj_crates SET craterefs = craterefs + 1 WHERE track_id = :track_id;
-        QString strHidden;
-        strHidden.setNum(PlaylistDAO::PLHT_AUTO_DJ);
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
-        if (oQuery.numRowsAffected() == 1) {
+        // Add a crate-reference to this track, if it's already an
+        // auto-DJ-crate track (in which case, we're done).
+        if (m_autoDjCrateTracks.addCrateRef(trackId)) {
             continue;
         }
 
-        // Create an entry for the track.
+        // Create an entry for the track, unless the track's
+        // mixxx_deleted flag is set.
         // The number of crate references is known to be 1 for such tracks.
-        // The number of references to each track in the auto-DJ playlist isn't
-        // set yet; it defaults to zero.
-        // If no records were modified by this query (i.e. because the track's
-        // mixxx_deleted flag is set), then there's no reason to update the number
-        // of auto-DJ-playlist references to each track.
-        // INSERT INTO temp_autodj_crates (track_id, craterefs, timesplayed, autodjrefs) SELECT :track_id, 1, library.timesplayed, 0 FROM library WHERE :track_id = library.id AND library.mixxx_deleted = 0;
-        oQuery.prepare(QString("INSERT INTO " AUTODJCRATES_TABLE " ("
-                AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-                AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-                ") SELECT :track_id_1, 1, " LIBRARY_TABLE ".%1, 0 FROM " LIBRARY_TABLE
-                " WHERE :track_id_2 = " LIBRARY_TABLE ".%2 AND " LIBRARY_TABLE
-                ".%3 = 0")
-                .arg(LIBRARYTABLE_TIMESPLAYED, // %1
-                     LIBRARYTABLE_ID, // %2
-                     LIBRARYTABLE_MIXXXDELETED)); // %3
-        oQuery.bindValue(":track_id_1", trackId.toVariant());
-        oQuery.bindValue(":track_id_2", trackId.toVariant());
+        oQuery.bindValue(":track_id", trackId.toVariant());
         if (!oQuery.exec()) {
             LOG_FAILED_QUERY(oQuery);
             return;
         }
-        if (oQuery.numRowsAffected() == 0) {
+        if (!oQuery.next()) {
             continue;
         }
-
-        // Update the number of auto-DJ-playlist references to this track.
-        if (!updateAutoDjPlaylistReferencesForTrack(trackId)) {
-            return; // failure
-        }
-
-        // Update the last-played date/time for this track.
-        if (!updateLastPlayedDateTimeForTrack(trackId)) {
-            return; // failure
-        }
+        m_autoDjCrateTracks.insertTrack(
+                trackId,
+                1,
+                oQuery.value(0).toInt(),
+                queryAutoDjPlaylistRefsForTrack(trackId) + countDeckRefs(trackId),
+                queryLastPlayedDateTimeForTrack(trackId));
     }
     for (const auto& trackId: removedTrackIds) {
-        // UPDATE temp_autodj_crates SET craterefs = craterefs - 1 WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_CRATEREFS " = " AUTODJCRATESTABLE_CRATEREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
-
         // Remove the track if it no longer has a crate reference.
-        //DELETE FROM temp_autodj_crates WHERE track_id = :track_id AND craterefs = 0;
-        oQuery.prepare("DELETE FROM " AUTODJCRATES_TABLE " WHERE "
-            AUTODJCRATESTABLE_TRACKID " = :track_id AND "
-            AUTODJCRATESTABLE_CRATEREFS " = 0");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        m_autoDjCrateTracks.removeCrateRef(trackId);
     }
-    // The transaction was successful.
-    oTransaction.commit();
 }
 
 // Signaled by the playlistDAO when a playlist is added.
@@ -968,8 +648,9 @@ void AutoDJCratesDAO::slotPlaylistAdded(int playlistId) {
     // We only care about changes to set-log playlists.
     if (m_pTrackCollection->getPlaylistDAO().getHiddenType(playlistId)
             == PlaylistDAO::PLHT_SET_LOG) {
+        // A new playlist is empty, i.e. the last-played
+        // date/time of the tracks is not affected.
         m_lstSetLogPlaylistIds.append(playlistId);
-        updateLastPlayedDateTime();
     }
 }
 
@@ -979,7 +660,7 @@ void AutoDJCratesDAO::slotPlaylistDeleted(int playlistId) {
     int iIndex = m_lstSetLogPlaylistIds.indexOf(playlistId);
     if (iIndex >= 0) {
         m_lstSetLogPlaylistIds.removeAt(iIndex);
-        updateLastPlayedDateTime();
+        updateLastPlayedDateTimes();
     }
 }
 
@@ -988,23 +669,13 @@ void AutoDJCratesDAO::slotPlaylistTrackAdded(int playlistId, TrackId trackId,
                                              int /* a_iPosition */) {
     // Deal with changes to the auto-DJ playlist.
     if (playlistId == m_iAutoDjPlaylistId) {
-        QSqlQuery oQuery(m_database);
-        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1
-        // WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        m_autoDjCrateTracks.addAutoDjRef(trackId);
     } else if (m_lstSetLogPlaylistIds.contains(playlistId)) {
         // Deal with changes to set-log playlists.
-        // If this query doesn't succeed, it'll log a message.
-        // Do nothing special otherwise -- any change it makes can be part of
-        // any current transaction.
-        updateLastPlayedDateTimeForTrack(trackId);
+        if (m_autoDjCrateTracks.contains(trackId)) {
+            m_autoDjCrateTracks.setLastPlayed(
+                    trackId, queryLastPlayedDateTimeForTrack(trackId));
+        }
     }
 }
 
@@ -1014,22 +685,13 @@ void AutoDJCratesDAO::slotPlaylistTrackRemoved(int playlistId,
                                                int /* a_iPosition */) {
     // Deal with changes to the auto-DJ playlist.
     if (playlistId == m_iAutoDjPlaylistId) {
-        QSqlQuery oQuery(m_database);
-        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs - 1 WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        m_autoDjCrateTracks.removeAutoDjRef(trackId);
     } else if (m_lstSetLogPlaylistIds.contains(playlistId)) {
         // Deal with changes to set-log playlists.
-        // If this query doesn't succeed, it'll log a message.
-        // Do nothing special otherwise -- any change it makes can be part of
-        // any current transaction.
-        updateLastPlayedDateTimeForTrack(trackId);
+        if (m_autoDjCrateTracks.contains(trackId)) {
+            m_autoDjCrateTracks.setLastPlayed(
+                    trackId, queryLastPlayedDateTimeForTrack(trackId));
+        }
     }
 }
 
@@ -1048,17 +710,7 @@ void AutoDJCratesDAO::slotPlayerInfoTrackLoaded(QString a_strGroup,
     for (unsigned int i = 0; i < numDecks; ++i) {
         if (a_strGroup == PlayerManager::groupForDeck(i)) {
             // Update the number of auto-DJ-playlist references to this track.
-            QSqlQuery oQuery(m_database);
-            // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1
-            // WHERE track_id = :track_id;
-            oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-                AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-                " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-            oQuery.bindValue(":track_id", trackId.toVariant());
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return;
-            }
+            m_autoDjCrateTracks.addAutoDjRef(trackId);
             return;
         }
     }
@@ -1074,17 +726,7 @@ void AutoDJCratesDAO::slotPlayerInfoTrackUnloaded(QString group,
     for (unsigned int i = 0; i < numDecks; ++i) {
         if (group == PlayerManager::groupForDeck(i)) {
             // Get rid of the ID of the track in this deck.
-            QSqlQuery oQuery(m_database);
-            // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs - 1
-            // WHERE track_id = :track_id;
-            oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-                AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-                " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-            oQuery.bindValue(":track_id", trackId.toVariant());
-            if (!oQuery.exec()) {
-                LOG_FAILED_QUERY(oQuery);
-                return;
-            }
+            m_autoDjCrateTracks.removeAutoDjRef(trackId);
             return;
         }
     }
@@ -1,10 +1,14 @@
 #ifndef AUTODJCRATESDAO_H
 #define AUTODJCRATESDAO_H
 
+#include <QDateTime>
+#include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QSqlDatabase>
 
 #include "preferences/usersettings.h"
+#include "library/autodj/autodjcrateselector.h"
 #include "library/crate/crateid.h"
 #include "track/track.h"
 #include "util/class.h"
@@ -32,29 +36,30 @@ class AutoDJCratesDAO : public QObject {
     // (Isn't that normal for QObject subclasses?)
     DISALLOW_COPY_AND_ASSIGN(AutoDJCratesDAO);
 
-    // Create the temporary auto-DJ-crates database.
+    // Load the tracks of all auto-DJ crates and connect to the signals
+    // that keep them up to date.
     // Done the first time it's used, since the user might not even make
     // use of this feature.
-    void createAndConnectAutoDjCratesDatabase();
+    void loadAndConnectAutoDjCrateTracks();
 
-    // Create the active-tracks view.
-    bool createActiveTracksView(bool a_bUseIgnoreTime);
+    // (Re-)load the tracks of all auto-DJ crates from the database.
+    // Returns true if successful.
+    bool loadAutoDjCrateTracks();
 
-    // Update the number of auto-DJ-playlist references to each track in the
-    // auto-DJ-crates database.  Returns true if successful.
-    bool updateAutoDjPlaylistReferences();
+    // The number of references to each track in the auto-DJ playlist.
+    QHash<TrackId, int> queryAutoDjPlaylistRefs();
+    int queryAutoDjPlaylistRefsForTrack(TrackId trackId);
 
-    // Update the number of auto-DJ-playlist references to the given track
-    // in the auto-DJ-crates database.  Returns true if successful.
-    bool updateAutoDjPlaylistReferencesForTrack(TrackId trackId);
+    // The number of decks the given track is loaded into.
+    int countDeckRefs(TrackId trackId);
 
-    // Update the last-played date/time for each track in the
-    // auto-DJ-crates database.  Returns true if successful.
-    bool updateLastPlayedDateTime();
+    // The last-played date/time of each track in the set-log playlists.
+    QHash<TrackId, QDateTime> queryLastPlayedDateTimes();
+    QDateTime queryLastPlayedDateTimeForTrack(TrackId trackId);
 
-    // Update the last-played date/time for the given track in the
-    // auto-DJ-crates database.  Returns true if successful.
-    bool updateLastPlayedDateTimeForTrack(TrackId trackId);
+    // Update the last-played date/time of all auto-DJ-crate tracks.
+    // Returns true if successful.
+    bool updateLastPlayedDateTimes();
 
     // Calculates a random Track from AutoDJ,
     // This is used when all active tracks are already queued up.
@@ -96,8 +101,8 @@ class AutoDJCratesDAO : public QObject {
     void slotPlayerInfoTrackUnloaded(QString group, TrackPointer pTrack);
 
   private:
-    void updateAutoDjCrate(CrateId crateId);
-    void deleteAutoDjCrate(CrateId crateId);
+    void addAutoDjCrate(CrateId crateId);
+    void removeAutoDjCrate(CrateId crateId);
 
     // The auto-DJ playlist's ID.
     const int m_iAutoDjPlaylistId;
@@ -110,13 +115,19 @@ class AutoDJCratesDAO : public QObject {
     // The source of our configuration.
     UserSettingsPointer m_pConfig;
 
-    // True if the auto-DJ-crates database has been created.
-    bool m_bAutoDjCratesDbCreated;
+    // True if the auto-DJ-crate tracks have been loaded.
+    bool m_bAutoDjCrateTracksLoaded;
 
     // True if active tracks can be tracks that haven't been played in
     // a while.
     bool m_bUseIgnoreTime;
 
+    // The tracks of all auto-DJ crates.
+    AutoDJCrateSelector m_autoDjCrateTracks;
+
+    // The ID of every auto-DJ crate.
+    QSet<CrateId> m_autoDjCrateIds;
+
     // The ID of every set-log playlist.
     QList<int> m_lstSetLogPlaylistIds;
 };
@@ -7,6 +7,8 @@
 
 #include "libraryhashdao.h"
 #include "library/queryutil.h"
+#include "util/db/sqllikewildcards.h"
+#include "util/db/sqllikewildcardescaper.h"
 
 QHash<QString, int> LibraryHashDAO::getDirectoryHashes() {
     QSqlQuery query(m_database);
@@ -172,3 +174,80 @@ QStringList LibraryHashDAO::getDeletedDirectories() {
     }
     return result;
 }
+
+void LibraryHashDAO::invalidateDirectories(const QStringList& dirPaths) {
+    FieldEscaper escaper(m_database);
+    QStringList escapedDirPaths = escaper.escapeStrings(dirPaths);
+
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE LibraryHashes "
+                "SET needs_verification=1 "
+                "WHERE directory_path IN (%1)")
+        .arg(escapedDirPaths.join(",")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark" << dirPaths.size()
+                << "directories as needing verification.";
+    }
+}
+
+void LibraryHashDAO::invalidateDirectoryTrees(const QStringList& dirPaths) {
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE LibraryHashes "
+                "SET needs_verification=1 "
+                "WHERE directory_path=:directory_path "
+                "OR directory_path LIKE :subdirectories ESCAPE '%1'")
+        .arg(kSqlLikeMatchAll));
+    for (const auto& dirPath: dirPaths) {
+        query.bindValue(":directory_path", dirPath);
+        query.bindValue(":subdirectories",
+                SqlLikeWildcardEscaper::apply(dirPath + "/", kSqlLikeMatchAll) +
+                        kSqlLikeMatchAll);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query)
+                    << "Couldn't mark directory tree" << dirPath
+                    << "as needing verification.";
+        }
+    }
+}
+
+void LibraryHashDAO::journalDirectoryChanges(const QStringList& dirPaths,
+                                             qint64 recordedAt) {
+    QSqlQuery query(m_database);
+    query.prepare("INSERT OR REPLACE INTO library_change_journal "
+                  "(directory_path, recorded_at) "
+                  "VALUES (:directory_path, :recorded_at)");
+    for (const auto& dirPath: dirPaths) {
+        query.bindValue(":directory_path", dirPath);
+        query.bindValue(":recorded_at", recordedAt);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query) << "Journaling directory change failed.";
+        }
+    }
+}
+
+QStringList LibraryHashDAO::getJournaledDirectories() {
+    QStringList result;
+    QSqlQuery query(m_database);
+    query.prepare("SELECT directory_path FROM library_change_journal");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+    const int directoryPathColumn = query.record().indexOf("directory_path");
+    while (query.next()) {
+        result << query.value(directoryPathColumn).toString();
+    }
+    return result;
+}
+
+void LibraryHashDAO::removeJournaledDirectories(qint64 recordedUntil) {
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM library_change_journal "
+                  "WHERE recorded_at<=:recorded_at");
+    query.bindValue(":recorded_at", recordedUntil);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+}
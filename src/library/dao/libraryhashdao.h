@@ -28,6 +28,17 @@ class LibraryHashDAO : public DAO {
     void updateDirectoryStatuses(const QStringList& dirPaths,
                                  const bool deleted, const bool verified);
     QStringList getDeletedDirectories();
+    void invalidateDirectories(const QStringList& dirPaths);
+    // Also invalidates all subdirectories, e.g. of a moved directory
+    void invalidateDirectoryTrees(const QStringList& dirPaths);
+
+    // Journal of directories that have been reported as changed by the
+    // LibraryWatcher and still need to be rescanned. Timestamps are in
+    // milliseconds since the epoch.
+    void journalDirectoryChanges(const QStringList& dirPaths,
+                                 qint64 recordedAt);
+    QStringList getJournaledDirectories();
+    void removeJournaledDirectories(qint64 recordedUntil);
 
   private:
     QSqlDatabase m_database;
@@ -1,6 +1,8 @@
 #include <QtDebug>
 #include <QtSql>
 
+#include <algorithm>
+
 #include "track/track.h"
 #include "library/dao/playlistdao.h"
 #include "library/queryutil.h"
@@ -405,10 +407,11 @@ void PlaylistDAO::removeHiddenTracks(const int playlistId) {
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-    	int position = query.value(query.record().indexOf("position")).toInt();
-    	removeTracksFromPlaylistInner(playlistId, position);
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
+    removeTracksFromPlaylistInner(playlistId, positions);
 
     transaction.commit();
     emit(changed(playlistId));
@@ -430,11 +433,11 @@ void PlaylistDAO::removeTrackFromPlaylist(const int playlistId, const TrackId& t
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-    	int position = query.value(query.record().indexOf("position")).toInt();
-        removeTracksFromPlaylistInner(playlistId, position);
-
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
+    removeTracksFromPlaylistInner(playlistId, positions);
 
     transaction.commit();
     emit(changed(playlistId));
@@ -445,67 +448,86 @@ void PlaylistDAO::removeTrackFromPlaylist(const int playlistId, const int positi
     // qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //          << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    removeTracksFromPlaylistInner(playlistId, position);
+    removeTracksFromPlaylistInner(playlistId, QList<int>() << position);
     transaction.commit();
     emit(changed(playlistId));
 }
 
 void PlaylistDAO::removeTracksFromPlaylist(const int playlistId, QList<int>& positions) {
-    // get positions in reversed order
-    qSort(positions.begin(), positions.end(), qGreater<int>());
-
     //qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //         << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
-    foreach (int position , positions) {
-    	removeTracksFromPlaylistInner(playlistId, position);
-    }
+    removeTracksFromPlaylistInner(playlistId, positions);
     transaction.commit();
     emit(changed(playlistId));
 }
 
-void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT track_id FROM PlaylistTracks WHERE playlist_id=:id "
-                  "AND position=:position");
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
-    }
-
-    if (!query.next()) {
-        qDebug() << "removeTrackFromPlaylist no track exists at position:"
-                 << position << "in playlist:" << playlistId;
-        return;
-    }
-    TrackId trackId(query.value(query.record().indexOf("track_id")));
-
-    // Delete the track from the playlist.
-    query.prepare("DELETE FROM PlaylistTracks "
-                  "WHERE playlist_id=:id AND position= :position");
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, QList<int> positions) {
+    qSort(positions);
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    QSqlQuery selectQuery(m_database);
+    selectQuery.prepare("SELECT track_id FROM PlaylistTracks "
+                        "WHERE playlist_id=:id AND position=:position");
+    QSqlQuery deleteQuery(m_database);
+    deleteQuery.prepare("DELETE FROM PlaylistTracks "
+                        "WHERE playlist_id=:id AND position=:position");
+
+    // The removed positions in ascending order
+    QList<int> removedPositions;
+    QList<TrackId> removedTrackIds;
+    for (int position: positions) {
+        selectQuery.bindValue(":id", playlistId);
+        selectQuery.bindValue(":position", position);
+        if (!selectQuery.exec()) {
+            LOG_FAILED_QUERY(selectQuery);
+            continue;
+        }
+        if (!selectQuery.next()) {
+            qDebug() << "removeTrackFromPlaylist no track exists at position:"
+                     << position << "in playlist:" << playlistId;
+            continue;
+        }
+        TrackId trackId(selectQuery.value(selectQuery.record().indexOf("track_id")));
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
+        // Delete the track from the playlist.
+        deleteQuery.bindValue(":id", playlistId);
+        deleteQuery.bindValue(":position", position);
+        if (!deleteQuery.exec()) {
+            LOG_FAILED_QUERY(deleteQuery);
+            continue;
+        }
+        removedPositions.append(position);
+        removedTrackIds.append(trackId);
+    }
+
+    // Close the gaps with a single pass over the remaining tracks. All
+    // tracks between the i-th and the (i+1)-th removed position move up
+    // by i+1 positions instead of shifting the whole tail of the playlist
+    // once for each removed track.
+    QSqlQuery updateQuery(m_database);
+    for (int i = 0; i < removedPositions.size(); ++i) {
+        QString queryString =
+                QString("UPDATE PlaylistTracks SET position=position-%1 "
+                        "WHERE playlist_id=%2 AND position>%3").arg(
+                                QString::number(i + 1),
+                                QString::number(playlistId),
+                                QString::number(removedPositions.at(i)));
+        if (i + 1 < removedPositions.size()) {
+            queryString += QString(" AND position<%1").arg(
+                    QString::number(removedPositions.at(i + 1)));
+        }
+        if (!updateQuery.exec(queryString)) {
+            LOG_FAILED_QUERY(updateQuery);
+        }
     }
 
-    QString queryString;
-    queryString = QString("UPDATE PlaylistTracks SET position=position-1 "
-                          "WHERE position>=%1 AND "
-                          "playlist_id=%2").arg(QString::number(position),
-                                                QString::number(playlistId));
-    if (!query.exec(queryString)) {
-        LOG_FAILED_QUERY(query);
+    // Report the removals from the end of the playlist towards the
+    // beginning, i.e. each position is valid at the time it is reported.
+    for (int i = removedPositions.size() - 1; i >= 0; --i) {
+        m_playlistsTrackIsIn.remove(removedTrackIds.at(i), playlistId);
+        emit(trackRemoved(playlistId, removedTrackIds.at(i), removedPositions.at(i)));
     }
-
-    m_playlistsTrackIsIn.remove(trackId, playlistId);
-    emit(trackRemoved(playlistId, trackId, position));
 }
 
 
@@ -569,33 +591,44 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
         position = max_position;
     }
 
+    int numValidTracks = 0;
+    for (const auto& trackId: trackIds) {
+        if (trackId.isValid()) {
+            ++numValidTracks;
+        }
+    }
+    if (numValidTracks == 0) {
+        return 0;
+    }
+
+    // Move all tracks behind the insert position down at once
+    QSqlQuery query(m_database);
+    if (!query.exec(QString("UPDATE PlaylistTracks SET position=position+%1 "
+                            "WHERE position>=%2 AND playlist_id=%3").arg(
+                                    QString::number(numValidTracks),
+                                    QString::number(position),
+                                    QString::number(playlistId)))) {
+        LOG_FAILED_QUERY(query);
+        return 0;
+    }
+
     QSqlQuery insertQuery(m_database);
     insertQuery.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
                         "VALUES (:playlist_id, :track_id, :position)");
-    QSqlQuery query(m_database);
     int insertPositon = position;
     for (const auto& trackId: trackIds) {
         if (!trackId.isValid()) {
             continue;
         }
-        // Move all tracks in playlist up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
-        query.prepare(QString("UPDATE PlaylistTracks SET position=position+1 "
-                              "WHERE position>=%1 AND "
-                              "playlist_id=%2").arg(insertPositon).arg(playlistId));
-
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
-            continue;
-        }
-
         // Insert the track at the given position
         insertQuery.bindValue(":playlist_id", playlistId);
         insertQuery.bindValue(":track_id", trackId.toVariant());
         insertQuery.bindValue(":position", insertPositon);
         if (!insertQuery.exec()) {
             LOG_FAILED_QUERY(insertQuery);
-            continue;
+            // Abort without committing, the positions of the
+            // shifted tracks would no longer be contiguous.
+            return 0;
         }
 
         // Increment the insert position for the track.
@@ -607,8 +640,10 @@ int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
 
     insertPositon = position;
     for (const auto& trackId: trackIds) {
+        if (!trackId.isValid()) {
+            continue;
+        }
         m_playlistsTrackIsIn.insert(trackId, playlistId);
-        // TODO(XXX) The position is wrong if any track failed to insert.
         emit(trackAdded(playlistId, trackId, insertPositon++));
     }
     emit(changed(playlistId));
@@ -779,57 +814,61 @@ int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
 }
 
 void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const int newPosition) {
+    if (oldPosition == newPosition) {
+        return;
+    }
+
+    // Positions are kept dense (1..n) instead of sparse or fractional keys:
+    // PlaylistTracks.position is read directly by the table models, the
+    // Auto DJ queue and the playlist exports, and it is shown to the
+    // user as the track number. Hiding sparse keys would need a dense row
+    // number in every one of those queries, which our SQLite versions can
+    // only compute with a correlated subquery per row. With the index on
+    // (playlist_id, position) a move only touches the rows between the old
+    // and the new position, which is small for drag and drop.
+    //
+    //  1) Park the moved track at the dummy position -1.
+    //  2) Shift the tracks between the old and the new position by one.
+    //  3) Move the track from the dummy position to its destination.
     ScopedTransaction transaction(m_database);
     QSqlQuery query(m_database);
 
-    // Algorithm for code below
-    // Case 1: destination < source (newPositon < oldPosition)
-    //    1) Set position = -1 where pos=source -- Gives that track a dummy index to keep stuff simple.
-    //    2) Decrement position where pos >= dest AND pos < source
-    //    3) Set position = dest where pos=-1 -- Move track from dummy pos to final destination.
-
-     // Case 2: destination > source (newPos > oldPos)
-     //   1) Set position=-1 where pos=source -- Give track a dummy index again.
-     //   2) Decrement position where pos > source AND pos <= dest
-     //   3) Set postion=dest where pos=-1 -- Move that track from dummy pos to final destination
-
-    QString queryString;
-
-    // Move moved track to  dummy position -1
-    queryString = QString("UPDATE PlaylistTracks SET position=-1 "
-                          "WHERE position=%1 AND "
-                          "playlist_id=%2").arg(QString::number(oldPosition),
-                                                QString::number(playlistId));
-    query.exec(queryString);
+    query.prepare("UPDATE PlaylistTracks SET position=-1 "
+                  "WHERE playlist_id=:id AND position=:position");
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", oldPosition);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
 
     if (newPosition < oldPosition) {
-        queryString = QString("UPDATE PlaylistTracks SET position=position+1 "
-                              "WHERE position >= %1 AND position < %2 AND "
-                              "playlist_id=%3").arg(QString::number(newPosition),
-                                                    QString::number(oldPosition),
-                                                    QString::number(playlistId));
+        query.prepare("UPDATE PlaylistTracks SET position=position+1 "
+                      "WHERE playlist_id=:id AND "
+                      "position>=:new_position AND position<:old_position");
     } else {
-        queryString = QString("UPDATE PlaylistTracks SET position=position-1 "
-                              "WHERE position>%1 AND position<=%2 AND "
-                              "playlist_id=%3").arg(QString::number(oldPosition),
-                                                    QString::number(newPosition),
-                                                    QString::number(playlistId));
+        query.prepare("UPDATE PlaylistTracks SET position=position-1 "
+                      "WHERE playlist_id=:id AND "
+                      "position>:old_position AND position<=:new_position");
+    }
+    query.bindValue(":id", playlistId);
+    query.bindValue(":old_position", oldPosition);
+    query.bindValue(":new_position", newPosition);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
     }
-    query.exec(queryString);
-
-    queryString = QString("UPDATE PlaylistTracks SET position = %1 "
-                          "WHERE position=-1 AND "
-                          "playlist_id=%2").arg(QString::number(newPosition),
-                                                QString::number(playlistId));
-    query.exec(queryString);
-
-    transaction.commit();
 
-    // Print out any SQL error, if there was one.
-    if (query.lastError().isValid()) {
-        qDebug() << query.lastError();
+    query.prepare("UPDATE PlaylistTracks SET position=:position "
+                  "WHERE playlist_id=:id AND position=-1");
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", newPosition);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
     }
 
+    transaction.commit();
     emit(changed(playlistId));
 }
 
@@ -860,6 +899,28 @@ void PlaylistDAO::shuffleTracks(const int playlistId, const QList<int>& position
     qsrand(seed);
     QHash<int,TrackId> trackPositionIds = allIds;
     QList<int> newPositions = positions;
+    // The index of each position in newPositions
+    QHash<int,int> newPositionIndices;
+    for (int i = 0; i < newPositions.count(); ++i) {
+        newPositionIndices.insert(newPositions.at(i), i);
+    }
+
+    // The tracks are swapped in memory and only the final positions
+    // are written to the database. Tracks are identified by the row id
+    // of PlaylistTracks, because a playlist may contain the same track
+    // multiple times.
+    QHash<int,int> rowIdsByPosition;
+    query.prepare("SELECT id, position FROM PlaylistTracks "
+                  "WHERE playlist_id=:id");
+    query.bindValue(":id", playlistId);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    while (query.next()) {
+        rowIdsByPosition.insert(query.value(1).toInt(), query.value(0).toInt());
+    }
+    const QHash<int,int> oldRowIdsByPosition = rowIdsByPosition;
     const int searchDistance = math_max(trackPositionIds.count() / 4, 1);
 
     qDebug() << "Shuffling Tracks";
@@ -975,22 +1036,28 @@ void PlaylistDAO::shuffleTracks(const int playlistId, const QList<int>& position
         //qDebug() << "Swapping tracks " << trackAPosition << " and " << trackBPosition;
         trackPositionIds.insert(trackAPosition, trackBId);
         trackPositionIds.insert(trackBPosition, trackAId);
-        newPositions.swap(newPositions.indexOf(trackAPosition),
-                          newPositions.indexOf(trackBPosition));
-        QString swapQuery = "UPDATE PlaylistTracks SET position=%1 "
-                "WHERE position=%2 AND playlist_id=%3";
-        query.exec(swapQuery.arg(QString::number(-1),
-                                 QString::number(trackAPosition),
-                                 QString::number(playlistId)));
-        query.exec(swapQuery.arg(QString::number(trackAPosition),
-                                 QString::number(trackBPosition),
-                                 QString::number(playlistId)));
-        query.exec(swapQuery.arg(QString::number(trackBPosition),
-                                 QString::number(-1),
-                                 QString::number(playlistId)));
-
-        if (query.lastError().isValid())
-            qDebug() << query.lastError();
+        const int trackAIndex = newPositionIndices.value(trackAPosition);
+        const int trackBIndex = newPositionIndices.value(trackBPosition);
+        newPositions.swap(trackAIndex, trackBIndex);
+        newPositionIndices.insert(trackAPosition, trackBIndex);
+        newPositionIndices.insert(trackBPosition, trackAIndex);
+        const int rowAId = rowIdsByPosition.value(trackAPosition);
+        rowIdsByPosition.insert(trackAPosition, rowIdsByPosition.value(trackBPosition));
+        rowIdsByPosition.insert(trackBPosition, rowAId);
+    }
+
+    query.prepare("UPDATE PlaylistTracks SET position=:position WHERE id=:id");
+    for (auto it = rowIdsByPosition.constBegin();
+            it != rowIdsByPosition.constEnd(); ++it) {
+        if (oldRowIdsByPosition.value(it.key()) == it.value()) {
+            continue;
+        }
+        query.bindValue(":position", it.key());
+        query.bindValue(":id", it.value());
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return;
+        }
     }
 
     transaction.commit();
@@ -132,7 +132,9 @@ class PlaylistDAO : public QObject, public virtual DAO {
 
   private:
     bool removeTracksFromPlaylist(const int playlistId, const int startIndex);
-    void removeTracksFromPlaylistInner(int playlistId, int position);
+    // Removes the tracks at the given positions and renumbers the
+    // remaining tracks. Must be invoked within a transaction.
+    void removeTracksFromPlaylistInner(int playlistId, QList<int> positions);
     void searchForDuplicateTrack(const int fromPosition,
                                  const int toPosition,
                                  TrackId trackID,
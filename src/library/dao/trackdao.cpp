@@ -16,6 +16,7 @@
 #include "util/db/sqlstringformatter.h"
 #include "util/db/sqllikewildcards.h"
 #include "util/db/sqllikewildcardescaper.h"
+#include "util/db/sqlmultirowinsert.h"
 #include "util/db/sqltransaction.h"
 #include "library/coverart.h"
 #include "library/coverartutils.h"
@@ -25,6 +26,7 @@
 #include "library/dao/playlistdao.h"
 #include "library/dao/analysisdao.h"
 #include "library/dao/libraryhashdao.h"
+#include "library/trackmetadatawriter.h"
 #include "library/coverartcache.h"
 #include "track/beatfactory.h"
 #include "track/beats.h"
@@ -35,9 +37,9 @@
 #include "util/file.h"
 #include "util/timer.h"
 #include "util/math.h"
+#include "util/performancetimer.h"
 
-QHash<TrackId, TrackWeakPointer> TrackDAO::m_sTracks;
-QMutex TrackDAO::m_sTracksMutex;
+WeakTrackCache TrackDAO::m_sTracks;
 
 enum { UndefinedRecordIndex = -2 };
 
@@ -78,10 +80,14 @@ TrackDAO::TrackDAO(CueDAO& cueDao,
           m_analysisDao(analysisDao),
           m_libraryHashDao(libraryHashDao),
           m_pConfig(pConfig),
+          m_pMetadataWriter(nullptr),
           m_recentTracksCache(kRecentTracksCacheSize),
           m_trackLocationIdColumn(UndefinedRecordIndex),
           m_queryLibraryIdColumn(UndefinedRecordIndex),
-          m_queryLibraryMixxxDeletedColumn(UndefinedRecordIndex) {
+          m_queryLibraryMixxxDeletedColumn(UndefinedRecordIndex),
+          m_thumbnailStore(pConfig ?
+                  CoverThumbnailStore(CoverThumbnailStore::directoryPath(pConfig)) :
+                  CoverThumbnailStore()) {
 }
 
 TrackDAO::~TrackDAO() {
@@ -92,25 +98,16 @@ TrackDAO::~TrackDAO() {
 
 void TrackDAO::finish() {
     // Save all tracks that haven't been saved yet.
-    QMutexLocker locker(&m_sTracksMutex);
-    QHashIterator<TrackId, TrackWeakPointer> it(m_sTracks);
-    while (it.hasNext()) {
-        it.next();
-        // Cast from TrackWeakPointer to TrackPointer. If the track still exists
-        // then pTrack will be non-nullptr. If the track is dirty then save it.
-        TrackPointer pTrack = TrackPointer(it.value());
-        if (pTrack) {
-            if (pTrack->isDirty()) {
-                saveTrack(pTrack);
-            }
-
-            // When this reference expires, tell the track to delete itself
-            // rather than signalling to TrackDAO.
-            pTrack->setDeleteOnReferenceExpiration(true);
+    for (const auto& pTrack: m_sTracks.takeAll()) {
+        // If the track is dirty then save it.
+        if (pTrack->isDirty()) {
+            saveTrack(pTrack);
         }
+
+        // When this reference expires, tell the track to delete itself
+        // rather than signalling to TrackDAO.
+        pTrack->setDeleteOnReferenceExpiration(true);
     }
-    m_sTracks.clear();
-    locker.unlock();
 
     // Clear cache, so all cached tracks without other references are deleted.
     // Will queue a bunch of saveTrack calls for every RecentTrackCacheItem in
@@ -281,7 +278,11 @@ void TrackDAO::saveTrack(Track* pTrack) {
         // could alternatively store a second copy of TrackMetadata
         // in Track.
         if (m_pConfig && m_pConfig->getValueString(ConfigKey("[Library]","WriteAudioTags")).toInt() == 1) {
-            SoundSourceProxy::saveTrackMetadata(pTrack);
+            if (m_pMetadataWriter) {
+                m_pMetadataWriter->enqueue(*pTrack);
+            } else {
+                SoundSourceProxy::saveTrackMetadata(pTrack);
+            }
         }
     }
 }
@@ -371,6 +372,8 @@ void TrackDAO::addTracksPrepare() {
     }
     // Start the transaction
     m_pTransaction = std::make_unique<SqlTransaction>(m_database);
+    // The image files may have changed since the last tracks were added
+    m_coverArtFolder = CoverArtFolder();
 
     m_pQueryTrackLocationInsert = std::make_unique<QSqlQuery>(m_database);
     m_pQueryTrackLocationSelect = std::make_unique<QSqlQuery>(m_database);
@@ -392,7 +395,7 @@ void TrackDAO::addTracksPrepare() {
             "artist,title,album,album_artist,year,genre,tracknumber,tracktotal,composer,"
             "grouping,filetype,location,comment,url,duration,rating,key,key_id,"
             "bitrate,samplerate,cuepoint,bpm,replaygain,replaygain_peak,wavesummaryhex,"
-            "timesplayed,channels,mixxx_deleted,header_parsed,"
+            "timesplayed,played,channels,mixxx_deleted,header_parsed,"
             "beats_version,beats_sub_version,beats,bpm_lock,"
             "keys_version,keys_sub_version,keys,"
             "coverart_source,coverart_type,coverart_location,coverart_hash"
@@ -400,7 +403,7 @@ void TrackDAO::addTracksPrepare() {
             ":artist,:title,:album,:album_artist,:year,:genre,:tracknumber,:tracktotal,:composer,"
             ":grouping,:filetype,:location,:comment,:url,:duration,:rating,:key,:key_id,"
             ":bitrate,:samplerate,:cuepoint,:bpm,:replaygain,:replaygain_peak,:wavesummaryhex,"
-            ":timesplayed,:channels,:mixxx_deleted,:header_parsed,"
+            ":timesplayed,:played,:channels,:mixxx_deleted,:header_parsed,"
             ":beats_version,:beats_sub_version,:beats,:bpm_lock,"
             ":keys_version,:keys_sub_version,:keys,"
             ":coverart_source,:coverart_type,:coverart_location,:coverart_hash"
@@ -427,6 +430,7 @@ void TrackDAO::addTracksFinish(bool rollback) {
     m_pQueryLibraryInsert.reset();
     m_pQueryLibrarySelect.reset();
     m_pTransaction.reset();
+    m_coverArtFolder = CoverArtFolder();
 
     emit(tracksAdded(m_tracksAddedSet));
     m_tracksAddedSet.clear();
@@ -450,42 +454,57 @@ namespace {
         }
     }
 
-    // Bind common values for insert/update
-    void bindTrackLibraryValues(QSqlQuery* pTrackLibraryQuery, const Track& track) {
-        pTrackLibraryQuery->bindValue(":artist", track.getArtist());
-        pTrackLibraryQuery->bindValue(":title", track.getTitle());
-        pTrackLibraryQuery->bindValue(":album", track.getAlbum());
-        pTrackLibraryQuery->bindValue(":album_artist", track.getAlbumArtist());
-        pTrackLibraryQuery->bindValue(":year", track.getYear());
-        pTrackLibraryQuery->bindValue(":genre", track.getGenre());
-        pTrackLibraryQuery->bindValue(":composer", track.getComposer());
-        pTrackLibraryQuery->bindValue(":grouping", track.getGrouping());
-        pTrackLibraryQuery->bindValue(":tracknumber", track.getTrackNumber());
-        pTrackLibraryQuery->bindValue(":tracktotal", track.getTrackTotal());
-        pTrackLibraryQuery->bindValue(":filetype", track.getType());
-        pTrackLibraryQuery->bindValue(":comment", track.getComment());
-        pTrackLibraryQuery->bindValue(":url", track.getURL());
-        pTrackLibraryQuery->bindValue(":duration", track.getDuration());
-        pTrackLibraryQuery->bindValue(":rating", track.getRating());
-        pTrackLibraryQuery->bindValue(":bitrate", track.getBitrate());
-        pTrackLibraryQuery->bindValue(":samplerate", track.getSampleRate());
-        pTrackLibraryQuery->bindValue(":cuepoint", track.getCuePoint());
-        pTrackLibraryQuery->bindValue(":bpm_lock", track.isBpmLocked()? 1 : 0);
-        pTrackLibraryQuery->bindValue(":replaygain", track.getReplayGain().getRatio());
-        pTrackLibraryQuery->bindValue(":replaygain_peak", track.getReplayGain().getPeak());
-        pTrackLibraryQuery->bindValue(":channels", track.getChannels());
-
-        pTrackLibraryQuery->bindValue(":header_parsed", track.isHeaderParsed() ? 1 : 0);
+    // The columns of the library table that are written from the
+    // properties of a track, both when inserting and when updating.
+    // Same order as the values returned by trackLibraryValues().
+    const QStringList kTrackLibraryColumns = QStringList()
+            << "artist" << "title" << "album" << "album_artist" << "year"
+            << "genre" << "composer" << "grouping" << "tracknumber"
+            << "tracktotal" << "filetype" << "comment" << "url"
+            << "duration" << "rating" << "bitrate" << "samplerate"
+            << "cuepoint" << "bpm_lock" << "replaygain" << "replaygain_peak"
+            << "channels" << "header_parsed" << "timesplayed" << "played"
+            << "coverart_source" << "coverart_type" << "coverart_location"
+            << "coverart_hash" << "bpm" << "beats_version"
+            << "beats_sub_version" << "beats" << "keys" << "keys_version"
+            << "keys_sub_version" << "key" << "key_id";
+
+    QVariantList trackLibraryValues(const Track& track) {
+        QVariantList values;
+        values.reserve(kTrackLibraryColumns.size());
+        values << track.getArtist()
+                << track.getTitle()
+                << track.getAlbum()
+                << track.getAlbumArtist()
+                << track.getYear()
+                << track.getGenre()
+                << track.getComposer()
+                << track.getGrouping()
+                << track.getTrackNumber()
+                << track.getTrackTotal()
+                << track.getType()
+                << track.getComment()
+                << track.getURL()
+                << track.getDuration()
+                << track.getRating()
+                << track.getBitrate()
+                << track.getSampleRate()
+                << track.getCuePoint()
+                << (track.isBpmLocked() ? 1 : 0)
+                << track.getReplayGain().getRatio()
+                << track.getReplayGain().getPeak()
+                << track.getChannels()
+                << (track.isHeaderParsed() ? 1 : 0);
 
         const PlayCounter playCounter(track.getPlayCounter());
-        pTrackLibraryQuery->bindValue(":timesplayed", playCounter.getTimesPlayed());
-        pTrackLibraryQuery->bindValue(":played", playCounter.isPlayed() ? 1 : 0);
+        values << playCounter.getTimesPlayed()
+                << (playCounter.isPlayed() ? 1 : 0);
 
         const CoverInfo coverInfo(track.getCoverInfo());
-        pTrackLibraryQuery->bindValue(":coverart_source", coverInfo.source);
-        pTrackLibraryQuery->bindValue(":coverart_type", coverInfo.type);
-        pTrackLibraryQuery->bindValue(":coverart_location", coverInfo.coverLocation);
-        pTrackLibraryQuery->bindValue(":coverart_hash", coverInfo.hash);
+        values << coverInfo.source
+                << coverInfo.type
+                << coverInfo.coverLocation
+                << coverInfo.hash;
 
         QByteArray beatsBlob;
         QString beatsVersion;
@@ -499,10 +518,10 @@ namespace {
             beatsSubVersion = pBeats->getSubVersion();
             dBpm = pBeats->getBpm();
         }
-        pTrackLibraryQuery->bindValue(":bpm", dBpm);
-        pTrackLibraryQuery->bindValue(":beats_version", beatsVersion);
-        pTrackLibraryQuery->bindValue(":beats_sub_version", beatsSubVersion);
-        pTrackLibraryQuery->bindValue(":beats", beatsBlob);
+        values << dBpm
+                << beatsVersion
+                << beatsSubVersion
+                << beatsBlob;
 
         QByteArray keysBlob;
         QString keysVersion;
@@ -517,11 +536,22 @@ namespace {
             key = keys.getGlobalKey();
             keyText = KeyUtils::getGlobalKeyText(keys);
         }
-        pTrackLibraryQuery->bindValue(":keys", keysBlob);
-        pTrackLibraryQuery->bindValue(":keys_version", keysVersion);
-        pTrackLibraryQuery->bindValue(":keys_sub_version", keysSubVersion);
-        pTrackLibraryQuery->bindValue(":key", keyText);
-        pTrackLibraryQuery->bindValue(":key_id", static_cast<int>(key));
+        values << keysBlob
+                << keysVersion
+                << keysSubVersion
+                << keyText
+                << static_cast<int>(key);
+
+        DEBUG_ASSERT(values.size() == kTrackLibraryColumns.size());
+        return values;
+    }
+
+    // Bind common values for insert/update
+    void bindTrackLibraryValues(QSqlQuery* pTrackLibraryQuery, const Track& track) {
+        const QVariantList values = trackLibraryValues(track);
+        for (int i = 0; i < kTrackLibraryColumns.size(); ++i) {
+            pTrackLibraryQuery->bindValue(":" + kTrackLibraryColumns.at(i), values.at(i));
+        }
     }
 
     bool insertTrackLibrary(QSqlQuery* pTrackLibraryInsert, const Track& track, DbId trackLocationId) {
@@ -682,7 +712,7 @@ TrackId TrackDAO::addTracksAddTrack(const TrackPointer& pTrack, bool unremove) {
     return trackId;
 }
 
-TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove) {
+TrackPointer TrackDAO::newTrackFromFile(const QFileInfo& fileInfo) {
     // TODO(uklotzde): Resolve Track through TrackCache
     TrackPointer pTrack(Track::newTemporary(fileInfo));
 
@@ -691,7 +721,7 @@ TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove
     // the track is already in the library. A refactoring is
     // needed to detect this before calling addTracksAddTrack().
     if (!SoundSourceProxy::isFileSupported(fileInfo)) {
-        qWarning() << "TrackDAO::addTracksAddFile:"
+        qWarning() << "TrackDAO::newTrackFromFile:"
                 << "Unsupported file type"
                 << pTrack->getLocation();
         return TrackPointer();
@@ -702,14 +732,26 @@ TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove
     // TODO(uklotzde): Loading of metadata can be skipped if
     // the track is already in the library. A refactoring is
     // needed to detect this before calling addTracksAddTrack().
-    SoundSourceProxy(pTrack).updateTrack();
-    if (!pTrack->isHeaderParsed()) {
-        qWarning() << "TrackDAO::addTracksAddFile:"
+    QImage coverImage;
+    SoundSourceProxy(pTrack).updateTrack(
+            SoundSourceProxy::ParseFileTagsMode::Default, &coverImage);
+    if (pTrack->isHeaderParsed()) {
+        guessCoverArtForNewTrack(pTrack, fileInfo, coverImage);
+    } else {
+        qWarning() << "TrackDAO::newTrackFromFile:"
                 << "Failed to parse track metadata from file"
                 << pTrack->getLocation();
         // Continue with adding the track to the library, no matter
         // if parsing the metadata from file succeeded or failed.
     }
+    return pTrack;
+}
+
+TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove) {
+    TrackPointer pTrack(newTrackFromFile(fileInfo));
+    if (!pTrack) {
+        return TrackPointer();
+    }
 
     const TrackId trackId(addTracksAddTrack(pTrack, unremove));
 
@@ -723,6 +765,41 @@ TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove
     }
 }
 
+void TrackDAO::guessCoverArtForNewTrack(const TrackPointer& pTrack,
+        const QFileInfo& fileInfo, const QImage& embeddedCoverImage) {
+    // The file tags have just been parsed, including the embedded cover
+    // art. Complete the cover art detection now instead of opening the
+    // file again in detectCoverArtForTracksWithoutCover().
+    CoverInfo coverInfo = pTrack->getCoverInfo();
+    if (coverInfo.source == CoverInfo::USER_SELECTED) {
+        return;
+    }
+    if (coverInfo.type == CoverInfo::METADATA) {
+        m_thumbnailStore.storeSmallThumbnails(coverInfo, embeddedCoverImage);
+        return;
+    }
+
+    const QString folder = fileInfo.absolutePath();
+    // Outside of addTracksPrepare() and addTracksFinish() the folder
+    // is listed again for each track
+    if (!m_pTransaction || m_coverArtFolder.folder() != folder) {
+        m_coverArtFolder = CoverArtFolder(folder);
+    }
+    QImage loadedImage;
+    const CoverInfoRelative coverInfoRelative =
+            m_coverArtFolder.selectCoverArtForTrack(
+                    fileInfo.baseName(), pTrack->getAlbum(), &loadedImage);
+    // Marks the cover art as GUESSED even if none has been found
+    pTrack->setCoverInfo(coverInfoRelative);
+    if (!loadedImage.isNull()) {
+        // The thumbnails of a cover file are shared by all tracks
+        // in the folder
+        m_thumbnailStore.storeSmallThumbnails(
+                CoverInfo(coverInfoRelative, pTrack->getLocation()),
+                loadedImage);
+    }
+}
+
 TrackPointer TrackDAO::addSingleTrack(const QFileInfo& fileInfo, bool unremove) {
     addTracksPrepare();
     TrackPointer pTrack(addTracksAddFile(fileInfo, unremove));
@@ -833,6 +910,229 @@ QList<TrackId> TrackDAO::addMultipleTracks(
     return trackIds;
 }
 
+namespace {
+    // Limits the length of "... IN (...)" clauses
+    const int kBulkSelectChunkSize = 500;
+
+    // Maps track locations to the ids of the corresponding rows
+    // in track_locations.
+    QHash<QString, DbId> selectTrackLocationIds(
+            const QSqlDatabase& database,
+            const QStringList& locations) {
+        QHash<QString, DbId> trackLocationIds;
+        for (int i = 0; i < locations.size(); i += kBulkSelectChunkSize) {
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            query.prepare(QString("SELECT id, location FROM track_locations "
+                                  "WHERE location IN (%1)").arg(
+                                          SqlStringFormatter::formatList(
+                                                  database,
+                                                  locations.mid(i, kBulkSelectChunkSize))));
+            if (!query.exec()) {
+                LOG_FAILED_QUERY(query);
+                continue;
+            }
+            while (query.next()) {
+                trackLocationIds.insert(
+                        query.value(1).toString(),
+                        DbId(query.value(0)));
+            }
+        }
+        return trackLocationIds;
+    }
+
+    // Maps the ids of track locations to the ids of the corresponding
+    // tracks in the library. Tracks that are marked as deleted are
+    // collected separately.
+    QHash<DbId, TrackId> selectLibraryTrackIds(
+            const QSqlDatabase& database,
+            const QList<DbId>& trackLocationIds,
+            QList<TrackId>* pDeletedTrackIds) {
+        QHash<DbId, TrackId> trackIds;
+        for (int i = 0; i < trackLocationIds.size(); i += kBulkSelectChunkSize) {
+            QStringList idStrings;
+            for (const auto& trackLocationId: trackLocationIds.mid(i, kBulkSelectChunkSize)) {
+                idStrings << trackLocationId.toString();
+            }
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            query.prepare(QString("SELECT id, location, mixxx_deleted FROM library "
+                                  "WHERE location IN (%1)").arg(idStrings.join(",")));
+            if (!query.exec()) {
+                LOG_FAILED_QUERY(query);
+                continue;
+            }
+            while (query.next()) {
+                const TrackId trackId(query.value(0));
+                trackIds.insert(DbId(query.value(1)), trackId);
+                if (pDeletedTrackIds && query.value(2).toBool()) {
+                    pDeletedTrackIds->append(trackId);
+                }
+            }
+        }
+        return trackIds;
+    }
+} // anonymous namespace
+
+QList<TrackId> TrackDAO::addTracksBulk(
+        const QList<TrackPointer>& tracks,
+        bool unremove) {
+    PerformanceTimer timer;
+    timer.start();
+
+    // Inserting the locations in sorted order keeps the updates of the
+    // unique index on track_locations.location local. The library table
+    // itself has no secondary indexes that would need to be maintained.
+    QMap<QString, int> trackIndexByLocation;
+    for (int i = 0; i < tracks.size(); ++i) {
+        const QString location = tracks.at(i)->getLocation();
+        if (!trackIndexByLocation.contains(location)) {
+            trackIndexByLocation.insert(location, i);
+        }
+    }
+    const QStringList locations = trackIndexByLocation.keys();
+
+    // Join the transaction of addTracksPrepare() if there is one
+    std::unique_ptr<SqlTransaction> pTransaction;
+    if (!m_pTransaction) {
+        pTransaction = std::make_unique<SqlTransaction>(m_database);
+    }
+
+    QHash<QString, DbId> trackLocationIds =
+            selectTrackLocationIds(m_database, locations);
+    QStringList newLocations;
+    {
+        SqlMultiRowInsert insertLocations(
+                m_database,
+                "INSERT INTO track_locations",
+                QStringList() << "location" << "directory" << "filename"
+                        << "filesize" << "fs_deleted" << "needs_verification");
+        for (const auto& location: locations) {
+            if (trackLocationIds.contains(location)) {
+                continue;
+            }
+            const Track& track =
+                    *tracks.at(trackIndexByLocation.value(location));
+            if (!insertLocations.addRow(QVariantList()
+                    << location
+                    << track.getDirectory()
+                    << track.getFileName()
+                    << track.getFileSize()
+                    << 0
+                    << 0)) {
+                return QList<TrackId>();
+            }
+            newLocations << location;
+        }
+        if (!insertLocations.flush()) {
+            return QList<TrackId>();
+        }
+    }
+    trackLocationIds.unite(selectTrackLocationIds(m_database, newLocations));
+
+    // Tracks that are already in the library are not inserted again,
+    // but might need to be unremoved.
+    QList<TrackId> deletedTrackIds;
+    QHash<DbId, TrackId> trackIds = selectLibraryTrackIds(
+            m_database, trackLocationIds.values(), &deletedTrackIds);
+    if (unremove && !deletedTrackIds.isEmpty()) {
+        QStringList idStrings;
+        for (const auto& trackId: deletedTrackIds) {
+            idStrings << trackId.toString();
+        }
+        QSqlQuery query(m_database);
+        query.prepare(QString("UPDATE library SET mixxx_deleted=0 "
+                              "WHERE id IN (%1)").arg(idStrings.join(",")));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return QList<TrackId>();
+        }
+    }
+
+    // The same columns as written by addTracksAddTrack()
+    QList<DbId> newTrackLocationIds;
+    QList<int> newTrackIndexes;
+    {
+        SqlMultiRowInsert insertTracks(
+                m_database,
+                "INSERT INTO library",
+                kTrackLibraryColumns + (QStringList()
+                        << "location" << "mixxx_deleted"));
+        for (const auto& location: locations) {
+            const DbId trackLocationId = trackLocationIds.value(location);
+            if (!trackLocationId.isValid() || trackIds.contains(trackLocationId)) {
+                continue;
+            }
+            const int trackIndex = trackIndexByLocation.value(location);
+            if (!insertTracks.addRow(trackLibraryValues(*tracks.at(trackIndex))
+                    << trackLocationId.toVariant()
+                    << 0)) {
+                return QList<TrackId>();
+            }
+            newTrackLocationIds << trackLocationId;
+            newTrackIndexes << trackIndex;
+        }
+        if (!insertTracks.flush()) {
+            return QList<TrackId>();
+        }
+    }
+    const QHash<DbId, TrackId> newTrackIds =
+            selectLibraryTrackIds(m_database, newTrackLocationIds, nullptr);
+    trackIds.unite(newTrackIds);
+
+    // Cues and analyses are stored in separate tables
+    QSet<TrackId> newTrackIdSet;
+    for (int i = 0; i < newTrackLocationIds.size(); ++i) {
+        const TrackId trackId = newTrackIds.value(newTrackLocationIds.at(i));
+        if (!trackId.isValid()) {
+            continue;
+        }
+        const TrackPointer& pTrack = tracks.at(newTrackIndexes.at(i));
+        m_analysisDao.saveTrackAnalyses(*pTrack);
+        m_cueDao.saveTrackCues(trackId, pTrack->getCuePoints());
+        newTrackIdSet.insert(trackId);
+    }
+
+    if (pTransaction && !pTransaction->commit()) {
+        return QList<TrackId>();
+    }
+
+    // Return the ids in the order of the given tracks. Invalid ids
+    // indicate tracks that could not be added.
+    QList<TrackId> result;
+    result.reserve(tracks.size());
+    for (int i = 0; i < tracks.size(); ++i) {
+        const TrackPointer& pTrack = tracks.at(i);
+        const TrackId trackId = trackIds.value(
+                trackLocationIds.value(pTrack->getLocation()));
+        result << trackId;
+        if (!trackId.isValid() || pTrack->getId().isValid()) {
+            // Failed or the same track has been given twice
+            continue;
+        }
+        pTrack->initId(trackId);
+        // Only the inserted tracks must be marked as clean, not
+        // existing ones or duplicates, see addTracksAddTrack()
+        if (trackIndexByLocation.value(pTrack->getLocation()) == i &&
+                newTrackIdSet.contains(trackId)) {
+            pTrack->markClean();
+        }
+    }
+
+    qDebug() << "TrackDAO: Added" << newTrackIds.size() << "of"
+             << tracks.size() << "tracks in"
+             << timer.elapsed().formatMillisWithUnit();
+
+    if (m_pTransaction) {
+        // Reported by addTracksFinish()
+        m_tracksAddedSet.unite(newTrackIdSet);
+    } else {
+        // A single notification for all new tracks
+        emit(tracksAdded(newTrackIdSet));
+    }
+    return result;
+}
+
 bool TrackDAO::onHidingTracks(
         const QList<TrackId>& trackIds) {
     QStringList idList;
@@ -998,10 +1298,9 @@ void TrackDAO::slotTrackReferenceExpired(Track* pTrack) {
         saveTrack(pTrack);
     }
 
-    // Delete Track from weak reference cache
-    m_sTracksMutex.lock();
-    m_sTracks.remove(pTrack->getId());
-    m_sTracksMutex.unlock();
+    // Delete Track from weak reference cache unless it has already
+    // been replaced by a new instance
+    m_sTracks.removeExpired(pTrack->getId());
 
     delete pTrack;
 }
@@ -1436,12 +1735,8 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
             this, SLOT(slotTrackReferenceExpired(Track*)),
             Qt::QueuedConnection);
 
-    m_sTracksMutex.lock();
-    // Automatic conversion to a weak pointer
-    m_sTracks[trackId] = pTrack;
-    //int trackCount = m_sTracks.count();
-    m_sTracksMutex.unlock();
-    //qDebug() << "TrackDAO::m_sTracks.count() =" << trackCount;
+    m_sTracks.insert(trackId, pTrack);
+    //qDebug() << "TrackDAO::m_sTracks.size() =" << m_sTracks.size();
 
     // Insert the loaded track into the recent tracks cache
     cacheRecentTrack(trackId, pTrack);
@@ -1489,14 +1784,7 @@ TrackPointer TrackDAO::getTrack(TrackId trackId, const bool cacheOnly) const {
     // strong reference somewhere. It's possible that something is currently
     // using this track so its reference count is non-zero despite it not being
     // present in the track cache.
-    QMutexLocker locker(&m_sTracksMutex);
-    QHash<TrackId, TrackWeakPointer>::iterator it = m_sTracks.find(trackId);
-    if (it != m_sTracks.end()) {
-        //qDebug() << "Returning cached TIO for track" << id;
-        pTrack = TrackPointer(it.value());
-    }
-    // Unlock the track cache mutex. Otherwise we can deadlock.
-    locker.unlock();
+    pTrack = m_sTracks.lookup(trackId);
 
     // If we were able to convert a weak reference to a strong reference then
     // re-insert it into the recent tracks cache so that its least-recently-used
@@ -1613,6 +1901,43 @@ void TrackDAO::invalidateTrackLocationsInLibrary() {
     }
 }
 
+void TrackDAO::invalidateTrackLocationsInDirectories(
+        const QStringList& directories) {
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE track_locations "
+                "SET needs_verification=1 "
+                "WHERE directory IN (%1)").arg(
+                        SqlStringFormatter::formatList(m_database, directories)));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark tracks in" << directories.size()
+                << "directories as needing verification.";
+    }
+}
+
+void TrackDAO::invalidateTrackLocationsInDirectoryTrees(
+        const QStringList& directories) {
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE track_locations "
+                "SET needs_verification=1 "
+                "WHERE directory=:directory "
+                "OR directory LIKE :subdirectories ESCAPE '%1'")
+        .arg(kSqlLikeMatchAll));
+    for (const auto& directory: directories) {
+        query.bindValue(":directory", directory);
+        query.bindValue(":subdirectories",
+                SqlLikeWildcardEscaper::apply(directory + "/", kSqlLikeMatchAll) +
+                        kSqlLikeMatchAll);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query)
+                    << "Couldn't mark tracks below" << directory
+                    << "as needing verification.";
+        }
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
@@ -1997,11 +2322,8 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
         "WHERE id=:track_id");
 
 
-    QRegExp coverArtFilenames(CoverArtUtils::supportedCoverArtExtensionsRegex(),
-                              Qt::CaseInsensitive);
-    QString currentDirectoryPath;
     MDir currentDirectory;
-    QLinkedList<QFileInfo> possibleCovers;
+    CoverArtFolder currentFolder;
 
     for (const auto& track: tracksWithoutCover) {
         if (*pCancel) {
@@ -2036,16 +2358,13 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
             continue;
         }
 
-        if (track.directoryPath != currentDirectoryPath) {
-            possibleCovers.clear();
-            currentDirectoryPath = track.directoryPath;
-            currentDirectory = MDir(currentDirectoryPath);
-            possibleCovers = CoverArtUtils::findPossibleCoversInFolder(
-                currentDirectoryPath);
+        if (track.directoryPath != currentFolder.folder()) {
+            currentDirectory = MDir(track.directoryPath);
+            currentFolder = CoverArtFolder(track.directoryPath);
         }
 
-        CoverInfoRelative coverInfo = CoverArtUtils::selectCoverArtForTrack(
-            trackInfo.baseName(), track.trackAlbum, possibleCovers);
+        CoverInfoRelative coverInfo = currentFolder.selectCoverArtForTrack(
+            trackInfo.baseName(), track.trackAlbum);
 
         updateQuery.bindValue(":coverart_type",
                               static_cast<int>(coverInfo.type));
@@ -2084,9 +2403,11 @@ TrackPointer TrackDAO::getOrAddTrack(const QString& trackLocation,
     }
 
     // If the track wasn't in the library already then it has not yet been
-    // checked for cover art. If processCoverArt is true then we should request
+    // checked for cover art, unless the file tags have been parsed while
+    // adding it. If processCoverArt is true then we should request
     // cover processing via CoverArtCache asynchronously.
-    if (processCoverArt && !trackAlreadyInLibrary) {
+    if (processCoverArt && !trackAlreadyInLibrary &&
+            pTrack->getCoverInfo().source == CoverInfo::UNKNOWN) {
         CoverArtCache* pCache = CoverArtCache::instance();
         if (pCache != nullptr) {
             pCache->requestGuessCover(pTrack);
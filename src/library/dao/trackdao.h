@@ -13,7 +13,10 @@
 #include <QString>
 
 #include "preferences/usersettings.h"
+#include "library/coverartutils.h"
+#include "library/coverthumbnailstore.h"
 #include "library/dao/dao.h"
+#include "library/dao/weaktrackcache.h"
 #include "track/track.h"
 #include "util/class.h"
 #include "util/memory.h"
@@ -23,6 +26,7 @@ class PlaylistDAO;
 class AnalysisDao;
 class CueDAO;
 class LibraryHashDAO;
+class TrackMetadataWriter;
 
 // Holds a strong reference to a track while it is in the "recent tracks"
 // cache. Once it expires from the cache it signals to
@@ -67,6 +71,12 @@ class TrackDAO : public QObject, public virtual DAO {
     }
     void finish();
 
+    // Writes modified track metadata into the files asynchronously
+    // instead of when saving a track. Must outlive this TrackDAO.
+    void setMetadataWriter(TrackMetadataWriter* pMetadataWriter) {
+        m_pMetadataWriter = pMetadataWriter;
+    }
+
     TrackId getTrackId(const QString& absoluteFilePath);
     QList<TrackId> getTrackIds(const QList<QFileInfo>& files);
     QList<TrackId> getTrackIds(const QDir& dir);
@@ -83,6 +93,22 @@ class TrackDAO : public QObject, public virtual DAO {
     TrackPointer addSingleTrack(const QFileInfo& fileInfo, bool unremove);
     QList<TrackId> addMultipleTracks(const QList<QFileInfo>& fileInfoList, bool unremove);
 
+    // Adds many tracks with multi-row INSERT statements. All columns
+    // are filled like in addTracksAddTrack(). Tracks that are already
+    // in the library are not updated, but unremoved if requested.
+    // Returns the ids of all given tracks in the same order. Failed
+    // tracks have an invalid id.
+    // If invoked between addTracksPrepare() and addTracksFinish() the
+    // tracks are added within that transaction and reported by
+    // addTracksFinish(). Otherwise the tracks are added in a separate
+    // transaction and a single tracksAdded() signal is emitted.
+    QList<TrackId> addTracksBulk(const QList<TrackPointer>& tracks, bool unremove);
+
+    // Creates a new track for a supported file and reads its metadata
+    // and cover art, without adding it to the library. Returns a null
+    // pointer for unsupported files.
+    TrackPointer newTrackFromFile(const QFileInfo& fileInfo);
+
     void addTracksPrepare();
     TrackPointer addTracksAddFile(const QFileInfo& fileInfo, bool unremove);
     TrackId addTracksAddTrack(const TrackPointer& pTrack, bool unremove);
@@ -119,6 +145,8 @@ class TrackDAO : public QObject, public virtual DAO {
     void markTrackLocationsAsVerified(const QStringList& locations);
     void markTracksInDirectoriesAsVerified(const QStringList& directories);
     void invalidateTrackLocationsInLibrary();
+    void invalidateTrackLocationsInDirectories(const QStringList& directories);
+    void invalidateTrackLocationsInDirectoryTrees(const QStringList& directories);
     void markUnverifiedTracksAsDeleted();
     void markTrackLocationsAsDeleted(const QString& directory);
     bool detectMovedTracks(QSet<TrackId>* pTracksMovedSetOld,
@@ -173,6 +201,11 @@ class TrackDAO : public QObject, public virtual DAO {
     void saveTrack(Track* pTrack);
     bool updateTrack(Track* pTrack);
 
+    // Guesses the cover art from the folder of a new track if no cover
+    // art is embedded in its file tags and stores thumbnails.
+    void guessCoverArtForNewTrack(const TrackPointer& pTrack,
+            const QFileInfo& fileInfo, const QImage& embeddedCoverImage);
+
     QSqlDatabase m_database;
 
     CueDAO& m_cueDao;
@@ -181,10 +214,9 @@ class TrackDAO : public QObject, public virtual DAO {
     LibraryHashDAO& m_libraryHashDao;
 
     UserSettingsPointer m_pConfig;
-    // Mutex that protects m_sTracks.
-    static QMutex m_sTracksMutex;
+    TrackMetadataWriter* m_pMetadataWriter;
     // Weak pointer cache of active tracks.
-    static QHash<TrackId, TrackWeakPointer> m_sTracks;
+    static WeakTrackCache m_sTracks;
 
     void cacheRecentTrack(
             TrackId trackId,
@@ -211,6 +243,13 @@ class TrackDAO : public QObject, public virtual DAO {
 
     QSet<TrackId> m_tracksAddedSet;
 
+    // The folder of the most recently added track. The scanner adds tracks
+    // folder by folder, so each folder is only listed once while guessing
+    // the cover art of new tracks. Only valid between addTracksPrepare()
+    // and addTracksFinish(), both reset it.
+    CoverArtFolder m_coverArtFolder;
+    CoverThumbnailStore m_thumbnailStore;
+
     DISALLOW_COPY_AND_ASSIGN(TrackDAO);
 };
 
@@ -0,0 +1,56 @@
+#include "library/dao/weaktrackcache.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+TrackPointer WeakTrackCache::lookup(TrackId trackId) const {
+    const Shard& s = shard(trackId);
+    QReadLocker locker(&s.lock);
+    const auto it = s.tracks.constFind(trackId);
+    if (it == s.tracks.constEnd()) {
+        return TrackPointer();
+    }
+    // Converting the weak reference into a strong reference is
+    // thread-safe and may happen while other readers hold the lock.
+    return TrackPointer(it.value());
+}
+
+void WeakTrackCache::insert(TrackId trackId, const TrackPointer& pTrack) {
+    Shard& s = shard(trackId);
+    QWriteLocker locker(&s.lock);
+    // Automatic conversion to a weak pointer
+    s.tracks.insert(trackId, pTrack);
+}
+
+void WeakTrackCache::removeExpired(TrackId trackId) {
+    Shard& s = shard(trackId);
+    QWriteLocker locker(&s.lock);
+    const auto it = s.tracks.find(trackId);
+    if ((it != s.tracks.end()) && it.value().expired()) {
+        s.tracks.erase(it);
+    }
+}
+
+QList<TrackPointer> WeakTrackCache::takeAll() {
+    QList<TrackPointer> tracks;
+    for (auto& s: m_shards) {
+        QWriteLocker locker(&s.lock);
+        for (const auto& pWeakTrack: s.tracks) {
+            TrackPointer pTrack(pWeakTrack);
+            if (pTrack) {
+                tracks.append(pTrack);
+            }
+        }
+        s.tracks.clear();
+    }
+    return tracks;
+}
+
+int WeakTrackCache::size() const {
+    int size = 0;
+    for (const auto& s: m_shards) {
+        QReadLocker locker(&s.lock);
+        size += s.tracks.size();
+    }
+    return size;
+}
@@ -0,0 +1,58 @@
+#ifndef WEAKTRACKCACHE_H
+#define WEAKTRACKCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+
+#include "track/track.h"
+#include "track/trackid.h"
+#include "util/class.h"
+
+// Thread-safe map of all track objects that are currently in use,
+// indexed by their id. Only weak references are stored, i.e. the cache
+// itself does not keep tracks alive.
+//
+// The map is split into shards that are locked independently. Lookups
+// of different tracks usually don't contend and concurrent lookups of
+// tracks within the same shard only share a read lock.
+class WeakTrackCache {
+  public:
+    WeakTrackCache() = default;
+
+    // Returns the track if it is cached and still alive.
+    TrackPointer lookup(TrackId trackId) const;
+
+    // Adds the track or replaces an existing entry.
+    void insert(TrackId trackId, const TrackPointer& pTrack);
+
+    // Removes the entry for an expired track. A track that has been
+    // cached for the same id in the meantime is kept.
+    void removeExpired(TrackId trackId);
+
+    // Removes all entries and returns the tracks that are still alive.
+    QList<TrackPointer> takeAll();
+
+    int size() const;
+
+  private:
+    static const int kShardCount = 16;
+
+    struct Shard {
+        mutable QReadWriteLock lock;
+        QHash<TrackId, TrackWeakPointer> tracks;
+    };
+
+    Shard& shard(TrackId trackId) {
+        return m_shards[qHash(trackId) % kShardCount];
+    }
+    const Shard& shard(TrackId trackId) const {
+        return m_shards[qHash(trackId) % kShardCount];
+    }
+
+    Shard m_shards[kShardCount];
+
+    DISALLOW_COPY_AND_ASSIGN(WeakTrackCache);
+};
+
+#endif // WEAKTRACKCACHE_H
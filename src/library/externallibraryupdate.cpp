@@ -0,0 +1,213 @@
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include "library/externallibraryupdate.h"
+
+#include "library/dao/settingsdao.h"
+#include "library/queryutil.h"
+#include "util/assert.h"
+
+namespace {
+
+const qint64 kHashBufferSize = 64 * 1024;
+
+const char kRowValueSeparator = '\x1f';
+
+} // anonymous namespace
+
+ExternalLibraryFileState::ExternalLibraryFileState(
+        const QSqlDatabase& database,
+        const QString& settingsKey,
+        const QString& filePath)
+        : m_database(database),
+          m_settingsKey(settingsKey),
+          m_filePath(filePath) {
+    QFileInfo fileInfo(m_filePath);
+    m_fileSize = fileInfo.size();
+    m_lastModified = fileInfo.lastModified();
+}
+
+bool ExternalLibraryFileState::isUnchanged() {
+    SettingsDAO settings(m_database);
+    if (settings.getValue(m_settingsKey + ".path") != m_filePath) {
+        return false;
+    }
+    if (settings.getValue(m_settingsKey + ".size").toLongLong() != m_fileSize) {
+        return false;
+    }
+    if (settings.getValue(m_settingsKey + ".modified").toLongLong() ==
+            m_lastModified.toMSecsSinceEpoch()) {
+        return true;
+    }
+    // The file has been touched, but its contents might still be
+    // the same.
+    // The hash is calculated even if none has been stored yet,
+    // so that save() can store it for the next comparison.
+    const QString hash = QString::fromLatin1(contentHash().toHex());
+    const QString storedHash = settings.getValue(m_settingsKey + ".hash");
+    if (storedHash.isEmpty() || (storedHash != hash)) {
+        return false;
+    }
+    // The caller skips the import and does not save(). Store the new
+    // modification time, so the file is not hashed again next time.
+    save();
+    return true;
+}
+
+void ExternalLibraryFileState::save() {
+    QFileInfo fileInfo(m_filePath);
+    if ((fileInfo.size() != m_fileSize) ||
+            (fileInfo.lastModified() != m_lastModified)) {
+        qDebug() << "Not storing state of external library file"
+                 << m_filePath << "that has been modified while importing";
+        return;
+    }
+    SettingsDAO settings(m_database);
+    settings.setValue(m_settingsKey + ".path", m_filePath);
+    settings.setValue(m_settingsKey + ".size", m_fileSize);
+    settings.setValue(m_settingsKey + ".modified",
+            m_lastModified.toMSecsSinceEpoch());
+    // The hash is only available if it has been needed by isUnchanged().
+    // Otherwise an outdated hash is removed.
+    settings.setValue(m_settingsKey + ".hash",
+            QString::fromLatin1(m_contentHash.toHex()));
+}
+
+QByteArray ExternalLibraryFileState::contentHash() {
+    if (!m_contentHash.isEmpty()) {
+        return m_contentHash;
+    }
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open external library file" << m_filePath;
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (!file.atEnd()) {
+        const QByteArray buffer = file.read(kHashBufferSize);
+        if (buffer.isEmpty()) {
+            // Read error
+            return QByteArray();
+        }
+        hash.addData(buffer);
+    }
+    m_contentHash = hash.result();
+    return m_contentHash;
+}
+
+ExternalTrackTableUpdater::ExternalTrackTableUpdater(
+        const QSqlDatabase& database,
+        const QString& tableName,
+        const QString& keyColumn,
+        const QStringList& columns)
+        : m_tableName(tableName),
+          m_keyColumn(keyColumn),
+          m_keyIndex(columns.indexOf(keyColumn)),
+          m_insertRows(database, "INSERT INTO " + tableName, columns),
+          m_updateQuery(database),
+          m_deleteQuery(database),
+          m_updatedRows(0),
+          m_removedRows(0) {
+    DEBUG_ASSERT(m_keyIndex >= 0);
+
+    QSqlQuery selectQuery(database);
+    selectQuery.setForwardOnly(true);
+    if (selectQuery.exec(QString("SELECT %1 FROM %2").arg(
+            columns.join(","), m_tableName))) {
+        QVariantList values;
+        while (selectQuery.next()) {
+            values.clear();
+            for (int i = 0; i < columns.size(); ++i) {
+                values << selectQuery.value(i);
+            }
+            m_rowDigests.insert(
+                    values.at(m_keyIndex).toString(),
+                    rowDigest(values));
+        }
+    } else {
+        LOG_FAILED_QUERY(selectQuery);
+    }
+
+    QStringList assignments;
+    for (const auto& column: columns) {
+        assignments << column + "=?";
+    }
+    m_updateQuery.prepare(QString("UPDATE %1 SET %2 WHERE %3=?").arg(
+            m_tableName, assignments.join(","), m_keyColumn));
+    m_deleteQuery.prepare(QString("DELETE FROM %1 WHERE %2=?").arg(
+            m_tableName, m_keyColumn));
+}
+
+ExternalTrackTableUpdater::~ExternalTrackTableUpdater() {
+    // The rows of a partially parsed file are kept like
+    // the updated rows
+    flush();
+}
+
+bool ExternalTrackTableUpdater::applyRow(const QVariantList& values) {
+    const QString key = values.at(m_keyIndex).toString();
+    if (m_appliedKeys.contains(key)) {
+        // Duplicate entries in the external library file
+        return true;
+    }
+    m_appliedKeys.insert(key);
+
+    const auto i = m_rowDigests.constFind(key);
+    if (i == m_rowDigests.constEnd()) {
+        return m_insertRows.addRow(values);
+    }
+    if (i.value() == rowDigest(values)) {
+        return true;
+    }
+    for (int j = 0; j < values.size(); ++j) {
+        m_updateQuery.bindValue(j, values.at(j));
+    }
+    m_updateQuery.bindValue(values.size(), values.at(m_keyIndex));
+    if (!m_updateQuery.exec()) {
+        LOG_FAILED_QUERY(m_updateQuery);
+        return false;
+    }
+    ++m_updatedRows;
+    return true;
+}
+
+bool ExternalTrackTableUpdater::flush() {
+    return m_insertRows.flush();
+}
+
+bool ExternalTrackTableUpdater::removeUnappliedRows() {
+    bool success = flush();
+    for (auto i = m_rowDigests.constBegin(); i != m_rowDigests.constEnd(); ++i) {
+        if (m_appliedKeys.contains(i.key())) {
+            continue;
+        }
+        m_deleteQuery.bindValue(0, i.key());
+        if (m_deleteQuery.exec()) {
+            ++m_removedRows;
+        } else {
+            LOG_FAILED_QUERY(m_deleteQuery);
+            success = false;
+        }
+    }
+    return success;
+}
+
+// static
+QByteArray ExternalTrackTableUpdater::rowDigest(const QVariantList& values) {
+    // Values are compared by their string representation, because
+    // values read from the database might have a different type than
+    // the parsed values, e.g. qlonglong instead of int.
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (const auto& value: values) {
+        if ((value.type() == QVariant::Double) ||
+                (static_cast<QMetaType::Type>(value.type()) == QMetaType::Float)) {
+            hash.addData(QString::number(value.toDouble(), 'g', 15).toUtf8());
+        } else {
+            hash.addData(value.toString().toUtf8());
+        }
+        hash.addData(&kRowValueSeparator, 1);
+    }
+    return hash.result();
+}
@@ -0,0 +1,126 @@
+#ifndef EXTERNALLIBRARYUPDATE_H
+#define EXTERNALLIBRARYUPDATE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+#include "util/db/sqlmultirowinsert.h"
+
+// Detects if the library file of an external application, e.g. the
+// iTunes XML or the Traktor NML file, has been modified since it has
+// been imported the last time. The size, modification time and a
+// content hash of the file are stored in the settings table.
+//
+// The content hash is only calculated by isUnchanged() if the
+// modification time has changed while the size is still the same,
+// i.e. when the file might have been rewritten by the application
+// without modifying it. save() stores the hash only if it has been
+// calculated, so the first rewrite after an import is always treated
+// as a modification.
+class ExternalLibraryFileState {
+  public:
+    ExternalLibraryFileState(
+            const QSqlDatabase& database,
+            const QString& settingsKey,
+            const QString& filePath);
+
+    const QString& filePath() const {
+        return m_filePath;
+    }
+    qint64 fileSize() const {
+        return m_fileSize;
+    }
+
+    // Returns true if the file has been imported before and has not
+    // been modified since. The state of a file that has only been
+    // touched is saved, so the caller does not need to save().
+    bool isUnchanged();
+
+    // Stores the state of the file after it has been imported
+    // successfully. Nothing is stored if the file has been modified
+    // in the meantime.
+    void save();
+
+  private:
+    QByteArray contentHash();
+
+    const QSqlDatabase m_database;
+    const QString m_settingsKey;
+    const QString m_filePath;
+    qint64 m_fileSize;
+    QDateTime m_lastModified;
+    QByteArray m_contentHash;
+};
+
+// Updates the table of an external library with the rows parsed from
+// the external library file. Only new, modified and removed rows are
+// written to the database. Rows are identified by a key column that
+// is stable between imports, e.g. the track id of iTunes or the
+// location of Traktor and Rhythmbox. The ids of existing rows are
+// preserved. New rows are buffered and inserted with multi-row
+// INSERT statements.
+//
+// The caller is responsible for wrapping the update into a transaction.
+class ExternalTrackTableUpdater {
+  public:
+    // The key column must be contained in the columns.
+    ExternalTrackTableUpdater(
+            const QSqlDatabase& database,
+            const QString& tableName,
+            const QString& keyColumn,
+            const QStringList& columns);
+    // Inserts the buffered new rows
+    ~ExternalTrackTableUpdater();
+
+    // Inserts or updates a single row with one value per column.
+    bool applyRow(const QVariantList& values);
+
+    // Inserts the buffered new rows. Must be invoked before the
+    // new rows are read from the table.
+    bool flush();
+
+    // Inserts the buffered new rows and deletes all rows that have
+    // not been applied since the construction. Must only be invoked
+    // after the external library file has been parsed completely.
+    bool removeUnappliedRows();
+
+    int appliedRows() const {
+        return m_appliedKeys.size();
+    }
+    int insertedRows() const {
+        return m_insertRows.insertedRows();
+    }
+    int updatedRows() const {
+        return m_updatedRows;
+    }
+    int removedRows() const {
+        return m_removedRows;
+    }
+
+  private:
+    static QByteArray rowDigest(const QVariantList& values);
+
+    const QString m_tableName;
+    const QString m_keyColumn;
+    const int m_keyIndex;
+
+    SqlMultiRowInsert m_insertRows;
+    QSqlQuery m_updateQuery;
+    QSqlQuery m_deleteQuery;
+
+    // The digests of all rows that existed before the update
+    QHash<QString, QByteArray> m_rowDigests;
+    QSet<QString> m_appliedKeys;
+
+    int m_updatedRows;
+    int m_removedRows;
+};
+
+#endif // EXTERNALLIBRARYUPDATE_H
@@ -14,11 +14,39 @@
 #include "library/dao/settingsdao.h"
 #include "library/baseexternaltrackmodel.h"
 #include "library/baseexternalplaylistmodel.h"
+#include "library/externallibraryupdate.h"
 #include "library/queryutil.h"
 #include "util/lcs.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
 #include "util/sandbox.h"
 
 const QString ITunesFeature::ITDB_PATH_KEY = "mixxx.itunesfeature.itdbpath";
+const QString ITunesFeature::ITDB_STATE_KEY = "mixxx.itunesfeature.itdbstate";
+
+namespace {
+
+// The rows are identified by the persistent id of iTunes. The track
+// ids of iTunes are not stable and may change with every export. The
+// column "id" is assigned by the database.
+const QStringList kTrackColumns = QStringList()
+        << "persistent_id"
+        << "artist"
+        << "title"
+        << "album"
+        << "album_artist"
+        << "year"
+        << "genre"
+        << "grouping"
+        << "comment"
+        << "tracknumber"
+        << "bpm"
+        << "bitrate"
+        << "duration"
+        << "location"
+        << "rating";
+
+} // anonymous namespace
 
 QString localhost_token() {
 #if defined(__WINDOWS__)
@@ -30,8 +58,24 @@ QString localhost_token() {
 
 ITunesFeature::ITunesFeature(QObject* parent, TrackCollection* pTrackCollection)
         : BaseExternalLibraryFeature(parent, pTrackCollection),
+          m_pITunesTrackModel(nullptr),
+          m_pITunesPlaylistModel(nullptr),
           m_pTrackCollection(pTrackCollection),
           m_cancelImport(false) {
+    m_isActivated = false;
+    m_title = tr("iTunes");
+    connect(&m_future_watcher, SIGNAL(finished()), this, SLOT(onTrackCollectionLoaded()));
+}
+
+ITunesFeature::~ITunesFeature() {
+    m_database.close();
+    m_cancelImport = true;
+    m_future.waitForFinished();
+    delete m_pITunesTrackModel;
+    delete m_pITunesPlaylistModel;
+}
+
+void ITunesFeature::initialize() {
     QString tableName = "itunes_library";
     QString idColumn = "id";
     QStringList columns;
@@ -65,24 +109,13 @@ ITunesFeature::ITunesFeature(QObject* parent, TrackCollection* pTrackCollection)
         "itunes_playlists",
         "itunes_playlist_tracks",
         m_trackSource);
-    m_isActivated = false;
-    m_title = tr("iTunes");
 
-    m_database = QSqlDatabase::cloneDatabase(pTrackCollection->database(), "ITUNES_SCANNER");
+    m_database = QSqlDatabase::cloneDatabase(m_pTrackCollection->database(), "ITUNES_SCANNER");
 
     //Open the database connection in this thread.
     if (!m_database.open()) {
         qDebug() << "Failed to open database for iTunes scanner." << m_database.lastError();
     }
-    connect(&m_future_watcher, SIGNAL(finished()), this, SLOT(onTrackCollectionLoaded()));
-}
-
-ITunesFeature::~ITunesFeature() {
-    m_database.close();
-    m_cancelImport = true;
-    m_future.waitForFinished();
-    delete m_pITunesTrackModel;
-    delete m_pITunesPlaylistModel;
 }
 
 BaseSqlTableModel* ITunesFeature::getPlaylistModelForPlaylist(QString playlist) {
@@ -321,26 +354,55 @@ void ITunesFeature::guessMusicLibraryMountpoint(QXmlStreamReader &xml) {
              << m_dbItunesRoot << "->" << m_mixxxItunesRoot;
 }
 
+bool ITunesFeature::findMusicFolder() {
+    // In some iTunes files the "Music Folder" key is located at the end
+    // of the file after all tracks and playlists. Only the keys need to
+    // be read, which is much faster than importing the tracks.
+    QFile itunes_file(m_dbfile);
+    if (!itunes_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    QXmlStreamReader xml(&itunes_file);
+    while (!xml.atEnd() && !m_cancelImport) {
+        xml.readNext();
+        if (xml.isStartElement() && xml.name() == "key" &&
+                xml.readElementText() == "Music Folder") {
+            if (readNextStartElement(xml)) {
+                guessMusicLibraryMountpoint(xml);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 // This method is executed in a separate thread
 // via QtConcurrent::run
 TreeItem* ITunesFeature::importLibrary() {
-    bool isTracksParsed=false;
-    bool isMusicFolderLocatedAfterTracks=false;
+    bool isTracksComplete=false;
+    bool isMusicFolderParsed=false;
   
     //Give thread a low priority
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
 
-    //Delete all table entries of iTunes feature
-    ScopedTransaction transaction(m_database);
-    clearTable("itunes_playlist_tracks");
-    clearTable("itunes_library");
-    clearTable("itunes_playlists");
-    transaction.commit();
+    // Parsing a large iTunes library takes a long time. Skip it
+    // entirely if the file has not been modified since the last import.
+    ExternalLibraryFileState fileState(m_database, ITDB_STATE_KEY, m_dbfile);
+    if (fileState.isUnchanged()) {
+        qDebug() << "iTunes library has not been modified since the last import";
+        return loadPlaylists();
+    }
 
     qDebug() << "ITunesFeature::importLibrary() ";
+    PerformanceTimer timer;
+    timer.start();
 
-    transaction.transaction();
+    // Playlists are rebuilt from scratch. The tracks in itunes_library
+    // are updated incrementally while parsing.
+    ScopedTransaction transaction(m_database);
+    clearTable("itunes_playlist_tracks");
+    clearTable("itunes_playlists");
 
     // By default set m_mixxxItunesRoot and m_dbItunesRoot to strip out
     // file://localhost/ from the URL. When we load the user's iTunes XML
@@ -365,36 +427,26 @@ TreeItem* ITunesFeature::importLibrary() {
             if (xml.name() == "key") {
                 QString key = xml.readElementText();
                 if (key == "Music Folder") {
-                    if (isTracksParsed) isMusicFolderLocatedAfterTracks = true;
-                    if (readNextStartElement(xml)) {
+                    if (!isMusicFolderParsed && readNextStartElement(xml)) {
                         guessMusicLibraryMountpoint(xml);
                     }
+                    isMusicFolderParsed = true;
                 } else if (key == "Tracks") {
-                    parseTracks(xml);
+                    // The locations of the tracks must be translated
+                    // before they are compared with the stored rows
+                    if (!isMusicFolderParsed) {
+                        isMusicFolderParsed = findMusicFolder();
+                    }
+                    isTracksComplete = parseTracks(xml);
                     if (playlist_root != NULL)
                         delete playlist_root;
                     playlist_root = parsePlaylists(xml);
-                    isTracksParsed = true;
                 }
             }
         }
     }
 
     itunes_file.close();
-    
-    if (isMusicFolderLocatedAfterTracks) {
-        qDebug() << "Updating iTunes real path from " << m_dbItunesRoot << " to " << m_mixxxItunesRoot;
-        // In some iTunes files "Music Folder" XML node is located at the end of file. So, we need to 
-        QSqlQuery query(m_database);
-        query.prepare("UPDATE itunes_library SET location = replace( location, :itunes_path, :mixxx_path )");
-        query.bindValue(":itunes_path", m_dbItunesRoot.replace(localhost_token(), ""));
-        query.bindValue(":mixxx_path", m_mixxxItunesRoot);
-        bool success = query.exec();
-
-        if (!success) {
-            LOG_FAILED_QUERY(query);
-        }
-    }
 
     // Even if an error occurred, commit the transaction. The file may have been
     // half-parsed.
@@ -407,58 +459,107 @@ TreeItem* ITunesFeature::importLibrary() {
         if (playlist_root)
             delete playlist_root;
         playlist_root = NULL;
+    } else if (isTracksComplete && !m_cancelImport) {
+        fileState.save();
     }
+
+    const mixxx::Duration elapsed = timer.elapsed();
+    qDebug() << "Parsed" << fileState.fileSize() << "bytes of iTunes library in"
+             << elapsed.formatMillisWithUnit() << "with"
+             << fileState.fileSize() / math_max(elapsed.toDoubleSeconds(), 0.001) / (1024 * 1024)
+             << "MiB/s";
     return playlist_root;
 }
 
-void ITunesFeature::parseTracks(QXmlStreamReader &xml) {
-    bool in_container_dictionary = false;
-    bool in_track_dictionary = false;
+TreeItem* ITunesFeature::loadPlaylists() {
+    TreeItem* rootItem = new TreeItem(this);
     QSqlQuery query(m_database);
-    query.prepare("INSERT INTO itunes_library (id, artist, title, album, album_artist, year, genre, grouping, comment, tracknumber,"
-                  "bpm, bitrate,"
-                  "duration, location,"
-                  "rating ) "
-                  "VALUES (:id, :artist, :title, :album, :album_artist, :year, :genre, :grouping, :comment, :tracknumber,"
-                  ":bpm, :bitrate,"
-                  ":duration, :location," ":rating )");
-
-    qDebug() << "Parse iTunes music collection";
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT name FROM itunes_playlists ORDER BY id")) {
+        LOG_FAILED_QUERY(query);
+        delete rootItem;
+        return NULL;
+    }
+    while (query.next()) {
+        rootItem->appendChild(query.value(0).toString());
+    }
+    return rootItem;
+}
 
-    //read all sunsequent <dict> until we reach the closing ENTRY tag
-    while (!xml.atEnd() && !m_cancelImport) {
-        xml.readNext();
+bool ITunesFeature::parseTracks(QXmlStreamReader &xml) {
+    bool in_container_dictionary = false;
+    bool in_track_dictionary = false;
+    bool isTracksComplete = false;
+    QHash<int, QString> persistentIds;
+    {
+        ExternalTrackTableUpdater updater(m_database, "itunes_library", "persistent_id", kTrackColumns);
+
+        qDebug() << "Parse iTunes music collection";
+
+        //read all sunsequent <dict> until we reach the closing ENTRY tag
+        while (!xml.atEnd() && !m_cancelImport) {
+            xml.readNext();
+
+            if (xml.isStartElement()) {
+                if (xml.name() == "dict") {
+                    if (!in_track_dictionary && !in_container_dictionary) {
+                        in_container_dictionary = true;
+                        continue;
+                    } else if (in_container_dictionary && !in_track_dictionary) {
+                        //We are in a <dict> tag that holds track information
+                        in_track_dictionary = true;
+                        //Parse track here
+                        parseTrack(xml, &updater, &persistentIds);
+                    }
+                }
+            }
 
-        if (xml.isStartElement()) {
-            if (xml.name() == "dict") {
-                if (!in_track_dictionary && !in_container_dictionary) {
-                    in_container_dictionary = true;
+            if (xml.isEndElement() && xml.name() == "dict") {
+                if (in_track_dictionary && in_container_dictionary) {
+                    in_track_dictionary = false;
                     continue;
                 } else if (in_container_dictionary && !in_track_dictionary) {
-                    //We are in a <dict> tag that holds track information
-                    in_track_dictionary = true;
-                    //Parse track here
-                    parseTrack(xml, query);
+                    // Done parsing tracks. Only now it is safe to remove
+                    // the tracks that have been deleted in iTunes.
+                    updater.removeUnappliedRows();
+                    qDebug() << "iTunes tracks:" << updater.appliedRows()
+                             << "total," << updater.insertedRows() << "added,"
+                             << updater.updatedRows() << "updated,"
+                             << updater.removedRows() << "removed";
+                    isTracksComplete = true;
+                    break;
                 }
             }
         }
+    }
 
-        if (xml.isEndElement() && xml.name() == "dict") {
-            if (in_track_dictionary && in_container_dictionary) {
-                in_track_dictionary = false;
-                continue;
-            } else if (in_container_dictionary && !in_track_dictionary) {
-                // Done parsing tracks.
-                in_container_dictionary = false;
-                break;
+    // The playlists refer to the tracks by their track ids in
+    // this file, which need to be mapped onto the rows
+    m_trackRowIds.clear();
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (query.exec("SELECT persistent_id, id FROM itunes_library")) {
+        QHash<QString, int> rowIds;
+        while (query.next()) {
+            rowIds.insert(query.value(0).toString(), query.value(1).toInt());
+        }
+        for (auto i = persistentIds.constBegin(); i != persistentIds.constEnd(); ++i) {
+            const auto rowId = rowIds.constFind(i.value());
+            if (rowId != rowIds.constEnd()) {
+                m_trackRowIds.insert(i.key(), rowId.value());
             }
         }
+    } else {
+        LOG_FAILED_QUERY(query);
     }
+    return isTracksComplete;
 }
 
-void ITunesFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+void ITunesFeature::parseTrack(QXmlStreamReader &xml, ExternalTrackTableUpdater* pUpdater,
+                               QHash<int, QString>* pPersistentIds) {
     //qDebug() << "----------------TRACK-----------------";
     int id = -1;
+    QString persistentId;
     QString title;
     QString artist;
     QString album;
@@ -496,6 +597,10 @@ void ITunesFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
                     id = content.toInt();
                     continue;
                 }
+                if (key == "Persistent ID") {
+                    persistentId = content;
+                    continue;
+                }
                 if (key == "Name") {
                     title = content;
                     continue;
@@ -578,30 +683,31 @@ void ITunesFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
         return;
     }
 
-    // If we reach the end of <dict>
-    // Save parsed track to database
-    query.bindValue(":id", id);
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":album_artist", album_artist);
-    query.bindValue(":genre", genre);
-    query.bindValue(":grouping", grouping);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-
-    if (!success) {
-        LOG_FAILED_QUERY(query);
-        return;
+    // Very old files don't contain persistent ids
+    if (persistentId.isEmpty()) {
+        persistentId = QString::number(id);
     }
+    pPersistentIds->insert(id, persistentId);
+
+    // If we reach the end of <dict>
+    // Save parsed track to database. The order of values must match
+    // kTrackColumns.
+    pUpdater->applyRow(QVariantList()
+            << persistentId
+            << artist
+            << title
+            << album
+            << album_artist
+            << year
+            << genre
+            << grouping
+            << comment
+            << tracknumber
+            << bpm
+            << bitrate
+            << playtime
+            << location
+            << rating);
 }
 
 TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader &xml) {
@@ -714,9 +820,14 @@ void ITunesFeature::parsePlaylist(QXmlStreamReader &xml, QSqlQuery &query_insert
 
                     readNextStartElement(xml);
                     track_reference = xml.readElementText().toInt();
+                    const int track_row_id = m_trackRowIds.value(track_reference, -1);
+                    if (track_row_id < 0) {
+                        // Remote or unknown track
+                        continue;
+                    }
 
                     query_insert_to_playlist_tracks.bindValue(":playlist_id", playlist_id);
-                    query_insert_to_playlist_tracks.bindValue(":track_id", track_reference);
+                    query_insert_to_playlist_tracks.bindValue(":track_id", track_row_id);
                     query_insert_to_playlist_tracks.bindValue(":position", playlist_position++);
 
                     //Insert tracks if we are not in a pre-build playlist
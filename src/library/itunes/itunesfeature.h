@@ -5,6 +5,7 @@
 #define ITUNESFEATURE_H
 
 #include <QStringListModel>
+#include <QHash>
 #include <QtSql>
 #include <QFuture>
 #include <QtConcurrentRun>
@@ -17,6 +18,7 @@
 
 class BaseExternalTrackModel;
 class BaseExternalPlaylistModel;
+class ExternalTrackTableUpdater;
 
 class ITunesFeature : public BaseExternalLibraryFeature {
     Q_OBJECT
@@ -30,6 +32,9 @@ class ITunesFeature : public BaseExternalLibraryFeature {
 
     TreeItemModel* getChildModel();
 
+  protected:
+    void initialize() override;
+
   public slots:
     void activate();
     void activate(bool forceReload);
@@ -43,9 +48,16 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     // returns the invisible rootItem for the sidebar model
     TreeItem* importLibrary();
     void guessMusicLibraryMountpoint(QXmlStreamReader &xml);
-    void parseTracks(QXmlStreamReader &xml);
-    void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    // Searches the whole file for the "Music Folder" key
+    bool findMusicFolder();
+    // Returns false if the tracks could not be parsed completely
+    bool parseTracks(QXmlStreamReader &xml);
+    void parseTrack(QXmlStreamReader &xml, ExternalTrackTableUpdater* pUpdater,
+                    QHash<int, QString>* pPersistentIds);
     TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    // Restores the child model from the database if the iTunes
+    // library has not been modified since the last import
+    TreeItem* loadPlaylists();
     void parsePlaylist(QXmlStreamReader &xml, QSqlQuery &query1,
                        QSqlQuery &query2, TreeItem*);
     void clearTable(QString table_name);
@@ -68,10 +80,14 @@ class ITunesFeature : public BaseExternalLibraryFeature {
 
     QString m_dbItunesRoot;
     QString m_mixxxItunesRoot;
+    // Maps the track ids of the imported file onto the ids
+    // of the rows in itunes_library
+    QHash<int, int> m_trackRowIds;
 
     QSharedPointer<BaseTrackCache> m_trackSource;
 
     static const QString ITDB_PATH_KEY;
+    static const QString ITDB_STATE_KEY;
 };
 
 #endif // ITUNESFEATURE_H
@@ -15,6 +15,7 @@
 #include "library/librarytablemodel.h"
 #include "library/sidebarmodel.h"
 #include "library/trackcollection.h"
+#include "library/trackmetadatawriter.h"
 #include "library/trackmodel.h"
 #include "library/browse/browsefeature.h"
 #include "library/crate/cratefeature.h"
@@ -28,6 +29,8 @@
 #include "library/traktor/traktorfeature.h"
 #include "library/librarycontrol.h"
 #include "library/setlogfeature.h"
+#include "library/scanner/librarywatcher.h"
+#include "control/controlobject.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/sandbox.h"
 #include "util/logger.h"
@@ -44,6 +47,8 @@ namespace {
 
 const mixxx::Logger kLogger("Library");
 
+const QString kMetadataWriterJournalFileName = "metadata_writeback.journal";
+
 } // anonymous namespace
 
 //static
@@ -74,7 +79,8 @@ Library::Library(
       m_pPlaylistFeature(nullptr),
       m_pCrateFeature(nullptr),
       m_pAnalysisFeature(nullptr),
-      m_scanner(pDbConnectionPool, m_pTrackCollection, pConfig) {
+      m_scanner(pDbConnectionPool, m_pTrackCollection, pConfig),
+      m_pLibraryWatcher(nullptr) {
 
     QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
 
@@ -94,6 +100,20 @@ Library::Library(
 
     m_pKeyNotation.reset(new ControlObject(ConfigKey(kConfigGroup, "key_notation")));
 
+    // Number of files with modified metadata that have not been
+    // written yet, for display in skins.
+    m_pMetadataWritesPending.reset(new ControlObject(
+            ConfigKey(kConfigGroup, "metadata_writes_pending")));
+    m_pMetadataWritesPending->setReadOnly();
+    m_pMetadataWriter.reset(new TrackMetadataWriter(
+            QDir(pConfig->getSettingsPath()).filePath(
+                    kMetadataWriterJournalFileName)));
+    connect(m_pMetadataWriter.data(), SIGNAL(pendingCountChanged(int)),
+            this, SLOT(slotMetadataWritesPending(int)));
+    m_pTrackCollection->getTrackDAO().setMetadataWriter(m_pMetadataWriter.data());
+    recoverPendingMetadataWrites();
+    m_pMetadataWriter->start(QThread::LowPriority);
+
     connect(&m_scanner, SIGNAL(scanStarted()),
             this, SIGNAL(scanStarted()));
     connect(&m_scanner, SIGNAL(scanFinished()),
@@ -102,6 +122,18 @@ Library::Library(
     connect(&m_scanner, SIGNAL(scanFinished()),
             this, SLOT(slotRefreshLibraryModels()));
 
+    if (m_pConfig->getValue(ConfigKey(kConfigGroup, "WatchLibraryDirectories"), false)) {
+        m_pLibraryWatcher = new LibraryWatcher(
+                this, &m_pTrackCollection->getLibraryHashDAO());
+        connect(m_pLibraryWatcher, SIGNAL(directoriesChanged(QStringList)),
+                &m_scanner, SLOT(scanChangedDirectories(QStringList)));
+        connect(&m_scanner, SIGNAL(scanStarted()),
+                m_pLibraryWatcher, SLOT(slotScanStarted()));
+        connect(&m_scanner, SIGNAL(scanFinished()),
+                m_pLibraryWatcher, SLOT(slotScanFinished()));
+        m_pLibraryWatcher->start();
+    }
+
     // TODO(rryan) -- turn this construction / adding of features into a static
     // method or something -- CreateDefaultLibrary
     m_pMixxxLibraryFeature = new MixxxLibraryFeature(this, m_pTrackCollection,m_pConfig);
@@ -175,6 +207,9 @@ Library::Library(
 }
 
 Library::~Library() {
+    // Stop watching before the database is disconnected.
+    delete m_pLibraryWatcher;
+
     // Delete the sidebar model first since it depends on the LibraryFeatures.
     delete m_pSidebarModel;
 
@@ -188,8 +223,13 @@ Library::~Library() {
     delete m_pLibraryControl;
 
     kLogger.info() << "Disconnecting database";
+    // Still queues the metadata of all modified tracks
     m_pTrackCollection->disconnectDatabase();
 
+    // Files that are still pending remain in the journal
+    m_pTrackCollection->getTrackDAO().setMetadataWriter(nullptr);
+    m_pMetadataWriter.reset();
+
     //IMPORTANT: m_pTrackCollection gets destroyed via the QObject hierarchy somehow.
     //           Qt does it for us due to the way RJ wrote all this stuff.
     //Update:  - OR NOT! As of Dec 8, 2009, this pointer must be destroyed manually otherwise
@@ -198,6 +238,24 @@ Library::~Library() {
     delete m_pTrackCollection;
 }
 
+void Library::recoverPendingMetadataWrites() {
+    TrackDAO& trackDao = m_pTrackCollection->getTrackDAO();
+    for (const auto& location: m_pMetadataWriter->recoveredLocations()) {
+        const TrackId trackId = trackDao.getTrackId(location);
+        if (!trackId.isValid()) {
+            continue;
+        }
+        TrackPointer pTrack = trackDao.getTrack(trackId);
+        if (pTrack) {
+            m_pMetadataWriter->enqueue(*pTrack);
+        }
+    }
+}
+
+void Library::slotMetadataWritesPending(int pendingCount) {
+    m_pMetadataWritesPending->forceSet(pendingCount);
+}
+
 void Library::bindSidebarWidget(WLibrarySidebar* pSidebarWidget) {
     m_pLibraryControl->bindSidebarWidget(pSidebarWidget);
 
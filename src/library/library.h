@@ -33,8 +33,10 @@ class MixxxLibraryFeature;
 class PlaylistFeature;
 class CrateFeature;
 class LibraryControl;
+class LibraryWatcher;
 class KeyboardEventFilter;
 class PlayerManagerInterface;
+class TrackMetadataWriter;
 
 class Library : public QObject {
     Q_OBJECT
@@ -101,6 +103,12 @@ class Library : public QObject {
         m_scanner.scan();
     }
 
+    // Rescans all directories that have been journaled as changed,
+    // e.g. by the LibraryWatcher during the previous session.
+    void scanChangedDirectories() {
+        m_scanner.scanChangedDirectories(QStringList());
+    }
+
   signals:
     void showTrackModel(QAbstractItemModel* model);
     void switchToView(const QString& view);
@@ -121,7 +129,14 @@ class Library : public QObject {
     void scanStarted();
     void scanFinished();
 
+  private slots:
+    void slotMetadataWritesPending(int pendingCount);
+
   private:
+    // Queues the files that have not been written during the
+    // previous session again.
+    void recoverPendingMetadataWrites();
+
     const UserSettingsPointer m_pConfig;
 
     // The Mixxx database connection pool
@@ -138,9 +153,12 @@ class Library : public QObject {
     CrateFeature* m_pCrateFeature;
     AnalysisFeature* m_pAnalysisFeature;
     LibraryScanner m_scanner;
+    LibraryWatcher* m_pLibraryWatcher;
     QFont m_trackTableFont;
     int m_iTrackTableRowHeight;
     QScopedPointer<ControlObject> m_pKeyNotation;
+    QScopedPointer<ControlObject> m_pMetadataWritesPending;
+    QScopedPointer<TrackMetadataWriter> m_pMetadataWriter;
 };
 
 #endif /* LIBRARY_H */
@@ -3,23 +3,47 @@
 
 #include "library/libraryfeature.h"
 
+#include "util/logger.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const mixxx::Logger kLogger("LibraryFeature");
+
+} // anonymous namespace
+
 // KEEP THIS cpp file to tell scons that moc should be called on the class!!!
 // The reason for this is that LibraryFeature uses slots/signals and for this
 // to work the code has to be precompiles by moc
 LibraryFeature::LibraryFeature(QObject *parent)
-        : QObject(parent) {
+        : QObject(parent),
+          m_initialized(false) {
 
 }
 
 LibraryFeature::LibraryFeature(UserSettingsPointer pConfig, QObject* parent)
         : QObject(parent),
-          m_pConfig(pConfig) {
+          m_pConfig(pConfig),
+          m_initialized(false) {
 }
 
 LibraryFeature::~LibraryFeature() {
 
 }
 
+void LibraryFeature::ensureInitialized() {
+    if (m_initialized) {
+        return;
+    }
+    // Set the flag first in case initialize() activates the feature
+    m_initialized = true;
+    PerformanceTimer timer;
+    timer.start();
+    initialize();
+    kLogger.info() << "Initialized" << title().toString() << "in"
+                   << timer.elapsed().debugMillisWithUnit();
+}
+
 QStringList LibraryFeature::getPlaylistFiles(QFileDialog::FileMode mode) const {
     QString lastPlaylistDirectory = m_pConfig->getValue(
             ConfigKey("[Library]", "LastImportExportPlaylistDirectory"),
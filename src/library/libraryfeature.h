@@ -65,7 +65,20 @@ class LibraryFeature : public QObject {
                             KeyboardEventFilter* /* keyboard */) {}
     virtual TreeItemModel* getChildModel() = 0;
 
+    // Calls initialize() once before the feature is used for the first
+    // time. The sidebar invokes this before activating the feature.
+    void ensureInitialized();
+    bool isInitialized() const {
+        return m_initialized;
+    }
+
   protected:
+    // Reimplement this to defer expensive work like opening foreign
+    // databases or creating track models until the user activates the
+    // feature. The constructor should only do what is needed to show
+    // the feature in the sidebar.
+    virtual void initialize() {}
+
     QStringList getPlaylistFiles() const {
         return getPlaylistFiles(QFileDialog::ExistingFiles);
     }
@@ -120,6 +133,8 @@ class LibraryFeature : public QObject {
   private: 
     QStringList getPlaylistFiles(QFileDialog::FileMode mode) const;
 
+    bool m_initialized;
+
 };
 
 #endif /* LIBRARYFEATURE_H */
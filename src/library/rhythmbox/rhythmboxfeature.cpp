@@ -7,13 +7,55 @@
 
 #include "library/baseexternaltrackmodel.h"
 #include "library/baseexternalplaylistmodel.h"
+#include "library/externallibraryupdate.h"
 #include "library/treeitem.h"
 #include "library/queryutil.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const QString kDatabaseStateKey = "mixxx.rhythmboxfeature.rhythmdbstate";
+
+const QStringList kTrackColumns = QStringList()
+        << "artist"
+        << "title"
+        << "album"
+        << "year"
+        << "genre"
+        << "comment"
+        << "tracknumber"
+        << "bpm"
+        << "bitrate"
+        << "duration"
+        << "location"
+        << "rating";
+
+} // anonymous namespace
 
 RhythmboxFeature::RhythmboxFeature(QObject* parent, TrackCollection* pTrackCollection)
         : BaseExternalLibraryFeature(parent, pTrackCollection),
+          m_pRhythmboxTrackModel(nullptr),
+          m_pRhythmboxPlaylistModel(nullptr),
           m_pTrackCollection(pTrackCollection),
           m_cancelImport(false) {
+    m_isActivated =  false;
+    m_title = tr("Rhythmbox");
+    connect(&m_track_watcher, SIGNAL(finished()),
+            this, SLOT(onTrackCollectionLoaded()),
+            Qt::QueuedConnection);
+}
+
+RhythmboxFeature::~RhythmboxFeature() {
+    m_database.close();
+    // stop import thread, if still running
+    m_cancelImport = true;
+    m_track_future.waitForFinished();
+    delete m_pRhythmboxTrackModel;
+    delete m_pRhythmboxPlaylistModel;
+}
+
+void RhythmboxFeature::initialize() {
     QString tableName = "rhythmbox_library";
     QString idColumn = "id";
     QStringList columns;
@@ -54,10 +96,7 @@ RhythmboxFeature::RhythmboxFeature(QObject* parent, TrackCollection* pTrackColle
         "rhythmbox_playlist_tracks",
         m_trackSource);
 
-    m_isActivated =  false;
-    m_title = tr("Rhythmbox");
-
-    m_database = QSqlDatabase::cloneDatabase(pTrackCollection->database(),
+    m_database = QSqlDatabase::cloneDatabase(m_pTrackCollection->database(),
                                              "RHYTHMBOX_SCANNER");
 
     //Open the database connection in this thread.
@@ -65,18 +104,6 @@ RhythmboxFeature::RhythmboxFeature(QObject* parent, TrackCollection* pTrackColle
         qDebug() << "Failed to open database for Rhythmbox scanner."
                  << m_database.lastError();
     }
-    connect(&m_track_watcher, SIGNAL(finished()),
-            this, SLOT(onTrackCollectionLoaded()),
-            Qt::QueuedConnection);
-}
-
-RhythmboxFeature::~RhythmboxFeature() {
-    m_database.close();
-    // stop import thread, if still running
-    m_cancelImport = true;
-    m_track_future.waitForFinished();
-    delete m_pRhythmboxTrackModel;
-    delete m_pRhythmboxPlaylistModel;
 }
 
 BaseSqlTableModel* RhythmboxFeature::getPlaylistModelForPlaylist(QString playlist) {
@@ -153,48 +180,62 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
         }
     }
 
-    if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
-        return NULL;
-
-    //Delete all table entries of Traktor feature
-    ScopedTransaction transaction(m_database);
-    clearTable("rhythmbox_playlist_tracks");
-    clearTable("rhythmbox_library");
-    clearTable("rhythmbox_playlists");
-    transaction.commit();
+    // The playlists are stored in a separate small file that is always
+    // parsed and imported from scratch. Parsing the tracks is skipped if
+    // the music collection has not been modified since the last import.
+    ExternalLibraryFileState fileState(m_database, kDatabaseStateKey, db.fileName());
+    if (fileState.isUnchanged()) {
+        qDebug() << "Rhythmbox music collection has not been modified since the last import";
+    } else {
+        if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
+            return NULL;
 
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO rhythmbox_library (artist, title, album, year, "
-                  "genre, comment, tracknumber, bpm, bitrate,"
-                  "duration, location, rating ) "
-                  "VALUES (:artist, :title, :album, :year, :genre, :comment, "
-                  ":tracknumber, :bpm, :bitrate, :duration, :location, :rating )");
+        PerformanceTimer timer;
+        timer.start();
 
+        ScopedTransaction transaction(m_database);
+        ExternalTrackTableUpdater updater(m_database, "rhythmbox_library", "location", kTrackColumns);
 
-    QXmlStreamReader xml(&db);
-    while (!xml.atEnd() && !m_cancelImport) {
-        xml.readNext();
-        if (xml.isStartElement() && xml.name() == "entry") {
-            QXmlStreamAttributes attr = xml.attributes();
-            //Check if we really parse a track and not album art information
-            if (attr.value("type").toString() == "song") {
-                importTrack(xml, query);
+        QXmlStreamReader xml(&db);
+        while (!xml.atEnd() && !m_cancelImport) {
+            xml.readNext();
+            if (xml.isStartElement() && xml.name() == "entry") {
+                QXmlStreamAttributes attr = xml.attributes();
+                //Check if we really parse a track and not album art information
+                if (attr.value("type").toString() == "song") {
+                    importTrack(xml, &updater);
+                }
             }
         }
-    }
-    transaction.commit();
+        const bool complete = !xml.hasError() && !m_cancelImport;
+        if (complete) {
+            // Tracks that have been deleted in Rhythmbox can only be
+            // detected after all tracks have been parsed
+            updater.removeUnappliedRows();
+        }
+        transaction.commit();
 
-    if (xml.hasError()) {
-        // do error handling
-        qDebug() << "Cannot process Rhythmbox music collection";
-        qDebug() << "XML ERROR: " << xml.errorString();
-        return NULL;
-    }
+        if (xml.hasError()) {
+            // do error handling
+            qDebug() << "Cannot process Rhythmbox music collection";
+            qDebug() << "XML ERROR: " << xml.errorString();
+            return NULL;
+        }
 
-    db.close();
-    if (m_cancelImport) {
-        return NULL;
+        db.close();
+        if (m_cancelImport) {
+            return NULL;
+        }
+        fileState.save();
+
+        const mixxx::Duration elapsed = timer.elapsed();
+        qDebug() << "Parsed" << fileState.fileSize() << "bytes of Rhythmbox music collection in"
+                 << elapsed.formatMillisWithUnit() << "with"
+                 << fileState.fileSize() / math_max(elapsed.toDoubleSeconds(), 0.001) / (1024 * 1024)
+                 << "MiB/s:"
+                 << updater.insertedRows() << "added,"
+                 << updater.updatedRows() << "updated,"
+                 << updater.removedRows() << "removed";
     }
     return importPlaylists();
 }
@@ -211,6 +252,10 @@ TreeItem* RhythmboxFeature::importPlaylists() {
      if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
         return NULL;
 
+    ScopedTransaction transaction(m_database);
+    clearTable("rhythmbox_playlist_tracks");
+    clearTable("rhythmbox_playlists");
+
     QSqlQuery query_insert_to_playlists(m_database);
     query_insert_to_playlists.prepare("INSERT INTO rhythmbox_playlists (id, name) "
                                       "VALUES (:id, :name)");
@@ -261,12 +306,13 @@ TreeItem* RhythmboxFeature::importPlaylists() {
         return NULL;
     }
     db.close();
+    transaction.commit();
 
     return rootItem;
 
 }
 
-void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+void RhythmboxFeature::importTrack(QXmlStreamReader &xml, ExternalTrackTableUpdater* pUpdater) {
     QString title;
     QString artist;
     QString album;
@@ -343,26 +389,20 @@ void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
         return;
     }
 
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-
-    if (!success) {
-        qDebug() << "SQL Error in rhythmboxfeature.cpp: line" << __LINE__
-                 << " " << query.lastError();
-        return;
-    }
+    // The order of values must match kTrackColumns
+    pUpdater->applyRow(QVariantList()
+            << artist
+            << title
+            << album
+            << year
+            << genre
+            << comment
+            << tracknumber
+            << bpm
+            << bitrate
+            << playtime
+            << location
+            << rating);
 }
 
 // reads all playlist entries and executes a SQL statement
@@ -17,6 +17,7 @@
 
 class BaseExternalTrackModel;
 class BaseExternalPlaylistModel;
+class ExternalTrackTableUpdater;
 
 class RhythmboxFeature : public BaseExternalLibraryFeature {
     Q_OBJECT
@@ -34,6 +35,9 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     // processes the playlist entries
     TreeItem* importPlaylists();
 
+  protected:
+    void initialize() override;
+
   public slots:
     void activate();
     void activateChild(const QModelIndex& index);
@@ -44,7 +48,7 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     // Removes all rows from a given table
     void clearTable(QString table_name);
     // reads the properties of a track and executes a SQL statement
-    void importTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    void importTrack(QXmlStreamReader &xml, ExternalTrackTableUpdater* pUpdater);
     // reads all playlist entries and executes a SQL statement
     void importPlaylist(QXmlStreamReader &xml, QSqlQuery &query, int playlist_id);
 
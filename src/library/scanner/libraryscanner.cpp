@@ -1,5 +1,10 @@
 #include "library/scanner/libraryscanner.h"
 
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+
 #include "sources/soundsourceproxy.h"
 #include "library/scanner/recursivescandirectorytask.h"
 #include "library/scanner/libraryscannerdlg.h"
@@ -20,6 +25,9 @@ namespace {
 // TODO(rryan) make configurable
 const int kScannerThreadPoolSize = 1;
 
+// New tracks are inserted into the database in batches
+const int kNewTracksPerBatch = 100;
+
 mixxx::Logger kLogger("LibraryScanner");
 
 QAtomicInt s_instanceCounter(0);
@@ -37,7 +45,8 @@ LibraryScanner::LibraryScanner(
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
           m_stateSema(1), // only one transaction is possible at a time
-          m_state(IDLE) {
+          m_state(IDLE),
+          m_scanStartedAt(0) {
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
     kLogger.debug() << "Starting thread";
@@ -53,6 +62,10 @@ LibraryScanner::LibraryScanner(
     // connect them to our slots to run the command on the scanner thread.
     connect(this, SIGNAL(startScan()),
             this, SLOT(slotStartScan()));
+    connect(this, SIGNAL(journalDirectoryChanges(QStringList)),
+            this, SLOT(slotJournalDirectoryChanges(QStringList)));
+    connect(this, SIGNAL(startIncrementalScan()),
+            this, SLOT(slotStartIncrementalScan()));
 
     // Force the GUI thread's Track cache to be cleared when a library
     // scan is finished, because we might have modified the database directly
@@ -122,7 +135,48 @@ void LibraryScanner::run() {
 void LibraryScanner::slotStartScan() {
     kLogger.debug() << "slotStartScan()";
     DEBUG_ASSERT(m_state == STARTING);
+    beginScan(false);
+}
+
+void LibraryScanner::slotStartIncrementalScan() {
+    kLogger.debug() << "slotStartIncrementalScan()";
+    DEBUG_ASSERT(m_state == STARTING);
+    beginScan(true);
+}
+
+void LibraryScanner::slotJournalDirectoryChanges(QStringList dirPaths) {
+    // Persist the changes before starting to scan them. If the scan is
+    // canceled or Mixxx quits in the meantime the affected directories
+    // will be rescanned during the next incremental scan.
+    m_libraryHashDao.journalDirectoryChanges(
+            dirPaths, QDateTime::currentMSecsSinceEpoch());
+}
+
+// static
+QStringList LibraryScanner::getRemovedDirectories(
+        const QStringList& changedDirs,
+        const QHash<QString, int>& directoryHashes) {
+    const QSet<QString> changedDirSet = changedDirs.toSet();
+    QStringList removedDirs;
+    for (const auto& dirPath: changedDirs) {
+        if (!QDir(dirPath).exists()) {
+            removedDirs << dirPath;
+        }
+    }
+    // The parent of a moved directory may be reported without it
+    for (auto it = directoryHashes.constBegin();
+            it != directoryHashes.constEnd(); ++it) {
+        const QString& dirPath = it.key();
+        if (!changedDirSet.contains(dirPath) &&
+                changedDirSet.contains(QFileInfo(dirPath).path()) &&
+                !QDir(dirPath).exists()) {
+            removedDirs << dirPath;
+        }
+    }
+    return removedDirs;
+}
 
+void LibraryScanner::beginScan(bool incremental) {
     // Recursively scan each directory in the directories table.
     m_libraryRootDirs = m_directoryDao.getDirs();
     // If there are no directories then we have nothing to do. Cleanup and
@@ -131,8 +185,22 @@ void LibraryScanner::slotStartScan() {
         changeScannerState(IDLE);
         return;
     }
+
+    QStringList changedDirs;
+    if (incremental) {
+        changedDirs = m_libraryHashDao.getJournaledDirectories();
+        if (changedDirs.isEmpty()) {
+            kLogger.debug() << "No changed directories to scan";
+            changeScannerState(IDLE);
+            return;
+        }
+    }
     changeScannerState(SCANNING);
 
+    // Journal entries that are recorded while scanning must not
+    // be discarded when the scan is finished.
+    m_scanStartedAt = QDateTime::currentMSecsSinceEpoch();
+
     QSet<QString> trackLocations = m_trackDao.getTrackLocations();
     QHash<QString, int> directoryHashes = m_libraryHashDao.getDirectoryHashes();
     QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
@@ -143,24 +211,48 @@ void LibraryScanner::slotStartScan() {
 
     m_scannerGlobal = ScannerGlobalPointer(
             new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                              coverExtensionFilter, directoryBlacklist));
+                              coverExtensionFilter, directoryBlacklist,
+                              incremental));
 
     m_scannerGlobal->startTimer();
 
     emit(scanStarted());
 
-    // First, we're going to mark all the directories that we've previously
-    // hashed as needing verification. As we search through the directory tree
-    // when we rescan, we'll mark any directory that does still exist as
-    // verified.
-    m_libraryHashDao.invalidateAllDirectories();
-
-    // Mark all the tracks in the library as needing verification of their
-    // existence. (ie. we want to check they're still on your hard drive where
-    // we think they are)
-    m_trackDao.invalidateTrackLocationsInLibrary();
+    if (incremental) {
+        // Only the changed directories and the tracks inside them need to be
+        // verified. Everything else stays untouched.
+        m_libraryHashDao.invalidateDirectories(changedDirs);
+        m_trackDao.invalidateTrackLocationsInDirectories(changedDirs);
+        // Subdirectories are only reported as changed on their own if they
+        // have been watched, so a moved directory takes its whole known
+        // tree with it.
+        const QStringList removedDirs =
+                getRemovedDirectories(changedDirs, directoryHashes);
+        if (!removedDirs.isEmpty()) {
+            kLogger.debug() << "Verifying" << removedDirs.size()
+                            << "removed directory trees.";
+            m_libraryHashDao.invalidateDirectoryTrees(removedDirs);
+            m_trackDao.invalidateTrackLocationsInDirectoryTrees(removedDirs);
+        }
+    } else {
+        // First, we're going to mark all the directories that we've previously
+        // hashed as needing verification. As we search through the directory tree
+        // when we rescan, we'll mark any directory that does still exist as
+        // verified.
+        m_libraryHashDao.invalidateAllDirectories();
+
+        // Mark all the tracks in the library as needing verification of their
+        // existence. (ie. we want to check they're still on your hard drive where
+        // we think they are)
+        m_trackDao.invalidateTrackLocationsInLibrary();
+    }
 
-    kLogger.debug() << "Recursively scanning library.";
+    if (incremental) {
+        kLogger.debug() << "Scanning" << changedDirs.size()
+                        << "changed directories.";
+    } else {
+        kLogger.debug() << "Recursively scanning library.";
+    }
 
     // Start scanning the library. This prepares insertion queries in TrackDAO
     // (must be called before calling addTracksAdd) and begins a transaction.
@@ -184,11 +276,35 @@ void LibraryScanner::slotStartScan() {
         // scanning so that relies on having an open bookmark for the containing
         // directory.
         MDir dir(dirPath);
-        if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir.dir())) {
-            queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
-                                                     dir.dir(),
-                                                     dir.token(),
-                                                     false));
+        if (!incremental) {
+            if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir.dir())) {
+                queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
+                                                         dir.dir(),
+                                                         dir.token(),
+                                                         false));
+            }
+            continue;
+        }
+        // A change under "/music2" is not under the root "/music"
+        const QString dirPathPrefix =
+                dirPath.endsWith('/') ? dirPath : dirPath + '/';
+        foreach (const QString& changedDirPath, changedDirs) {
+            if (changedDirPath != dirPath &&
+                    !changedDirPath.startsWith(dirPathPrefix)) {
+                continue;
+            }
+            const QDir changedDir(changedDirPath);
+            if (!changedDir.exists()) {
+                // The directory and its tracks remain unverified and
+                // will be marked as deleted when the scan is finished.
+                continue;
+            }
+            if (!m_scannerGlobal->testAndMarkDirectoryScanned(changedDir)) {
+                queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
+                                                         changedDir,
+                                                         dir.token(),
+                                                         false));
+            }
         }
     }
     pWatcher->taskDone();
@@ -292,6 +408,10 @@ void LibraryScanner::cleanUpScan() {
     // A.
     m_libraryHashDao.removeDeletedDirectoryHashes();
 
+    // All changes that have been journaled before the scan started
+    // have been picked up now.
+    m_libraryHashDao.removeJournaledDirectories(m_scanStartedAt);
+
     transaction.commit();
 
     kLogger.debug() << "Detecting cover art for unscanned files";
@@ -321,6 +441,9 @@ void LibraryScanner::slotFinishUnhashedScan() {
         kLogger.debug() << "Recursive scanning interrupted by the user";
     }
 
+    // Insert the remaining tracks of the last batch
+    addNewTracks();
+
     // Finish adding the tracks -- rollback the transaction if the scan did not
     // finish cleanly and the user did not cancel the transaction.
     m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
@@ -361,6 +484,15 @@ void LibraryScanner::scan() {
     }
 }
 
+void LibraryScanner::scanChangedDirectories(QStringList dirPaths) {
+    if (!dirPaths.isEmpty()) {
+        emit(journalDirectoryChanges(dirPaths));
+    }
+    if (changeScannerState(STARTING)) {
+        emit(startIncrementalScan());
+    }
+}
+
 // this is called after pressing the cancel button in the scanner
 // progress dialog
 void LibraryScanner::slotCancel() {
@@ -469,20 +601,14 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
 void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
     //kLogger.debug() << "slotAddNewTrack" << trackPath;
     ScopedTimer timer("LibraryScanner::addNewTrack");
-    // For statistics tracking and to detect moved tracks
-    TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false));
+    // The metadata is read for each track, but the tracks are
+    // inserted into the database in batches.
+    TrackPointer pTrack(m_trackDao.newTrackFromFile(trackPath));
     if (pTrack) {
-        // The track's actual location might differ from the
-        // given trackPath
-        const QString trackLocation(pTrack->getLocation());
-        // Acknowledge successful track addition
-        if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackLocation);
+        m_newTracks.append(pTrack);
+        if (m_newTracks.size() >= kNewTracksPerBatch) {
+            addNewTracks();
         }
-        // Signal the main instance of TrackDAO, that there is
-        // a new track in the database.
-        emit(trackAdded(pTrack));
-        emit(progressLoading(trackLocation));
     } else {
         // Acknowledge failed track addition
         // TODO(XXX): Is it really intended to acknowledge a failed
@@ -496,6 +622,37 @@ void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
     }
 }
 
+void LibraryScanner::addNewTracks() {
+    if (m_newTracks.isEmpty()) {
+        return;
+    }
+    ScopedTimer timer("LibraryScanner::addNewTracks");
+    const QList<TrackId> trackIds =
+            m_trackDao.addTracksBulk(m_newTracks, false);
+    for (int i = 0; i < m_newTracks.size(); ++i) {
+        const TrackPointer& pTrack = m_newTracks.at(i);
+        // The track's actual location might differ from the
+        // given trackPath
+        const QString trackLocation(pTrack->getLocation());
+        // For statistics tracking and to detect moved tracks. Failed
+        // track additions are acknowledged as well, see above.
+        if (m_scannerGlobal) {
+            m_scannerGlobal->trackAdded(trackLocation);
+        }
+        if ((i < trackIds.size()) && trackIds.at(i).isValid()) {
+            // Signal the main instance of TrackDAO, that there is
+            // a new track in the database.
+            emit(trackAdded(pTrack));
+            emit(progressLoading(trackLocation));
+        } else {
+            kLogger.warning()
+                    << "Failed to add track to library:"
+                    << trackLocation;
+        }
+    }
+    m_newTracks.clear();
+}
+
 bool LibraryScanner::changeScannerState(ScannerState newState) {
     switch (newState) {
     case IDLE:
@@ -26,6 +26,7 @@ class TrackCollection;
 
 class LibraryScanner : public QThread {
     FRIEND_TEST(LibraryScannerTest, ScannerRoundtrip);
+    FRIEND_TEST(LibraryScannerTest, MovedDirectoryTree);
     Q_OBJECT
   public:
     LibraryScanner(
@@ -39,6 +40,13 @@ class LibraryScanner : public QThread {
     // in progress.
     void scan();
 
+    // Call from any thread to journal the given directories as changed and
+    // to start an incremental scan of all journaled directories. Only the
+    // journaled directories and new subdirectories are visited. If a scan
+    // is already in progress the directories are journaled and picked up
+    // by the next scan.
+    void scanChangedDirectories(QStringList dirPaths);
+
     // Call from any thread to cancel the scan.
     void slotCancel();
 
@@ -55,6 +63,10 @@ class LibraryScanner : public QThread {
     // Emitted by scan() to invoke slotStartScan in the scanner thread's event
     // loop.
     void startScan();
+    // Emitted by scanChangedDirectories to invoke the corresponding slots in
+    // the scanner thread's event loop.
+    void journalDirectoryChanges(QStringList dirPaths);
+    void startIncrementalScan();
 
   protected:
     void run();
@@ -64,6 +76,8 @@ class LibraryScanner : public QThread {
 
   private slots:
     void slotStartScan();
+    void slotStartIncrementalScan();
+    void slotJournalDirectoryChanges(QStringList dirPaths);
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
 
@@ -96,7 +110,16 @@ class LibraryScanner : public QThread {
     // CANCELING -> IDLE
     bool changeScannerState(LibraryScanner::ScannerState newState);
 
+    void beginScan(bool incremental);
+    // Returns the changed directories and their known subdirectories that
+    // don't exist anymore, e.g. because they have been moved. All of their
+    // subdirectories need to be verified as well.
+    static QStringList getRemovedDirectories(
+            const QStringList& changedDirs,
+            const QHash<QString, int>& directoryHashes);
     void cleanUpScan();
+    // Inserts the pending new tracks into the database
+    void addNewTracks();
 
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
 
@@ -118,6 +141,9 @@ class LibraryScanner : public QThread {
     // Global scanner state for scan currently in progress.
     ScannerGlobalPointer m_scannerGlobal;
 
+    // New tracks with metadata that have not been inserted yet
+    QList<TrackPointer> m_newTracks;
+
     // The Semaphore guards the state transitions queued to the
     // Qt even Queue in the way, that you cannot start a
     // new scan while the old one is canceled
@@ -126,6 +152,8 @@ class LibraryScanner : public QThread {
     volatile ScannerState m_state;
 
     QStringList m_libraryRootDirs;
+    // Start of the current scan in milliseconds since the epoch.
+    qint64 m_scanStartedAt;
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
 };
 
@@ -0,0 +1,122 @@
+#include "library/scanner/librarywatcher.h"
+
+#include "library/dao/libraryhashdao.h"
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("LibraryWatcher");
+
+// Changes are reported after no new events have been received
+// for this period of time.
+const int kDebounceMillis = 3000;
+
+} // anonymous namespace
+
+LibraryWatcher::LibraryWatcher(QObject* parent, LibraryHashDAO* pLibraryHashDao)
+        : QObject(parent),
+          m_pLibraryHashDao(pLibraryHashDao),
+          m_active(false),
+          m_scanning(false),
+          m_changesWhileScanning(false) {
+    DEBUG_ASSERT(m_pLibraryHashDao);
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(kDebounceMillis);
+    connect(&m_debounceTimer, SIGNAL(timeout()),
+            this, SLOT(slotEmitChanges()));
+    connect(&m_fileSystemWatcher, SIGNAL(directoryChanged(const QString&)),
+            this, SLOT(slotDirectoryChanged(const QString&)));
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    stop();
+}
+
+void LibraryWatcher::start() {
+    m_active = true;
+    updateWatchedDirectories();
+}
+
+void LibraryWatcher::stop() {
+    m_active = false;
+    m_debounceTimer.stop();
+    const QStringList watchedDirs = m_fileSystemWatcher.directories();
+    if (!watchedDirs.isEmpty()) {
+        m_fileSystemWatcher.removePaths(watchedDirs);
+    }
+    // Pending changes are lost, they will be detected by the next
+    // full rescan.
+    m_changedDirs.clear();
+}
+
+void LibraryWatcher::slotScanStarted() {
+    m_scanning = true;
+}
+
+void LibraryWatcher::slotScanFinished() {
+    m_scanning = false;
+    if (!m_active) {
+        return;
+    }
+    // Directories might have been added or removed by the scan
+    updateWatchedDirectories();
+    if (m_changesWhileScanning) {
+        m_changesWhileScanning = false;
+        // The scanner has journaled these changes, but was not
+        // able to start another scan while the previous one was
+        // still running.
+        emit(directoriesChanged(QStringList()));
+    }
+}
+
+void LibraryWatcher::slotDirectoryChanged(const QString& dirPath) {
+    if (!m_active) {
+        return;
+    }
+    m_changedDirs.insert(dirPath);
+    m_debounceTimer.start();
+}
+
+void LibraryWatcher::slotEmitChanges() {
+    if (m_changedDirs.isEmpty()) {
+        return;
+    }
+    const QStringList changedDirs = m_changedDirs.toList();
+    m_changedDirs.clear();
+    kLogger.debug() << "Detected changes in" << changedDirs.size()
+                    << "directories";
+    if (m_scanning) {
+        m_changesWhileScanning = true;
+    }
+    emit(directoriesChanged(changedDirs));
+}
+
+void LibraryWatcher::updateWatchedDirectories() {
+    const QSet<QString> knownDirs =
+            QSet<QString>::fromList(m_pLibraryHashDao->getDirectoryHashes().keys());
+    const QSet<QString> watchedDirs =
+            QSet<QString>::fromList(m_fileSystemWatcher.directories());
+
+    const QStringList obsoleteDirs = (watchedDirs - knownDirs).toList();
+    if (!obsoleteDirs.isEmpty()) {
+        m_fileSystemWatcher.removePaths(obsoleteDirs);
+    }
+
+    const QStringList newDirs = (knownDirs - watchedDirs).toList();
+    if (newDirs.isEmpty()) {
+        return;
+    }
+    const QStringList failedDirs = m_fileSystemWatcher.addPaths(newDirs);
+    if (!failedDirs.isEmpty()) {
+        kLogger.warning()
+                << "Failed to watch" << failedDirs.size() << "of"
+                << knownDirs.size() << "library directories."
+                << "Changes in these directories are only detected"
+                << "by a full rescan. On Linux consider increasing"
+                << "fs.inotify.max_user_watches.";
+    }
+    kLogger.info() << "Watching"
+                   << m_fileSystemWatcher.directories().size()
+                   << "library directories";
+}
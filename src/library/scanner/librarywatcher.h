@@ -0,0 +1,67 @@
+#ifndef MIXXX_LIBRARYWATCHER_H
+#define MIXXX_LIBRARYWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+class LibraryHashDAO;
+
+// Watches all known library directories for changes while Mixxx is
+// running and reports changed directories in batches. The changes are
+// journaled and rescanned by LibraryScanner::scanChangedDirectories()
+// which only visits the touched directories instead of hashing the
+// whole library.
+//
+// QFileSystemWatcher is backed by inotify on Linux and by the native
+// notification APIs on other platforms. Each directory requires a
+// separate watch. If the number of watches is limited by the system
+// (fs.inotify.max_user_watches on Linux) the remaining directories are
+// not watched and a warning is logged. Changes in these directories
+// are only detected by a full rescan.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+  public:
+    LibraryWatcher(QObject* parent, LibraryHashDAO* pLibraryHashDao);
+    ~LibraryWatcher() override;
+
+    // Starts watching all directories that have been scanned before.
+    void start();
+    void stop();
+
+    bool isActive() const {
+        return m_active;
+    }
+
+  signals:
+    // Emitted with a batch of changed directories. An empty list is
+    // emitted after a scan to pick up changes that have been journaled
+    // while the scan was running.
+    void directoriesChanged(QStringList dirPaths);
+
+  public slots:
+    void slotScanStarted();
+    void slotScanFinished();
+
+  private slots:
+    void slotDirectoryChanged(const QString& dirPath);
+    void slotEmitChanges();
+
+  private:
+    void updateWatchedDirectories();
+
+    LibraryHashDAO* m_pLibraryHashDao;
+    QFileSystemWatcher m_fileSystemWatcher;
+    // Collects events for a short period of time, because copying or
+    // moving many files generates a burst of events for each directory.
+    QTimer m_debounceTimer;
+    QSet<QString> m_changedDirs;
+    bool m_active;
+    bool m_scanning;
+    bool m_changesWhileScanning;
+};
+
+#endif // MIXXX_LIBRARYWATCHER_H
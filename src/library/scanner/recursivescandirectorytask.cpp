@@ -66,6 +66,12 @@ void RecursiveScanDirectoryTask::run() {
                 // Art Folder since it is probably a waste of time.
                 continue;
             }
+            if (m_scannerGlobal->isIncremental() &&
+                    m_scannerGlobal->directoryHashInDatabase(currentFile) != -1) {
+                // Known subdirectories are watched on their own and
+                // only rescanned if they have been reported as changed.
+                continue;
+            }
             const QDir currentDir(currentFile);
             dirsToScan.append(currentDir);
         }
@@ -40,7 +40,8 @@ class ScannerGlobal {
                   const QHash<QString, int>& directoryHashes,
                   const QRegExp& supportedExtensionsMatcher,
                   const QRegExp& supportedCoverExtensionsMatcher,
-                  const QStringList& directoriesBlacklist)
+                  const QStringList& directoriesBlacklist,
+                  bool incremental = false)
             : m_trackLocations(trackLocations),
               m_directoryHashes(directoryHashes),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
@@ -49,6 +50,7 @@ class ScannerGlobal {
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
+              m_incremental(incremental),
               m_numScannedDirectories(0) {
     }
 
@@ -66,6 +68,13 @@ class ScannerGlobal {
         return m_directoryHashes.value(directoryPath, -1);
     }
 
+    // An incremental scan only visits the directories that have been
+    // reported as changed and all subdirectories that are not yet known,
+    // i.e. that don't have a hash in the database.
+    inline bool isIncremental() const {
+        return m_incremental;
+    }
+
     inline bool directoryBlacklisted(const QString& directoryPath) const {
         return m_directoriesBlacklist.contains(directoryPath);
     }
@@ -213,6 +222,7 @@ class ScannerGlobal {
 
     volatile bool m_scanFinishedCleanly;
     volatile bool m_shouldCancel;
+    const bool m_incremental;
 
     // Stats tracking.
     PerformanceTimer m_timer;
@@ -8,50 +8,52 @@
 #include "util/db/sqllikewildcards.h"
 
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column) {
+    const TrackSnapshotPointer pSnapshot = pTrack->getSnapshot();
+    const TrackSnapshot& track = *pSnapshot;
     if (column == LIBRARYTABLE_ARTIST) {
-        return pTrack->getArtist();
+        return track.metadata.getArtist();
     } else if (column == LIBRARYTABLE_TITLE) {
-        return pTrack->getTitle();
+        return track.metadata.getTitle();
     } else if (column == LIBRARYTABLE_ALBUM) {
-        return pTrack->getAlbum();
+        return track.metadata.getAlbum();
     } else if (column == LIBRARYTABLE_ALBUMARTIST) {
-        return pTrack->getAlbumArtist();
+        return track.metadata.getAlbumArtist();
     } else if (column == LIBRARYTABLE_YEAR) {
-        return pTrack->getYear();
+        return track.metadata.getYear();
     } else if (column == LIBRARYTABLE_DATETIMEADDED) {
-        return pTrack->getDateAdded();
+        return track.dateAdded;
     } else if (column == LIBRARYTABLE_GENRE) {
-        return pTrack->getGenre();
+        return track.metadata.getGenre();
     } else if (column == LIBRARYTABLE_COMPOSER) {
-        return pTrack->getComposer();
+        return track.metadata.getComposer();
     } else if (column == LIBRARYTABLE_GROUPING) {
-        return pTrack->getGrouping();
+        return track.metadata.getGrouping();
     } else if (column == LIBRARYTABLE_FILETYPE) {
-        return pTrack->getType();
+        return track.type;
     } else if (column == LIBRARYTABLE_TRACKNUMBER) {
-        return pTrack->getTrackNumber();
+        return track.metadata.getTrackNumber();
     } else if (column == LIBRARYTABLE_LOCATION) {
-        return QDir::toNativeSeparators(pTrack->getLocation());
+        return QDir::toNativeSeparators(track.location);
     } else if (column == LIBRARYTABLE_COMMENT) {
-        return pTrack->getComment();
+        return track.metadata.getComment();
     } else if (column == LIBRARYTABLE_DURATION) {
-        return pTrack->getDuration();
+        return track.metadata.getDuration();
     } else if (column == LIBRARYTABLE_BITRATE) {
-        return pTrack->getBitrate();
+        return track.metadata.getBitrate();
     } else if (column == LIBRARYTABLE_BPM) {
-        return pTrack->getBpm();
+        return track.bpm;
     } else if (column == LIBRARYTABLE_PLAYED) {
-        return pTrack->getPlayCounter().isPlayed();
+        return track.playCounter.isPlayed();
     } else if (column == LIBRARYTABLE_TIMESPLAYED) {
-        return pTrack->getPlayCounter().getTimesPlayed();
+        return track.playCounter.getTimesPlayed();
     } else if (column == LIBRARYTABLE_RATING) {
-        return pTrack->getRating();
+        return track.rating;
     } else if (column == LIBRARYTABLE_KEY) {
-        return pTrack->getKeyText();
+        return track.keyText;
     } else if (column == LIBRARYTABLE_KEY_ID) {
-        return static_cast<int>(pTrack->getKey());
+        return static_cast<int>(track.key);
     } else if (column == LIBRARYTABLE_BPM_LOCK) {
-        return pTrack->isBpmLocked();
+        return track.bpmLocked;
     }
 
     return QVariant();
@@ -175,17 +177,13 @@ CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
 
 bool CrateFilterNode::match(const TrackPointer& pTrack) const {
     if (!m_matchInitialized) {
-        CrateTrackSelectResult crateTracks(
-             m_pCrateStorage->selectTracksSortedByCrateNameLike(m_crateNameLike));
-
-        while (crateTracks.next()) {
-            m_matchingTrackIds.push_back(crateTracks.trackId());
-        }
-
+        m_matchingTrackIds =
+                m_pCrateStorage->collectTrackIdsByCrateNameLike(m_crateNameLike);
         m_matchInitialized = true;
     }
 
-    return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+    const TrackId trackId(pTrack->getId());
+    return trackId.isValid() && m_matchingTrackIds.contains(trackId.toInt());
 }
 
 QString CrateFilterNode::toSql() const {
@@ -103,7 +103,7 @@ class CrateFilterNode : public QueryNode {
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
-    mutable std::vector<TrackId> m_matchingTrackIds;
+    mutable IdBitmap m_matchingTrackIds;
 };
 
 class NumericFilterNode : public QueryNode {
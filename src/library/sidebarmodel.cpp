@@ -59,6 +59,7 @@ void SidebarModel::activateDefaultSelection() {
             static_cast<unsigned int>(m_sFeatures.size())) {
         emit(selectIndex(getDefaultSelection()));
         // Selecting an index does not activate it.
+        m_sFeatures[m_iDefaultSelectedIndex]->ensureInitialized();
         m_sFeatures[m_iDefaultSelectedIndex]->activate();
     }
 }
@@ -230,11 +231,13 @@ void SidebarModel::clicked(const QModelIndex& index) {
 
     if (index.isValid()) {
         if (index.internalPointer() == this) {
+            m_sFeatures[index.row()]->ensureInitialized();
             m_sFeatures[index.row()]->activate();
         } else {
             TreeItem* tree_item = (TreeItem*)index.internalPointer();
             if (tree_item) {
                 LibraryFeature* feature = tree_item->feature();
+                feature->ensureInitialized();
                 feature->activateChild(index);
             }
         }
@@ -258,6 +261,7 @@ void SidebarModel::rightClicked(const QPoint& globalPos, const QModelIndex& inde
     //qDebug() << "SidebarModel::rightClicked() index=" << index;
     if (index.isValid()) {
         if (index.internalPointer() == this) {
+            m_sFeatures[index.row()]->ensureInitialized();
             m_sFeatures[index.row()]->activate();
             m_sFeatures[index.row()]->onRightClick(globalPos);
         }
@@ -266,6 +270,7 @@ void SidebarModel::rightClicked(const QPoint& globalPos, const QModelIndex& inde
             TreeItem* tree_item = (TreeItem*)index.internalPointer();
             if (tree_item) {
                 LibraryFeature* feature = tree_item->feature();
+                feature->ensureInitialized();
                 feature->activateChild(index);
                 feature->onRightClickChild(globalPos, index);
             }
@@ -279,11 +284,13 @@ bool SidebarModel::dropAccept(const QModelIndex& index, QList<QUrl> urls,
     bool result = false;
     if (index.isValid()) {
         if (index.internalPointer() == this) {
+            m_sFeatures[index.row()]->ensureInitialized();
             result = m_sFeatures[index.row()]->dropAccept(urls, pSource);
         } else {
             TreeItem* tree_item = (TreeItem*)index.internalPointer();
             if (tree_item) {
                 LibraryFeature* feature = tree_item->feature();
+                feature->ensureInitialized();
                 result = feature->dropAcceptChild(index, urls, pSource);
             }
         }
@@ -297,11 +304,13 @@ bool SidebarModel::dragMoveAccept(const QModelIndex& index, QUrl url) {
 
     if (index.isValid()) {
         if (index.internalPointer() == this) {
+            m_sFeatures[index.row()]->ensureInitialized();
             result = m_sFeatures[index.row()]->dragMoveAccept(url);
         } else {
             TreeItem* tree_item = (TreeItem*)index.internalPointer();
             if (tree_item) {
                 LibraryFeature* feature = tree_item->feature();
+                feature->ensureInitialized();
                 result = feature->dragMoveAcceptChild(index, url);
             }
         }
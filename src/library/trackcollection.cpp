@@ -184,6 +184,7 @@ bool TrackCollection::purgeTracks(
     VERIFY_OR_DEBUG_ASSERT(transaction.commit()) {
         return false;
     }
+    m_crates.afterPurgingTracks(trackIds);
     // TODO(XXX): Move reversible actions inside transaction
     m_cueDao.deleteCuesForTracks(trackIds);
     m_playlistDao.removeTracksFromPlaylists(trackIds);
@@ -265,6 +266,7 @@ bool TrackCollection::deleteCrate(
     VERIFY_OR_DEBUG_ASSERT(transaction.commit()) {
         return false;
     }
+    m_crates.afterDeletingCrate(crateId);
 
     // Emit signals
     emit(crateDeleted(crateId));
@@ -286,6 +288,7 @@ bool TrackCollection::addCrateTracks(
     VERIFY_OR_DEBUG_ASSERT(transaction.commit()) {
         return false;
     }
+    m_crates.afterAddingCrateTracks(crateId, trackIds);
 
     // Emit signals
     emit(crateTracksChanged(crateId, trackIds, QList<TrackId>()));
@@ -307,6 +310,7 @@ bool TrackCollection::removeCrateTracks(
     VERIFY_OR_DEBUG_ASSERT(transaction.commit()) {
         return false;
     }
+    m_crates.afterRemovingCrateTracks(crateId, trackIds);
 
     // Emit signals
     emit(crateTracksChanged(crateId, QList<TrackId>(), trackIds));
@@ -314,6 +318,33 @@ bool TrackCollection::removeCrateTracks(
     return true;
 }
 
+CrateSummary TrackCollection::summarizeCrate(const Crate& crate) const {
+    CrateSummary crateSummary(crate.getId());
+    if (m_pTrackSource.isNull()) {
+        m_crates.readCrateSummaryById(crate.getId(), &crateSummary);
+        return crateSummary;
+    }
+    static_cast<Crate&>(crateSummary) = crate;
+
+    BaseTrackCache* pTrackSource = m_pTrackSource.data();
+    // Hidden tracks have been loaded into the cache when it was built,
+    // tracks that are hidden later are removed from it
+    pTrackSource->ensureIndexBuilt();
+    const int durationColumn = pTrackSource->fieldIndex(
+            ColumnCache::COLUMN_LIBRARYTABLE_DURATION);
+    const int hiddenColumn = pTrackSource->fieldIndex(
+            ColumnCache::COLUMN_LIBRARYTABLE_MIXXXDELETED);
+    m_crates.summarizeCrateTracks(&crateSummary,
+            [pTrackSource, durationColumn, hiddenColumn](TrackId trackId) {
+                if (!pTrackSource->isCached(trackId) ||
+                        pTrackSource->data(trackId, hiddenColumn).toBool()) {
+                    return -1.0;
+                }
+                return pTrackSource->data(trackId, durationColumn).toDouble();
+            });
+    return crateSummary;
+}
+
 bool TrackCollection::updateAutoDjCrate(
         CrateId crateId,
         bool isAutoDjSource) {
@@ -56,6 +56,9 @@ class TrackCollection : public QObject,
     AnalysisDao& getAnalysisDAO() {
         return m_analysisDao;
     }
+    LibraryHashDAO& getLibraryHashDAO() {
+        return m_libraryHashDao;
+    }
 
     QSharedPointer<BaseTrackCache> getTrackSource() const {
         return m_pTrackSource;
@@ -80,6 +83,11 @@ class TrackCollection : public QObject,
 
     bool updateAutoDjCrate(CrateId crateId, bool isAutoDjSource);
 
+    // Summarizes the visible tracks of the crate from the crate index and
+    // the track source, which are both kept in memory. Without a track
+    // source, e.g. in tests, the tracks are aggregated in the database.
+    CrateSummary summarizeCrate(const Crate& crate) const;
+
   signals:
     void crateInserted(CrateId id);
     void crateUpdated(CrateId id);
@@ -0,0 +1,225 @@
+#include "library/trackmetadatawriter.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include "mixer/playerinfo.h"
+#include "sources/soundsourceproxy.h"
+#include "util/logger.h"
+#include "util/time.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackMetadataWriter");
+
+// How often to check again if all pending files are loaded into decks
+const unsigned long kFileInUseRetryMillis = 5000;
+
+} // anonymous namespace
+
+// static
+const mixxx::Duration TrackMetadataWriter::kPlaybackWriteInterval =
+        mixxx::Duration::fromMillis(2000);
+
+TrackMetadataWriter::TrackMetadataWriter(const QString& journalFilePath)
+        : m_journalFilePath(journalFilePath),
+          m_exit(false),
+          m_nextSequence(0),
+          m_journal(journalFilePath) {
+    readJournal();
+}
+
+TrackMetadataWriter::~TrackMetadataWriter() {
+    stop();
+    wait();
+    const int pendingCount = m_pendingOrder.size();
+    if (pendingCount > 0) {
+        kLogger.info() << "Postponing" << pendingCount
+                << "pending file(s) until the next start";
+    }
+}
+
+void TrackMetadataWriter::stop() {
+    QMutexLocker locker(&m_mutex);
+    m_exit = true;
+    m_waitCondition.wakeAll();
+}
+
+void TrackMetadataWriter::enqueue(const Track& track) {
+    PendingWrite pendingWrite;
+    bool parsedFromFile = false;
+    track.getTrackMetadata(&pendingWrite.trackMetadata, &parsedFromFile);
+    const QString location = track.getLocation();
+    if (!parsedFromFile) {
+        kLogger.debug() << "Skip writing of track metadata into file"
+                << location;
+        return;
+    }
+    pendingWrite.pSecurityToken = track.getSecurityToken();
+
+    int pendingCount;
+    {
+        QMutexLocker locker(&m_mutex);
+        pendingWrite.sequence = m_nextSequence++;
+        auto it = m_pendingWrites.find(location);
+        if (it == m_pendingWrites.end()) {
+            m_pendingWrites.insert(location, pendingWrite);
+            m_pendingOrder.append(location);
+            appendToJournal(location);
+        } else {
+            // Coalesce with the pending write
+            *it = pendingWrite;
+        }
+        pendingCount = m_pendingOrder.size();
+        m_waitCondition.wakeAll();
+    }
+    emit(pendingCountChanged(pendingCount));
+}
+
+int TrackMetadataWriter::pendingCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_pendingOrder.size();
+}
+
+void TrackMetadataWriter::run() {
+    QThread::currentThread()->setObjectName("TrackMetadataWriter");
+    kLogger.debug() << "Entering thread";
+
+    mixxx::Duration lastWriteTime;
+    bool hasWritten = false;
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_exit) {
+        if (m_pendingOrder.isEmpty()) {
+            m_waitCondition.wait(&m_mutex);
+            continue;
+        }
+        if (hasWritten && isPlaybackActive()) {
+            const mixxx::Duration elapsed =
+                    mixxx::Time::elapsed() - lastWriteTime;
+            if (elapsed < kPlaybackWriteInterval) {
+                m_waitCondition.wait(&m_mutex,
+                        (kPlaybackWriteInterval - elapsed).toIntegerMillis() + 1);
+                continue;
+            }
+        }
+        const int index = nextWritableIndex();
+        if (index < 0) {
+            m_waitCondition.wait(&m_mutex, kFileInUseRetryMillis);
+            continue;
+        }
+        const QString location = m_pendingOrder.at(index);
+        const PendingWrite pendingWrite = m_pendingWrites.value(location);
+
+        locker.unlock();
+        if (!writeTrackMetadata(location, pendingWrite.trackMetadata,
+                pendingWrite.pSecurityToken)) {
+            kLogger.warning() << "Failed to write track metadata into file"
+                    << location;
+        }
+        lastWriteTime = mixxx::Time::elapsed();
+        hasWritten = true;
+        locker.relock();
+
+        // Keep the entry if it has been modified again while writing
+        auto it = m_pendingWrites.find(location);
+        if ((it != m_pendingWrites.end()) &&
+                (it->sequence == pendingWrite.sequence)) {
+            m_pendingWrites.erase(it);
+            m_pendingOrder.removeOne(location);
+        }
+        const int pendingCount = m_pendingOrder.size();
+        if (pendingCount == 0) {
+            truncateJournal();
+        }
+        locker.unlock();
+        emit(pendingCountChanged(pendingCount));
+        locker.relock();
+    }
+
+    kLogger.debug() << "Exiting thread";
+}
+
+int TrackMetadataWriter::nextWritableIndex() const {
+    for (int i = 0; i < m_pendingOrder.size(); ++i) {
+        if (!isFileInUse(m_pendingOrder.at(i))) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TrackMetadataWriter::isPlaybackActive() const {
+    return PlayerInfo::instance().getCurrentPlayingDeck() >= 0;
+}
+
+bool TrackMetadataWriter::isFileInUse(const QString& location) const {
+    // Rewriting the tags of a file while it is read by the
+    // CachingReader might corrupt the audio data of the deck.
+    return PlayerInfo::instance().isFileLoaded(location);
+}
+
+bool TrackMetadataWriter::writeTrackMetadata(const QString& location,
+        const mixxx::TrackMetadata& trackMetadata,
+        const SecurityTokenPointer& pSecurityToken) {
+    TrackPointer pTrack = Track::newTemporary(
+            QFileInfo(location), pSecurityToken);
+    pTrack->setTrackMetadata(trackMetadata, true);
+    return SoundSourceProxy::saveTrackMetadata(pTrack.get()) ==
+            SoundSourceProxy::SaveTrackMetadataResult::SUCCEEDED;
+}
+
+void TrackMetadataWriter::readJournal() {
+    if (m_journalFilePath.isEmpty() || !m_journal.exists()) {
+        return;
+    }
+    if (!m_journal.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        kLogger.warning() << "Failed to read journal" << m_journalFilePath;
+        return;
+    }
+    QSet<QString> locations;
+    QTextStream in(&m_journal);
+    in.setCodec("UTF-8");
+    while (!in.atEnd()) {
+        const QString location = in.readLine();
+        if (!location.isEmpty() && !locations.contains(location)) {
+            locations.insert(location);
+            m_recoveredLocations.append(location);
+        }
+    }
+    m_journal.close();
+    if (!m_recoveredLocations.isEmpty()) {
+        kLogger.info() << "Recovered" << m_recoveredLocations.size()
+                << "pending file(s) from journal";
+    }
+    // The recovered locations are journaled again when they are queued,
+    // locations that are not queued anymore are dropped
+    truncateJournal();
+}
+
+void TrackMetadataWriter::appendToJournal(const QString& location) {
+    if (m_journalFilePath.isEmpty() ||
+            m_journaledLocations.contains(location)) {
+        return;
+    }
+    m_journaledLocations.insert(location);
+    if (!m_journal.isOpen() &&
+            !m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        kLogger.warning() << "Failed to open journal" << m_journalFilePath;
+        return;
+    }
+    m_journal.write(location.toUtf8() + '\n');
+    m_journal.flush();
+}
+
+void TrackMetadataWriter::truncateJournal() {
+    if (m_journalFilePath.isEmpty()) {
+        return;
+    }
+    m_journaledLocations.clear();
+    m_journal.close();
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        kLogger.warning() << "Failed to truncate journal" << m_journalFilePath;
+    }
+}
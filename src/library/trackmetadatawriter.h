@@ -0,0 +1,99 @@
+#ifndef TRACKMETADATAWRITER_H
+#define TRACKMETADATAWRITER_H
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "track/track.h"
+#include "track/trackmetadata.h"
+#include "util/duration.h"
+
+// Writes track metadata back into the tags of audio files on a background
+// thread instead of blocking the thread that releases a modified track.
+//
+// Repeated edits of the same file are coalesced, i.e. only the most recent
+// metadata is written once. While a deck is playing writes are throttled
+// to keep the disk available for reading audio data, and files that are
+// loaded into a deck are not touched until they have been ejected.
+//
+// The locations of all pending files are recorded in a journal file. If
+// the application quits before the queue has been drained the locations
+// are available from recoveredLocations() on the next start, so that the
+// metadata can be reloaded from the database and queued again.
+class TrackMetadataWriter : public QThread {
+    Q_OBJECT
+  public:
+    // The journal is disabled if journalFilePath is empty.
+    explicit TrackMetadataWriter(const QString& journalFilePath);
+    ~TrackMetadataWriter() override;
+
+    // Requests the thread to exit after the current file has been
+    // written. Pending files remain in the journal.
+    void stop();
+
+    // Queues the current metadata of the track for writing. Does nothing
+    // if the metadata has never been parsed from the file, because it
+    // would overwrite tags that Mixxx does not know about.
+    void enqueue(const Track& track);
+
+    int pendingCount() const;
+
+    // Locations that were still pending when the application quit.
+    const QStringList& recoveredLocations() const {
+        return m_recoveredLocations;
+    }
+
+  signals:
+    void pendingCountChanged(int pendingCount);
+
+  protected:
+    void run() override;
+
+    // Overridable for testing
+    virtual bool isPlaybackActive() const;
+    virtual bool isFileInUse(const QString& location) const;
+    virtual bool writeTrackMetadata(const QString& location,
+            const mixxx::TrackMetadata& trackMetadata,
+            const SecurityTokenPointer& pSecurityToken);
+
+    // The minimum delay between two writes while a deck is playing
+    static const mixxx::Duration kPlaybackWriteInterval;
+
+  private:
+    struct PendingWrite {
+        mixxx::TrackMetadata trackMetadata;
+        SecurityTokenPointer pSecurityToken;
+        // Incremented whenever the entry is replaced by a newer edit
+        quint64 sequence;
+    };
+
+    // Returns the index of the next location in m_pendingOrder that
+    // may be written now or -1 if all pending files are in use.
+    int nextWritableIndex() const;
+
+    void readJournal();
+    void appendToJournal(const QString& location);
+    void truncateJournal();
+
+    const QString m_journalFilePath;
+    QStringList m_recoveredLocations;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_waitCondition;
+    bool m_exit;
+    QHash<QString, PendingWrite> m_pendingWrites;
+    // Locations in the order they have been queued
+    QList<QString> m_pendingOrder;
+    quint64 m_nextSequence;
+    QFile m_journal;
+    // The locations in the journal, each is only written once
+    QSet<QString> m_journaledLocations;
+};
+
+#endif // TRACKMETADATAWRITER_H
@@ -10,13 +10,40 @@
 
 #include "library/traktor/traktorfeature.h"
 
+#include "library/externallibraryupdate.h"
 #include "library/librarytablemodel.h"
 #include "library/missingtablemodel.h"
 #include "library/queryutil.h"
 #include "library/trackcollection.h"
 #include "library/treeitem.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
 #include "util/sandbox.h"
 
+namespace {
+
+const QString kCollectionStateKey = "mixxx.traktorfeature.collectionstate";
+
+// Each playlist is identified by its path in the tree of folders
+const QString kPlaylistPathDelimiter = "-->";
+
+const QStringList kTrackColumns = QStringList()
+        << "artist"
+        << "title"
+        << "album"
+        << "year"
+        << "genre"
+        << "comment"
+        << "tracknumber"
+        << "bpm"
+        << "bitrate"
+        << "duration"
+        << "location"
+        << "rating"
+        << "key";
+
+} // anonymous namespace
+
 TraktorTrackModel::TraktorTrackModel(QObject* parent,
                                      TrackCollection* pTrackCollection,
                                      QSharedPointer<BaseTrackCache> trackSource)
@@ -53,7 +80,24 @@ bool TraktorPlaylistModel::isColumnHiddenByDefault(int column) {
 TraktorFeature::TraktorFeature(QObject* parent, TrackCollection* pTrackCollection)
         : BaseExternalLibraryFeature(parent, pTrackCollection),
           m_pTrackCollection(pTrackCollection),
+          m_pTraktorTableModel(nullptr),
+          m_pTraktorPlaylistModel(nullptr),
           m_cancelImport(false) {
+    m_isActivated = false;
+    m_title = tr("Traktor");
+    connect(&m_future_watcher, SIGNAL(finished()),
+            this, SLOT(onTrackCollectionLoaded()));
+}
+
+TraktorFeature::~TraktorFeature() {
+    m_database.close();
+    m_cancelImport = true;
+    m_future.waitForFinished();
+    delete m_pTraktorTableModel;
+    delete m_pTraktorPlaylistModel;
+}
+
+void TraktorFeature::initialize() {
     QString tableName = "traktor_library";
     QString idColumn = "id";
     QStringList columns;
@@ -83,13 +127,10 @@ TraktorFeature::TraktorFeature(QObject* parent, TrackCollection* pTrackCollectio
                   << "genre";
     m_trackSource->setSearchColumns(searchColumns);
 
-    m_isActivated = false;
     m_pTraktorTableModel = new TraktorTrackModel(this, m_pTrackCollection, m_trackSource);
     m_pTraktorPlaylistModel = new TraktorPlaylistModel(this, m_pTrackCollection, m_trackSource);
 
-    m_title = tr("Traktor");
-
-    m_database = QSqlDatabase::cloneDatabase(pTrackCollection->database(),
+    m_database = QSqlDatabase::cloneDatabase(m_pTrackCollection->database(),
                                              "TRAKTOR_SCANNER");
 
     //Open the database connection in this thread.
@@ -97,16 +138,6 @@ TraktorFeature::TraktorFeature(QObject* parent, TrackCollection* pTrackCollectio
         qDebug() << "Failed to open database for iTunes scanner."
                  << m_database.lastError();
     }
-    connect(&m_future_watcher, SIGNAL(finished()),
-            this, SLOT(onTrackCollectionLoaded()));
-}
-
-TraktorFeature::~TraktorFeature() {
-    m_database.close();
-    m_cancelImport = true;
-    m_future.waitForFinished();
-    delete m_pTraktorTableModel;
-    delete m_pTraktorPlaylistModel;
 }
 
 BaseSqlTableModel* TraktorFeature::getPlaylistModelForPlaylist(QString playlist) {
@@ -180,22 +211,26 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     //Give thread a low priority
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
+
+    // Skip parsing if the collection has not been modified since the
+    // last import
+    ExternalLibraryFileState fileState(m_database, kCollectionStateKey, file);
+    if (fileState.isUnchanged()) {
+        qDebug() << "Traktor collection has not been modified since the last import";
+        return loadPlaylists();
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+
     //Invisible root item of Traktor's child model
     TreeItem* root = NULL;
-    //Delete all table entries of Traktor feature
+    // Playlists are rebuilt from scratch. The tracks in traktor_library
+    // are updated incrementally while parsing.
     ScopedTransaction transaction(m_database);
     clearTable("traktor_playlist_tracks");
-    clearTable("traktor_library");
     clearTable("traktor_playlists");
-    transaction.commit();
-
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO traktor_library (artist, title, album, year,"
-                  "genre,comment,tracknumber,bpm, bitrate,duration, location,"
-                  "rating,key) VALUES (:artist, :title, :album, :year,:genre,"
-                  ":comment, :tracknumber,:bpm, :bitrate,:duration, :location,"
-                  ":rating,:key)");
+    ExternalTrackTableUpdater updater(m_database, "traktor_library", "location", kTrackColumns);
 
     //Parse Trakor XML file using SAX (for performance)
     QFile traktor_file(file);
@@ -205,6 +240,7 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     }
     QXmlStreamReader xml(&traktor_file);
     bool inCollectionTag = false;
+    bool isCollectionParsed = false;
     bool inPlaylistsTag = false;
     bool isRootFolderParsed = false;
     int nAudioFiles = 0;
@@ -218,7 +254,7 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
             // Each "ENTRY" tag in <COLLECTION> represents a track
             if (inCollectionTag && xml.name() == "ENTRY") {
                 //parse track
-                parseTrack(xml, query);
+                parseTrack(xml, &updater);
                 ++nAudioFiles; //increment number of files in the music collection
             }
             if (xml.name() == "PLAYLISTS") {
@@ -238,6 +274,10 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
         if (xml.isEndElement()) {
             if (xml.name() == "COLLECTION") {
                 inCollectionTag = false;
+                // All tracks are known now. Remove those that have been
+                // deleted in Traktor.
+                updater.removeUnappliedRows();
+                isCollectionParsed = true;
             }
             if (xml.name() == "PLAYLISTS" && inPlaylistsTag) {
                 inPlaylistsTag = false;
@@ -252,14 +292,61 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
          return NULL;
     }
 
-    qDebug() << "Found: " << nAudioFiles << " audio files in Traktor";
+    qDebug() << "Found: " << nAudioFiles << " audio files in Traktor:"
+             << updater.insertedRows() << "added,"
+             << updater.updatedRows() << "updated,"
+             << updater.removedRows() << "removed";
     //initialize TraktorTableModel
     transaction.commit();
 
+    if (isCollectionParsed && !m_cancelImport) {
+        fileState.save();
+    }
+
+    const mixxx::Duration elapsed = timer.elapsed();
+    qDebug() << "Parsed" << fileState.fileSize() << "bytes of Traktor collection in"
+             << elapsed.formatMillisWithUnit() << "with"
+             << fileState.fileSize() / math_max(elapsed.toDoubleSeconds(), 0.001) / (1024 * 1024)
+             << "MiB/s";
     return root;
 }
 
-void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+TreeItem* TraktorFeature::loadPlaylists() {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT name FROM traktor_playlists ORDER BY id")) {
+        LOG_FAILED_QUERY(query);
+        return NULL;
+    }
+    TreeItem* rootItem = new TreeItem(this);
+    // Folders are not stored in the database and are restored from the
+    // paths of the playlists. Empty folders are omitted.
+    QHash<QString, TreeItem*> folders;
+    while (query.next()) {
+        const QString playlistPath = query.value(0).toString();
+        const QStringList names = playlistPath.split(
+                kPlaylistPathDelimiter, QString::SkipEmptyParts);
+        if (names.isEmpty()) {
+            continue;
+        }
+        TreeItem* parent = rootItem;
+        QString folderPath;
+        for (int i = 0; i < names.size() - 1; ++i) {
+            folderPath += kPlaylistPathDelimiter;
+            folderPath += names.at(i);
+            TreeItem* folder = folders.value(folderPath);
+            if (!folder) {
+                folder = parent->appendChild(names.at(i), folderPath);
+                folders.insert(folderPath, folder);
+            }
+            parent = folder;
+        }
+        parent->appendChild(names.last(), playlistPath);
+    }
+    return rootItem;
+}
+
+void TraktorFeature::parseTrack(QXmlStreamReader &xml, ExternalTrackTableUpdater* pUpdater) {
     QString title;
     QString artist;
     QString album;
@@ -345,27 +432,22 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
     }
 
     // If we reach the end of ENTRY within the COLLECTION tag
-    // Save parsed track to database
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":key", key);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-    if (!success) {
-        qDebug() << "SQL Error in TraktorTableModel.cpp: line"
-                 << __LINE__ << " " << query.lastError();
-        return;
-    }
+    // Save parsed track to database. The order of values must match
+    // kTrackColumns.
+    pUpdater->applyRow(QVariantList()
+            << artist
+            << title
+            << album
+            << year
+            << genre
+            << comment
+            << tracknumber
+            << bpm
+            << bitrate
+            << playtime
+            << location
+            << rating
+            << key);
 }
 
 // Purpose: Parsing all the folder and playlists of Traktor
@@ -380,7 +462,7 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
     QString current_path = "";
     QMap<QString,QString> map;
 
-    QString delimiter = "-->";
+    const QString& delimiter = kPlaylistPathDelimiter;
 
     TreeItem *rootItem = new TreeItem(this);
     TreeItem * parent = rootItem;
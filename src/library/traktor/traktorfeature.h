@@ -18,6 +18,7 @@
 
 class TrackCollection;
 class BaseExternalPlaylistModel;
+class ExternalTrackTableUpdater;
 
 class TraktorTrackModel : public BaseExternalTrackModel {
   public:
@@ -47,6 +48,9 @@ class TraktorFeature : public BaseExternalLibraryFeature {
 
     TreeItemModel* getChildModel();
 
+  protected:
+    void initialize() override;
+
   public slots:
     void activate();
     void activateChild(const QModelIndex& index);
@@ -57,9 +61,12 @@ class TraktorFeature : public BaseExternalLibraryFeature {
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     TreeItem* importLibrary(QString file);
     // parses a track in the music collection
-    void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    void parseTrack(QXmlStreamReader &xml, ExternalTrackTableUpdater* pUpdater);
     // Iterates over all playliost and folders and constructs the childmodel
     TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    // Restores the childmodel from the database if the collection
+    // has not been modified since the last import
+    TreeItem* loadPlaylists();
     // processes a particular playlist
     void parsePlaylistEntries(QXmlStreamReader &xml, QString playlist_path,
     QSqlQuery query_insert_into_playlist, QSqlQuery query_insert_into_playlisttracks);
@@ -15,6 +15,8 @@
 *                                                                         *
 ***************************************************************************/
 
+#include <stdio.h>
+
 #include <QThread>
 #include <QDir>
 #include <QtDebug>
@@ -25,8 +27,10 @@
 
 #include "mixxx.h"
 #include "mixxxapplication.h"
-#include "sources/soundsourceproxy.h"
 #include "errordialoghandler.h"
+#include "mixer/offlinerenderer.h"
+#include "preferences/settingsmanager.h"
+#include "sources/soundsourceproxy.h"
 #include "util/cmdlineargs.h"
 #include "util/console.h"
 #include "util/logging.h"
@@ -55,6 +59,36 @@ int runMixxx(MixxxApplication* app, const CmdlineArgs& args) {
     return result;
 }
 
+int runOfflineRender(const CmdlineArgs& args) {
+    OfflineRenderScript script;
+    QString error;
+    if (!script.load(args.getRenderScriptPath(), &error)) {
+        qWarning() << error;
+        return -1;
+    }
+
+    // The settings are only read, rendering must not change them
+    SettingsManager settingsManager(nullptr, args.getSettingsPath());
+    SoundSourceProxy::loadPlugins();
+
+    OfflineRenderer renderer(settingsManager.settings(), script);
+    const bool success = args.getRenderOutputPath().isEmpty() ?
+            renderer.render(nullptr, &error) :
+            renderer.renderToFile(args.getRenderOutputPath(), &error);
+    if (!success) {
+        qWarning() << error;
+        return -1;
+    }
+    fprintf(stdout, "Rendered %.1f s in %.1f s: %.1fx realtime, "
+            "engine %.1fx realtime\n",
+            static_cast<double>(renderer.getFramesRendered()) /
+                    script.getSampleRate(),
+            renderer.getRenderDuration().toDoubleSeconds(),
+            renderer.getRealtimeFactor(),
+            renderer.getEngineRealtimeFactor());
+    return 0;
+}
+
 } // anonymous namespace
 
 int main(int argc, char * argv[]) {
@@ -99,9 +133,6 @@ int main(int argc, char * argv[]) {
     QTextCodec::setCodecForTr(QTextCodec::codecForName("UTF-8"));
 #endif
 
-    // Enumerate and load SoundSource plugins
-    SoundSourceProxy::loadPlugins();
-
 #ifdef __APPLE__
     QDir dir(QApplication::applicationDirPath());
     // Set the search path for Qt plugins to be in the bundle's PlugIns
@@ -122,7 +153,8 @@ int main(int argc, char * argv[]) {
     // When the last window is closed, terminate the Qt event loop.
     QObject::connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
 
-    int result = runMixxx(&app, args);
+    int result = args.getRenderEnabled() ?
+            runOfflineRender(args) : runMixxx(&app, args);
 
     qDebug() << "Mixxx shutdown complete with code" << result;
 
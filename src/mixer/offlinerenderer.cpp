@@ -0,0 +1,548 @@
+#include "mixer/offlinerenderer.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+#include <QtDebug>
+
+#include "control/controlobject.h"
+#include "effects/effectrack.h"
+#include "effects/effectsmanager.h"
+#include "effects/native/biquadfullkilleqeffect.h"
+#include "effects/native/filtereffect.h"
+#include "effects/native/nativebackend.h"
+#include "encoder/encoder.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginedeck.h"
+#include "engine/enginemaster.h"
+#include "mixer/basetrackplayer.h"
+#include "mixer/deck.h"
+#include "mixer/playermanager.h"
+#include "mixer/sampler.h"
+#include "soundio/soundmanagerutil.h"
+#include "track/beatfactory.h"
+#include "track/track.h"
+#include "util/defs.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/sleepableqthread.h"
+#include "waveform/guitick.h"
+
+namespace {
+
+const int kMinBufferFrames = 16;
+const int kMaxBufferFrames = 8192;
+const int kMaxDecks = 4;
+const int kMaxSamplers = 64;
+
+// The EQ settings of DlgPrefEQ
+const QString kMixerProfile = "[Mixer Profile]";
+
+// The time a track may take to load before rendering fails
+const mixxx::Duration kTrackLoadTimeout = mixxx::Duration::fromSeconds(30);
+
+// The time a reader may take to deliver the chunks of one callback
+const mixxx::Duration kReadTimeout = mixxx::Duration::fromSeconds(10);
+
+// Writes the encoded output into a file like EngineRecord
+class EncoderFileCallback : public EncoderCallback {
+  public:
+    explicit EncoderFileCallback(const QString& path)
+            : m_file(path) {
+    }
+
+    bool open() {
+        return m_file.open(QIODevice::WriteOnly);
+    }
+
+    QString errorString() const {
+        return m_file.errorString();
+    }
+
+    void write(const unsigned char* header, const unsigned char* body,
+               int headerLen, int bodyLen) override {
+        // Relevant for OGG
+        if (headerLen > 0) {
+            m_file.write(reinterpret_cast<const char*>(header), headerLen);
+        }
+        m_file.write(reinterpret_cast<const char*>(body), bodyLen);
+    }
+
+    int tell() override {
+        return static_cast<int>(m_file.pos());
+    }
+
+    void seek(int pos) override {
+        m_file.seek(static_cast<qint64>(pos));
+    }
+
+    int filelen() override {
+        return static_cast<int>(m_file.size());
+    }
+
+  private:
+    QFile m_file;
+};
+
+bool parseDouble(const QString& text, double* pValue) {
+    bool ok = false;
+    *pValue = text.toDouble(&ok);
+    return ok;
+}
+
+bool parseInt(const QString& text, int min, int max, int* pValue) {
+    bool ok = false;
+    *pValue = text.toInt(&ok);
+    return ok && *pValue >= min && *pValue <= max;
+}
+
+bool startsEarlier(const OfflineRenderCommand& lhs,
+                   const OfflineRenderCommand& rhs) {
+    return lhs.startTime < rhs.startTime;
+}
+
+}  // anonymous namespace
+
+OfflineRenderScript::OfflineRenderScript()
+        : m_sampleRate(44100),
+          m_bufferFrames(1024),
+          m_numDecks(2),
+          m_numSamplers(0),
+          m_length(0.0) {
+}
+
+bool OfflineRenderScript::load(const QString& path, QString* pError) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *pError = QString("Could not open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return parse(QTextStream(&file).readAll(), pError);
+}
+
+bool OfflineRenderScript::parse(const QString& script, QString* pError) {
+    const QStringList lines = script.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString line = lines[i].section('#', 0, 0).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        const QStringList tokens = line.split(QRegExp("\\s+"));
+        const QString& statement = tokens[0];
+        bool valid = false;
+        if (statement == "samplerate" && tokens.size() == 2) {
+            valid = parseInt(tokens[1], 8000, 192000, &m_sampleRate);
+        } else if (statement == "buffer" && tokens.size() == 2) {
+            valid = parseInt(tokens[1], kMinBufferFrames, kMaxBufferFrames,
+                    &m_bufferFrames);
+        } else if (statement == "decks" && tokens.size() == 2) {
+            valid = parseInt(tokens[1], 1, kMaxDecks, &m_numDecks);
+        } else if (statement == "samplers" && tokens.size() == 2) {
+            valid = parseInt(tokens[1], 0, kMaxSamplers, &m_numSamplers);
+        } else if (statement == "length" && tokens.size() == 2) {
+            valid = parseDouble(tokens[1], &m_length) && m_length > 0;
+        } else if (statement == "load" && tokens.size() >= 3) {
+            // The location may contain spaces
+            int deck = 0;
+            valid = parseInt(tokens[1], 1, kMaxDecks, &deck);
+            if (valid) {
+                m_tracks[deck - 1] = line.section(QRegExp("\\s+"), 2);
+            }
+        } else if (statement == "bpm" && tokens.size() == 3) {
+            int deck = 0;
+            double bpm = 0.0;
+            valid = parseInt(tokens[1], 1, kMaxDecks, &deck) &&
+                    parseDouble(tokens[2], &bpm) && bpm > 0;
+            if (valid) {
+                m_trackBpms[deck - 1] = bpm;
+            }
+        } else if (statement == "sampler" && tokens.size() >= 3) {
+            int sampler = 0;
+            valid = parseInt(tokens[1], 1, kMaxSamplers, &sampler);
+            if (valid) {
+                m_samplerTracks[sampler - 1] = line.section(QRegExp("\\s+"), 2);
+            }
+        } else if (statement == "set" && tokens.size() == 5) {
+            OfflineRenderCommand command;
+            command.key = ConfigKey(tokens[2], tokens[3]);
+            valid = parseDouble(tokens[1], &command.startTime) &&
+                    command.startTime >= 0 &&
+                    parseDouble(tokens[4], &command.startValue);
+            if (valid) {
+                command.endTime = command.startTime;
+                command.endValue = command.startValue;
+                m_commands.append(command);
+            }
+        } else if (statement == "ramp" && tokens.size() == 7) {
+            OfflineRenderCommand command;
+            command.key = ConfigKey(tokens[3], tokens[4]);
+            valid = parseDouble(tokens[1], &command.startTime) &&
+                    parseDouble(tokens[2], &command.endTime) &&
+                    command.startTime >= 0 &&
+                    command.endTime > command.startTime &&
+                    parseDouble(tokens[5], &command.startValue) &&
+                    parseDouble(tokens[6], &command.endValue);
+            if (valid) {
+                m_commands.append(command);
+            }
+        }
+        if (!valid) {
+            *pError = QString("Invalid statement in line %1: %2")
+                    .arg(QString::number(i + 1), line);
+            return false;
+        }
+    }
+
+    if (m_length <= 0) {
+        *pError = "The script has no length";
+        return false;
+    }
+    for (auto it = m_tracks.constBegin(); it != m_tracks.constEnd(); ++it) {
+        if (it.key() >= m_numDecks) {
+            *pError = QString("Deck %1 does not exist").arg(it.key() + 1);
+            return false;
+        }
+    }
+    for (auto it = m_trackBpms.constBegin(); it != m_trackBpms.constEnd(); ++it) {
+        if (!m_tracks.contains(it.key())) {
+            *pError = QString("Deck %1 has no track").arg(it.key() + 1);
+            return false;
+        }
+    }
+    for (auto it = m_samplerTracks.constBegin();
+            it != m_samplerTracks.constEnd(); ++it) {
+        if (it.key() >= m_numSamplers) {
+            *pError = QString("Sampler %1 does not exist").arg(it.key() + 1);
+            return false;
+        }
+    }
+    std::stable_sort(m_commands.begin(), m_commands.end(), startsEarlier);
+    return true;
+}
+
+OfflineRenderer::OfflineRenderer(UserSettingsPointer pConfig,
+                                 const OfflineRenderScript& script)
+        : m_pConfig(pConfig),
+          m_script(script),
+          m_pGuiTick(std::make_unique<GuiTick>()),
+          m_pNumDecks(std::make_unique<ControlObject>(
+                  ConfigKey("[Master]", "num_decks"))),
+          m_pNumSamplers(std::make_unique<ControlObject>(
+                  ConfigKey("[Master]", "num_samplers"))),
+          m_nextCommand(0),
+          m_framesRendered(0) {
+    // Set up like MixxxMainWindow::initialize(), but without sidechain,
+    // because nothing is recorded or broadcast.
+    m_pEffectsManager = new EffectsManager(NULL, pConfig);
+    m_pEngineMaster = new EngineMaster(pConfig, "[Master]", m_pEffectsManager,
+                                       false, true);
+    NativeBackend* pNativeBackend = new NativeBackend(m_pEffectsManager);
+    m_pEffectsManager->addEffectsBackend(pNativeBackend);
+    m_pEffectsManager->setup();
+
+    ControlObject::set(ConfigKey("[Master]", "samplerate"),
+            m_script.getSampleRate());
+    // Like DlgPrefEQ::slotApply()
+    ControlObject::set(ConfigKey(kMixerProfile, "LoEQFrequency"),
+            pConfig->getValue(ConfigKey(kMixerProfile, "LoEQFrequencyPrecise"),
+                    250.0));
+    ControlObject::set(ConfigKey(kMixerProfile, "HiEQFrequency"),
+            pConfig->getValue(ConfigKey(kMixerProfile, "HiEQFrequencyPrecise"),
+                    2500.0));
+    m_pEngineMaster->onOutputConnected(AudioOutput(AudioOutput::MASTER, 0, 2));
+
+    // Like PlayerManager::addDeckInner()
+    for (int i = 0; i < m_script.getNumDecks(); ++i) {
+        const QString group = PlayerManager::groupForDeck(i);
+        const EngineChannel::ChannelOrientation orientation =
+                (i % 2 == 0) ? EngineChannel::LEFT : EngineChannel::RIGHT;
+        Deck* pDeck = new Deck(NULL, pConfig, m_pEngineMaster,
+                               m_pEffectsManager, orientation, group);
+        m_decks.append(pDeck);
+        m_players.append(pDeck);
+        m_pNumDecks->set(m_decks.size());
+
+        EqualizerRackPointer pEqRack = m_pEffectsManager->getEqualizerRack(0);
+        if (pEqRack) {
+            pEqRack->addEffectChainSlotForGroup(group);
+        }
+        pDeck->setupEqControls();
+        QuickEffectRackPointer pQuickEffectRack =
+                m_pEffectsManager->getQuickEffectRack(0);
+        if (pQuickEffectRack) {
+            pQuickEffectRack->addEffectChainSlotForGroup(group);
+        }
+        loadDefaultEffects(group);
+    }
+
+    // Like PlayerManager::addSamplerInner()
+    for (int i = 0; i < m_script.getNumSamplers(); ++i) {
+        Sampler* pSampler = new Sampler(NULL, pConfig, m_pEngineMaster,
+                m_pEffectsManager, EngineChannel::CENTER,
+                PlayerManager::groupForSampler(i));
+        m_samplers.append(pSampler);
+        m_players.append(pSampler);
+        m_pNumSamplers->set(m_samplers.size());
+    }
+}
+
+OfflineRenderer::~OfflineRenderer() {
+    // Same order as MixxxMainWindow::finalize()
+    qDeleteAll(m_samplers);
+    qDeleteAll(m_decks);
+    delete m_pEngineMaster;
+    delete m_pEffectsManager;
+}
+
+void OfflineRenderer::loadDefaultEffects(const QString& group) {
+    // Like DlgPrefEQ::applySelections(), the preferences are not created
+    // for offline rendering
+    EqualizerRackPointer pEqRack = m_pEffectsManager->getEqualizerRack(0);
+    if (pEqRack) {
+        EffectPointer pEffect = m_pEffectsManager->instantiateEffect(
+                m_pConfig->getValue(
+                        ConfigKey(kMixerProfile, "EffectForGroup_" + group),
+                        BiquadFullKillEQEffect::getId()));
+        pEqRack->loadEffectToGroup(group, pEffect);
+        if (pEffect && m_pConfig->getValue(
+                ConfigKey(kMixerProfile, "EnableEQs"), "yes") == "no") {
+            pEffect->setEnabled(false);
+        }
+    }
+    QuickEffectRackPointer pQuickEffectRack =
+            m_pEffectsManager->getQuickEffectRack(0);
+    if (pQuickEffectRack) {
+        pQuickEffectRack->loadEffectToGroup(group,
+                m_pEffectsManager->instantiateEffect(m_pConfig->getValue(
+                        ConfigKey(kMixerProfile, "QuickEffectForGroup_" + group),
+                        FilterEffect::getId())));
+    }
+}
+
+double OfflineRenderer::getRealtimeFactor() const {
+    if (m_renderDuration.toDoubleSeconds() <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(m_framesRendered) / m_script.getSampleRate() /
+            m_renderDuration.toDoubleSeconds();
+}
+
+double OfflineRenderer::getEngineRealtimeFactor() const {
+    if (m_engineDuration.toDoubleSeconds() <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(m_framesRendered) / m_script.getSampleRate() /
+            m_engineDuration.toDoubleSeconds();
+}
+
+bool OfflineRenderer::renderToFile(const QString& path, QString* pError) {
+    const QString formatName = QFileInfo(path).suffix().toUpper();
+    bool supported = false;
+    for (const auto& format : EncoderFactory::getFactory().getFormats()) {
+        supported = supported || format.internalName == formatName;
+    }
+    if (!supported) {
+        *pError = QString("Unsupported output format: %1").arg(path);
+        return false;
+    }
+
+    EncoderFileCallback file(path);
+    if (!file.open()) {
+        *pError = QString("Could not open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    EncoderPointer pEncoder = EncoderFactory::getFactory().getNewEncoder(
+            EncoderFactory::getFactory().getFormatFor(formatName),
+            m_pConfig, &file);
+    QString errorMessage;
+    if (pEncoder->initEncoder(m_script.getSampleRate(), errorMessage) < 0) {
+        *pError = QString("Could not initialize the encoder for %1").arg(path);
+        return false;
+    }
+    const bool success = render(pEncoder.get(), pError);
+    pEncoder->flush();
+    return success;
+}
+
+bool OfflineRenderer::render(Encoder* pEncoder, QString* pError) {
+    if (!prepare(pError)) {
+        return false;
+    }
+
+    const int bufferFrames = m_script.getBufferFrames();
+    const SINT framesToRender = static_cast<SINT>(
+            m_script.getLength() * m_script.getSampleRate());
+    PerformanceTimer timer;
+    timer.start();
+    bool success = true;
+    while (success && m_framesRendered < framesToRender) {
+        success = renderBuffer(pEncoder, static_cast<int>(math_min<SINT>(
+                bufferFrames, framesToRender - m_framesRendered)), pError);
+    }
+    m_renderDuration = timer.elapsed();
+    return success;
+}
+
+bool OfflineRenderer::prepare(QString* pError) {
+    m_commandControls.clear();
+    for (const auto& command : m_script.getCommands()) {
+        ControlObject* pControl = ControlObject::getControl(command.key, false);
+        if (!pControl) {
+            *pError = QString("Unknown control %1,%2")
+                    .arg(command.key.group, command.key.item);
+            return false;
+        }
+        m_commandControls.append(pControl);
+    }
+    m_nextCommand = 0;
+    m_activeRamps.clear();
+
+    if (!loadTracks(pError)) {
+        return false;
+    }
+
+    m_framesRendered = 0;
+    m_renderDuration = mixxx::Duration();
+    m_engineDuration = mixxx::Duration();
+    return true;
+}
+
+bool OfflineRenderer::renderBuffer(Encoder* pEncoder, int frames,
+        QString* pError) {
+    applyCommands(static_cast<double>(m_framesRendered) /
+            m_script.getSampleRate());
+    if (!processEngine(pError)) {
+        return false;
+    }
+    if (pEncoder) {
+        pEncoder->encodeBuffer(m_pEngineMaster->getMasterBuffer(), frames * 2);
+    }
+    m_framesRendered += frames;
+    return true;
+}
+
+bool OfflineRenderer::loadTracks(QString* pError) {
+    QList<QPair<BaseTrackPlayerImpl*, QString>> players;
+    const QMap<int, QString>& tracks = m_script.getTracks();
+    for (auto it = tracks.constBegin(); it != tracks.constEnd(); ++it) {
+        players.append(qMakePair<BaseTrackPlayerImpl*, QString>(
+                m_decks[it.key()], it.value()));
+    }
+    const QMap<int, QString>& samplerTracks = m_script.getSamplerTracks();
+    for (auto it = samplerTracks.constBegin();
+            it != samplerTracks.constEnd(); ++it) {
+        players.append(qMakePair<BaseTrackPlayerImpl*, QString>(
+                m_samplers[it.key()], it.value()));
+    }
+
+    for (const auto& player : players) {
+        if (!QFileInfo(player.second).exists()) {
+            *pError = QString("Track not found: %1").arg(player.second);
+            return false;
+        }
+        player.first->slotLoadTrack(Track::newTemporary(player.second), false);
+    }
+
+    // The reader worker is woken by the callbacks, their output is dropped
+    PerformanceTimer timer;
+    timer.start();
+    for (const auto& player : players) {
+        EngineBuffer* pEngineBuffer =
+                player.first->getEngineDeck()->getEngineBuffer();
+        while (!pEngineBuffer->isTrackLoaded() ||
+                pEngineBuffer->isTrackLoading()) {
+            if (timer.elapsed() > kTrackLoadTimeout) {
+                *pError = QString("Could not load %1").arg(player.second);
+                return false;
+            }
+            if (!processEngine(pError)) {
+                return false;
+            }
+            SleepableQThread::msleep(1);
+        }
+    }
+    // Let the players finish loading, e.g. update the BPM from the tags
+    QCoreApplication::processEvents();
+
+    // The sample rate of the tracks is known now
+    const QMap<int, double>& bpms = m_script.getTrackBpms();
+    for (auto it = bpms.constBegin(); it != bpms.constEnd(); ++it) {
+        TrackPointer pTrack = m_decks[it.key()]->getLoadedTrack();
+        pTrack->setBeats(BeatFactory::makeBeatGrid(*pTrack, it.value(), 0.0));
+    }
+    QCoreApplication::processEvents();
+    return true;
+}
+
+void OfflineRenderer::applyCommands(double time) {
+    const QList<OfflineRenderCommand>& commands = m_script.getCommands();
+    while (m_nextCommand < commands.size() &&
+            commands[m_nextCommand].startTime <= time) {
+        if (commands[m_nextCommand].endTime > time) {
+            m_activeRamps.append(m_nextCommand);
+        } else {
+            // Sets and ramps that were skipped by a long buffer
+            m_commandControls[m_nextCommand]->set(
+                    commands[m_nextCommand].endValue);
+        }
+        ++m_nextCommand;
+    }
+
+    for (auto it = m_activeRamps.begin(); it != m_activeRamps.end();) {
+        const OfflineRenderCommand& command = commands[*it];
+        if (time >= command.endTime) {
+            m_commandControls[*it]->set(command.endValue);
+            it = m_activeRamps.erase(it);
+        } else {
+            const double ratio = (time - command.startTime) /
+                    (command.endTime - command.startTime);
+            m_commandControls[*it]->set(command.startValue +
+                    ratio * (command.endValue - command.startValue));
+            ++it;
+        }
+    }
+}
+
+bool OfflineRenderer::waitForReaders(QString* pError) {
+    for (BaseTrackPlayerImpl* pPlayer : m_players) {
+        EngineBuffer* pEngineBuffer = pPlayer->getEngineDeck()->getEngineBuffer();
+        if (pEngineBuffer->collectReaderChunks()) {
+            continue;
+        }
+        PerformanceTimer timer;
+        timer.start();
+        do {
+            if (timer.elapsed() > kReadTimeout) {
+                *pError = QString("Timed out reading the track of %1")
+                        .arg(pPlayer->getGroup());
+                return false;
+            }
+            // Leaves the CPU to the reader worker
+            SleepableQThread::usleep(100);
+        } while (!pEngineBuffer->collectReaderChunks());
+    }
+    return true;
+}
+
+bool OfflineRenderer::processEngine(QString* pError) {
+    if (!waitForReaders(pError)) {
+        return false;
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    m_pEngineMaster->process(m_script.getBufferFrames() * 2);
+    m_lastEngineDuration = timer.elapsed();
+    m_engineDuration += m_lastEngineDuration;
+
+    // Deliver the signals that are queued for the main thread, e.g. the
+    // responses of the effects engine and the loaded tracks
+    QCoreApplication::processEvents();
+    return true;
+}
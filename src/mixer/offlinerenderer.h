@@ -0,0 +1,180 @@
+#ifndef MIXER_OFFLINERENDERER_H
+#define MIXER_OFFLINERENDERER_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "preferences/usersettings.h"
+#include "util/duration.h"
+#include "util/memory.h"
+#include "util/types.h"
+
+class BaseTrackPlayerImpl;
+class ControlObject;
+class Deck;
+class EffectsManager;
+class Encoder;
+class EngineMaster;
+class GuiTick;
+class Sampler;
+
+// Sets a control at startTime or ramps it linearly from startValue to
+// endValue between startTime and endTime. Times are in seconds.
+struct OfflineRenderCommand {
+    double startTime;
+    double endTime;
+    ConfigKey key;
+    double startValue;
+    double endValue;
+};
+
+// The timeline of an offline render. Scripts are plain text with one
+// statement per line, # starts a comment:
+//
+//   samplerate 44100         sample rate of the output, default 44100
+//   buffer 1024              frames per engine callback, default 1024
+//   decks 2                  number of decks, default 2
+//   samplers 4               number of samplers, default 0
+//   length 300               seconds to render, required
+//   load 1 /path/track.mp3   loads a track into deck 1 before rendering
+//   sampler 1 /path/hit.wav  loads a track into sampler 1 before rendering
+//   bpm 1 128                sets a beat grid on the track of deck 1
+//   set 0.5 [Channel1] play 1
+//   ramp 30 45 [Master] crossfader -1 1
+//
+// Commands take effect in the first callback that starts at or after their
+// time, so the timing resolution is one buffer.
+class OfflineRenderScript {
+  public:
+    OfflineRenderScript();
+
+    // Returns false with a message in pError if the script is invalid
+    bool parse(const QString& script, QString* pError);
+    bool load(const QString& path, QString* pError);
+
+    int getSampleRate() const {
+        return m_sampleRate;
+    }
+    int getBufferFrames() const {
+        return m_bufferFrames;
+    }
+    int getNumDecks() const {
+        return m_numDecks;
+    }
+    int getNumSamplers() const {
+        return m_numSamplers;
+    }
+    double getLength() const {
+        return m_length;
+    }
+    // The track locations by the zero based deck index
+    const QMap<int, QString>& getTracks() const {
+        return m_tracks;
+    }
+    // The BPMs of the beat grids by the zero based deck index
+    const QMap<int, double>& getTrackBpms() const {
+        return m_trackBpms;
+    }
+    // The track locations by the zero based sampler index
+    const QMap<int, QString>& getSamplerTracks() const {
+        return m_samplerTracks;
+    }
+    // Sorted by start time, commands with the same time keep their order
+    const QList<OfflineRenderCommand>& getCommands() const {
+        return m_commands;
+    }
+
+  private:
+    int m_sampleRate;
+    int m_bufferFrames;
+    int m_numDecks;
+    int m_numSamplers;
+    double m_length;
+    QMap<int, QString> m_tracks;
+    QMap<int, double> m_trackBpms;
+    QMap<int, QString> m_samplerTracks;
+    QList<OfflineRenderCommand> m_commands;
+};
+
+// Drives an EngineMaster without a sound device as fast as the CPU allows.
+// The decks, the effects and the master mix are set up like in the main
+// window, but the engine callback runs on the calling thread and waits for
+// the CachingReader instead of playing silence for chunks that are not read
+// yet. So the output of a script only depends on the script, the tracks and
+// the settings, which makes the realtime factor a repeatable benchmark.
+class OfflineRenderer {
+  public:
+    OfflineRenderer(UserSettingsPointer pConfig,
+                    const OfflineRenderScript& script);
+    virtual ~OfflineRenderer();
+
+    // Renders the master output into a file. The format is chosen by the
+    // extension of the file like in the recording preferences.
+    bool renderToFile(const QString& path, QString* pError);
+
+    // Renders the master output into pEncoder, which may be null to only
+    // measure the engine.
+    bool render(Encoder* pEncoder, QString* pError);
+
+    // render() split up for benchmarks that time each callback: prepare()
+    // resolves the controls and loads the tracks, then each renderBuffer()
+    // applies the commands due and runs one callback of the script's
+    // buffer size. frames limits what is encoded of the last buffer.
+    // renderBuffer() fails if a reader does not deliver its chunks in time.
+    bool prepare(QString* pError);
+    bool renderBuffer(Encoder* pEncoder, int frames, QString* pError);
+
+    SINT getFramesRendered() const {
+        return m_framesRendered;
+    }
+    // The time spent rendering, including waiting for the decoders
+    mixxx::Duration getRenderDuration() const {
+        return m_renderDuration;
+    }
+    // The time spent in EngineMaster::process()
+    mixxx::Duration getEngineDuration() const {
+        return m_engineDuration;
+    }
+    // The time of the last EngineMaster::process() call
+    mixxx::Duration getLastEngineDuration() const {
+        return m_lastEngineDuration;
+    }
+    // Seconds of audio rendered per second
+    double getRealtimeFactor() const;
+    double getEngineRealtimeFactor() const;
+
+  private:
+    void loadDefaultEffects(const QString& group);
+    bool loadTracks(QString* pError);
+    void applyCommands(double time);
+    bool waitForReaders(QString* pError);
+    bool processEngine(QString* pError);
+
+    const UserSettingsPointer m_pConfig;
+    const OfflineRenderScript m_script;
+
+    std::unique_ptr<GuiTick> m_pGuiTick;
+    std::unique_ptr<ControlObject> m_pNumDecks;
+    std::unique_ptr<ControlObject> m_pNumSamplers;
+    EffectsManager* m_pEffectsManager;
+    EngineMaster* m_pEngineMaster;
+    QList<Deck*> m_decks;
+    QList<Sampler*> m_samplers;
+    // The decks followed by the samplers
+    QList<BaseTrackPlayerImpl*> m_players;
+
+    // The controls of the commands, resolved before rendering
+    QVector<ControlObject*> m_commandControls;
+    int m_nextCommand;
+    // The ramps that have started but not ended yet
+    QList<int> m_activeRamps;
+
+    SINT m_framesRendered;
+    mixxx::Duration m_renderDuration;
+    mixxx::Duration m_engineDuration;
+    mixxx::Duration m_lastEngineDuration;
+};
+
+#endif /* MIXER_OFFLINERENDERER_H */
@@ -22,6 +22,7 @@
 #include <QFileDialog>
 #include <QGLWidget>
 #include <QUrl>
+#include <QtConcurrentRun>
 #include <QtDebug>
 
 #include "analyzer/analyzerqueue.h"
@@ -69,6 +70,8 @@
 #include "util/screensaver.h"
 #include "util/logger.h"
 #include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/startupprofiler.h"
 
 #ifdef __VINYLCONTROL__
 #include "vinylcontrol/vinylcontrolmanager.h"
@@ -82,6 +85,70 @@ namespace {
 
 const mixxx::Logger kLogger("MixxxMainWindow");
 
+// The following startup stages run on the global thread pool while the
+// main thread sets up the engine and the players. They must neither
+// create QObjects nor interact with the user.
+
+void loadSoundSourcePlugins() {
+    mixxx::StartupProfiler::Stage stage("SoundSource plugins");
+    SoundSourceProxy::loadPlugins();
+}
+
+struct DatabaseStartupResult {
+    DatabaseStartupResult()
+        : connected(false),
+          schemaResult(SchemaManager::Result::SchemaError) {
+    }
+    bool connected;
+    SchemaManager::Result schemaResult;
+};
+
+// Opens a temporary connection for the worker thread, upgrades the
+// schema and optimizes the database. The result is reported to the
+// user by checkDatabaseStartup() on the main thread.
+DatabaseStartupResult prepareDatabase(
+        mixxx::DbConnectionPoolPtr pDbConnectionPool,
+        bool optimize) {
+    mixxx::StartupProfiler::Stage stage("Database");
+    DatabaseStartupResult result;
+    const mixxx::DbConnectionPooler dbConnectionPooler(pDbConnectionPool);
+    QSqlDatabase dbConnection = mixxx::DbConnectionPooled(pDbConnectionPool);
+    if (!dbConnection.isOpen()) {
+        return result;
+    }
+    result.connected = true;
+
+    kLogger.info() << "Initializing or upgrading database schema";
+    result.schemaResult = MixxxDb::upgradeDatabaseSchema(dbConnection);
+    switch (result.schemaResult) {
+    case SchemaManager::Result::CurrentVersion:
+    case SchemaManager::Result::UpgradeSucceeded:
+    case SchemaManager::Result::NewerVersionBackwardsCompatible:
+        if (optimize) {
+            MixxxDb::optimizeDatabase(dbConnection);
+        }
+        break;
+    default:
+        // Leave an incompatible or broken database untouched
+        break;
+    }
+    return result;
+}
+
+// Informs the user if the database could not be prepared.
+bool checkDatabaseStartup(const DatabaseStartupResult& result) {
+    if (!result.connected) {
+        QMessageBox::critical(0, MixxxMainWindow::tr("Cannot open database"),
+                            MixxxMainWindow::tr("Unable to establish a database connection.\n"
+                                "Mixxx requires QT with SQLite support. Please read "
+                                "the Qt SQL driver documentation for information on how "
+                                "to build it.\n\n"
+                                "Click OK to exit."), QMessageBox::Ok);
+        return false;
+    }
+    return MixxxDb::checkDatabaseSchemaUpgrade(result.schemaResult);
+}
+
 } // anonymous namespace
 
 // static
@@ -168,14 +235,43 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     UserSettingsPointer pConfig = m_pSettingsManager->settings();
 
+    // Independent stages that do not touch the GUI run concurrently with
+    // the setup of the engine below and are joined right before the
+    // library needs them.
+    QFuture<void> soundSourcePluginsFuture =
+            QtConcurrent::run(loadSoundSourcePlugins);
+
+    m_pDbConnectionPool = MixxxDb(pConfig).connectionPool();
+    if (!m_pDbConnectionPool) {
+        // TODO(XXX) something a little more elegant
+        exit(-1);
+    }
+    kLogger.info() << "Connecting to database";
+    QFuture<DatabaseStartupResult> databaseFuture =
+            QtConcurrent::run(prepareDatabase, m_pDbConnectionPool,
+                    pConfig->getValue(
+                            ConfigKey(MixxxDb::kConfigGroup, "OptimizeOnStartup"),
+                            true));
+
     Sandbox::initialize(QDir(pConfig->getSettingsPath()).filePath("sandbox.cfg"));
 
     QString resourcePath = pConfig->getResourcePath();
 
-    FontUtils::initializeFonts(resourcePath); // takes a long time
+    {
+        // QFontDatabase must only be used from the GUI thread
+        mixxx::StartupProfiler::Stage stage("Fonts");
+        FontUtils::initializeFonts(resourcePath); // takes a long time
+    }
 
     launchProgress(2);
 
+    // Initialize controller sub-system,
+    // but do not set up controllers until the end of the application startup.
+    // The controllers are enumerated on the thread of the ControllerManager
+    // while the engine is set up.
+    qDebug() << "Creating ControllerManager";
+    m_pControllerManager = new ControllerManager(pConfig);
+
     // Set the visibility of tooltips, default "1" = ON
     m_toolTipsCfg = static_cast<mixxx::TooltipsPreference>(
         pConfig->getValue(ConfigKey("[Controls]", "Tooltips"),
@@ -184,6 +280,8 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     setAttribute(Qt::WA_AcceptTouchEvents);
     m_pTouchShift = new ControlPushButton(ConfigKey("[Controls]", "touch_shift"));
 
+    mixxx::Duration stageBegin = mixxx::Time::elapsed();
+
     // Create the Effects subsystem.
     m_pEffectsManager = new EffectsManager(this, pConfig);
 
@@ -199,8 +297,13 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     // Sets up the EffectChains and EffectRacks (long)
     m_pEffectsManager->setup();
 
+    mixxx::StartupProfiler::recordStage("Effects and engine",
+            stageBegin, mixxx::Time::elapsed());
+
     launchProgress(8);
 
+    stageBegin = mixxx::Time::elapsed();
+
     // Although m_pSoundManager is created here, m_pSoundManager->setupDevices()
     // needs to be called after m_pPlayerManager registers sound IO for each EngineChannel.
     m_pSoundManager = new SoundManager(pConfig, m_pEngine);
@@ -213,8 +316,13 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     m_pBroadcastManager = new BroadcastManager(pConfig, m_pSoundManager);
 #endif
 
+    mixxx::StartupProfiler::recordStage("Sound and recording",
+            stageBegin, mixxx::Time::elapsed());
+
     launchProgress(11);
 
+    stageBegin = mixxx::Time::elapsed();
+
     // Needs to be created before CueControl (decks) and WTrackTableView.
     m_pGuiTick = new GuiTick();
 
@@ -249,6 +357,9 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     m_pPlayerManager->addSampler();
     m_pPlayerManager->addPreviewDeck();
 
+    mixxx::StartupProfiler::recordStage("Players",
+            stageBegin, mixxx::Time::elapsed());
+
     launchProgress(30);
 
 #ifdef __VINYLCONTROL__
@@ -263,29 +374,38 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     delete pModplugPrefs; // not needed anymore
 #endif
 
-    CoverArtCache::create();
+    CoverArtCache::create()->setThumbnailDirectory(
+            CoverThumbnailStore::directoryPath(pConfig));
 
-    m_pDbConnectionPool = MixxxDb(pConfig).connectionPool();
-    if (!m_pDbConnectionPool) {
-        // TODO(XXX) something a little more elegant
-        exit(-1);
+    {
+        mixxx::StartupProfiler::Stage stage("Waiting for database");
+        databaseFuture.waitForFinished();
     }
     // Create a connection for the main thread
     m_pDbConnectionPool->createThreadLocalConnection();
-    if (!initializeDatabase()) {
+    if (!checkDatabaseStartup(databaseFuture.result())) {
         // TODO(XXX) something a little more elegant
         exit(-1);
     }
 
     launchProgress(35);
 
-    m_pLibrary = new Library(
-            this,
-            pConfig,
-            m_pDbConnectionPool,
-            m_pPlayerManager,
-            m_pRecordingManager);
-    m_pPlayerManager->bindToLibrary(m_pLibrary);
+    {
+        // The library needs to know all supported file types
+        mixxx::StartupProfiler::Stage stage("Waiting for SoundSource plugins");
+        soundSourcePluginsFuture.waitForFinished();
+    }
+
+    {
+        mixxx::StartupProfiler::Stage stage("Library");
+        m_pLibrary = new Library(
+                this,
+                pConfig,
+                m_pDbConnectionPool,
+                m_pPlayerManager,
+                m_pRecordingManager);
+        m_pPlayerManager->bindToLibrary(m_pLibrary);
+    }
 
     launchProgress(40);
 
@@ -311,19 +431,14 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
         }
     }
 
-    // Call inits to invoke all other construction parts
-
-    // Initialize controller sub-system,
-    // but do not set up controllers until the end of the application startup
-    // (long)
-    qDebug() << "Creating ControllerManager";
-    m_pControllerManager = new ControllerManager(pConfig);
-
     launchProgress(47);
 
-    WaveformWidgetFactory::create(); // takes a long time
-    WaveformWidgetFactory::instance()->startVSync(m_pGuiTick);
-    WaveformWidgetFactory::instance()->setConfig(pConfig);
+    {
+        mixxx::StartupProfiler::Stage stage("Waveforms");
+        WaveformWidgetFactory::create(); // takes a long time
+        WaveformWidgetFactory::instance()->startVSync(m_pGuiTick);
+        WaveformWidgetFactory::instance()->setConfig(pConfig);
+    }
 
     launchProgress(52);
 
@@ -341,12 +456,15 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
         mixxx::ScreenSaverHelper::inhibit();
     }
 
-    // Initialize preference dialog
-    m_pPrefDlg = new DlgPreferences(this, m_pSkinLoader, m_pSoundManager, m_pPlayerManager,
-                                    m_pControllerManager, m_pVCManager, m_pEffectsManager,
-                                    pConfig, m_pLibrary);
-    m_pPrefDlg->setWindowIcon(QIcon(":/images/ic_mixxx_window.png"));
-    m_pPrefDlg->setHidden(true);
+    {
+        // Initialize preference dialog
+        mixxx::StartupProfiler::Stage stage("Preferences");
+        m_pPrefDlg = new DlgPreferences(this, m_pSkinLoader, m_pSoundManager, m_pPlayerManager,
+                                        m_pControllerManager, m_pVCManager, m_pEffectsManager,
+                                        pConfig, m_pLibrary);
+        m_pPrefDlg->setWindowIcon(QIcon(":/images/ic_mixxx_window.png"));
+        m_pPrefDlg->setHidden(true);
+    }
 
     launchProgress(60);
 
@@ -364,6 +482,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     QWidget* oldWidget = m_pWidgetParent;
 
+    stageBegin = mixxx::Time::elapsed();
     // Load skin to a QWidget that we set as the central widget. Assignment
     // intentional in next line.
     if (!(m_pWidgetParent = m_pSkinLoader->loadDefaultSkin(this, m_pKeyboard,
@@ -380,6 +499,9 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
         //TODO (XXX) add dialog to warn user and launch skin choice page
     }
 
+    mixxx::StartupProfiler::recordStage("Skin",
+            stageBegin, mixxx::Time::elapsed());
+
     // Fake a 100 % progress here.
     // At a later place it will newer shown up, since it is
     // immediately replaced by the real widget.
@@ -428,8 +550,14 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     // loaded a skin, see Bug #1047435
     if (rescan || hasChanged_MusicDir || m_pSettingsManager->shouldRescanLibrary()) {
         m_pLibrary->scan();
+    } else {
+        // Pick up changes that have been detected by the library
+        // watcher but not scanned before Mixxx was closed.
+        m_pLibrary->scanChangedDirectories();
     }
 
+    mixxx::StartupProfiler::report();
+
     // Try open player device If that fails, the preference panel is opened.
     bool retryClicked;
     do {
@@ -659,23 +787,6 @@ void MixxxMainWindow::finalize() {
     StatsManager::destroy();
 }
 
-bool MixxxMainWindow::initializeDatabase() {
-    kLogger.info() << "Connecting to database";
-    QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
-    if (!dbConnection.isOpen()) {
-        QMessageBox::critical(0, tr("Cannot open database"),
-                            tr("Unable to establish a database connection.\n"
-                                "Mixxx requires QT with SQLite support. Please read "
-                                "the Qt SQL driver documentation for information on how "
-                                "to build it.\n\n"
-                                "Click OK to exit."), QMessageBox::Ok);
-        return false;
-    }
-
-    kLogger.info() << "Initializing or upgrading database schema";
-    return MixxxDb::initDatabaseSchema(dbConnection);
-}
-
 void MixxxMainWindow::initializeWindow() {
     // be sure createMenuBar() is called first
     DEBUG_ASSERT(m_pMenuBar != nullptr);
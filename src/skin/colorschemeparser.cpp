@@ -1,6 +1,8 @@
 
 #include "skin/colorschemeparser.h"
 
+#include <QTextStream>
+
 #include "widget/wpixmapstore.h"
 #include "widget/wimagestore.h"
 #include "widget/wskincolor.h"
@@ -11,8 +13,8 @@
 #include "skin/imgcolor.h"
 #include "skin/imginvert.h"
 
-void ColorSchemeParser::setupLegacyColorSchemes(QDomElement docElem,
-                                                UserSettingsPointer pConfig) {
+QString ColorSchemeParser::setupLegacyColorSchemes(QDomElement docElem,
+                                                   UserSettingsPointer pConfig) {
     QDomNode colsch = docElem.namedItem("Schemes");
 
     bool found = false;
@@ -36,20 +38,25 @@ void ColorSchemeParser::setupLegacyColorSchemes(QDomElement docElem,
         }
 
         if (found) {
+            QDomNode filters = sch.namedItem("Filters");
             QSharedPointer<ImgSource> imsrc =
-                    QSharedPointer<ImgSource>(parseFilters(sch.namedItem("Filters")));
+                    QSharedPointer<ImgSource>(parseFilters(filters));
             WPixmapStore::setLoader(imsrc);
             WImageStore::setLoader(imsrc);
             WSkinColor::setLoader(imsrc);
+            QString filtersKey;
+            QTextStream stream(&filtersKey);
+            filters.save(stream, 0);
+            stream.flush();
+            return filtersKey;
         }
     }
-    if (!found) {
-        QSharedPointer<ImgSource> imsrc =
-                QSharedPointer<ImgSource>(new ImgLoader());
-        WPixmapStore::setLoader(imsrc);
-        WImageStore::setLoader(imsrc);
-        WSkinColor::setLoader(imsrc);
-    }
+    QSharedPointer<ImgSource> imsrc =
+            QSharedPointer<ImgSource>(new ImgLoader());
+    WPixmapStore::setLoader(imsrc);
+    WImageStore::setLoader(imsrc);
+    WSkinColor::setLoader(imsrc);
+    return QString();
 }
 
 ImgSource* ColorSchemeParser::parseFilters(QDomNode filt) {
@@ -7,7 +7,9 @@ class ImgSource;
 
 class ColorSchemeParser {
   public:
-    static void setupLegacyColorSchemes(QDomElement docElem, UserSettingsPointer pConfig);
+    // Returns a string that identifies the image filters of the selected
+    // color scheme or an empty string if images are not filtered.
+    static QString setupLegacyColorSchemes(QDomElement docElem, UserSettingsPointer pConfig);
   private:
     static ImgSource* parseFilters(QDomNode filter);
     ColorSchemeParser() { }
@@ -0,0 +1,380 @@
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QStringList>
+#include <QtDebug>
+
+#include "skin/compiledskin.h"
+
+#include "skin/skincontext.h"
+#include "skin/svgparser.h"
+#include "util/assert.h"
+#include "util/version.h"
+
+namespace {
+
+// "MXSK"
+const quint32 kMagic = 0x4D58534B;
+// Increment when changing the file format or the compilation rules
+const quint32 kFormatVersion = 1;
+
+enum NodeType {
+    kEndOfChildren = 0,
+    kElementNode = 1,
+    kTextNode = 2,
+};
+
+void writeElement(QDataStream& out, const QDomElement& element) {
+    out << static_cast<quint8>(kElementNode) << element.tagName();
+    const QDomNamedNodeMap attributes = element.attributes();
+    out << static_cast<quint32>(attributes.count());
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QDomAttr attribute = attributes.item(i).toAttr();
+        out << attribute.name() << attribute.value();
+    }
+    QDomNode child = element.firstChild();
+    while (!child.isNull()) {
+        if (child.isElement()) {
+            writeElement(out, child.toElement());
+        } else if (child.isText()) {
+            // includes CDATA sections
+            out << static_cast<quint8>(kTextNode) << child.nodeValue();
+        }
+        // Ignore all other node types.
+        child = child.nextSibling();
+    }
+    out << static_cast<quint8>(kEndOfChildren);
+}
+
+// Reads the remainder of an element after its node type.
+QDomElement readElement(QDataStream& in, QDomDocument& document) {
+    QString tagName;
+    in >> tagName;
+    QDomElement element = document.createElement(tagName);
+    quint32 attributeCount = 0;
+    in >> attributeCount;
+    for (quint32 i = 0; i < attributeCount; ++i) {
+        QString name;
+        QString value;
+        in >> name >> value;
+        element.setAttribute(name, value);
+    }
+    while (in.status() == QDataStream::Ok) {
+        quint8 nodeType = kEndOfChildren;
+        in >> nodeType;
+        if (nodeType == kElementNode) {
+            element.appendChild(readElement(in, document));
+        } else if (nodeType == kTextNode) {
+            QString text;
+            in >> text;
+            element.appendChild(document.createTextNode(text));
+        } else {
+            if (nodeType != kEndOfChildren) {
+                in.setStatus(QDataStream::ReadCorruptData);
+            }
+            break;
+        }
+    }
+    return element;
+}
+
+// Removes the template expressions from a parsed SVG that SvgParser
+// would otherwise evaluate again when the pixmap is loaded. The source
+// files of external scripts are collected in scriptFiles.
+void stripSvgTemplates(QDomElement* pElement, QStringList* pScriptFiles) {
+    const QDomNamedNodeMap attributes = pElement->attributes();
+    QStringList expressionAttributes;
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QString name = attributes.item(i).toAttr().name();
+        if (name.startsWith("expr-")) {
+            expressionAttributes.append(name);
+        }
+    }
+    if (pElement->tagName() == "text") {
+        expressionAttributes.append("value");
+    }
+    foreach (const QString& name, expressionAttributes) {
+        pElement->removeAttribute(name);
+    }
+
+    QDomNode child = pElement->firstChild();
+    while (!child.isNull()) {
+        QDomNode next = child.nextSibling();
+        if (child.isElement()) {
+            QDomElement childElement = child.toElement();
+            if (childElement.tagName() == "script") {
+                if (childElement.hasAttribute("src")) {
+                    pScriptFiles->append(childElement.attribute("src"));
+                }
+                pElement->removeChild(childElement);
+            } else {
+                stripSvgTemplates(&childElement, pScriptFiles);
+            }
+        }
+        child = next;
+    }
+}
+
+void removeSetVariables(QDomElement* pElement) {
+    QDomNode child = pElement->firstChild();
+    while (!child.isNull()) {
+        QDomNode next = child.nextSibling();
+        if (child.isElement() && (child.nodeName() == "SetVariable")) {
+            pElement->removeChild(child);
+        }
+        child = next;
+    }
+}
+
+} // anonymous namespace
+
+CompiledSkin::CompiledSkin(const QString& skinPath, double scaleFactor)
+        : m_skinPath(QDir(skinPath).absolutePath()),
+          m_scaleFactor(scaleFactor),
+          m_locale(QLocale().name()),
+          m_version(Version::version() + " " + Version::developmentRevision()) {
+}
+
+void CompiledSkin::addDependency(const QString& filePath) {
+    const QFileInfo fileInfo(filePath);
+    FileInfo dependency;
+    dependency.filePath = fileInfo.absoluteFilePath();
+    dependency.size = fileInfo.size();
+    dependency.lastModified = fileInfo.lastModified();
+    m_dependencies.append(dependency);
+}
+
+bool CompiledSkin::isDependencyModified(const FileInfo& dependency) const {
+    const QFileInfo fileInfo(dependency.filePath);
+    return !fileInfo.exists() ||
+            (fileInfo.size() != dependency.size) ||
+            (fileInfo.lastModified() != dependency.lastModified);
+}
+
+QDomElement CompiledSkin::loadTemplate(const QString& path) {
+    const QString absolutePath = QFileInfo(path).absoluteFilePath();
+    QHash<QString, QDomElement>::const_iterator it =
+            m_templateCache.find(absolutePath);
+    if (it != m_templateCache.end()) {
+        return it.value();
+    }
+
+    QFile templateFile(absolutePath);
+    if (!templateFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "CompiledSkin::loadTemplate - could not open template file:"
+                   << absolutePath;
+        return QDomElement();
+    }
+
+    QDomDocument tmpl("template");
+    QString errorMessage;
+    int errorLine;
+    int errorColumn;
+    if (!tmpl.setContent(&templateFile, &errorMessage,
+                         &errorLine, &errorColumn)) {
+        qWarning() << "CompiledSkin::loadTemplate - setContent failed see"
+                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
+        qWarning() << "CompiledSkin::loadTemplate - message:" << errorMessage;
+        return QDomElement();
+    }
+
+    addDependency(absolutePath);
+    m_templateCache[absolutePath] = tmpl.documentElement();
+    return tmpl.documentElement();
+}
+
+bool CompiledSkin::compile(const QDomElement& skinDocument, SkinContext* pContext) {
+    m_document = QDomDocument("skin");
+    m_dependencies.clear();
+    m_templateCache.clear();
+    addDependency(QDir(m_skinPath).filePath("skin.xml"));
+
+    QDomElement root = m_document.importNode(skinDocument, true).toElement();
+    m_document.appendChild(root);
+    const bool success = compileChildren(&root, pContext);
+    m_templateCache.clear();
+    if (!success) {
+        m_document.clear();
+    }
+    return success;
+}
+
+bool CompiledSkin::compileChildren(QDomElement* pParent, SkinContext* pContext) {
+    QDomNode child = pParent->firstChild();
+    while (!child.isNull()) {
+        // Nodes that replace the current child have already been compiled
+        QDomNode next = child.nextSibling();
+        if (child.isElement()) {
+            QDomElement element = child.toElement();
+            const QString tagName = element.tagName();
+            if (tagName == "SetVariable") {
+                pContext->updateVariable(element);
+                pParent->removeChild(element);
+            } else if (tagName == "Variable") {
+                pParent->replaceChild(
+                        m_document.createTextNode(pContext->variableNodeToText(element)),
+                        element);
+            } else if (tagName == "Template") {
+                if (!compileTemplate(pParent, element, pContext)) {
+                    return false;
+                }
+            } else if (tagName == "svg") {
+                compileSvg(pParent, element, pContext);
+            } else if ((tagName == "State") && pContext->hasVariableUpdates(element)) {
+                // WPushButton evaluates all <SetVariable> nodes of a state
+                // before any other nodes of the state
+                SkinContext stateContext(*pContext);
+                stateContext.updateVariables(element);
+                removeSetVariables(&element);
+                if (!compileChildren(&element, &stateContext)) {
+                    return false;
+                }
+            } else if (!compileChildren(&element, pContext)) {
+                return false;
+            }
+        }
+        child = next;
+    }
+    return true;
+}
+
+bool CompiledSkin::compileTemplate(QDomElement* pParent, const QDomElement& node,
+        SkinContext* pContext) {
+    if (!node.hasAttribute("src")) {
+        SKIN_WARNING(node, *pContext)
+                << "Template instantiation without src attribute:"
+                << node.text();
+        return false;
+    }
+    const QString path = node.attribute("src");
+    const QDomElement templateNode = loadTemplate(path);
+    if (templateNode.isNull()) {
+        SKIN_WARNING(node, *pContext) << "Template instantiation for template failed:" << path;
+        return false;
+    }
+
+    // Instantiate a copy of the template with the variables of the
+    // <Template> node, see LegacySkinParser::parseTemplate()
+    QDomElement instance = m_document.importNode(templateNode, true).toElement();
+    SkinContext templateContext(*pContext);
+    templateContext.updateVariables(node);
+    templateContext.setXmlPath(path);
+    if (!compileChildren(&instance, &templateContext)) {
+        return false;
+    }
+
+    // Replace the <Template> node with the widgets of the template
+    QDomNode child = instance.firstChild();
+    while (!child.isNull()) {
+        QDomNode next = child.nextSibling();
+        if (child.isElement()) {
+            pParent->insertBefore(child, node);
+        }
+        child = next;
+    }
+    pParent->removeChild(node);
+    return true;
+}
+
+void CompiledSkin::compileSvg(QDomElement* pParent, const QDomElement& node,
+        SkinContext* pContext) {
+    const SvgParser svgParser(*pContext);
+    QDomElement svg = svgParser.parseSvgTree(
+            node, pContext->getXmlPath()).toElement();
+    QStringList scriptFiles;
+    stripSvgTemplates(&svg, &scriptFiles);
+    foreach (const QString& scriptFile, scriptFiles) {
+        addDependency(pContext->getSkinPath(scriptFile));
+    }
+    pParent->replaceChild(svg, node);
+}
+
+bool CompiledSkin::load(const QString& cacheFilePath) {
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    in >> magic >> formatVersion;
+    if ((magic != kMagic) || (formatVersion != kFormatVersion)) {
+        return false;
+    }
+
+    QString version;
+    QString locale;
+    double scaleFactor = 0.0;
+    QString skinPath;
+    in >> version >> locale >> scaleFactor >> skinPath;
+    if ((in.status() != QDataStream::Ok) ||
+            (version != m_version) ||
+            (locale != m_locale) ||
+            (scaleFactor != m_scaleFactor) ||
+            (skinPath != m_skinPath)) {
+        return false;
+    }
+
+    quint32 dependencyCount = 0;
+    in >> dependencyCount;
+    QList<FileInfo> dependencies;
+    for (quint32 i = 0; (i < dependencyCount) && (in.status() == QDataStream::Ok); ++i) {
+        FileInfo dependency;
+        in >> dependency.filePath >> dependency.size >> dependency.lastModified;
+        if (isDependencyModified(dependency)) {
+            qDebug() << "Compiled skin is outdated:" << dependency.filePath
+                     << "has been modified";
+            return false;
+        }
+        dependencies.append(dependency);
+    }
+
+    QDomDocument document("skin");
+    quint8 nodeType = kEndOfChildren;
+    in >> nodeType;
+    if (nodeType != kElementNode) {
+        return false;
+    }
+    document.appendChild(readElement(in, document));
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Failed to read compiled skin from" << cacheFilePath;
+        return false;
+    }
+
+    m_document = document;
+    m_dependencies = dependencies;
+    return true;
+}
+
+bool CompiledSkin::save(const QString& cacheFilePath) const {
+    VERIFY_OR_DEBUG_ASSERT(!documentElement().isNull()) {
+        return false;
+    }
+    QDir().mkpath(QFileInfo(cacheFilePath).absolutePath());
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_8);
+
+    out << kMagic << kFormatVersion;
+    out << m_version << m_locale << m_scaleFactor << m_skinPath;
+    out << static_cast<quint32>(m_dependencies.size());
+    foreach (const FileInfo& dependency, m_dependencies) {
+        out << dependency.filePath << dependency.size << dependency.lastModified;
+    }
+    writeElement(out, m_document.documentElement());
+
+    file.close();
+    if ((out.status() != QDataStream::Ok) || (file.error() != QFile::NoError)) {
+        // Never leave a truncated cache file behind
+        file.remove();
+        return false;
+    }
+    return true;
+}
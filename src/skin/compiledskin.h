@@ -0,0 +1,66 @@
+#ifndef COMPILEDSKIN_H
+#define COMPILEDSKIN_H
+
+#include <QDateTime>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class SkinContext;
+
+// A skin document with all templates instantiated and all variables
+// resolved, i.e. the widget tree that LegacySkinParser would build from
+// the skin's XML files.
+//
+// Compiling a skin evaluates <SetVariable>, <Variable> and the template
+// expressions of inline SVGs once in document order. The compiled
+// document no longer needs any <Template> or variable nodes and can be
+// stored in a binary cache file. The cache file is only valid for the
+// same skin files, scale factor, locale and Mixxx version, otherwise
+// loading it fails and the skin needs to be compiled again.
+class CompiledSkin {
+  public:
+    CompiledSkin(const QString& skinPath, double scaleFactor);
+
+    QDomElement documentElement() const {
+        return m_document.documentElement();
+    }
+
+    // Compiles the skin document using the context for evaluating
+    // variables. Returns false if any template could not be loaded.
+    bool compile(const QDomElement& skinDocument, SkinContext* pContext);
+
+    bool load(const QString& cacheFilePath);
+    bool save(const QString& cacheFilePath) const;
+
+  private:
+    struct FileInfo {
+        QString filePath;
+        qint64 size;
+        QDateTime lastModified;
+    };
+
+    void addDependency(const QString& filePath);
+    bool isDependencyModified(const FileInfo& fileInfo) const;
+
+    QDomElement loadTemplate(const QString& path);
+
+    bool compileChildren(QDomElement* pParent, SkinContext* pContext);
+    bool compileTemplate(QDomElement* pParent, const QDomElement& node,
+            SkinContext* pContext);
+    void compileSvg(QDomElement* pParent, const QDomElement& node,
+            SkinContext* pContext);
+
+    QString m_skinPath;
+    double m_scaleFactor;
+    QString m_locale;
+    QString m_version;
+
+    QDomDocument m_document;
+    QList<FileInfo> m_dependencies;
+    QHash<QString, QDomElement> m_templateCache;
+};
+
+#endif /* COMPILEDSKIN_H */
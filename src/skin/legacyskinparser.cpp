@@ -25,6 +25,8 @@
 #include "controllers/controllermanager.h"
 
 #include "skin/colorschemeparser.h"
+#include "skin/compiledskin.h"
+#include "skin/skinimagecache.h"
 #include "skin/skincontext.h"
 #include "skin/launchimage.h"
 
@@ -225,6 +227,78 @@ QDomElement LegacySkinParser::openSkin(const QString& skinPath) {
     return skin.documentElement();
 }
 
+QDomElement LegacySkinParser::openCompiledSkin(const QString& skinPath) {
+    // Skin warnings refer to line numbers in the XML files that are not
+    // available in the compiled skin.
+    if (CmdlineArgs::Instance().getDeveloper()) {
+        return openSkin(skinPath);
+    }
+
+    CompiledSkin compiledSkin(skinPath, m_pContext->getScaleFactor());
+    const QString cacheFilePath = QDir(m_pConfig->getSettingsPath()).filePath(
+            QString("skincache/%1.bin").arg(QDir(skinPath).dirName()));
+    if (compiledSkin.load(cacheFilePath)) {
+        qDebug() << "LegacySkinParser::openCompiledSkin - using" << cacheFilePath;
+        return compiledSkin.documentElement();
+    }
+
+    QDomElement skinDocument = openSkin(skinPath);
+    if (skinDocument.isNull()) {
+        return skinDocument;
+    }
+    // The variables of the skin are resolved while compiling and must
+    // not leak into the context that is used for parsing the widgets.
+    SkinContext compileContext(m_pConfig, skinPath + "/skin.xml");
+    compileContext.setSkinBasePath(skinPath + "/");
+    if (!compiledSkin.compile(skinDocument, &compileContext)) {
+        qWarning() << "LegacySkinParser::openCompiledSkin - failed to compile skin:"
+                   << skinPath;
+        return skinDocument;
+    }
+    if (!compiledSkin.save(cacheFilePath)) {
+        qWarning() << "LegacySkinParser::openCompiledSkin - failed to write"
+                   << cacheFilePath;
+    }
+    return compiledSkin.documentElement();
+}
+
+namespace {
+
+// Collects the paths of all image files that are referenced by the text
+// of an element, e.g. <Path>knob.svg</Path>.
+void collectImagePaths(const QDomElement& element, const SkinContext& context,
+        QStringList* pFilePaths) {
+    QDomNode child = element.firstChild();
+    if (!child.isNull() && child.isText() && child.nextSibling().isNull()) {
+        const QString fileName = child.nodeValue().trimmed();
+        if (fileName.endsWith(".svg", Qt::CaseInsensitive) ||
+                fileName.endsWith(".png", Qt::CaseInsensitive) ||
+                fileName.endsWith(".jpg", Qt::CaseInsensitive) ||
+                fileName.endsWith(".bmp", Qt::CaseInsensitive)) {
+            pFilePaths->append(context.getSkinPath(fileName));
+        }
+        return;
+    }
+    while (!child.isNull()) {
+        if (child.isElement()) {
+            collectImagePaths(child.toElement(), context, pFilePaths);
+        }
+        child = child.nextSibling();
+    }
+}
+
+} // anonymous namespace
+
+void LegacySkinParser::prefetchImages(const QString& skinPath,
+        const QDomElement& skinDocument, const QString& colorSchemeKey) {
+    QStringList filePaths;
+    collectImagePaths(skinDocument, *m_pContext, &filePaths);
+    const QString cacheDirPath = QDir(m_pConfig->getSettingsPath()).filePath(
+            QString("skincache/%1").arg(QDir(skinPath).dirName()));
+    SkinImageCache::prefetch(filePaths, m_pContext->getScaleFactor(),
+            WPixmapStore::getLoader(), colorSchemeKey, cacheDirPath);
+}
+
 // static
 QList<QString> LegacySkinParser::getSchemeList(const QString& qSkinPath) {
 
@@ -312,7 +386,12 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     if (m_pParent) {
         qDebug() << "ERROR: Somehow a parent already exists -- you are probably re-using a LegacySkinParser which is not advisable!";
     }
-    QDomElement skinDocument = openSkin(skinPath);
+
+    // Templates and images are referenced relative to the skin path
+    QStringList skinPaths(skinPath);
+    QDir::setSearchPaths("skin", skinPaths);
+
+    QDomElement skinDocument = openCompiledSkin(skinPath);
 
     if (skinDocument.isNull()) {
         qDebug() << "LegacySkinParser::parseSkin - failed for skin:" << skinPath;
@@ -372,10 +451,9 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
         }
     }
 
-    ColorSchemeParser::setupLegacyColorSchemes(skinDocument, m_pConfig);
-
-    QStringList skinPaths(skinPath);
-    QDir::setSearchPaths("skin", skinPaths);
+    const QString colorSchemeKey =
+            ColorSchemeParser::setupLegacyColorSchemes(skinDocument, m_pConfig);
+    prefetchImages(skinPath, skinDocument, colorSchemeKey);
 
     // don't parent till here so the first opengl waveform doesn't screw
     // up --bkgood
@@ -384,6 +462,8 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     // fullscreen mostly) --bkgood
     m_pParent = pParent;
     QList<QWidget*> widgets = parseNode(skinDocument);
+    // All widgets have picked up their images
+    SkinImageCache::clear();
 
     if (widgets.empty()) {
         SKIN_WARNING(skinDocument, *m_pContext) << "Skin produced no widgets!";
@@ -55,6 +55,13 @@ class LegacySkinParser : public QObject, public SkinParser {
 
   private:
     static QDomElement openSkin(const QString& skinPath);
+    // Opens the compiled skin from the cache or compiles and caches
+    // the skin if the cache is outdated.
+    QDomElement openCompiledSkin(const QString& skinPath);
+    // Rasterizes all images of the skin concurrently before the widgets
+    // are created.
+    void prefetchImages(const QString& skinPath,
+            const QDomElement& skinDocument, const QString& colorSchemeKey);
 
     QList<QWidget*> parseNode(const QDomElement& node);
 
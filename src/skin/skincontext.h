@@ -47,6 +47,9 @@ class SkinContext {
     }
     void setVariable(const QString& name, const QString& value);
     void setXmlPath(const QString& xmlPath);
+    const QString& getXmlPath() const {
+        return m_xmlPath;
+    }
 
     // Returns whether the node has a <SetVariable> node.
     bool hasVariableUpdates(const QDomNode& node) const;
@@ -211,6 +214,8 @@ class SkinContext {
     }
 
     QString nodeToString(const QDomNode& node) const;
+    // Evaluates a <Variable> or <SetVariable> node.
+    QString variableNodeToText(const QDomElement& element) const;
     PixmapSource getPixmapSource(const QDomNode& pixmapNode) const;
     PixmapSource getPixmapSource(const QString& filename) const;
 
@@ -260,8 +265,6 @@ class SkinContext {
     // parent. Otherwise we are a root SkinContext.
     bool isRoot() const { return !m_parentGlobal.isValid(); }
 
-    QString variableNodeToText(const QDomElement& element) const;
-
     QString m_xmlPath;
     QDir m_skinBasePath;
     UserSettingsPointer m_pConfig;
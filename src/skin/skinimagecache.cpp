@@ -0,0 +1,208 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QSet>
+#include <QSvgRenderer>
+#include <QtConcurrentMap>
+#include <QtDebug>
+
+#include <cstring>
+
+#include "skin/skinimagecache.h"
+
+#include "skin/pixmapsource.h"
+#include "util/timer.h"
+
+namespace {
+
+// "MXRC"
+const quint32 kRasterMagic = 0x4D585243;
+// Increment when changing the file format or how images are rasterized
+const quint32 kRasterVersion = 1;
+
+const QString kRasterSuffix = ".raster";
+
+} // anonymous namespace
+
+// static
+QHash<QString, QImage> SkinImageCache::s_images;
+
+// static
+QString SkinImageCache::imageKey(const QString& filePath, double scaleFactor) {
+    return filePath + "@" + QString::number(scaleFactor);
+}
+
+// static
+void SkinImageCache::prefetch(const QStringList& filePaths,
+        double scaleFactor,
+        QSharedPointer<ImgSource> pLoader,
+        const QString& colorSchemeKey,
+        const QString& cacheDirPath) {
+    ScopedTimer timer("SkinImageCache::prefetch");
+    const QDir cacheDir(cacheDirPath);
+    if (!cacheDirPath.isEmpty()) {
+        cacheDir.mkpath(cacheDirPath);
+    }
+
+    QList<Request> requests;
+    QSet<QString> cacheFileNames;
+    foreach (const QString& filePath, filePaths) {
+        if (s_images.contains(imageKey(filePath, scaleFactor))) {
+            continue;
+        }
+        const QFileInfo fileInfo(filePath);
+        if (!fileInfo.exists()) {
+            continue;
+        }
+        Request request;
+        request.filePath = filePath;
+        request.scaleFactor = scaleFactor;
+        request.pLoader = pLoader;
+        if (!cacheDirPath.isEmpty()) {
+            const QString key = QString("%1|%2|%3|%4|%5").arg(
+                    fileInfo.absoluteFilePath(),
+                    QString::number(fileInfo.size()),
+                    QString::number(fileInfo.lastModified().toMSecsSinceEpoch()),
+                    QString::number(scaleFactor),
+                    colorSchemeKey);
+            const QString cacheFileName = QString::fromLatin1(
+                    QCryptographicHash::hash(key.toUtf8(),
+                            QCryptographicHash::Sha1).toHex()) + kRasterSuffix;
+            cacheFileNames.insert(cacheFileName);
+            request.cacheFilePath = cacheDir.filePath(cacheFileName);
+        }
+        requests.append(request);
+        // Reserve the key to skip duplicate paths
+        s_images.insert(imageKey(filePath, scaleFactor), QImage());
+    }
+
+    const QList<QImage> images = QtConcurrent::blockingMapped(
+            requests, &SkinImageCache::rasterize);
+    for (int i = 0; i < requests.size(); ++i) {
+        const QString key = imageKey(requests[i].filePath, scaleFactor);
+        if (images[i].isNull()) {
+            s_images.remove(key);
+        } else {
+            s_images.insert(key, images[i]);
+        }
+    }
+    qDebug() << "SkinImageCache prefetched" << s_images.size() << "images";
+
+    if (!cacheDirPath.isEmpty()) {
+        const QStringList staleFileNames = cacheDir.entryList(
+                QStringList() << ("*" + kRasterSuffix), QDir::Files);
+        foreach (const QString& fileName, staleFileNames) {
+            if (!cacheFileNames.contains(fileName)) {
+                QFile::remove(cacheDir.filePath(fileName));
+            }
+        }
+    }
+}
+
+// static
+QImage SkinImageCache::image(const QString& filePath, double scaleFactor) {
+    return s_images.value(imageKey(filePath, scaleFactor));
+}
+
+// static
+void SkinImageCache::clear() {
+    s_images.clear();
+}
+
+// static
+QImage SkinImageCache::rasterize(const Request& request) {
+    if (!request.cacheFilePath.isEmpty()) {
+        const QImage image = readRaster(request.cacheFilePath);
+        if (!image.isNull()) {
+            return image;
+        }
+    }
+
+    QImage image;
+    if (PixmapSource(request.filePath).isSVG()) {
+        // See Paintable::Paintable()
+        QSvgRenderer renderer(request.filePath);
+        if (!renderer.isValid()) {
+            return QImage();
+        }
+        image = QImage(renderer.defaultSize() * request.scaleFactor,
+                QImage::Format_ARGB32);
+        image.fill(0x00000000);  // Transparent black.
+        QPainter painter(&image);
+        renderer.render(&painter);
+        painter.end();
+        request.pLoader->correctImageColors(&image);
+    } else {
+        QScopedPointer<QImage> pImage(
+                request.pLoader->getImage(request.filePath, request.scaleFactor));
+        if (pImage) {
+            image = *pImage;
+        }
+    }
+
+    if (!image.isNull() && !request.cacheFilePath.isEmpty()) {
+        writeRaster(request.cacheFilePath, image);
+    }
+    return image;
+}
+
+// static
+QImage SkinImageCache::readRaster(const QString& cacheFilePath) {
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_8);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 format = QImage::Format_Invalid;
+    qint32 bytesPerLine = 0;
+    QByteArray bits;
+    in >> magic >> version >> width >> height >> format >> bytesPerLine >> bits;
+    if ((in.status() != QDataStream::Ok) ||
+            (magic != kRasterMagic) ||
+            (version != kRasterVersion) ||
+            (format <= QImage::Format_Invalid)) {
+        return QImage();
+    }
+    QImage image(width, height, static_cast<QImage::Format>(format));
+    if (image.isNull() ||
+            (image.bytesPerLine() != bytesPerLine) ||
+            (image.byteCount() != bits.size())) {
+        return QImage();
+    }
+    std::memcpy(image.bits(), bits.constData(), bits.size());
+    return image;
+}
+
+// static
+bool SkinImageCache::writeRaster(const QString& cacheFilePath, const QImage& image) {
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_8);
+    out << kRasterMagic << kRasterVersion
+        << static_cast<qint32>(image.width())
+        << static_cast<qint32>(image.height())
+        << static_cast<qint32>(image.format())
+        << static_cast<qint32>(image.bytesPerLine())
+        << QByteArray::fromRawData(
+                reinterpret_cast<const char*>(image.constBits()),
+                image.byteCount());
+    file.close();
+    if ((out.status() != QDataStream::Ok) || (file.error() != QFile::NoError)) {
+        // Never leave a truncated cache file behind
+        file.remove();
+        return false;
+    }
+    return true;
+}
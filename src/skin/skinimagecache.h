@@ -0,0 +1,59 @@
+#ifndef SKINIMAGECACHE_H
+#define SKINIMAGECACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "skin/imgsource.h"
+
+// Rasterized images of the skin that is currently being loaded.
+//
+// Before the widgets of a skin are created all image files referenced by
+// the skin are loaded, rasterized and color corrected concurrently on the
+// global thread pool. The widgets then pick up the prefetched images
+// instead of rasterizing them one at a time on the GUI thread.
+//
+// The rasters are also stored in a cache directory. Cache files are keyed
+// by the path, size and modification time of the image file, the scale
+// factor and the color scheme, so that unmodified images are read back
+// without decoding PNGs or rendering SVGs.
+class SkinImageCache {
+  public:
+    // Rasterizes the files and blocks until all images are available.
+    // Cache files of images that are no longer used are deleted from
+    // cacheDirPath. No cache files are used if cacheDirPath is empty.
+    static void prefetch(const QStringList& filePaths,
+            double scaleFactor,
+            QSharedPointer<ImgSource> pLoader,
+            const QString& colorSchemeKey,
+            const QString& cacheDirPath);
+
+    // Returns a null image if the image has not been prefetched. SVG
+    // images are rendered in their default size and color corrected
+    // like Paintable does.
+    static QImage image(const QString& filePath, double scaleFactor);
+
+    // Releases all prefetched images after the skin has been loaded.
+    static void clear();
+
+  private:
+    struct Request {
+        QString filePath;
+        double scaleFactor;
+        QSharedPointer<ImgSource> pLoader;
+        QString cacheFilePath;
+    };
+
+    static QString imageKey(const QString& filePath, double scaleFactor);
+    static QImage rasterize(const Request& request);
+    static QImage readRaster(const QString& cacheFilePath);
+    static bool writeRaster(const QString& cacheFilePath, const QImage& image);
+
+    static QHash<QString, QImage> s_images;
+};
+
+#endif /* SKINIMAGECACHE_H */
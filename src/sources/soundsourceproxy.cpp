@@ -427,7 +427,8 @@ namespace {
 } // anonymous namespace
 
 void SoundSourceProxy::updateTrack(
-        ParseFileTagsMode parseFileTagsMode) const {
+        ParseFileTagsMode parseFileTagsMode,
+        QImage* pCoverImage) const {
     DEBUG_ASSERT(m_pTrack);
 
     if (getUrl().isEmpty()) {
@@ -546,6 +547,9 @@ void SoundSourceProxy::updateTrack(
             }
         }
         m_pTrack->setCoverInfo(coverInfoRelative);
+        if (pCoverImage) {
+            *pCoverImage = coverImg;
+        }
     }
 }
 
@@ -64,8 +64,11 @@ class SoundSourceProxy {
     // File tags are parsed as specified and the track's metadata and
     // cover art is initialized or updated. But only if the track object
     // is not marked as dirty! Otherwise parsing of file tags is skipped.
+    // If pCoverImage is provided it receives the cover image that has
+    // been parsed from the file tags while they are open anyway.
     void updateTrack(
-            ParseFileTagsMode parseFileTagsMode = ParseFileTagsMode::Default) const;
+            ParseFileTagsMode parseFileTagsMode = ParseFileTagsMode::Default,
+            QImage* pCoverImage = nullptr) const;
 
     const QUrl& getUrl() const {
         return m_url;
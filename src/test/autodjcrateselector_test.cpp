@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "library/autodj/autodjcrateselector.h"
+
+namespace {
+
+class AutoDJCrateSelectorTest : public testing::Test {
+  protected:
+    QDateTime dateTime(int day) const {
+        return QDateTime(QDate(2017, 1, day), QTime(12, 0), Qt::UTC);
+    }
+
+    QList<TrackId> activeTracks() {
+        QList<TrackId> trackIds;
+        for (int rank = 0; rank < m_selector.countActiveTracks(); ++rank) {
+            trackIds.append(m_selector.activeTrackAt(rank));
+        }
+        return trackIds;
+    }
+
+    AutoDJCrateSelector m_selector;
+};
+
+TEST_F(AutoDJCrateSelectorTest, RankByTimesPlayed) {
+    m_selector.insertTrack(TrackId(1), 1, 3, 0, dateTime(1));
+    m_selector.insertTrack(TrackId(2), 1, 0, 0, QDateTime());
+    m_selector.insertTrack(TrackId(3), 1, 1, 0, dateTime(3));
+    m_selector.insertTrack(TrackId(4), 1, 1, 0, dateTime(2));
+
+    EXPECT_EQ(4, m_selector.countActiveTracks());
+    EXPECT_EQ(1, m_selector.countActiveUnplayedTracks());
+    EXPECT_EQ(QList<TrackId>() << TrackId(2) << TrackId(4) << TrackId(3) << TrackId(1),
+              activeTracks());
+}
+
+TEST_F(AutoDJCrateSelectorTest, RankByLastPlayed) {
+    m_selector.setRankByLastPlayed(true);
+    m_selector.insertTrack(TrackId(1), 1, 3, 0, dateTime(1));
+    m_selector.insertTrack(TrackId(2), 1, 0, 0, QDateTime());
+    m_selector.insertTrack(TrackId(3), 1, 1, 0, dateTime(3));
+    m_selector.insertTrack(TrackId(4), 1, 1, 0, dateTime(2));
+
+    EXPECT_EQ(QList<TrackId>() << TrackId(2) << TrackId(1) << TrackId(4) << TrackId(3),
+              activeTracks());
+    EXPECT_EQ(1, m_selector.countActiveTracksLastPlayedBefore(dateTime(1)));
+    EXPECT_EQ(3, m_selector.countActiveTracksLastPlayedBefore(dateTime(3)));
+}
+
+TEST_F(AutoDJCrateSelectorTest, QueuedTracksAreInactive) {
+    for (int i = 1; i <= 100; ++i) {
+        m_selector.insertTrack(TrackId(i), 1, i, 0, dateTime(1));
+    }
+    // Build the ranking before queuing tracks
+    EXPECT_EQ(TrackId(1), m_selector.activeTrackAt(0));
+
+    for (int i = 1; i <= 100; i += 2) {
+        m_selector.addAutoDjRef(TrackId(i));
+    }
+    EXPECT_EQ(50, m_selector.countActiveTracks());
+    for (int rank = 0; rank < 50; ++rank) {
+        EXPECT_EQ(TrackId(2 * (rank + 1)), m_selector.activeTrackAt(rank));
+    }
+
+    m_selector.removeAutoDjRef(TrackId(1));
+    EXPECT_EQ(51, m_selector.countActiveTracks());
+    EXPECT_EQ(TrackId(1), m_selector.activeTrackAt(0));
+    EXPECT_EQ(TrackId(2), m_selector.activeTrackAt(1));
+}
+
+TEST_F(AutoDJCrateSelectorTest, CrateRefs) {
+    m_selector.insertTrack(TrackId(1), 1, 0, 0, QDateTime());
+    EXPECT_TRUE(m_selector.addCrateRef(TrackId(1)));
+    EXPECT_FALSE(m_selector.addCrateRef(TrackId(2)));
+
+    m_selector.removeCrateRef(TrackId(1));
+    EXPECT_TRUE(m_selector.contains(TrackId(1)));
+    m_selector.removeCrateRef(TrackId(1));
+    EXPECT_FALSE(m_selector.contains(TrackId(1)));
+    EXPECT_EQ(0, m_selector.countActiveTracks());
+    EXPECT_EQ(0, m_selector.countActiveUnplayedTracks());
+}
+
+TEST_F(AutoDJCrateSelectorTest, PlayedTracksAreRankedLast) {
+    m_selector.insertTrack(TrackId(1), 1, 0, 0, QDateTime());
+    m_selector.insertTrack(TrackId(2), 1, 0, 0, QDateTime());
+    EXPECT_EQ(TrackId(1), m_selector.activeTrackAt(0));
+
+    m_selector.setTimesPlayed(TrackId(1), 1);
+    m_selector.setLastPlayed(TrackId(1), dateTime(1));
+    EXPECT_EQ(1, m_selector.countActiveUnplayedTracks());
+    EXPECT_EQ(QList<TrackId>() << TrackId(2) << TrackId(1),
+              activeTracks());
+}
+
+}  // namespace
@@ -0,0 +1,106 @@
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+
+#include "test/mixxxtest.h"
+#include "skin/compiledskin.h"
+#include "skin/skincontext.h"
+
+namespace {
+
+const char* kSkinXml =
+        "<skin>"
+        "<SetVariable name=\"group\">[Channel1]</SetVariable>"
+        "<WidgetGroup>"
+        "<Children>"
+        "<Template src=\"%1\">"
+        "<SetVariable name=\"label\">Deck <Variable name=\"group\"/></SetVariable>"
+        "</Template>"
+        "</Children>"
+        "</WidgetGroup>"
+        "</skin>";
+
+const char* kTemplateXml =
+        "<Template>"
+        "<SetVariable name=\"suffix\" expression=\"'_' + 'x'\"/>"
+        "<Label><Text><Variable name=\"label\"/><Variable name=\"suffix\"/></Text></Label>"
+        "</Template>";
+
+class CompiledSkinTest : public MixxxTest {
+  protected:
+    CompiledSkinTest()
+            : m_skinDir(QDir::temp().filePath("CompiledSkinTest")) {
+        QDir().mkpath(m_skinDir.path());
+        writeFile("template.xml", kTemplateXml);
+        writeFile("skin.xml", QString(kSkinXml).arg(m_skinDir.filePath("template.xml")));
+    }
+
+    ~CompiledSkinTest() override {
+        m_skinDir.remove("skin.xml");
+        m_skinDir.remove("template.xml");
+        m_skinDir.remove("skin.bin");
+        QDir::temp().rmdir("CompiledSkinTest");
+    }
+
+    void writeFile(const QString& fileName, const QString& contents) {
+        QFile file(m_skinDir.filePath(fileName));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(contents.toUtf8());
+    }
+
+    QDomElement openSkin() {
+        QFile file(m_skinDir.filePath("skin.xml"));
+        file.open(QIODevice::ReadOnly);
+        QDomDocument document;
+        document.setContent(&file);
+        return document.documentElement();
+    }
+
+    bool compile(CompiledSkin* pCompiledSkin) {
+        SkinContext context(config(), m_skinDir.filePath("skin.xml"));
+        context.setSkinBasePath(m_skinDir.path() + "/");
+        return pCompiledSkin->compile(openSkin(), &context);
+    }
+
+    QDir m_skinDir;
+};
+
+TEST_F(CompiledSkinTest, ResolvesTemplatesAndVariables) {
+    CompiledSkin compiledSkin(m_skinDir.path(), 1.0);
+    ASSERT_TRUE(compile(&compiledSkin));
+
+    const QDomElement root = compiledSkin.documentElement();
+    EXPECT_TRUE(root.elementsByTagName("Template").isEmpty());
+    EXPECT_TRUE(root.elementsByTagName("SetVariable").isEmpty());
+    EXPECT_TRUE(root.elementsByTagName("Variable").isEmpty());
+
+    const QDomNodeList labels = root.elementsByTagName("Label");
+    ASSERT_EQ(1, labels.count());
+    EXPECT_QSTRING_EQ("WidgetGroup", labels.at(0).parentNode().parentNode().nodeName());
+    EXPECT_QSTRING_EQ("Deck [Channel1]_x", labels.at(0).toElement().text());
+}
+
+TEST_F(CompiledSkinTest, SaveAndLoad) {
+    const QString cacheFilePath = m_skinDir.filePath("skin.bin");
+    {
+        CompiledSkin compiledSkin(m_skinDir.path(), 1.0);
+        ASSERT_TRUE(compile(&compiledSkin));
+        ASSERT_TRUE(compiledSkin.save(cacheFilePath));
+    }
+
+    CompiledSkin loadedSkin(m_skinDir.path(), 1.0);
+    ASSERT_TRUE(loadedSkin.load(cacheFilePath));
+    EXPECT_QSTRING_EQ("Deck [Channel1]_x",
+            loadedSkin.documentElement().elementsByTagName("Label").at(0).toElement().text());
+
+    // A different scale factor requires compiling the skin again
+    CompiledSkin scaledSkin(m_skinDir.path(), 2.0);
+    EXPECT_FALSE(scaledSkin.load(cacheFilePath));
+
+    // Modifying a template invalidates the cache
+    writeFile("template.xml", QString(kTemplateXml) + "\n");
+    CompiledSkin modifiedSkin(m_skinDir.path(), 1.0);
+    EXPECT_FALSE(modifiedSkin.load(cacheFilePath));
+}
+
+}  // namespace
@@ -311,3 +311,50 @@ TEST_F(CoverArtUtilTest, searchImage) {
     }
     EXPECT_TRUE(QDir(trackdir).rmdir(trackdir));
 }
+
+TEST_F(CoverArtUtilTest, coverArtFolder) {
+    QString trackdir(QDir::tempPath() % "/CoverArtFolder");
+    ASSERT_FALSE(QDir().exists(trackdir)); // it must start empty
+    ASSERT_TRUE(QDir().mkpath(trackdir));
+
+    QImage img = QImage(kReferencePNGLocationTest);
+    ASSERT_FALSE(img.isNull());
+    const QString coverLocation(trackdir % "/cover.jpg");
+    const QString otherLocation(trackdir % "/other.png");
+    EXPECT_TRUE(img.save(coverLocation, "jpg"));
+    EXPECT_TRUE(img.scaled(20, 20).save(otherLocation, "png"));
+
+    CoverArtFolder folder(trackdir);
+    EXPECT_EQ(trackdir, folder.folder());
+
+    CoverInfoRelative expected;
+    expected.source = CoverInfo::GUESSED;
+    expected.type = CoverInfo::FILE;
+    expected.coverLocation = "cover.jpg";
+    expected.hash = CoverArtUtils::calculateHash(QImage(coverLocation));
+
+    // The image is only loaded for the first track that selects it
+    QImage loadedImage;
+    EXPECT_EQ(expected, folder.selectCoverArtForTrack(
+            "track1", "album", &loadedImage));
+    EXPECT_FALSE(loadedImage.isNull());
+    loadedImage = QImage();
+    EXPECT_EQ(expected, folder.selectCoverArtForTrack(
+            "track2", "album", &loadedImage));
+    EXPECT_TRUE(loadedImage.isNull());
+
+    // Same result as without caching
+    QLinkedList<QFileInfo> covers =
+            CoverArtUtils::findPossibleCoversInFolder(trackdir);
+    EXPECT_EQ(CoverArtUtils::selectCoverArtForTrack("track3", "album", covers),
+            folder.selectCoverArtForTrack("track3", "album"));
+
+    // A track that is named like an image file selects this file
+    expected.coverLocation = "other.png";
+    expected.hash = CoverArtUtils::calculateHash(QImage(otherLocation));
+    EXPECT_EQ(expected, folder.selectCoverArtForTrack("other", "album"));
+
+    QFile::remove(coverLocation);
+    QFile::remove(otherLocation);
+    EXPECT_TRUE(QDir(trackdir).rmdir(trackdir));
+}
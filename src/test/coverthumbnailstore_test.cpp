@@ -0,0 +1,107 @@
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+
+#include "test/mixxxtest.h"
+#include "library/coverthumbnailstore.h"
+
+namespace {
+
+class CoverThumbnailStoreTest : public MixxxTest {
+  protected:
+    CoverThumbnailStoreTest()
+            : m_testDir(QDir::temp().filePath("CoverThumbnailStoreTest")),
+              m_store(m_testDir.path()) {
+        m_info.type = CoverInfo::METADATA;
+        m_info.source = CoverInfo::GUESSED;
+        m_info.trackLocation = "/music/track.mp3";
+        m_info.hash = 4321;
+
+        m_image = QImage(300, 150, QImage::Format_RGB32);
+        m_image.fill(0xFF336699);
+    }
+
+    ~CoverThumbnailStoreTest() override {
+        foreach (const QString& fileName, m_testDir.entryList(QDir::Files)) {
+            m_testDir.remove(fileName);
+        }
+        QDir::temp().rmdir("CoverThumbnailStoreTest");
+    }
+
+    QDir m_testDir;
+    CoverThumbnailStore m_store;
+    CoverInfo m_info;
+    QImage m_image;
+};
+
+TEST_F(CoverThumbnailStoreTest, ThumbnailSize) {
+    EXPECT_EQ(32, CoverThumbnailStore::thumbnailSize(1));
+    EXPECT_EQ(32, CoverThumbnailStore::thumbnailSize(32));
+    EXPECT_EQ(64, CoverThumbnailStore::thumbnailSize(33));
+    EXPECT_EQ(256, CoverThumbnailStore::thumbnailSize(100));
+    EXPECT_EQ(0, CoverThumbnailStore::thumbnailSize(257));
+}
+
+TEST_F(CoverThumbnailStoreTest, StoreAndLoadRaw) {
+    EXPECT_TRUE(m_store.load(m_info, 64).isNull());
+
+    const QImage thumbnail = m_store.store(m_info, 64, m_image);
+    EXPECT_EQ(QSize(64, 32), thumbnail.size());
+
+    const QImage image = m_store.load(m_info, 64);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(thumbnail.size(), image.size());
+    EXPECT_EQ(thumbnail.pixel(10, 10), image.pixel(10, 10));
+    // Only stored for the requested size
+    EXPECT_TRUE(m_store.load(m_info, 32).isNull());
+}
+
+TEST_F(CoverThumbnailStoreTest, StoreAndLoadCompressed) {
+    m_store.store(m_info, 256, m_image);
+
+    const QImage image = m_store.load(m_info, 256);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(QSize(256, 128), image.size());
+}
+
+TEST_F(CoverThumbnailStoreTest, SameHashDifferentLocation) {
+    m_store.store(m_info, 32, m_image);
+
+    CoverInfo otherInfo = m_info;
+    otherInfo.trackLocation = "/music/other.mp3";
+    EXPECT_NE(m_store.filePath(m_info, 32), m_store.filePath(otherInfo, 32));
+    EXPECT_TRUE(m_store.load(otherInfo, 32).isNull());
+    EXPECT_NE(CoverThumbnailStore::coverKey(m_info),
+            CoverThumbnailStore::coverKey(otherInfo));
+}
+
+TEST_F(CoverThumbnailStoreTest, Prune) {
+    CoverInfo info = m_info;
+    for (int i = 0; i < 4; ++i) {
+        info.trackLocation = QString("/music/track%1.mp3").arg(i);
+        m_store.store(info, 32, m_image);
+    }
+    const qint64 fileSize = QFileInfo(m_store.filePath(info, 32)).size();
+    ASSERT_GT(fileSize, 0);
+
+    // Nothing to do below the maximum size
+    m_store.prune(4 * fileSize);
+    EXPECT_EQ(4, m_testDir.entryList(QDir::Files).size());
+
+    // Deletes more than needed to get below the maximum size
+    m_store.prune(3 * fileSize);
+    EXPECT_EQ(2, m_testDir.entryList(QDir::Files).size());
+
+    m_store.prune(0);
+    EXPECT_TRUE(m_testDir.entryList(QDir::Files).isEmpty());
+}
+
+TEST_F(CoverThumbnailStoreTest, Disabled) {
+    CoverThumbnailStore store;
+    EXPECT_FALSE(store.isEnabled());
+    const QImage thumbnail = store.store(m_info, 32, m_image);
+    EXPECT_EQ(QSize(32, 16), thumbnail.size());
+    EXPECT_TRUE(store.load(m_info, 32).isNull());
+}
+
+}  // namespace
@@ -65,3 +65,54 @@ TEST_F(CrateStorageTest, persistentLifecycle) {
     EXPECT_FALSE(m_crateStorage.readCrateByName(kNewCrateName));
     EXPECT_EQ(kNumCrates - 1, m_crateStorage.countCrates());
 }
+
+TEST_F(CrateStorageTest, crateTrackIndex) {
+    Crate crate;
+    crate.setName("Crate");
+    CrateId crateId;
+    ASSERT_TRUE(m_crateStorage.onInsertingCrate(crate, &crateId));
+
+    const QList<TrackId> trackIds = QList<TrackId>()
+            << TrackId(1) << TrackId(2) << TrackId(100000);
+    ASSERT_TRUE(m_crateStorage.onAddingCrateTracks(crateId, trackIds));
+    // The index is updated after the transaction has been committed
+    EXPECT_FALSE(m_crateStorage.isCrateTrack(crateId, TrackId(1)));
+    m_crateStorage.afterAddingCrateTracks(crateId, trackIds);
+    EXPECT_EQ(3u, m_crateStorage.countCrateTracks(crateId));
+    EXPECT_TRUE(m_crateStorage.isCrateTrack(crateId, TrackId(100000)));
+    EXPECT_FALSE(m_crateStorage.isCrateTrack(crateId, TrackId(3)));
+    EXPECT_EQ(3, m_crateStorage.collectTrackIdsByCrateNameLike("rat").size());
+    EXPECT_TRUE(m_crateStorage.collectTrackIdsByCrateNameLike("Other").isEmpty());
+
+    const QList<TrackId> removedTrackIds = QList<TrackId>() << TrackId(2);
+    ASSERT_TRUE(m_crateStorage.onRemovingCrateTracks(crateId, removedTrackIds));
+    m_crateStorage.afterRemovingCrateTracks(crateId, removedTrackIds);
+    EXPECT_EQ(2u, m_crateStorage.countCrateTracks(crateId));
+    EXPECT_FALSE(m_crateStorage.isCrateTrack(crateId, TrackId(2)));
+
+    // Reloading the index from the database yields the same contents
+    m_crateStorage.disconnectDatabase();
+    m_crateStorage.connectDatabase(dbConnection());
+    EXPECT_EQ(2u, m_crateStorage.countCrateTracks(crateId));
+    EXPECT_TRUE(m_crateStorage.isCrateTrack(crateId, TrackId(1)));
+    EXPECT_TRUE(m_crateStorage.isCrateTrack(crateId, TrackId(100000)));
+}
+
+TEST_F(CrateStorageTest, summarizeCrateTracks) {
+    Crate crate;
+    crate.setName("Crate");
+    CrateId crateId;
+    ASSERT_TRUE(m_crateStorage.onInsertingCrate(crate, &crateId));
+    const QList<TrackId> trackIds = QList<TrackId>()
+            << TrackId(1) << TrackId(2) << TrackId(3);
+    ASSERT_TRUE(m_crateStorage.onAddingCrateTracks(crateId, trackIds));
+    m_crateStorage.afterAddingCrateTracks(crateId, trackIds);
+
+    CrateSummary crateSummary(crateId);
+    // Track 2 is hidden
+    m_crateStorage.summarizeCrateTracks(&crateSummary, [](TrackId trackId) {
+        return trackId == TrackId(2) ? -1.0 : 60.0 * trackId.toInt();
+    });
+    EXPECT_EQ(2u, crateSummary.getTrackCount());
+    EXPECT_DOUBLE_EQ(240.0, crateSummary.getTrackDuration());
+}
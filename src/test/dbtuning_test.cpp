@@ -0,0 +1,311 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QHash>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include "test/librarytest.h"
+
+#include "database/mixxxdb.h"
+#include "library/crate/cratestorage.h"
+#include "library/dao/playlistdao.h"
+#include "library/trackcollection.h"
+#include "util/db/sqltransaction.h"
+
+namespace {
+
+// The different tunings of the SQLite connection that are compared
+// by the benchmarks below. Run the benchmarks with
+//   mixxx-test --benchmark --benchmark_filter=BM_Db
+struct SqliteTuning {
+    const char* label;
+    const char* journalMode;
+    const char* synchronous;
+    int cacheSizeKiB;
+    int mmapSizeMiB;
+};
+
+const SqliteTuning kSqliteTunings[] = {
+    { "SQLite defaults", "", "", 0, 0 },
+    { "DELETE/FULL", "DELETE", "FULL", 0, 0 },
+    { "WAL/FULL", "WAL", "FULL", 0, 0 },
+    { "WAL/NORMAL", "WAL", "NORMAL", 0, 0 },
+    { "WAL/NORMAL cache", "WAL", "NORMAL", 16 * 1024, 0 },
+    { "WAL/NORMAL cache mmap", "WAL", "NORMAL", 16 * 1024, 64 },
+};
+
+const int kNumSqliteTunings = sizeof(kSqliteTunings) / sizeof(kSqliteTunings[0]);
+
+// The [Database] config items that select a tuning. Empty values
+// keep the SQLite defaults.
+QHash<QString, QString> dbSettings(const SqliteTuning& tuning) {
+    QHash<QString, QString> settings;
+    settings.insert("JournalMode", tuning.journalMode);
+    settings.insert("Synchronous", tuning.synchronous);
+    settings.insert("CacheSizeKiB", QString::number(tuning.cacheSizeKiB));
+    settings.insert("MmapSizeMiB", QString::number(tuning.mmapSizeMiB));
+    return settings;
+}
+
+// A fresh Mixxx database with the current schema, opened
+// with either the default or the given tuning.
+class DbTuningTest : public LibraryTest {
+  protected:
+    DbTuningTest() {
+    }
+    explicit DbTuningTest(const SqliteTuning& tuning)
+            : LibraryTest(dbSettings(tuning)) {
+    }
+
+    QList<TrackId> insertTracks(int count) {
+        QList<TrackId> trackIds;
+        SqlTransaction transaction(dbConnection());
+        QSqlQuery insertLocation(dbConnection());
+        insertLocation.prepare(
+                "INSERT INTO track_locations "
+                "(location, filename, directory, filesize, fs_deleted, needs_verification) "
+                "VALUES (:location, :filename, :directory, 0, 0, 0)");
+        QSqlQuery insertTrack(dbConnection());
+        insertTrack.prepare(
+                "INSERT INTO library "
+                "(artist, title, album, location, mixxx_deleted, duration) "
+                "VALUES (:artist, :title, :album, :location, 0, 180)");
+        for (int i = 0; i < count; ++i) {
+            const int trackIndex = m_trackCounter++;
+            const QString directory =
+                    QString("/music/artist %1").arg(trackIndex / 100);
+            const QString fileName =
+                    QString("track %1.mp3").arg(trackIndex);
+            insertLocation.bindValue(":location", directory + "/" + fileName);
+            insertLocation.bindValue(":filename", fileName);
+            insertLocation.bindValue(":directory", directory);
+            if (!insertLocation.exec()) {
+                return trackIds;
+            }
+            insertTrack.bindValue(":artist", QString("Artist %1").arg(trackIndex / 100));
+            insertTrack.bindValue(":title", QString("Title %1").arg(trackIndex));
+            insertTrack.bindValue(":album", QString("Album %1").arg(trackIndex / 10));
+            insertTrack.bindValue(":location", insertLocation.lastInsertId());
+            if (!insertTrack.exec()) {
+                return trackIds;
+            }
+            trackIds.append(TrackId(insertTrack.lastInsertId()));
+        }
+        transaction.commit();
+        return trackIds;
+    }
+
+  private:
+    int m_trackCounter = 0;
+};
+
+// Provides the database of a single tuning to a benchmark
+class DbTuningBenchmark : public DbTuningTest {
+  public:
+    explicit DbTuningBenchmark(const SqliteTuning& tuning)
+            : DbTuningTest(tuning) {
+    }
+
+    using DbTuningTest::collection;
+    using DbTuningTest::dbConnection;
+    using DbTuningTest::insertTracks;
+
+  private:
+    void TestBody() override {
+    }
+};
+
+TEST_F(DbTuningTest, DefaultsKeepSqliteDefaults) {
+    QSqlQuery query(dbConnection());
+
+    ASSERT_TRUE(query.exec("PRAGMA synchronous"));
+    ASSERT_TRUE(query.next());
+    // FULL = 2
+    EXPECT_EQ(2, query.value(0).toInt());
+
+    ASSERT_TRUE(query.exec("PRAGMA mmap_size"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(0, query.value(0).toInt());
+}
+
+class DbTuningWalTest : public DbTuningTest {
+  protected:
+    DbTuningWalTest()
+            : DbTuningTest(kSqliteTunings[kNumSqliteTunings - 1]) {
+    }
+};
+
+TEST_F(DbTuningWalTest, PragmasAreApplied) {
+    const SqliteTuning& tuning = kSqliteTunings[kNumSqliteTunings - 1];
+    QSqlQuery query(dbConnection());
+
+    ASSERT_TRUE(query.exec("PRAGMA journal_mode"));
+    ASSERT_TRUE(query.next());
+    EXPECT_QSTRING_EQ(QString(tuning.journalMode).toLower(),
+            query.value(0).toString().toLower());
+
+    ASSERT_TRUE(query.exec("PRAGMA synchronous"));
+    ASSERT_TRUE(query.next());
+    // NORMAL = 1
+    EXPECT_EQ(1, query.value(0).toInt());
+
+    ASSERT_TRUE(query.exec("PRAGMA cache_size"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(-tuning.cacheSizeKiB, query.value(0).toInt());
+}
+
+TEST_F(DbTuningTest, InsertTracks) {
+    EXPECT_EQ(100, insertTracks(100).size());
+    MixxxDb::optimizeDatabase(dbConnection());
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM library"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(100, query.value(0).toInt());
+}
+
+const int kNumTracks = 10000;
+const int kTracksPerBatch = 1000;
+
+#define FOR_ALL_SQLITE_TUNINGS(bm) bm->DenseRange(0, kNumSqliteTunings - 1)
+
+static void BM_DbInsertTracks(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    while (state.KeepRunning()) {
+        db.insertTracks(kTracksPerBatch);
+    }
+    state.SetItemsProcessed(state.iterations() * kTracksPerBatch);
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbInsertTracks));
+
+static void BM_DbCrateMembership(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    const QList<TrackId> trackIds = db.insertTracks(kNumTracks);
+    TrackCollection* pCollection = db.collection();
+    Crate crate;
+    crate.setName("Benchmark");
+    CrateId crateId;
+    pCollection->insertCrate(crate, &crateId);
+    const QList<TrackId> batch = trackIds.mid(0, kTracksPerBatch);
+    while (state.KeepRunning()) {
+        pCollection->addCrateTracks(crateId, batch);
+        benchmark::DoNotOptimize(pCollection->crates().countCrateTracks(crateId));
+        pCollection->removeCrateTracks(crateId, batch);
+    }
+    state.SetItemsProcessed(state.iterations() * kTracksPerBatch);
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbCrateMembership));
+
+static void BM_DbPlaylistReorder(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    const QList<TrackId> trackIds = db.insertTracks(kNumTracks);
+    PlaylistDAO& playlistDao = db.collection()->getPlaylistDAO();
+    const int playlistId = playlistDao.createPlaylist("Benchmark");
+    playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+    while (state.KeepRunning()) {
+        // Move the first track to the end and back again
+        playlistDao.moveTrack(playlistId, 1, kNumTracks);
+        playlistDao.moveTrack(playlistId, kNumTracks, 1);
+    }
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbPlaylistReorder));
+
+static void BM_DbPlaylistMoveNearby(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    const QList<TrackId> trackIds = db.insertTracks(kNumTracks);
+    PlaylistDAO& playlistDao = db.collection()->getPlaylistDAO();
+    const int playlistId = playlistDao.createPlaylist("Benchmark");
+    playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+    const int position = kNumTracks / 2;
+    while (state.KeepRunning()) {
+        // A drag and drop in the middle of the playlist only shifts the
+        // tracks in between
+        playlistDao.moveTrack(playlistId, position, position + 10);
+        playlistDao.moveTrack(playlistId, position + 10, position);
+    }
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbPlaylistMoveNearby));
+
+static void BM_DbPlaylistInsertRemove(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    const QList<TrackId> trackIds = db.insertTracks(kNumTracks);
+    PlaylistDAO& playlistDao = db.collection()->getPlaylistDAO();
+    const int playlistId = playlistDao.createPlaylist("Benchmark");
+    playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+    const QList<TrackId> batch = trackIds.mid(0, 100);
+    while (state.KeepRunning()) {
+        // Insert a batch of tracks into the middle of the
+        // playlist and remove it again
+        const int position = kNumTracks / 2;
+        playlistDao.insertTracksIntoPlaylist(batch, playlistId, position);
+        QList<int> positions;
+        for (int i = 0; i < batch.size(); ++i) {
+            positions.append(position + i);
+        }
+        playlistDao.removeTracksFromPlaylist(playlistId, positions);
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbPlaylistInsertRemove));
+
+static void BM_DbPlaylistShuffle(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    const QList<TrackId> trackIds = db.insertTracks(kNumTracks);
+    PlaylistDAO& playlistDao = db.collection()->getPlaylistDAO();
+    const int playlistId = playlistDao.createPlaylist("Benchmark");
+    playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+    QHash<int,TrackId> allIds;
+    for (int i = 0; i < trackIds.size(); ++i) {
+        allIds.insert(i + 1, trackIds.at(i));
+    }
+    // Shuffle a selection of tracks that is spread over the whole
+    // playlist. The duplicate search of the shuffle algorithm scans
+    // a quarter of the playlist for each track.
+    QList<int> positions;
+    for (int i = 1; i <= kNumTracks; i += kNumTracks / 100) {
+        positions.append(i);
+    }
+    while (state.KeepRunning()) {
+        playlistDao.shuffleTracks(playlistId, positions, allIds);
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbPlaylistShuffle));
+
+static void BM_DbSelectAllTracks(benchmark::State& state) {
+    const SqliteTuning& tuning = kSqliteTunings[state.range_x()];
+    DbTuningBenchmark db(tuning);
+    db.insertTracks(kNumTracks);
+    MixxxDb::optimizeDatabase(db.dbConnection());
+    while (state.KeepRunning()) {
+        QSqlQuery query(db.dbConnection());
+        query.setForwardOnly(true);
+        query.exec("SELECT library.id, artist, title, album, duration, "
+                   "track_locations.location "
+                   "FROM library INNER JOIN track_locations "
+                   "ON library.location = track_locations.id "
+                   "WHERE mixxx_deleted=0");
+        int rows = 0;
+        while (query.next()) {
+            ++rows;
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(state.iterations() * kNumTracks);
+    state.SetLabel(tuning.label);
+}
+FOR_ALL_SQLITE_TUNINGS(BENCHMARK(BM_DbSelectAllTracks));
+
+}  // namespace
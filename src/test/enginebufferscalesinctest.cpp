@@ -0,0 +1,240 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <vector>
+
+#include "engine/enginebufferscalelinear.h"
+#include "engine/enginebufferscalesinc.h"
+#include "engine/readaheadmanager.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+const int kSampleRate = 44100;
+const SINT kBufferSize = 1024;
+const SINT kBufferFrames = kBufferSize / 2;
+
+// Plays a stereo sine with the given frequency in cycles per input frame
+// and offset in both directions at the rate of the scaler. The right channel
+// is the inverted left channel.
+class SineReadAheadManager : public ReadAheadManager {
+  public:
+    SineReadAheadManager(double frequency, CSAMPLE amplitude,
+            CSAMPLE offset = 0)
+            : ReadAheadManager(),
+              m_frequency(frequency),
+              m_amplitude(amplitude),
+              m_offset(offset),
+              m_frame(0),
+              m_framesRead(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer,
+            SINT requested_samples) override {
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            CSAMPLE sample = m_offset;
+            if (m_frequency != 0) {
+                sample += m_amplitude * static_cast<CSAMPLE>(
+                        sin(2 * M_PI * m_frequency * m_frame));
+            }
+            buffer[i] = sample;
+            buffer[i + 1] = -sample;
+            m_frame += dRate < 0 ? -1 : 1;
+        }
+        m_framesRead += requested_samples / 2;
+        return requested_samples;
+    }
+
+    SINT getFramesRead() const {
+        return m_framesRead;
+    }
+
+  private:
+    const double m_frequency;
+    const CSAMPLE m_amplitude;
+    const CSAMPLE m_offset;
+    SINT m_frame;
+    SINT m_framesRead;
+};
+
+class EngineBufferScaleSincTest : public testing::Test {
+  protected:
+    static void setRate(EngineBufferScale* pScaler, double rate) {
+        double tempoRatio = rate;
+        double pitchRatio = rate;
+        pScaler->setSampleRate(kSampleRate);
+        pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    // Scales a few buffers so the filter is filled and returns the peak
+    // amplitude of the last one
+    static CSAMPLE settledPeak(EngineBufferScale* pScaler, double rate) {
+        setRate(pScaler, rate);
+        std::vector<CSAMPLE> output(kBufferSize);
+        for (int i = 0; i < 4; ++i) {
+            pScaler->scaleBuffer(output.data(), kBufferSize);
+        }
+        CSAMPLE peak = 0;
+        for (const CSAMPLE sample : output) {
+            peak = math_max(peak, fabs(sample));
+        }
+        return peak;
+    }
+
+    static const EngineBufferScaleSinc::Quality kQualities[];
+};
+
+const EngineBufferScaleSinc::Quality EngineBufferScaleSincTest::kQualities[] = {
+    EngineBufferScaleSinc::Quality::Fast,
+    EngineBufferScaleSinc::Quality::Medium,
+    EngineBufferScaleSinc::Quality::High,
+};
+
+TEST_F(EngineBufferScaleSincTest, ConstantIsUnchanged) {
+    for (const auto quality : kQualities) {
+        for (const double rate : { 0.5, 1.0, 1.37, 2.5 }) {
+            SineReadAheadManager readAheadManager(0, 0, 0.5);
+            EngineBufferScaleSinc scaler(&readAheadManager, quality);
+            setRate(&scaler, rate);
+            std::vector<CSAMPLE> output(kBufferSize);
+            // Skip the fade in from the silent history
+            scaler.scaleBuffer(output.data(), kBufferSize);
+            scaler.scaleBuffer(output.data(), kBufferSize);
+            for (SINT i = 0; i < kBufferSize; i += 2) {
+                EXPECT_NEAR(0.5, output[i], 1e-5);
+                EXPECT_NEAR(-0.5, output[i + 1], 1e-5);
+            }
+        }
+    }
+}
+
+TEST_F(EngineBufferScaleSincTest, PassbandIsFlat) {
+    for (const auto quality : kQualities) {
+        for (const double rate : { 0.5, 1.0, 1.5 }) {
+            SineReadAheadManager readAheadManager(0.02, 0.5);
+            EngineBufferScaleSinc scaler(&readAheadManager, quality);
+            EXPECT_NEAR(0.5, settledPeak(&scaler, rate), 0.01)
+                    << "quality " << static_cast<int>(quality)
+                    << " rate " << rate;
+        }
+    }
+}
+
+TEST_F(EngineBufferScaleSincTest, AliasesAreSuppressed) {
+    // Above the Nyquist frequency of the output at rate 1.5
+    const double frequency = 0.45;
+    const double rate = 1.5;
+
+    SineReadAheadManager linearReadAheadManager(frequency, 0.5);
+    EngineBufferScaleLinear linear(&linearReadAheadManager);
+    const CSAMPLE linearPeak = settledPeak(&linear, rate);
+    EXPECT_GT(linearPeak, 0.25);
+
+    for (const auto quality : kQualities) {
+        SineReadAheadManager readAheadManager(frequency, 0.5);
+        EngineBufferScaleSinc scaler(&readAheadManager, quality);
+        EXPECT_LT(settledPeak(&scaler, rate), 0.01)
+                << "quality " << static_cast<int>(quality);
+    }
+}
+
+TEST_F(EngineBufferScaleSincTest, FramesReadFollowRate) {
+    for (const double rate : { 0.5, 1.0, 1.37, -1.2 }) {
+        SineReadAheadManager readAheadManager(0.02, 0.5);
+        EngineBufferScaleSinc scaler(&readAheadManager);
+        setRate(&scaler, rate);
+        std::vector<CSAMPLE> output(kBufferSize);
+        double framesRead = 0;
+        const int buffers = 100;
+        for (int i = 0; i < buffers; ++i) {
+            framesRead += scaler.scaleBuffer(output.data(), kBufferSize);
+        }
+        EXPECT_EQ(readAheadManager.getFramesRead(), framesRead);
+        // The scaler reads the rest of the buffer and the history of the
+        // filter ahead.
+        EXPECT_NEAR(fabs(rate) * buffers * kBufferFrames, framesRead,
+                fabs(rate) * kBufferFrames + 32) << "rate " << rate;
+    }
+}
+
+TEST_F(EngineBufferScaleSincTest, QualityChangeIsSmooth) {
+    const double frequency = 0.01;
+    const double rate = 1.2;
+    SineReadAheadManager readAheadManager(frequency, 0.5);
+    EngineBufferScaleSinc scaler(&readAheadManager,
+            EngineBufferScaleSinc::Quality::Fast);
+    setRate(&scaler, rate);
+
+    std::vector<CSAMPLE> output(kBufferSize);
+    // Skip the fade in from the silent history
+    scaler.scaleBuffer(output.data(), kBufferSize);
+    CSAMPLE last = output[kBufferSize - 2];
+    // The highest step of the sine between two output frames
+    const CSAMPLE maxStep = static_cast<CSAMPLE>(
+            2 * M_PI * frequency * rate * 0.5) * 1.05f;
+    for (const auto quality : { EngineBufferScaleSinc::Quality::High,
+            EngineBufferScaleSinc::Quality::Medium,
+            EngineBufferScaleSinc::Quality::Fast }) {
+        scaler.setQuality(quality);
+        EXPECT_EQ(quality, scaler.getQuality());
+        scaler.scaleBuffer(output.data(), kBufferSize);
+        for (SINT i = 0; i < kBufferSize; i += 2) {
+            EXPECT_LT(fabs(output[i] - last), maxStep) << "frame " << i / 2;
+            last = output[i];
+        }
+    }
+}
+
+// The rates of the benchmarks in percent
+const int kBenchmarkRates[] = { 50, 100, 150 };
+
+static void BM_ScaleBuffer(benchmark::State& state,
+        EngineBufferScale* pScaler, int ratePercent) {
+    double tempoRatio = ratePercent / 100.0;
+    double pitchRatio = tempoRatio;
+    pScaler->setSampleRate(kSampleRate);
+    pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    std::vector<CSAMPLE> output(kBufferSize);
+    while (state.KeepRunning()) {
+        pScaler->scaleBuffer(output.data(), kBufferSize);
+    }
+    state.SetItemsProcessed(state.iterations() * kBufferFrames);
+}
+
+// The input is constant, so the benchmarks measure the scaler only
+
+// The argument is the rate in percent
+static void BM_ScaleLinear(benchmark::State& state) {
+    SineReadAheadManager readAheadManager(0, 0, 0.5);
+    EngineBufferScaleLinear scaler(&readAheadManager);
+    BM_ScaleBuffer(state, &scaler, state.range_x());
+}
+
+static void LinearArguments(benchmark::internal::Benchmark* b) {
+    for (const int rate : kBenchmarkRates) {
+        b->Arg(rate);
+    }
+}
+BENCHMARK(BM_ScaleLinear)->Apply(LinearArguments);
+
+// The arguments are the quality and the rate in percent
+static void BM_ScaleSinc(benchmark::State& state) {
+    SineReadAheadManager readAheadManager(0, 0, 0.5);
+    EngineBufferScaleSinc scaler(&readAheadManager,
+            static_cast<EngineBufferScaleSinc::Quality>(state.range_x()));
+    BM_ScaleBuffer(state, &scaler, state.range_y());
+}
+
+static void SincArguments(benchmark::internal::Benchmark* b) {
+    for (int quality = 0; quality <= 2; ++quality) {
+        for (const int rate : kBenchmarkRates) {
+            b->ArgPair(quality, rate);
+        }
+    }
+}
+BENCHMARK(BM_ScaleSinc)->Apply(SincArguments);
+
+}  // namespace
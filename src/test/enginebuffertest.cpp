@@ -379,6 +379,39 @@ TEST_F(EngineBufferE2ETest, RubberbandReverseTest) {
     // on the uses library version
 }
 
+TEST_F(EngineBufferE2ETest, RubberbandWorkerSeekTest) {
+    // The lookahead of the worker must be dropped on seeks and when
+    // reversing without crashing.
+    EngineBuffer* pEngineBuffer = m_pChannel1->getEngineBuffer();
+    // The worker thread is only started once it is selected
+    EXPECT_TRUE(pEngineBuffer->m_pScaleRBWorker.fetchAndAddAcquire(0) == NULL);
+    ControlObject::set(ConfigKey("[Master]", "keylock_engine"),
+                       static_cast<double>(EngineBuffer::RUBBERBAND_WORKER));
+    EXPECT_TRUE(pEngineBuffer->m_pScaleRBWorker.fetchAndAddAcquire(0) != NULL);
+    ControlObject::set(ConfigKey(m_sGroup1, "keylock"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup1, "rate"), 0.5);
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    for (int i = 0; i < 8; ++i) {
+        ProcessBuffer();
+    }
+    pEngineBuffer->queueNewPlaypos(1000, EngineBuffer::SEEK_EXACT);
+    ProcessBuffer();
+    // Continues from the seek position instead of the lookahead
+    const double seekPlayPos = pEngineBuffer->m_filepos_play;
+    EXPECT_NEAR(1000 + pEngineBuffer->getSpeed() * kProcessBufferSize,
+            seekPlayPos, 0.1 * kProcessBufferSize);
+
+    ControlObject::set(ConfigKey(m_sGroup1, "reverse"), 1.0);
+    ProcessBuffer();
+    const double reversePlayPos = pEngineBuffer->m_filepos_play;
+    EXPECT_GT(0.0, pEngineBuffer->getSpeed());
+    EXPECT_GT(seekPlayPos, reversePlayPos);
+    ProcessBuffer();
+    EXPECT_GT(reversePlayPos, pEngineBuffer->m_filepos_play);
+    // Note: we cannot compare a golden buffer here, because the result depends
+    // on the timing of the worker thread
+}
+
 TEST_F(EngineBufferE2ETest, CueGotoAndStopTest) {
     // Be sure, that the Crossfade buffer is processed only once
     // Bug #1504838
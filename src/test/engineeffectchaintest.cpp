@@ -0,0 +1,303 @@
+#include <gtest/gtest.h>
+
+#include <QSet>
+#include <QtDebug>
+#include <vector>
+
+#include "effects/native/bitcrushereffect.h"
+#include "effects/native/echoeffect.h"
+#include "effects/native/filtereffect.h"
+#include "engine/channelhandle.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
+#include "engine/effects/groupfeaturestate.h"
+#include "util/fifo.h"
+#include "util/math.h"
+#include "util/memory.h"
+#include "util/sample.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+const unsigned int kSampleRate = 44100;
+const unsigned int kNumSamples = 512;
+
+// Compares the output of a chain with a filter and a bitcrusher, which both
+// process in place, with the output of the same effects processed one after
+// the other into separate buffers.
+class EngineEffectChainTest : public testing::Test {
+  protected:
+    EngineEffectChainTest()
+            : m_chain("test"),
+              m_input(kNumSamples),
+              m_buffer1(kNumSamples),
+              m_buffer2(kNumSamples) {
+        QString group = "[Channel1]";
+        m_channel = m_factory.getOrCreateHandle(group);
+        m_registeredChannels.insert(ChannelHandleAndGroup(m_channel, group));
+
+        QPair<EffectsRequestPipe*, EffectsResponsePipe*> pipes =
+                TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                        16, 16, false, false);
+        m_pRequestPipe.reset(pipes.first);
+        m_pResponsePipe.reset(pipes.second);
+
+        m_pFilter.reset(makeEffect<FilterEffect>());
+        m_pBitCrusher.reset(makeEffect<BitCrusherEffect>());
+        m_pReferenceFilter.reset(makeEffect<FilterEffect>());
+        m_pReferenceBitCrusher.reset(makeEffect<BitCrusherEffect>());
+        EXPECT_TRUE(m_pFilter->processesInPlace());
+        EXPECT_TRUE(m_pBitCrusher->processesInPlace());
+
+        addEffect(m_pFilter.get(), 0);
+        addEffect(m_pBitCrusher.get(), 1);
+
+        for (unsigned int i = 0; i < kNumSamples; i += 2) {
+            m_input[i] = static_cast<CSAMPLE>(0.8 * sin(i * 0.01));
+            m_input[i + 1] = static_cast<CSAMPLE>(0.8 * cos(i * 0.03));
+        }
+    }
+
+    template <class EffectType>
+    EngineEffect* makeEffect() {
+        EngineEffect* pEffect = new EngineEffect(EffectType::getManifest(),
+                m_registeredChannels, EffectInstantiatorPointer(
+                        new EffectProcessorInstantiator<EffectType>()));
+        EffectsRequest enable;
+        enable.type = EffectsRequest::SET_EFFECT_PARAMETERS;
+        enable.SetEffectParameters.enabled = true;
+        pEffect->processEffectsRequest(enable, m_pResponsePipe.get());
+
+        // Lower the lpf of the filter, the bitcrusher keeps its defaults
+        EngineEffectParameter* pLpf = pEffect->getParameterById("lpf");
+        if (pLpf != nullptr) {
+            EngineEffectParameter::Values values = pLpf->values();
+            values.value = 1000;
+            pEffect->setParameterValues(0, values);
+            pEffect->updateParameters();
+        }
+        return pEffect;
+    }
+
+    void addEffect(EngineEffect* pEffect, int iIndex) {
+        addEffect(&m_chain, pEffect, iIndex);
+    }
+
+    void addEffect(EngineEffectChain* pChain, EngineEffect* pEffect,
+            int iIndex) {
+        EffectsRequest add;
+        add.type = EffectsRequest::ADD_EFFECT_TO_CHAIN;
+        add.AddEffectToChain.pEffect = pEffect;
+        add.AddEffectToChain.iIndex = iIndex;
+        pChain->processEffectsRequest(add, m_pResponsePipe.get());
+    }
+
+    void disableEffect(EngineEffect* pEffect) {
+        EffectsRequest disable;
+        disable.type = EffectsRequest::SET_EFFECT_PARAMETERS;
+        disable.SetEffectParameters.enabled = false;
+        pEffect->processEffectsRequest(disable, m_pResponsePipe.get());
+    }
+
+    void setMix(double mix) {
+        setMix(&m_chain, mix);
+    }
+
+    void setMix(EngineEffectChain* pChain, double mix) {
+        EffectsRequest parameters;
+        parameters.type = EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS;
+        parameters.SetEffectChainParameters.enabled = true;
+        parameters.SetEffectChainParameters.insertion_type = EffectChain::INSERT;
+        parameters.SetEffectChainParameters.mix = mix;
+        pChain->processEffectsRequest(parameters, m_pResponsePipe.get());
+    }
+
+    void enableChain(double mix) {
+        enableChain(&m_chain, mix);
+    }
+
+    void enableChain(EngineEffectChain* pChain, double mix) {
+        setMix(pChain, mix);
+
+        EffectsRequest enableForChannel;
+        enableForChannel.type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_CHANNEL;
+        enableForChannel.channel = m_channel;
+        pChain->processEffectsRequest(enableForChannel, m_pResponsePipe.get());
+    }
+
+    // Compares a fully wet chain of the effects with the reference effects
+    // processed one after the other, also while the last effect fades out.
+    void testFullyWet(const std::vector<EngineEffect*>& effects,
+            const std::vector<EngineEffect*>& referenceEffects) {
+        EngineEffectChain chain("fullywet");
+        for (size_t i = 0; i < effects.size(); ++i) {
+            addEffect(&chain, effects[i], static_cast<int>(i));
+        }
+        enableChain(&chain, 1.0);
+
+        SampleBuffer chainBuffer(kNumSamples);
+        for (int buffer = 0; buffer < 5; ++buffer) {
+            EffectProcessor::EnableState enableState =
+                    EffectProcessor::ENABLED;
+            if (buffer == 0) {
+                enableState = EffectProcessor::ENABLING;
+            } else if (buffer == 4) {
+                disableEffect(effects.back());
+                disableEffect(referenceEffects.back());
+            }
+
+            SampleUtil::copy(chainBuffer.data(), m_input.data(), kNumSamples);
+            chain.process(m_channel, chainBuffer.data(), kNumSamples,
+                    kSampleRate, m_featureState);
+
+            const CSAMPLE* pInput = m_input.data();
+            CSAMPLE* pOutput = m_buffer1.data();
+            for (EngineEffect* pEffect : referenceEffects) {
+                pEffect->process(m_channel, pInput, pOutput, kNumSamples,
+                        kSampleRate, enableState, m_featureState);
+                pInput = pOutput;
+                pOutput = pOutput == m_buffer1.data() ?
+                        m_buffer2.data() : m_buffer1.data();
+            }
+
+            // The first buffer ramps the mix from dry
+            if (buffer > 0) {
+                for (unsigned int i = 0; i < kNumSamples; ++i) {
+                    ASSERT_FLOAT_EQ(pInput[i], chainBuffer[i])
+                            << "buffer " << buffer << " sample " << i;
+                }
+            }
+        }
+    }
+
+    // Processes the input with the chain and with the reference effects,
+    // the result of the reference effects is in m_buffer2
+    void process(SampleBuffer* pChainBuffer,
+            EffectProcessor::EnableState enableState) {
+        SampleUtil::copy(pChainBuffer->data(), m_input.data(), kNumSamples);
+        m_chain.process(m_channel, pChainBuffer->data(), kNumSamples,
+                kSampleRate, m_featureState);
+
+        m_pReferenceFilter->process(m_channel, m_input.data(),
+                m_buffer1.data(), kNumSamples, kSampleRate, enableState,
+                m_featureState);
+        m_pReferenceBitCrusher->process(m_channel, m_buffer1.data(),
+                m_buffer2.data(), kNumSamples, kSampleRate, enableState,
+                m_featureState);
+    }
+
+    ChannelHandleFactory m_factory;
+    ChannelHandle m_channel;
+    QSet<ChannelHandleAndGroup> m_registeredChannels;
+    std::unique_ptr<EffectsRequestPipe> m_pRequestPipe;
+    std::unique_ptr<EffectsResponsePipe> m_pResponsePipe;
+    std::unique_ptr<EngineEffect> m_pFilter;
+    std::unique_ptr<EngineEffect> m_pBitCrusher;
+    std::unique_ptr<EngineEffect> m_pReferenceFilter;
+    std::unique_ptr<EngineEffect> m_pReferenceBitCrusher;
+    EngineEffectChain m_chain;
+    GroupFeatureState m_featureState;
+    SampleBuffer m_input;
+    SampleBuffer m_buffer1;
+    SampleBuffer m_buffer2;
+};
+
+TEST_F(EngineEffectChainTest, FullyWetProcessesInPlace) {
+    enableChain(1.0);
+    SampleBuffer chainBuffer(kNumSamples);
+    // Ramps the mix from dry
+    process(&chainBuffer, EffectProcessor::ENABLING);
+
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        process(&chainBuffer, EffectProcessor::ENABLED);
+        for (unsigned int i = 0; i < kNumSamples; ++i) {
+            ASSERT_FLOAT_EQ(m_buffer2[i], chainBuffer[i]) << i;
+        }
+    }
+}
+
+TEST_F(EngineEffectChainTest, HalfWetMixesWithDry) {
+    enableChain(0.5);
+    SampleBuffer chainBuffer(kNumSamples);
+    process(&chainBuffer, EffectProcessor::ENABLING);
+
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        process(&chainBuffer, EffectProcessor::ENABLED);
+        for (unsigned int i = 0; i < kNumSamples; ++i) {
+            ASSERT_NEAR(0.5 * m_input[i] + 0.5 * m_buffer2[i], chainBuffer[i],
+                    1e-6) << i;
+        }
+    }
+}
+
+TEST_F(EngineEffectChainTest, ResumesAfterSilence) {
+    enableChain(1.0);
+    SampleBuffer chainBuffer(kNumSamples);
+    process(&chainBuffer, EffectProcessor::ENABLING);
+    process(&chainBuffer, EffectProcessor::ENABLED);
+
+    // Long enough for the chain to fall asleep, while the reference effects
+    // keep processing silence
+    SampleBuffer input(kNumSamples);
+    SampleUtil::copy(input.data(), m_input.data(), kNumSamples);
+    m_input.clear();
+    for (unsigned int buffer = 0; buffer < 10 * kSampleRate / kNumSamples;
+            ++buffer) {
+        process(&chainBuffer, EffectProcessor::ENABLED);
+        for (unsigned int i = 0; i < kNumSamples; ++i) {
+            ASSERT_NEAR(0.0, chainBuffer[i], 1e-6) << i;
+        }
+    }
+
+    // The first buffer with audible input is processed completely
+    SampleUtil::copy(m_input.data(), input.data(), kNumSamples);
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        process(&chainBuffer, EffectProcessor::ENABLED);
+        for (unsigned int i = 0; i < kNumSamples; ++i) {
+            ASSERT_NEAR(m_buffer2[i], chainBuffer[i], 1e-5) << i;
+        }
+    }
+}
+
+TEST_F(EngineEffectChainTest, FullyWetWithoutInPlaceEffect) {
+    std::unique_ptr<EngineEffect> pEcho(makeEffect<EchoEffect>());
+    std::unique_ptr<EngineEffect> pReferenceEcho(makeEffect<EchoEffect>());
+    EXPECT_FALSE(pEcho->processesInPlace());
+    testFullyWet({ pEcho.get() }, { pReferenceEcho.get() });
+}
+
+TEST_F(EngineEffectChainTest, FullyWetInPlaceEffectFollowedByOther) {
+    std::unique_ptr<EngineEffect> pFilter(makeEffect<FilterEffect>());
+    std::unique_ptr<EngineEffect> pEcho(makeEffect<EchoEffect>());
+    std::unique_ptr<EngineEffect> pReferenceEcho(makeEffect<EchoEffect>());
+    testFullyWet({ pFilter.get(), pEcho.get() },
+            { m_pReferenceFilter.get(), pReferenceEcho.get() });
+}
+
+TEST_F(EngineEffectChainTest, FullyDryKeepsProcessingEffects) {
+    enableChain(0.0);
+    SampleBuffer chainBuffer(kNumSamples);
+    process(&chainBuffer, EffectProcessor::ENABLING);
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        process(&chainBuffer, EffectProcessor::ENABLED);
+        // The input is left untouched
+        for (unsigned int i = 0; i < kNumSamples; ++i) {
+            ASSERT_EQ(m_input[i], chainBuffer[i]) << i;
+        }
+    }
+
+    // Ramps the mix from dry
+    setMix(1.0);
+    process(&chainBuffer, EffectProcessor::ENABLED);
+
+    // The state of the effects is the same as if they have been heard
+    // all the time
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        process(&chainBuffer, EffectProcessor::ENABLED);
+        for (unsigned int i = 0; i < kNumSamples; ++i) {
+            ASSERT_FLOAT_EQ(m_buffer2[i], chainBuffer[i]) << i;
+        }
+    }
+}
+
+}  // namespace
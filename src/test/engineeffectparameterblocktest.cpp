@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <QAtomicInt>
+#include <QSet>
+#include <QtDebug>
+#include <thread>
+
+#include "effects/native/filtereffect.h"
+#include "engine/channelhandle.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectparameterblock.h"
+
+namespace {
+
+class EngineEffectParameterBlockTest : public testing::Test {
+  protected:
+    static EngineEffectParameter::Values makeValues(double value) {
+        EngineEffectParameter::Values values;
+        values.value = value;
+        values.defaultValue = value;
+        values.minimum = value;
+        values.maximum = value;
+        return values;
+    }
+};
+
+TEST_F(EngineEffectParameterBlockTest, ValuesChangeOnUpdate) {
+    ChannelHandleFactory factory;
+    QSet<ChannelHandleAndGroup> registeredChannels;
+    registeredChannels.insert(ChannelHandleAndGroup(
+            factory.getOrCreateHandle("[Channel1]"), "[Channel1]"));
+    EngineEffect effect(FilterEffect::getManifest(), registeredChannels,
+            EffectInstantiatorPointer(
+                    new EffectProcessorInstantiator<FilterEffect>()));
+
+    EngineEffectParameter* pLpf = effect.getParameterById("lpf");
+    EngineEffectParameter* pHpf = effect.getParameterById("hpf");
+    ASSERT_NE(nullptr, pLpf);
+    ASSERT_NE(nullptr, pHpf);
+    const double lpf = pLpf->value();
+    const double hpf = pHpf->value();
+
+    // Nothing changes before the first set
+    effect.updateParameters();
+    EXPECT_DOUBLE_EQ(lpf, pLpf->value());
+    EXPECT_DOUBLE_EQ(hpf, pHpf->value());
+
+    EngineEffectParameter::Values values = pLpf->values();
+    values.value = lpf / 2;
+    EXPECT_TRUE(effect.setParameterValues(0, values));
+    EXPECT_FALSE(effect.setParameterValues(-1, values));
+    EXPECT_FALSE(effect.setParameterValues(3, values));
+
+    // Takes effect with the next callback only
+    EXPECT_DOUBLE_EQ(lpf, pLpf->value());
+    effect.updateParameters();
+    EXPECT_DOUBLE_EQ(lpf / 2, pLpf->value());
+    EXPECT_DOUBLE_EQ(hpf, pHpf->value());
+}
+
+TEST_F(EngineEffectParameterBlockTest, ConcurrentUpdatesAreConsistent) {
+    // A controller sending far more than 1,000 changes per second
+    const int kParameters = 4;
+    const int kWrites = 100000;
+    EngineEffectParameterBlock block(kParameters);
+    for (int i = 0; i < kParameters; ++i) {
+        block.setValues(i, makeValues(0));
+    }
+
+    QAtomicInt done(0);
+    std::thread writer([&block, &done] {
+        for (int write = 1; write <= kWrites; ++write) {
+            for (int i = 0; i < kParameters; ++i) {
+                block.setValues(i, makeValues(write));
+            }
+        }
+        done.fetchAndStoreRelease(1);
+    });
+
+    // Like the engine, but without waiting for the next callback
+    int updates = 0;
+    int inconsistentReads = 0;
+    while (done.fetchAndAddAcquire(0) == 0) {
+        if (!block.takeChanges()) {
+            continue;
+        }
+        ++updates;
+        for (int i = 0; i < kParameters; ++i) {
+            const EngineEffectParameter::Values values = block.getValues(i);
+            if (values.defaultValue != values.value ||
+                    values.minimum != values.value ||
+                    values.maximum != values.value) {
+                ++inconsistentReads;
+            }
+        }
+    }
+    writer.join();
+
+    EXPECT_EQ(0, inconsistentReads);
+    EXPECT_GT(updates, 0);
+    // The last values are not lost
+    block.takeChanges();
+    for (int i = 0; i < kParameters; ++i) {
+        EXPECT_DOUBLE_EQ(kWrites, block.getValues(i).value);
+    }
+}
+
+}  // namespace
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+
+#include "engine/enginefilterbiquad1.h"
+#include "engine/enginefilterdesign.h"
+
+namespace {
+
+// Relative to the magnitude of each coefficient
+const double kMaxRelativeError = 1e-9;
+
+const double kFrequencies[] = { 0.0001, 0.001, 0.01, 0.1, 0.2, 0.3, 0.45 };
+
+class EngineFilterDesignTest : public testing::Test {
+  protected:
+    // Designs the reference coefficients with fidlib
+    static void designWithFidlib(double* pCoef, int numCoef, const char* spec,
+            double freq0, double freq1 = 0) {
+        char spec_d[FIDSPEC_LENGTH];
+        ASSERT_LT(strlen(spec), sizeof(spec_d));
+        strcpy(spec_d, spec);
+        pCoef[0] = fid_design_coef(pCoef + 1, numCoef - 1, spec_d,
+                1.0, freq0, freq1, 0);
+    }
+
+    // Two cascaded Butterworth filters like EngineFilterIIR::setCoefs2()
+    static void designLinkwitzRileyWithFidlib(double* pCoef, const char* spec,
+            int halfOrder, double freq) {
+        designWithFidlib(pCoef, halfOrder + 1, spec, freq);
+        for (int i = 1; i <= halfOrder; ++i) {
+            pCoef[halfOrder + i] = pCoef[i];
+        }
+        pCoef[0] *= pCoef[0];
+    }
+
+    static void expectCoefsEqual(const double* pExpected, const double* pCoef,
+            int numCoef, const char* spec) {
+        for (int i = 0; i < numCoef; ++i) {
+            EXPECT_NEAR(pExpected[i], pCoef[i],
+                    fabs(pExpected[i]) * kMaxRelativeError + 1e-15)
+                    << spec << " coefficient " << i;
+        }
+    }
+
+    void testPrototype(EngineFilterDesign::Prototype prototype,
+            const char* name) {
+        double expected[2 * EngineFilterDesign::kMaxOrder + 1];
+        double coef[2 * EngineFilterDesign::kMaxOrder + 1];
+        char spec[FIDSPEC_LENGTH];
+        for (int order = 1; order <= EngineFilterDesign::kMaxOrder; ++order) {
+            for (double freq: kFrequencies) {
+                format_fidspec(spec, sizeof(spec), "Lp%s%d", name, order);
+                designWithFidlib(expected, order + 1, spec, freq);
+                EngineFilterDesign::lowPass(coef, prototype, order, freq);
+                expectCoefsEqual(expected, coef, order + 1, spec);
+
+                format_fidspec(spec, sizeof(spec), "Hp%s%d", name, order);
+                designWithFidlib(expected, order + 1, spec, freq);
+                EngineFilterDesign::highPass(coef, prototype, order, freq);
+                expectCoefsEqual(expected, coef, order + 1, spec);
+
+                const double freq1 = freq * 1.7;
+                if (freq1 < 0.5) {
+                    format_fidspec(spec, sizeof(spec), "Bp%s%d", name, order);
+                    designWithFidlib(expected, 2 * order + 1, spec, freq, freq1);
+                    EngineFilterDesign::bandPass(coef, prototype, order,
+                            freq, freq1);
+                    expectCoefsEqual(expected, coef, 2 * order + 1, spec);
+                }
+            }
+        }
+    }
+};
+
+TEST_F(EngineFilterDesignTest, besselMatchesFidlib) {
+    testPrototype(EngineFilterDesign::Prototype::Bessel, "Be");
+}
+
+TEST_F(EngineFilterDesignTest, butterworthMatchesFidlib) {
+    testPrototype(EngineFilterDesign::Prototype::Butterworth, "Bu");
+}
+
+TEST_F(EngineFilterDesignTest, linkwitzRileyMatchesFidlib) {
+    double expected[9];
+    double coef[9];
+    char spec[FIDSPEC_LENGTH];
+    for (int order = 2; order <= 8; order *= 2) {
+        const int halfOrder = order / 2;
+        for (double freq: kFrequencies) {
+            format_fidspec(spec, sizeof(spec), "LpBu%d", halfOrder);
+            designLinkwitzRileyWithFidlib(expected, spec, halfOrder, freq);
+            EngineFilterDesign::lowPassLinkwitzRiley(coef, order, freq);
+            expectCoefsEqual(expected, coef, order + 1, spec);
+
+            format_fidspec(spec, sizeof(spec), "HpBu%d", halfOrder);
+            designLinkwitzRileyWithFidlib(expected, spec, halfOrder, freq);
+            EngineFilterDesign::highPassLinkwitzRiley(coef, order, freq);
+            expectCoefsEqual(expected, coef, order + 1, spec);
+        }
+    }
+}
+
+TEST_F(EngineFilterDesignTest, biquadsMatchFidlib) {
+    // The shelf slope must not exceed 1.8 for the gains below
+    const double kQs[] = { 0.3, 0.707, 1.5 };
+    const double kGains[] = { -25.0, 0.0, 6.0 };
+    double expected[6];
+    double coef[6];
+    char spec[FIDSPEC_LENGTH];
+    for (double freq: kFrequencies) {
+        for (double Q: kQs) {
+            format_fidspec(spec, sizeof(spec), "LpBq/%.10f", Q);
+            designWithFidlib(expected, 3, spec, freq);
+            EngineFilterDesign::lowPassBiquad(coef, freq, Q);
+            expectCoefsEqual(expected, coef, 3, spec);
+
+            format_fidspec(spec, sizeof(spec), "BpBq/%.10f", Q);
+            designWithFidlib(expected, 3, spec, freq);
+            EngineFilterDesign::bandPassBiquad(coef, freq, Q);
+            expectCoefsEqual(expected, coef, 3, spec);
+
+            format_fidspec(spec, sizeof(spec), "HpBq/%.10f", Q);
+            designWithFidlib(expected, 3, spec, freq);
+            EngineFilterDesign::highPassBiquad(coef, freq, Q);
+            expectCoefsEqual(expected, coef, 3, spec);
+
+            for (double dBgain: kGains) {
+                format_fidspec(spec, sizeof(spec), "PkBq/%.10f/%.10f", Q, dBgain);
+                designWithFidlib(expected, 6, spec, freq);
+                EngineFilterDesign::peakingBiquad(coef, freq, Q, dBgain);
+                expectCoefsEqual(expected, coef, 6, spec);
+
+                format_fidspec(spec, sizeof(spec), "LsBq/%.10f/%.10f", Q, dBgain);
+                designWithFidlib(expected, 6, spec, freq);
+                EngineFilterDesign::lowShelvingBiquad(coef, freq, Q, dBgain);
+                expectCoefsEqual(expected, coef, 6, spec);
+
+                format_fidspec(spec, sizeof(spec), "HsBq/%.10f/%.10f", Q, dBgain);
+                designWithFidlib(expected, 6, spec, freq);
+                EngineFilterDesign::highShelvingBiquad(coef, freq, Q, dBgain);
+                expectCoefsEqual(expected, coef, 6, spec);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "effects/native/lvmixeqbase.h"
+#include "engine/enginefilterbessel4.h"
+#include "engine/enginefilterbessel8.h"
+#include "engine/enginefilterbiquad1.h"
+#include "engine/enginefilterbutterworth4.h"
+#include "engine/enginefilterbutterworth8.h"
+
+namespace {
+
+const int kSampleRate = 44100;
+const int kBufferSize = 1024;
+const CSAMPLE kMaxError = 1e-5f;
+
+// Processes the filter sample by sample through processSample()
+template<class Filter>
+class SampleBySampleFilter : public Filter {
+  public:
+    using Filter::Filter;
+
+    void processBySample(const CSAMPLE* pIn, CSAMPLE* pOutput,
+            const int iBufferSize) {
+        for (int i = 0; i < iBufferSize; i += 2) {
+            pOutput[i] = this->processSample(
+                    this->m_coef, this->m_buf1, pIn[i]);
+            pOutput[i + 1] = this->processSample(
+                    this->m_coef, this->m_buf2, pIn[i + 1]);
+        }
+    }
+};
+
+class EngineFilterIIRLanesTest : public testing::Test {
+  protected:
+    static std::vector<CSAMPLE> noise(int numSamples) {
+        std::vector<CSAMPLE> buffer(numSamples);
+        unsigned int seed = 1;
+        for (auto& sample : buffer) {
+            seed = seed * 1103515245 + 12345;
+            sample = static_cast<CSAMPLE>(seed >> 16 & 0x7fff) / 0x4000 - 1;
+        }
+        return buffer;
+    }
+
+    static void expectBuffersNear(const std::vector<CSAMPLE>& expected,
+            const std::vector<CSAMPLE>& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_NEAR(expected[i], actual[i], kMaxError) << "sample " << i;
+        }
+    }
+
+    // The filter processes both channels in the lanes of
+    // EngineFilterIIRLanes once it has settled
+    template<class Filter>
+    void testLanesMatchSamples(Filter* pLanes,
+            SampleBySampleFilter<Filter>* pBySample) {
+        pLanes->assumeSettled();
+        pBySample->assumeSettled();
+        const std::vector<CSAMPLE> input = noise(kBufferSize);
+        std::vector<CSAMPLE> expected(kBufferSize);
+        std::vector<CSAMPLE> actual(kBufferSize);
+        for (int i = 0; i < 4; ++i) {
+            pBySample->processBySample(input.data(), expected.data(),
+                    kBufferSize);
+            pLanes->process(input.data(), actual.data(), kBufferSize);
+            expectBuffersNear(expected, actual);
+        }
+    }
+};
+
+TEST_F(EngineFilterIIRLanesTest, lowPassMatchesProcessSample) {
+    EngineFilterBessel4Low lanes(kSampleRate, 500);
+    SampleBySampleFilter<EngineFilterBessel4Low> bySample(kSampleRate, 500);
+    testLanesMatchSamples(&lanes, &bySample);
+
+    EngineFilterButterworth8Low lanes8(kSampleRate, 500);
+    SampleBySampleFilter<EngineFilterButterworth8Low> bySample8(
+            kSampleRate, 500);
+    testLanesMatchSamples(&lanes8, &bySample8);
+
+    // A single section
+    EngineFilterBiquad1Low biquadLanes(kSampleRate, 1000, 0.7, false);
+    SampleBySampleFilter<EngineFilterBiquad1Low> biquadBySample(
+            kSampleRate, 1000, 0.7, false);
+    testLanesMatchSamples(&biquadLanes, &biquadBySample);
+}
+
+TEST_F(EngineFilterIIRLanesTest, highPassMatchesProcessSample) {
+    EngineFilterButterworth8High lanes(kSampleRate, 500);
+    SampleBySampleFilter<EngineFilterButterworth8High> bySample(
+            kSampleRate, 500);
+    testLanesMatchSamples(&lanes, &bySample);
+
+    EngineFilterButterworth4High lanes4(kSampleRate, 500);
+    SampleBySampleFilter<EngineFilterButterworth4High> bySample4(
+            kSampleRate, 500);
+    testLanesMatchSamples(&lanes4, &bySample4);
+
+    // A single section
+    EngineFilterBiquad1High biquadLanes(kSampleRate, 1000, 0.7, false);
+    SampleBySampleFilter<EngineFilterBiquad1High> biquadBySample(
+            kSampleRate, 1000, 0.7, false);
+    testLanesMatchSamples(&biquadLanes, &biquadBySample);
+}
+
+TEST_F(EngineFilterIIRLanesTest, bandPassMatchesProcessSample) {
+    EngineFilterBessel8Band lanes(kSampleRate, 500, 2000);
+    SampleBySampleFilter<EngineFilterBessel8Band> bySample(
+            kSampleRate, 500, 2000);
+    testLanesMatchSamples(&lanes, &bySample);
+
+    // The high pass sections followed by the low pass sections
+    EngineFilterButterworth8Band lanes16(kSampleRate, 500, 2000);
+    SampleBySampleFilter<EngineFilterButterworth8Band> bySample16(
+            kSampleRate, 500, 2000);
+    testLanesMatchSamples(&lanes16, &bySample16);
+
+    EngineFilterBiquad1Band biquadLanes(kSampleRate, 1000, 1.5);
+    SampleBySampleFilter<EngineFilterBiquad1Band> biquadBySample(
+            kSampleRate, 1000, 1.5);
+    testLanesMatchSamples(&biquadLanes, &biquadBySample);
+}
+
+TEST_F(EngineFilterIIRLanesTest, lanesUseOwnCoefficients) {
+    EngineFilterBessel8Low low1(kSampleRate, 200);
+    EngineFilterBessel8Low low2(kSampleRate, 3000);
+    low1.assumeSettled();
+    low2.assumeSettled();
+
+    double coef1[9];
+    double coef2[9];
+    EngineFilterDesign::lowPass(coef1, EngineFilterDesign::Prototype::Bessel,
+            8, 200.0 / kSampleRate);
+    EngineFilterDesign::lowPass(coef2, EngineFilterDesign::Prototype::Bessel,
+            8, 3000.0 / kSampleRate);
+    EngineFilterBessel8Low::Lanes<4> lanes;
+    lanes.setCoefs(0, coef1);
+    lanes.setCoefs(1, coef1);
+    lanes.setCoefs(2, coef2);
+    lanes.setCoefs(3, coef2);
+
+    const std::vector<CSAMPLE> input = noise(kBufferSize);
+    std::vector<CSAMPLE> expected1(kBufferSize);
+    std::vector<CSAMPLE> expected2(kBufferSize);
+    low1.process(input.data(), expected1.data(), kBufferSize);
+    low2.process(input.data(), expected2.data(), kBufferSize);
+    for (int i = 0; i < kBufferSize; i += 2) {
+        double frame[4] = { input[i], input[i + 1], input[i], input[i + 1] };
+        lanes.processFrame(frame);
+        EXPECT_NEAR(expected1[i], frame[0], kMaxError);
+        EXPECT_NEAR(expected1[i + 1], frame[1], kMaxError);
+        EXPECT_NEAR(expected2[i], frame[2], kMaxError);
+        EXPECT_NEAR(expected2[i + 1], frame[3], kMaxError);
+    }
+}
+
+TEST_F(EngineFilterIIRLanesTest, lvMixEqFlatIsDelayedInput) {
+    LVMixEQEffectGroupState<EngineFilterBessel4Low> eq;
+    std::vector<CSAMPLE> impulse(kBufferSize, 0);
+    std::vector<CSAMPLE> output(kBufferSize);
+    // Settle the gains
+    eq.processChannel(impulse.data(), output.data(), kBufferSize,
+            kSampleRate, 1.0, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+
+    impulse[0] = 1;
+    eq.processChannel(impulse.data(), output.data(), kBufferSize,
+            kSampleRate, 1.0, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+    int delay = -1;
+    for (int i = 0; i < kBufferSize; ++i) {
+        if (output[i] != 0) {
+            EXPECT_EQ(-1, delay) << "second peak at " << i;
+            EXPECT_FLOAT_EQ(1.0f, output[i]);
+            delay = i;
+        }
+    }
+    EXPECT_GT(delay, 0);
+    EXPECT_EQ(0, delay % 2);
+}
+
+TEST_F(EngineFilterIIRLanesTest, lvMixEqLowBandIsLowPass) {
+    LVMixEQEffectGroupState<EngineFilterBessel8Low> eq;
+    EngineFilterBessel8Low lowPass(kSampleRate, kStartupLoFreq);
+    lowPass.setFrequencyCornersForIntDelay(
+            kStartupLoFreq / kSampleRate, kMaxDelay);
+
+    const std::vector<CSAMPLE> input = noise(kBufferSize);
+    std::vector<CSAMPLE> expected(kBufferSize);
+    std::vector<CSAMPLE> actual(kBufferSize);
+    for (int i = 0; i < 3; ++i) {
+        lowPass.process(input.data(), expected.data(), kBufferSize);
+        eq.processChannel(input.data(), actual.data(), kBufferSize,
+                kSampleRate, 1.0, 0.0, 0.0, kStartupLoFreq, kStartupHiFreq);
+    }
+    // Both start from silence, after the gains of the EQ have settled
+    // the low band is the lower low pass
+    expectBuffersNear(expected, actual);
+}
+
+TEST_F(EngineFilterIIRLanesTest, lvMixEqRestartsLowPassesWhenFlat) {
+    // The low passes are not processed while all bands have the same gain.
+    // Afterwards they must not depend on what has been played before.
+    LVMixEQEffectGroupState<EngineFilterBessel4Low> eqUsed;
+    LVMixEQEffectGroupState<EngineFilterBessel4Low> eqFlat;
+    const std::vector<CSAMPLE> input = noise(kBufferSize);
+    std::vector<CSAMPLE> expected(kBufferSize);
+    std::vector<CSAMPLE> actual(kBufferSize);
+    for (int i = 0; i < 3; ++i) {
+        eqUsed.processChannel(input.data(), actual.data(), kBufferSize,
+                kSampleRate, 0.5, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+        eqFlat.processChannel(input.data(), expected.data(), kBufferSize,
+                kSampleRate, 1.0, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+    }
+    for (int i = 0; i < 4; ++i) {
+        eqUsed.processChannel(input.data(), actual.data(), kBufferSize,
+                kSampleRate, 1.0, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+        eqFlat.processChannel(input.data(), expected.data(), kBufferSize,
+                kSampleRate, 1.0, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+    }
+    for (int i = 0; i < 3; ++i) {
+        eqUsed.processChannel(input.data(), actual.data(), kBufferSize,
+                kSampleRate, 0.5, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+        eqFlat.processChannel(input.data(), expected.data(), kBufferSize,
+                kSampleRate, 0.5, 1.0, 1.0, kStartupLoFreq, kStartupHiFreq);
+        expectBuffersNear(expected, actual);
+    }
+}
+
+TEST_F(EngineFilterIIRLanesTest, lvMixEqInPlace) {
+    LVMixEQEffectGroupState<EngineFilterBessel4Low> eq;
+    LVMixEQEffectGroupState<EngineFilterBessel4Low> eqInPlace;
+    const std::vector<CSAMPLE> input = noise(kBufferSize);
+    std::vector<CSAMPLE> expected(kBufferSize);
+    std::vector<CSAMPLE> actual(kBufferSize);
+    for (int i = 0; i < 3; ++i) {
+        actual = input;
+        eq.processChannel(input.data(), expected.data(), kBufferSize,
+                kSampleRate, 0.5, 1.5, 0.8, 300, 3000);
+        eqInPlace.processChannel(actual.data(), actual.data(), kBufferSize,
+                kSampleRate, 0.5, 1.5, 0.8, 300, 3000);
+        expectBuffersNear(expected, actual);
+    }
+    actual = input;
+    eq.processChannelAndPause(input.data(), expected.data(), kBufferSize);
+    eqInPlace.processChannelAndPause(actual.data(), actual.data(), kBufferSize);
+    expectBuffersNear(expected, actual);
+}
+
+}
@@ -0,0 +1,217 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QtDebug>
+#include <algorithm>
+#include <vector>
+
+#include "mixer/offlinerenderer.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+
+// Benchmarks of the audio callback with the decks, samplers and effects set
+// up like in the main window. Each benchmark reports the mean, the 99th
+// percentile and the maximum time of EngineMaster::process() in its label,
+// together with the time a callback of that size may take before the sound
+// device runs dry. Run with: mixxx-test --benchmark
+
+namespace {
+
+const QString kTrackLocation = QDir::currentPath() + "/src/test/sine-30.wav";
+
+// The callbacks that are rendered before measuring, e.g. for the effects to
+// allocate their state
+const double kWarmUpSeconds = 0.5;
+
+// Provides the test config and deletes the controls afterwards
+class EngineMasterBenchmark : public MixxxTest {
+  private:
+    void TestBody() override {
+    }
+};
+
+// The decks with a track that plays in a loop
+QString playingDecks(int decks) {
+    QString script;
+    for (int i = 1; i <= decks; ++i) {
+        script += QString(
+                "load %1 %2\n"
+                "set 0 [Channel%1] repeat 1\n"
+                "set 0 [Channel%1] play 1\n").arg(QString::number(i), kTrackLocation);
+    }
+    return script;
+}
+
+// Renders the script with the buffer size in frames and the sample rate of
+// the benchmark arguments
+void benchmarkEngineMaster(benchmark::State& state, int decks,
+        const QString& commands) {
+    EngineMasterBenchmark fixture;
+    const int bufferFrames = state.range_x();
+    const int sampleRate = state.range_y();
+
+    OfflineRenderScript script;
+    QString error;
+    bool success = script.parse(QString(
+            "samplerate %1\n"
+            "buffer %2\n"
+            "decks %3\n"
+            "length 3600\n").arg(QString::number(sampleRate),
+                    QString::number(bufferFrames), QString::number(decks)) +
+            playingDecks(decks) + commands, &error);
+    OfflineRenderer renderer(fixture.config(), script);
+    success = success && renderer.prepare(&error);
+    if (!success) {
+        state.SetLabel(error.toStdString());
+        while (state.KeepRunning()) {
+        }
+        return;
+    }
+
+    const int warmUpBuffers = static_cast<int>(
+            kWarmUpSeconds * sampleRate / bufferFrames) + 1;
+    for (int i = 0; success && i < warmUpBuffers; ++i) {
+        success = renderer.renderBuffer(nullptr, bufferFrames, &error);
+    }
+
+    std::vector<double> durations;
+    while (state.KeepRunning()) {
+        // Keeps running after a failure, the old API can't abort
+        if (success) {
+            success = renderer.renderBuffer(nullptr, bufferFrames, &error);
+            durations.push_back(1e-3 *
+                    renderer.getLastEngineDuration().toIntegerNanos());
+        }
+    }
+    if (!success) {
+        state.SetLabel(error.toStdString());
+        return;
+    }
+    state.SetItemsProcessed(state.iterations() * bufferFrames);
+
+    std::sort(durations.begin(), durations.end());
+    double sum = 0.0;
+    for (const double duration : durations) {
+        sum += duration;
+    }
+    const size_t p99 = std::min(durations.size() - 1,
+            static_cast<size_t>(ceil(durations.size() * 0.99)) - 1);
+    const double budget = 1e6 * bufferFrames / sampleRate;
+    state.SetLabel(QString("mean %1 us, p99 %2 us, max %3 us of %4 us")
+            .arg(QString::number(sum / durations.size(), 'f', 1),
+                    QString::number(durations[p99], 'f', 1),
+                    QString::number(durations.back(), 'f', 1),
+                    QString::number(budget, 'f', 1)).toStdString());
+}
+
+void BufferSizesAndSampleRates(benchmark::internal::Benchmark* b) {
+    for (const int sampleRate : { 44100, 48000, 96000 }) {
+        for (int bufferFrames = 64; bufferFrames <= 4096; bufferFrames *= 2) {
+            b->ArgPair(bufferFrames, sampleRate);
+        }
+    }
+    // The engine worker threads run concurrently
+    b->UseRealTime();
+}
+
+// The EQ and the quick effect of each deck are loaded like in the default
+// preferences, so they are part of all benchmarks.
+
+static void BM_EngineMaster_TwoDecks(benchmark::State& state) {
+    benchmarkEngineMaster(state, 2, QString());
+}
+BENCHMARK(BM_EngineMaster_TwoDecks)->Apply(BufferSizesAndSampleRates);
+
+static void BM_EngineMaster_FourDecks(benchmark::State& state) {
+    benchmarkEngineMaster(state, 4, QString());
+}
+BENCHMARK(BM_EngineMaster_FourDecks)->Apply(BufferSizesAndSampleRates);
+
+// The arguments are taken by the buffer size and the sample rate, so there
+// is one benchmark per keylock engine
+QString keylock(int decks, int engine) {
+    QString script = QString("set 0 [Master] keylock_engine %1\n")
+            .arg(QString::number(engine));
+    for (int i = 1; i <= decks; ++i) {
+        script += QString(
+                "set 0 [Channel%1] keylock 1\n"
+                "set 0 [Channel%1] rate 0.5\n").arg(QString::number(i));
+    }
+    return script;
+}
+
+static void BM_EngineMaster_FourDecksKeylockSoundTouch(benchmark::State& state) {
+    benchmarkEngineMaster(state, 4, keylock(4, 0));
+}
+BENCHMARK(BM_EngineMaster_FourDecksKeylockSoundTouch)
+        ->Apply(BufferSizesAndSampleRates);
+
+static void BM_EngineMaster_FourDecksKeylockRubberBand(benchmark::State& state) {
+    benchmarkEngineMaster(state, 4, keylock(4, 1));
+}
+BENCHMARK(BM_EngineMaster_FourDecksKeylockRubberBand)
+        ->Apply(BufferSizesAndSampleRates);
+
+// Deck 1 is the master, the others follow it with different file BPMs
+static void BM_EngineMaster_FourDecksSync(benchmark::State& state) {
+    benchmarkEngineMaster(state, 4,
+            "bpm 1 128\n"
+            "bpm 2 124\n"
+            "bpm 3 130\n"
+            "bpm 4 140\n"
+            "set 0 [Channel1] sync_master 1\n"
+            "set 0 [Channel2] sync_enabled 1\n"
+            "set 0 [Channel3] sync_enabled 1\n"
+            "set 0 [Channel4] sync_enabled 1\n");
+}
+BENCHMARK(BM_EngineMaster_FourDecksSync)->Apply(BufferSizesAndSampleRates);
+
+// A chain in each effect unit, enabled for one deck each
+static void BM_EngineMaster_FourDecksEffects(benchmark::State& state) {
+    QString script;
+    for (int i = 1; i <= 4; ++i) {
+        // Loads the first or the last of the default chains
+        script += QString(
+                "set 0 [EffectRack1_EffectUnit%1] %2 1\n"
+                "set 0 [EffectRack1_EffectUnit%1] mix 0.5\n"
+                "set 0 [EffectRack1_EffectUnit%1] group_[Channel%1]_enable 1\n")
+                .arg(QString::number(i), i % 2 ? "next_chain" : "prev_chain");
+    }
+    benchmarkEngineMaster(state, 4, script);
+}
+BENCHMARK(BM_EngineMaster_FourDecksEffects)->Apply(BufferSizesAndSampleRates);
+
+// Like a controller turning the EQ and quick effect knobs of all decks at
+// once, 16 parameter changes per callback. That is more than 1,000 changes
+// per second for buffers up to 512 frames, the p99 and max show the jitter
+// they cause.
+static void BM_EngineMaster_FourDecksParameterChanges(benchmark::State& state) {
+    QString script;
+    for (int i = 1; i <= 4; ++i) {
+        script += QString(
+                "ramp 0 3600 [Channel%1] filterLow 0 4\n"
+                "ramp 0 3600 [Channel%1] filterMid 4 0\n"
+                "ramp 0 3600 [Channel%1] filterHigh 0 4\n"
+                "ramp 0 3600 [QuickEffectRack1_[Channel%1]] super1 0 1\n")
+                .arg(QString::number(i));
+    }
+    benchmarkEngineMaster(state, 4, script);
+}
+BENCHMARK(BM_EngineMaster_FourDecksParameterChanges)
+        ->Apply(BufferSizesAndSampleRates);
+
+static void BM_EngineMaster_TwoDecksSixteenSamplers(benchmark::State& state) {
+    QString script = "samplers 16\n";
+    for (int i = 1; i <= 16; ++i) {
+        script += QString(
+                "sampler %1 %2\n"
+                "set 0 [Sampler%1] repeat 1\n"
+                "set 0 [Sampler%1] play 1\n").arg(QString::number(i), kTrackLocation);
+    }
+    benchmarkEngineMaster(state, 2, script);
+}
+BENCHMARK(BM_EngineMaster_TwoDecksSixteenSamplers)
+        ->Apply(BufferSizesAndSampleRates);
+
+}  // namespace
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QtSql>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+
+#include "library/dao/settingsdao.h"
+#include "library/externallibraryupdate.h"
+
+#include "test/librarytest.h"
+
+namespace {
+
+const QString kSettingsKey = "mixxx.test.externallibrary";
+
+const QStringList kColumns = QStringList()
+        << "location"
+        << "title"
+        << "bpm";
+
+class ExternalLibraryUpdateTest : public LibraryTest {
+  protected:
+    void SetUp() override {
+        QSqlQuery query(dbConnection());
+        ASSERT_TRUE(query.exec(
+                "CREATE TABLE IF NOT EXISTS test_library ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "location TEXT UNIQUE, title TEXT, bpm REAL)"));
+    }
+
+    void TearDown() override {
+        QSqlQuery query(dbConnection());
+        query.exec("DROP TABLE IF EXISTS test_library");
+    }
+
+    void writeFile(QTemporaryFile* pFile, const QByteArray& contents) {
+        ASSERT_TRUE(pFile->open());
+        pFile->resize(0);
+        pFile->write(contents);
+        pFile->close();
+    }
+
+    // Simulates that the file has been touched since it has been saved
+    void moveStoredModificationTime() {
+        SettingsDAO settings(dbConnection());
+        settings.setValue(kSettingsKey + ".modified", 0);
+    }
+
+    QVariantList row(const QString& location, const QString& title, double bpm) {
+        return QVariantList() << location << title << bpm;
+    }
+
+    // Maps the locations to the ids and titles of all rows
+    QMap<QString, QPair<int, QString>> selectRows() {
+        QMap<QString, QPair<int, QString>> rows;
+        QSqlQuery query(dbConnection());
+        if (query.exec("SELECT location, id, title FROM test_library")) {
+            while (query.next()) {
+                rows.insert(query.value(0).toString(), qMakePair(
+                        query.value(1).toInt(), query.value(2).toString()));
+            }
+        }
+        return rows;
+    }
+};
+
+TEST_F(ExternalLibraryUpdateTest, UnchangedFileIsSkipped) {
+    QTemporaryFile file;
+    writeFile(&file, "collection");
+
+    ExternalLibraryFileState firstImport(dbConnection(), kSettingsKey, file.fileName());
+    EXPECT_FALSE(firstImport.isUnchanged());
+    firstImport.save();
+
+    ExternalLibraryFileState secondImport(dbConnection(), kSettingsKey, file.fileName());
+    EXPECT_TRUE(secondImport.isUnchanged());
+}
+
+TEST_F(ExternalLibraryUpdateTest, ResizedFileIsImported) {
+    QTemporaryFile file;
+    writeFile(&file, "collection");
+    ExternalLibraryFileState(dbConnection(), kSettingsKey, file.fileName()).save();
+
+    writeFile(&file, "modified collection");
+    ExternalLibraryFileState state(dbConnection(), kSettingsKey, file.fileName());
+    EXPECT_FALSE(state.isUnchanged());
+}
+
+TEST_F(ExternalLibraryUpdateTest, TouchedFileIsComparedByHash) {
+    QTemporaryFile file;
+    writeFile(&file, "collection");
+    ExternalLibraryFileState(dbConnection(), kSettingsKey, file.fileName()).save();
+    // Not hashed while importing
+    EXPECT_TRUE(SettingsDAO(dbConnection()).getValue(kSettingsKey + ".hash").isEmpty());
+
+    // Without a stored hash a touched file is imported again, which
+    // stores the hash that has been calculated for the comparison
+    moveStoredModificationTime();
+    {
+        ExternalLibraryFileState state(dbConnection(), kSettingsKey, file.fileName());
+        EXPECT_FALSE(state.isUnchanged());
+        state.save();
+    }
+    EXPECT_FALSE(SettingsDAO(dbConnection()).getValue(kSettingsKey + ".hash").isEmpty());
+
+    // Same contents
+    moveStoredModificationTime();
+    {
+        ExternalLibraryFileState state(dbConnection(), kSettingsKey, file.fileName());
+        EXPECT_TRUE(state.isUnchanged());
+    }
+    // The new modification time has been stored, so the file is not
+    // hashed again
+    EXPECT_NE(0, SettingsDAO(dbConnection()).getValue(
+            kSettingsKey + ".modified").toLongLong());
+    EXPECT_FALSE(SettingsDAO(dbConnection()).getValue(kSettingsKey + ".hash").isEmpty());
+
+    // Same size, but different contents
+    writeFile(&file, "Collection");
+    moveStoredModificationTime();
+    {
+        ExternalLibraryFileState state(dbConnection(), kSettingsKey, file.fileName());
+        EXPECT_FALSE(state.isUnchanged());
+    }
+}
+
+TEST_F(ExternalLibraryUpdateTest, RowsAreDiffed) {
+    {
+        ExternalTrackTableUpdater updater(dbConnection(), "test_library", "location", kColumns);
+        EXPECT_TRUE(updater.applyRow(row("/a.mp3", "A", 120.5)));
+        EXPECT_TRUE(updater.applyRow(row("/b.mp3", "B", 121.0)));
+        EXPECT_TRUE(updater.applyRow(row("/c.mp3", "C", 122.0)));
+        // Duplicate entries are ignored
+        EXPECT_TRUE(updater.applyRow(row("/c.mp3", "C2", 122.0)));
+        EXPECT_TRUE(updater.removeUnappliedRows());
+        EXPECT_EQ(3, updater.appliedRows());
+        EXPECT_EQ(3, updater.insertedRows());
+        EXPECT_EQ(0, updater.updatedRows());
+        EXPECT_EQ(0, updater.removedRows());
+    }
+    const QMap<QString, QPair<int, QString>> oldRows = selectRows();
+    ASSERT_EQ(3, oldRows.size());
+    EXPECT_QSTRING_EQ("C", oldRows.value("/c.mp3").second);
+
+    {
+        ExternalTrackTableUpdater updater(dbConnection(), "test_library", "location", kColumns);
+        // Unchanged, including the value read back from a REAL column
+        EXPECT_TRUE(updater.applyRow(row("/a.mp3", "A", 120.5)));
+        // Modified
+        EXPECT_TRUE(updater.applyRow(row("/b.mp3", "B2", 121.0)));
+        // New, while /c.mp3 has been removed
+        EXPECT_TRUE(updater.applyRow(row("/d.mp3", "D", 123.0)));
+        EXPECT_TRUE(updater.removeUnappliedRows());
+        EXPECT_EQ(3, updater.appliedRows());
+        EXPECT_EQ(1, updater.insertedRows());
+        EXPECT_EQ(1, updater.updatedRows());
+        EXPECT_EQ(1, updater.removedRows());
+    }
+    const QMap<QString, QPair<int, QString>> newRows = selectRows();
+    ASSERT_EQ(3, newRows.size());
+    EXPECT_FALSE(newRows.contains("/c.mp3"));
+    // The ids of existing rows are preserved
+    EXPECT_EQ(oldRows.value("/a.mp3"), newRows.value("/a.mp3"));
+    EXPECT_EQ(oldRows.value("/b.mp3").first, newRows.value("/b.mp3").first);
+    EXPECT_QSTRING_EQ("B2", newRows.value("/b.mp3").second);
+    EXPECT_QSTRING_EQ("D", newRows.value("/d.mp3").second);
+}
+
+TEST_F(ExternalLibraryUpdateTest, PendingRowsAreInsertedOnDestruction) {
+    {
+        ExternalTrackTableUpdater updater(dbConnection(), "test_library", "location", kColumns);
+        EXPECT_TRUE(updater.applyRow(row("/a.mp3", "A", 120.0)));
+        // The file has not been parsed completely, i.e.
+        // removeUnappliedRows() is not invoked
+    }
+    EXPECT_EQ(1, selectRows().size());
+}
+
+}  // namespace
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <QList>
+
+#include "util/idbitmap.h"
+
+namespace {
+
+class IdBitmapTest : public testing::Test {
+  protected:
+    QList<IdBitmap::value_type> ids(const IdBitmap& bitmap) const {
+        QList<IdBitmap::value_type> result;
+        bitmap.forEach([&result](IdBitmap::value_type id) {
+            result.append(id);
+        });
+        return result;
+    }
+};
+
+TEST_F(IdBitmapTest, InsertRemove) {
+    IdBitmap bitmap;
+    EXPECT_TRUE(bitmap.isEmpty());
+
+    EXPECT_TRUE(bitmap.insert(70000));
+    EXPECT_TRUE(bitmap.insert(3));
+    EXPECT_TRUE(bitmap.insert(1));
+    EXPECT_FALSE(bitmap.insert(3));
+    EXPECT_EQ(3, bitmap.size());
+    EXPECT_TRUE(bitmap.contains(1));
+    EXPECT_FALSE(bitmap.contains(2));
+    EXPECT_TRUE(bitmap.contains(70000));
+    EXPECT_EQ(QList<IdBitmap::value_type>() << 1 << 3 << 70000, ids(bitmap));
+
+    EXPECT_TRUE(bitmap.remove(70000));
+    EXPECT_FALSE(bitmap.remove(70000));
+    EXPECT_FALSE(bitmap.remove(2));
+    EXPECT_EQ(2, bitmap.size());
+    EXPECT_EQ(QList<IdBitmap::value_type>() << 1 << 3, ids(bitmap));
+}
+
+TEST_F(IdBitmapTest, DenseChunk) {
+    // Exceed the maximum size of a sparse chunk
+    IdBitmap bitmap;
+    for (IdBitmap::value_type id = 0; id < 10000; id += 2) {
+        EXPECT_TRUE(bitmap.insert(id));
+    }
+    EXPECT_EQ(5000, bitmap.size());
+    for (IdBitmap::value_type id = 0; id < 10000; ++id) {
+        EXPECT_EQ((id % 2) == 0, bitmap.contains(id));
+    }
+    QList<IdBitmap::value_type> actualIds = ids(bitmap);
+    ASSERT_EQ(5000, actualIds.size());
+    for (int i = 0; i < actualIds.size(); ++i) {
+        EXPECT_EQ(static_cast<IdBitmap::value_type>(2 * i), actualIds[i]);
+    }
+
+    // Shrink below the limit of sparse chunks, the chunk stays dense
+    for (IdBitmap::value_type id = 0; id < 4000; id += 2) {
+        EXPECT_TRUE(bitmap.remove(id));
+    }
+    EXPECT_EQ(3000, bitmap.size());
+    EXPECT_FALSE(bitmap.contains(0));
+    EXPECT_TRUE(bitmap.contains(4000));
+    EXPECT_EQ(3000, ids(bitmap).size());
+
+    // Adding and removing an id near the limit
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(bitmap.insert(1));
+        EXPECT_TRUE(bitmap.remove(1));
+    }
+    EXPECT_EQ(3000, bitmap.size());
+
+    // Shrink until the chunk becomes sparse
+    for (IdBitmap::value_type id = 4000; id < 8000; id += 2) {
+        EXPECT_TRUE(bitmap.remove(id));
+    }
+    EXPECT_EQ(1000, bitmap.size());
+    EXPECT_FALSE(bitmap.contains(7998));
+    EXPECT_TRUE(bitmap.contains(8000));
+    QList<IdBitmap::value_type> remainingIds = ids(bitmap);
+    ASSERT_EQ(1000, remainingIds.size());
+    EXPECT_EQ(8000u, remainingIds.first());
+    EXPECT_EQ(9998u, remainingIds.last());
+}
+
+TEST_F(IdBitmapTest, Unite) {
+    IdBitmap lhs;
+    lhs.insert(1);
+    lhs.insert(100000);
+    IdBitmap rhs;
+    rhs.insert(2);
+    rhs.insert(100000);
+    lhs.unite(rhs);
+    EXPECT_EQ(QList<IdBitmap::value_type>() << 1 << 2 << 100000, ids(lhs));
+
+    lhs.clear();
+    EXPECT_TRUE(lhs.isEmpty());
+    EXPECT_FALSE(lhs.contains(1));
+}
+
+}  // namespace
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QDir>
+#include <QSqlQuery>
+#include <QVariant>
+
 #include "test/librarytest.h"
 
 #include "library/scanner/libraryscanner.h"
@@ -52,3 +56,83 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+TEST_F(LibraryScannerTest, ChangeJournal) {
+    LibraryHashDAO& libraryHashDao = collection()->getLibraryHashDAO();
+    EXPECT_TRUE(libraryHashDao.getJournaledDirectories().isEmpty());
+
+    libraryHashDao.journalDirectoryChanges(
+            QStringList() << "/music/a" << "/music/b", 1000);
+    libraryHashDao.journalDirectoryChanges(
+            QStringList() << "/music/b" << "/music/c", 2000);
+    QStringList journaledDirs = libraryHashDao.getJournaledDirectories();
+    journaledDirs.sort();
+    EXPECT_EQ(QStringList() << "/music/a" << "/music/b" << "/music/c",
+              journaledDirs);
+
+    // Only changes that have been recorded before the scan
+    // started are removed.
+    libraryHashDao.removeJournaledDirectories(1500);
+    journaledDirs = libraryHashDao.getJournaledDirectories();
+    journaledDirs.sort();
+    EXPECT_EQ(QStringList() << "/music/b" << "/music/c", journaledDirs);
+
+    libraryHashDao.removeJournaledDirectories(2000);
+    EXPECT_TRUE(libraryHashDao.getJournaledDirectories().isEmpty());
+}
+
+TEST_F(LibraryScannerTest, MovedDirectoryTree) {
+    const QString root = QDir::tempPath() + "/LibraryScannerTest";
+    const QString moved = root + "/moved";
+    const QString movedSub = moved + "/sub";
+    // Shares the prefix of the moved directory
+    const QString kept = root + "/moved_kept";
+    ASSERT_TRUE(QDir().mkpath(kept));
+    ASSERT_FALSE(QDir(moved).exists());
+
+    LibraryHashDAO& libraryHashDao = collection()->getLibraryHashDAO();
+    libraryHashDao.saveDirectoryHash(root, 1);
+    libraryHashDao.saveDirectoryHash(moved, 2);
+    libraryHashDao.saveDirectoryHash(movedSub, 3);
+    libraryHashDao.saveDirectoryHash(kept, 4);
+
+    // Only the parent has been reported as changed
+    EXPECT_EQ(QStringList() << moved,
+              LibraryScanner::getRemovedDirectories(
+                      QStringList() << root,
+                      libraryHashDao.getDirectoryHashes()));
+    EXPECT_EQ(QStringList() << moved,
+              LibraryScanner::getRemovedDirectories(
+                      QStringList() << moved,
+                      libraryHashDao.getDirectoryHashes()));
+
+    QSqlQuery query(dbConnection());
+    query.prepare("INSERT INTO track_locations "
+                  "(location, directory, needs_verification) "
+                  "VALUES (:location, :directory, 0)");
+    for (const auto& directory: QStringList() << moved << movedSub << kept) {
+        query.bindValue(":location", directory + "/track.mp3");
+        query.bindValue(":directory", directory);
+        ASSERT_TRUE(query.exec());
+    }
+
+    libraryHashDao.invalidateDirectoryTrees(QStringList() << moved);
+    collection()->getTrackDAO().invalidateTrackLocationsInDirectoryTrees(
+            QStringList() << moved);
+
+    libraryHashDao.markUnverifiedDirectoriesAsDeleted();
+    QStringList deletedDirs = libraryHashDao.getDeletedDirectories();
+    deletedDirs.sort();
+    EXPECT_EQ(QStringList() << moved << movedSub, deletedDirs);
+
+    ASSERT_TRUE(query.exec("SELECT directory FROM track_locations "
+                           "WHERE needs_verification=1 ORDER BY directory"));
+    QStringList unverifiedDirs;
+    while (query.next()) {
+        unverifiedDirs << query.value(0).toString();
+    }
+    EXPECT_EQ(QStringList() << moved << movedSub, unverifiedDirs);
+
+    QDir().rmdir(kept);
+    QDir().rmdir(root);
+}
@@ -1,6 +1,8 @@
 #ifndef LIBRARYTEST_H
 #define LIBRARYTEST_H
 
+#include <QHash>
+
 #include "test/mixxxtest.h"
 
 #include "database/mixxxdb.h"
@@ -12,7 +14,12 @@
 class LibraryTest : public MixxxTest {
   protected:
     LibraryTest()
-        : m_mixxxDb(config()),
+        : LibraryTest(QHash<QString, QString>()) {
+    }
+    // Overrides items of the [Database] config group before the
+    // database is opened, e.g. to compare different SQLite tunings.
+    explicit LibraryTest(const QHash<QString, QString>& dbSettings)
+        : m_mixxxDb(configureDatabase(config(), dbSettings)),
           m_dbConnectionPooler(m_mixxxDb.connectionPool()),
           m_dbConnection(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool())),
           m_trackCollection(config()) {
@@ -36,6 +43,15 @@ class LibraryTest : public MixxxTest {
     }
 
   private:
+    static UserSettingsPointer configureDatabase(
+            UserSettingsPointer pConfig,
+            const QHash<QString, QString>& dbSettings) {
+        for (auto it = dbSettings.constBegin(); it != dbSettings.constEnd(); ++it) {
+            pConfig->setValue(ConfigKey(MixxxDb::kConfigGroup, it.key()), it.value());
+        }
+        return pConfig;
+    }
+
     const MixxxDb m_mixxxDb;
     const mixxx::DbConnectionPooler m_dbConnectionPooler;
     QSqlDatabase m_dbConnection;
@@ -15,8 +15,12 @@
 #include "effects/native/phasereffect.h"
 #include "effects/native/reverbeffect.h"
 #include "engine/channelhandle.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
 #include "engine/effects/groupfeaturestate.h"
 #include "test/mixxxtest.h"
+#include "util/fifo.h"
+#include "util/memory.h"
 #include "util/samplebuffer.h"
 
 namespace {
@@ -78,4 +82,121 @@ DECLARE_EFFECT_BENCHMARK(MoogLadder4FilterEffect)
 DECLARE_EFFECT_BENCHMARK(PhaserEffect)
 DECLARE_EFFECT_BENCHMARK(ReverbEffect)
 
+template <class EffectType>
+EngineEffect* addEffectToChain(EngineEffectChain* pChain, int iIndex,
+        const QSet<ChannelHandleAndGroup>& registeredChannels,
+        EffectsResponsePipe* pResponsePipe) {
+    EngineEffect* pEffect = new EngineEffect(EffectType::getManifest(),
+            registeredChannels, EffectInstantiatorPointer(
+                    new EffectProcessorInstantiator<EffectType>()));
+
+    EffectsRequest enable;
+    enable.type = EffectsRequest::SET_EFFECT_PARAMETERS;
+    enable.SetEffectParameters.enabled = true;
+    pEffect->processEffectsRequest(enable, pResponsePipe);
+
+    EffectsRequest add;
+    add.type = EffectsRequest::ADD_EFFECT_TO_CHAIN;
+    add.AddEffectToChain.pEffect = pEffect;
+    add.AddEffectToChain.iIndex = iIndex;
+    pChain->processEffectsRequest(add, pResponsePipe);
+    return pEffect;
+}
+
+// Processes a chain of three effects for a channel like an effect unit, with
+// the buffer size and the mix in percent of the benchmark arguments. A mix of
+// 100% does not need the dry signal, so effects that process in place do not
+// need a copy of the channel buffer.
+template <class EffectType1, class EffectType2, class EffectType3>
+void benchmarkEffectChain(const unsigned int sampleRate,
+                          benchmark::State* pState) {
+    const unsigned int numSamples = pState->range_x();
+    const double mix = pState->range_y() / 100.0;
+
+    ControlPotmeter loEqFrequency(
+        ConfigKey("[Mixer Profile]", "LoEQFrequency"), 0., 22040);
+    loEqFrequency.setDefaultValue(250.0);
+    ControlPotmeter hiEqFrequency(
+        ConfigKey("[Mixer Profile]", "HiEQFrequency"), 0., 22040);
+    hiEqFrequency.setDefaultValue(2500.0);
+
+    ChannelHandleFactory factory;
+    QSet<ChannelHandleAndGroup> registeredChannels;
+    QString channel1_group = QString("[Channel1]");
+    ChannelHandle channel1 = factory.getOrCreateHandle(channel1_group);
+    registeredChannels.insert(ChannelHandleAndGroup(channel1, channel1_group));
+
+    // The responses are not read, the pipes just need to be large enough
+    QPair<EffectsRequestPipe*, EffectsResponsePipe*> pipes =
+            TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                    16, 16, false, false);
+    std::unique_ptr<EffectsRequestPipe> pRequestPipe(pipes.first);
+    std::unique_ptr<EffectsResponsePipe> pResponsePipe(pipes.second);
+
+    EngineEffectChain chain("benchmark");
+    std::unique_ptr<EngineEffect> pEffect1(addEffectToChain<EffectType1>(
+            &chain, 0, registeredChannels, pResponsePipe.get()));
+    std::unique_ptr<EngineEffect> pEffect2(addEffectToChain<EffectType2>(
+            &chain, 1, registeredChannels, pResponsePipe.get()));
+    std::unique_ptr<EngineEffect> pEffect3(addEffectToChain<EffectType3>(
+            &chain, 2, registeredChannels, pResponsePipe.get()));
+
+    EffectsRequest parameters;
+    parameters.type = EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS;
+    parameters.SetEffectChainParameters.enabled = true;
+    parameters.SetEffectChainParameters.insertion_type = EffectChain::INSERT;
+    parameters.SetEffectChainParameters.mix = mix;
+    chain.processEffectsRequest(parameters, pResponsePipe.get());
+
+    EffectsRequest enableForChannel;
+    enableForChannel.type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_CHANNEL;
+    enableForChannel.channel = channel1;
+    chain.processEffectsRequest(enableForChannel, pResponsePipe.get());
+
+    GroupFeatureState featureState;
+    SampleBuffer buffer(numSamples);
+    buffer.fill(0.5);
+
+    // Finish ramping in the effects and the mix
+    chain.process(channel1, buffer.data(), numSamples, sampleRate,
+            featureState);
+
+    while (pState->KeepRunning()) {
+        chain.process(channel1, buffer.data(), numSamples, sampleRate,
+                featureState);
+    }
+    pState->SetItemsProcessed(pState->iterations() * numSamples);
+}
+
+void BufferSizesAndMixes(benchmark::internal::Benchmark* b) {
+    for (const int mix : { 50, 100 }) {
+        for (int numSamples = 32; numSamples <= 4096; numSamples *= 2) {
+            b->ArgPair(numSamples, mix);
+        }
+    }
+}
+
+// All of them process in place
+static void BM_NativeEffects_Chain_FilterBitCrusherBessel8LVMixEQ(
+        benchmark::State& state) {
+    benchmarkEffectChain<FilterEffect, BitCrusherEffect, Bessel8LVMixEQEffect>(
+            44100, &state);
+}
+BENCHMARK(BM_NativeEffects_Chain_FilterBitCrusherBessel8LVMixEQ)
+        ->Apply(BufferSizesAndMixes);
+
+// None of them processes in place
+static void BM_NativeEffects_Chain_EchoFlangerReverb(benchmark::State& state) {
+    benchmarkEffectChain<EchoEffect, FlangerEffect, ReverbEffect>(
+            44100, &state);
+}
+BENCHMARK(BM_NativeEffects_Chain_EchoFlangerReverb)->Apply(BufferSizesAndMixes);
+
+// The filter processes in place, the others write to the chain buffers
+static void BM_NativeEffects_Chain_FilterEchoReverb(benchmark::State& state) {
+    benchmarkEffectChain<FilterEffect, EchoEffect, ReverbEffect>(
+            44100, &state);
+}
+BENCHMARK(BM_NativeEffects_Chain_FilterEchoReverb)->Apply(BufferSizesAndMixes);
+
 }  // namespace
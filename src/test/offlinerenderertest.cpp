@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QtDebug>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "encoder/encoder.h"
+#include "mixer/offlinerenderer.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+
+namespace {
+
+// Keeps the rendered samples
+class EncoderMock : public Encoder {
+  public:
+    int initEncoder(int samplerate, QString errorMessage) override {
+        Q_UNUSED(samplerate);
+        Q_UNUSED(errorMessage);
+        return 0;
+    }
+    void encodeBuffer(const CSAMPLE* samples, const int size) override {
+        m_samples.insert(m_samples.end(), samples, samples + size);
+    }
+    void updateMetaData(const QString& artist, const QString& title,
+                        const QString& album) override {
+        Q_UNUSED(artist);
+        Q_UNUSED(title);
+        Q_UNUSED(album);
+    }
+    void flush() override {
+    }
+    void setEncoderSettings(const EncoderSettings& settings) override {
+        Q_UNUSED(settings);
+    }
+
+    CSAMPLE peak(int begin, int end) const {
+        CSAMPLE peak = 0;
+        for (int i = begin; i < end; ++i) {
+            peak = math_max(peak, fabs(m_samples[i]));
+        }
+        return peak;
+    }
+
+    std::vector<CSAMPLE> m_samples;
+};
+
+class OfflineRendererTest : public MixxxTest {
+  protected:
+    OfflineRenderScript parse(const QString& script) {
+        OfflineRenderScript result;
+        QString error;
+        EXPECT_TRUE(result.parse(script, &error)) << error.toStdString();
+        return result;
+    }
+
+    bool parseFails(const QString& script) {
+        OfflineRenderScript result;
+        QString error;
+        const bool success = result.parse(script, &error);
+        EXPECT_FALSE(error.isEmpty() && !success);
+        return !success;
+    }
+
+    const QString m_trackLocation = QDir::currentPath() + "/src/test/sine-30.wav";
+};
+
+TEST_F(OfflineRendererTest, ParseScript) {
+    OfflineRenderScript script = parse(
+            "# A comment\n"
+            "samplerate 48000\n"
+            "buffer 256  # frames\n"
+            "decks 3\n"
+            "samplers 8\n"
+            "length 12.5\n"
+            "load 3 /path/with spaces/track.mp3\n"
+            "bpm 3 127.5\n"
+            "sampler 8 hit.wav\n"
+            "ramp 2 4 [Master] crossfader -1 1\n"
+            "set 1.5 [Channel1] play 1\n"
+            "\n"
+            "set 2 [Channel2] play 1\n");
+    EXPECT_EQ(48000, script.getSampleRate());
+    EXPECT_EQ(256, script.getBufferFrames());
+    EXPECT_EQ(3, script.getNumDecks());
+    EXPECT_DOUBLE_EQ(12.5, script.getLength());
+    ASSERT_EQ(1, script.getTracks().size());
+    EXPECT_EQ(QString("/path/with spaces/track.mp3"), script.getTracks()[2]);
+    EXPECT_DOUBLE_EQ(127.5, script.getTrackBpms()[2]);
+    EXPECT_EQ(8, script.getNumSamplers());
+    ASSERT_EQ(1, script.getSamplerTracks().size());
+    EXPECT_EQ(QString("hit.wav"), script.getSamplerTracks()[7]);
+
+    // Sorted by time, the ramp stays before the set at the same time
+    const QList<OfflineRenderCommand>& commands = script.getCommands();
+    ASSERT_EQ(3, commands.size());
+    EXPECT_EQ(ConfigKey("[Channel1]", "play"), commands[0].key);
+    EXPECT_DOUBLE_EQ(1.5, commands[0].endTime);
+    EXPECT_EQ(ConfigKey("[Master]", "crossfader"), commands[1].key);
+    EXPECT_DOUBLE_EQ(4.0, commands[1].endTime);
+    EXPECT_DOUBLE_EQ(-1.0, commands[1].startValue);
+    EXPECT_DOUBLE_EQ(1.0, commands[1].endValue);
+    EXPECT_EQ(ConfigKey("[Channel2]", "play"), commands[2].key);
+}
+
+TEST_F(OfflineRendererTest, ParseErrors) {
+    EXPECT_TRUE(parseFails("samplerate 44100\n"));
+    EXPECT_TRUE(parseFails("length 10\nbuffer 1000000\n"));
+    EXPECT_TRUE(parseFails("length 10\nload 3 track.mp3\n"));
+    EXPECT_TRUE(parseFails("length 10\nsampler 1 hit.wav\n"));
+    EXPECT_TRUE(parseFails("length 10\nbpm 1 128\n"));
+    EXPECT_TRUE(parseFails("length 10\nload 1 track.mp3\nbpm 1 0\n"));
+    EXPECT_TRUE(parseFails("length 10\nset 1 [Channel1] play\n"));
+    EXPECT_TRUE(parseFails("length 10\nramp 4 2 [Master] crossfader 0 1\n"));
+    EXPECT_TRUE(parseFails("length 10\nplay 1\n"));
+}
+
+TEST_F(OfflineRendererTest, RenderTimeline) {
+    OfflineRenderScript script = parse(QString(
+            "length 1\n"
+            "load 1 %1\n"
+            "set 0.5 [Channel1] play 1\n"
+            "ramp 0 2 [Master] crossfader -1 1\n").arg(m_trackLocation));
+    OfflineRenderer renderer(config(), script);
+    EncoderMock encoder;
+    QString error;
+    ASSERT_TRUE(renderer.render(&encoder, &error)) << error.toStdString();
+
+    EXPECT_EQ(44100, renderer.getFramesRendered());
+    ASSERT_EQ(2 * 44100u, encoder.m_samples.size());
+    EXPECT_GT(renderer.getRealtimeFactor(), 0.0);
+
+    // Silent until the deck starts playing
+    EXPECT_EQ(0.0f, encoder.peak(0, 2 * 22016));
+    EXPECT_GT(encoder.peak(2 * 23040, 2 * 44100), 0.1f);
+
+    // The ramp has been interpolated up to the start of the last buffer
+    EXPECT_NEAR(0.0, ControlObject::get(ConfigKey("[Master]", "crossfader")),
+            2.0 * 1024 / 44100);
+}
+
+TEST_F(OfflineRendererTest, RenderEqCommands) {
+    const QString script = QString(
+            "length 1\n"
+            "load 1 %1\n"
+            "set 0 [Channel1] play 1\n").arg(m_trackLocation);
+    // Kills all bands of the default EQ of the deck
+    const QString killScript = script +
+            "set 0 [EqualizerRack1_[Channel1]_Effect1] button_parameter1 1\n"
+            "set 0 [EqualizerRack1_[Channel1]_Effect1] button_parameter2 1\n"
+            "set 0 [EqualizerRack1_[Channel1]_Effect1] button_parameter3 1\n";
+
+    CSAMPLE peak = 0;
+    CSAMPLE killedPeak = 0;
+    {
+        OfflineRenderer renderer(config(), parse(script));
+        EncoderMock encoder;
+        QString error;
+        ASSERT_TRUE(renderer.render(&encoder, &error)) << error.toStdString();
+        peak = encoder.peak(2 * 22050, 2 * 44100);
+    }
+    {
+        OfflineRenderer renderer(config(), parse(killScript));
+        EncoderMock encoder;
+        QString error;
+        ASSERT_TRUE(renderer.render(&encoder, &error)) << error.toStdString();
+        killedPeak = encoder.peak(2 * 22050, 2 * 44100);
+    }
+    EXPECT_GT(peak, 0.1f);
+    EXPECT_LT(killedPeak, peak / 2);
+}
+
+TEST_F(OfflineRendererTest, RenderFailsForUnknownControl) {
+    OfflineRenderScript script = parse(
+            "length 1\n"
+            "set 0 [Channel1] no_such_control 1\n");
+    OfflineRenderer renderer(config(), script);
+    QString error;
+    EXPECT_FALSE(renderer.render(nullptr, &error));
+    EXPECT_FALSE(error.isEmpty());
+}
+
+}  // namespace
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+
+#include "library/dao/playlistdao.h"
+
+#include "test/librarytest.h"
+
+namespace {
+
+class PlaylistDAOTest : public LibraryTest {
+  protected:
+    void SetUp() override {
+        m_playlistId = playlistDao().createPlaylist("Test");
+        ASSERT_NE(-1, m_playlistId);
+        QList<TrackId> trackIds;
+        for (int i = 1; i <= 10; ++i) {
+            trackIds.append(TrackId(i));
+        }
+        ASSERT_TRUE(playlistDao().appendTracksToPlaylist(trackIds, m_playlistId));
+    }
+
+    PlaylistDAO& playlistDao() {
+        return collection()->getPlaylistDAO();
+    }
+
+    // The track ids ordered by position. Fails if the positions are
+    // not contiguous starting at 1.
+    QList<int> trackIdsByPosition() {
+        QList<int> trackIds;
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT track_id, position FROM PlaylistTracks "
+                      "WHERE playlist_id=:id ORDER BY position");
+        query.bindValue(":id", m_playlistId);
+        EXPECT_TRUE(query.exec());
+        while (query.next()) {
+            EXPECT_EQ(trackIds.size() + 1, query.value(1).toInt());
+            trackIds.append(query.value(0).toInt());
+        }
+        return trackIds;
+    }
+
+    int m_playlistId;
+};
+
+TEST_F(PlaylistDAOTest, removeTracksKeepsPositionsContiguous) {
+    QList<int> positions;
+    positions << 2 << 9 << 5 << 6;
+    playlistDao().removeTracksFromPlaylist(m_playlistId, positions);
+    EXPECT_EQ(QList<int>() << 1 << 3 << 4 << 7 << 8 << 10,
+              trackIdsByPosition());
+
+    playlistDao().removeTrackFromPlaylist(m_playlistId, 1);
+    EXPECT_EQ(QList<int>() << 3 << 4 << 7 << 8 << 10,
+              trackIdsByPosition());
+
+    playlistDao().removeTrackFromPlaylist(m_playlistId, TrackId(10));
+    EXPECT_EQ(QList<int>() << 3 << 4 << 7 << 8,
+              trackIdsByPosition());
+}
+
+TEST_F(PlaylistDAOTest, insertTracks) {
+    QList<TrackId> trackIds;
+    trackIds << TrackId(11) << TrackId() << TrackId(12);
+    EXPECT_EQ(2, playlistDao().insertTracksIntoPlaylist(
+            trackIds, m_playlistId, 3));
+    EXPECT_EQ(QList<int>() << 1 << 2 << 11 << 12 << 3 << 4 << 5
+                           << 6 << 7 << 8 << 9 << 10,
+              trackIdsByPosition());
+}
+
+TEST_F(PlaylistDAOTest, moveTrack) {
+    playlistDao().moveTrack(m_playlistId, 2, 8);
+    EXPECT_EQ(QList<int>() << 1 << 3 << 4 << 5 << 6 << 7 << 8 << 2 << 9 << 10,
+              trackIdsByPosition());
+    playlistDao().moveTrack(m_playlistId, 8, 2);
+    EXPECT_EQ(QList<int>() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10,
+              trackIdsByPosition());
+    playlistDao().moveTrack(m_playlistId, 5, 5);
+    EXPECT_EQ(QList<int>() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10,
+              trackIdsByPosition());
+}
+
+TEST_F(PlaylistDAOTest, shuffleTracksIsPermutation) {
+    QList<int> positions;
+    QHash<int,TrackId> allIds;
+    for (int i = 1; i <= 10; ++i) {
+        allIds.insert(i, TrackId(i));
+        if (i > 3) {
+            positions << i;
+        }
+    }
+    playlistDao().shuffleTracks(m_playlistId, positions, allIds);
+    QList<int> trackIds = trackIdsByPosition();
+    ASSERT_EQ(10, trackIds.size());
+    // Tracks outside of the shuffled range are not moved
+    EXPECT_EQ(QList<int>() << 1 << 2 << 3, trackIds.mid(0, 3));
+    qSort(trackIds);
+    EXPECT_EQ(QList<int>() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10,
+              trackIds);
+}
+
+}  // namespace
@@ -341,6 +341,44 @@ TEST_F(SampleUtilTest, sumAbsPerChannel) {
     }
 }
 
+TEST_F(SampleUtilTest, measureLevels) {
+    for (int i = 0; i < evenBuffers.size(); ++i) {
+        int j = evenBuffers[i];
+        CSAMPLE* buffer = buffers[j];
+        int size = sizes[j];
+        FillBuffer(buffer, -0.5f, size);
+        SampleUtil::applyAlternatingGain(buffer, 1.0, 2.0, size);
+        buffer[size - 1] = 1.5f;
+        SampleUtil::Levels levels;
+        SampleUtil::CLIP_STATUS clipping =
+                SampleUtil::measureLevels(&levels, buffer, size);
+        EXPECT_EQ(SampleUtil::CLIP_STATUS(SampleUtil::CLIPPING_RIGHT), clipping);
+        EXPECT_FLOAT_EQ(size / 4.0f, levels.sumAbsL);
+        EXPECT_FLOAT_EQ(size / 2.0f - 1 + 1.5f, levels.sumAbsR);
+        EXPECT_FLOAT_EQ(0.5f, levels.peakL);
+        EXPECT_FLOAT_EQ(1.5f, levels.peakR);
+        // Only the last frame has a positive mid signal
+        EXPECT_FLOAT_EQ(0.5f, levels.peakMid);
+    }
+}
+
+TEST_F(SampleUtilTest, isSilent) {
+    for (int i = 0; i < buffers.size(); ++i) {
+        CSAMPLE* buffer = buffers[i];
+        int size = sizes[i];
+        EXPECT_TRUE(SampleUtil::isSilent(buffer, size));
+        // Below -120 dBFS
+        FillBuffer(buffer, -0.0000009f, size);
+        EXPECT_TRUE(SampleUtil::isSilent(buffer, size));
+        // Audible in the first block and in the remainder
+        buffer[0] = 0.001f;
+        EXPECT_FALSE(SampleUtil::isSilent(buffer, size));
+        buffer[0] = 0;
+        buffer[size - 1] = -0.001f;
+        EXPECT_FALSE(SampleUtil::isSilent(buffer, size));
+    }
+}
+
 TEST_F(SampleUtilTest, interleaveBuffer) {
     for (int i = 0; i < buffers.size(); ++i) {
         CSAMPLE* buffer = buffers[i];
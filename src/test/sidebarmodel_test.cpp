@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <QUrl>
+
+#include "library/libraryfeature.h"
+#include "library/sidebarmodel.h"
+#include "library/treeitemmodel.h"
+
+#include "test/mixxxtest.h"
+
+namespace {
+
+// Records whether it has been initialized before it is used
+class LazyFeature : public LibraryFeature {
+  public:
+    LazyFeature()
+            : m_initializeCount(0),
+              m_initializedWhenUsed(false) {
+    }
+
+    QVariant title() override {
+        return "Lazy";
+    }
+    QIcon getIcon() override {
+        return QIcon();
+    }
+    TreeItemModel* getChildModel() override {
+        return &m_childModel;
+    }
+
+    bool dragMoveAccept(QUrl url) override {
+        Q_UNUSED(url);
+        m_initializedWhenUsed = isInitialized();
+        return true;
+    }
+
+    void activate() override {
+        m_initializedWhenUsed = isInitialized();
+    }
+
+    int m_initializeCount;
+    bool m_initializedWhenUsed;
+
+  protected:
+    void initialize() override {
+        ++m_initializeCount;
+    }
+
+  private:
+    TreeItemModel m_childModel;
+};
+
+class SidebarModelTest : public MixxxTest {
+  protected:
+    SidebarModelTest() {
+        m_model.addLibraryFeature(&m_feature1);
+        m_model.addLibraryFeature(&m_feature2);
+    }
+
+    LazyFeature m_feature1;
+    LazyFeature m_feature2;
+    SidebarModel m_model;
+};
+
+TEST_F(SidebarModelTest, FeaturesAreInitializedOnFirstUse) {
+    // Showing the sidebar does not initialize the features
+    EXPECT_EQ(2, m_model.rowCount());
+    EXPECT_QSTRING_EQ("Lazy", m_model.data(m_model.index(0, 0)).toString());
+    EXPECT_FALSE(m_feature1.isInitialized());
+    EXPECT_FALSE(m_feature2.isInitialized());
+
+    // Dragging over a feature uses it
+    EXPECT_TRUE(m_model.dragMoveAccept(m_model.index(0, 0),
+            QUrl::fromLocalFile("/music/track.mp3")));
+    EXPECT_TRUE(m_feature1.m_initializedWhenUsed);
+    EXPECT_EQ(1, m_feature1.m_initializeCount);
+    EXPECT_FALSE(m_feature2.isInitialized());
+
+    // Only initialized once
+    m_feature1.m_initializedWhenUsed = false;
+    m_model.clicked(m_model.index(0, 0));
+    EXPECT_TRUE(m_feature1.m_initializedWhenUsed);
+    EXPECT_EQ(1, m_feature1.m_initializeCount);
+
+    m_model.clicked(m_model.index(1, 0));
+    EXPECT_TRUE(m_feature2.m_initializedWhenUsed);
+    EXPECT_EQ(1, m_feature2.m_initializeCount);
+}
+
+}  // namespace
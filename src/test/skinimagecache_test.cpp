@@ -0,0 +1,79 @@
+#include <QDir>
+#include <QImage>
+
+#include "test/mixxxtest.h"
+#include "skin/imgloader.h"
+#include "skin/skinimagecache.h"
+
+namespace {
+
+class SkinImageCacheTest : public MixxxTest {
+  protected:
+    SkinImageCacheTest()
+            : m_testDir(QDir::temp().filePath("SkinImageCacheTest")),
+              m_pLoader(new ImgLoader()) {
+        QDir().mkpath(m_testDir.path());
+        m_image = QImage(16, 8, QImage::Format_ARGB32);
+        m_image.fill(0xFF336699);
+        m_image.save(imagePath(), "PNG");
+    }
+
+    ~SkinImageCacheTest() override {
+        SkinImageCache::clear();
+        QDir cacheDir(cacheDirPath());
+        foreach (const QString& fileName, cacheDir.entryList(QDir::Files)) {
+            cacheDir.remove(fileName);
+        }
+        m_testDir.rmdir("cache");
+        m_testDir.remove("image.png");
+        QDir::temp().rmdir("SkinImageCacheTest");
+    }
+
+    QString imagePath() const {
+        return m_testDir.filePath("image.png");
+    }
+
+    QString cacheDirPath() const {
+        return m_testDir.filePath("cache");
+    }
+
+    QDir m_testDir;
+    QSharedPointer<ImgSource> m_pLoader;
+    QImage m_image;
+};
+
+TEST_F(SkinImageCacheTest, Prefetch) {
+    EXPECT_TRUE(SkinImageCache::image(imagePath(), 1.0).isNull());
+
+    SkinImageCache::prefetch(QStringList() << imagePath() << imagePath(),
+            1.0, m_pLoader, QString(), cacheDirPath());
+    const QImage image = SkinImageCache::image(imagePath(), 1.0);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(m_image.size(), image.size());
+    EXPECT_EQ(m_image.pixel(0, 0), image.pixel(0, 0));
+    // Only prefetched for the requested scale factor
+    EXPECT_TRUE(SkinImageCache::image(imagePath(), 2.0).isNull());
+    EXPECT_EQ(1, QDir(cacheDirPath()).entryList(QDir::Files).size());
+}
+
+TEST_F(SkinImageCacheTest, ReadFromCacheDirectory) {
+    SkinImageCache::prefetch(QStringList() << imagePath(),
+            1.0, m_pLoader, QString(), cacheDirPath());
+    const QImage image = SkinImageCache::image(imagePath(), 1.0);
+    SkinImageCache::clear();
+    EXPECT_TRUE(SkinImageCache::image(imagePath(), 1.0).isNull());
+
+    // Read back from the raster file
+    SkinImageCache::prefetch(QStringList() << imagePath(),
+            1.0, m_pLoader, QString(), cacheDirPath());
+    EXPECT_EQ(image, SkinImageCache::image(imagePath(), 1.0));
+
+    // A different color scheme uses a different cache file and the
+    // cache file of the previous color scheme is deleted
+    SkinImageCache::clear();
+    SkinImageCache::prefetch(QStringList() << imagePath(),
+            1.0, m_pLoader, "<Filters><Invert/></Filters>", cacheDirPath());
+    EXPECT_EQ(1, QDir(cacheDirPath()).entryList(QDir::Files).size());
+}
+
+}  // namespace
@@ -0,0 +1,221 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QtSql>
+#include <QString>
+#include <QStringBuilder>
+#include <QDir>
+#include <QFileInfo>
+
+#include "sources/soundsourceproxy.h"
+#include "library/dao/trackdao.h"
+
+#include "test/librarytest.h"
+
+namespace {
+
+// The columns of the library table that are filled from the
+// track when it is added
+const QString kLibraryColumns =
+        "artist,title,album,album_artist,year,genre,composer,grouping,"
+        "tracknumber,tracktotal,filetype,comment,url,duration,rating,"
+        "bitrate,samplerate,cuepoint,bpm_lock,replaygain,replaygain_peak,"
+        "channels,header_parsed,timesplayed,played,"
+        "coverart_source,coverart_type,coverart_location,coverart_hash,"
+        "bpm,beats_version,beats_sub_version,beats,"
+        "keys,keys_version,keys_sub_version,key,key_id,mixxx_deleted";
+
+class TrackDAOTest : public LibraryTest {
+  protected:
+    void SetUp() override {
+        m_supportedFileExt = "." % SoundSourceProxy::getSupportedFileExtensions().first();
+    }
+
+    void TearDown() override {
+        // make sure we clean up the db
+        QSqlQuery query(dbConnection());
+        query.prepare("DELETE FROM library");
+        query.exec();
+        query.prepare("DELETE FROM track_locations");
+        query.exec();
+    }
+
+    QString trackLocation(const QString& fileName) const {
+        return QDir::tempPath() + "/TestDir/" + fileName + m_supportedFileExt;
+    }
+
+    TrackPointer newTrack(const QString& fileName) const {
+        TrackPointer pTrack(Track::newTemporary(trackLocation(fileName)));
+        pTrack->setArtist("Artist");
+        pTrack->setTitle(fileName);
+        pTrack->setURL("http://www.mixxx.org");
+        pTrack->setRating(4);
+        pTrack->setCuePoint(4711.0);
+        pTrack->setBpm(128.0);
+        CoverInfoRelative coverInfo;
+        coverInfo.source = CoverInfo::USER_SELECTED;
+        coverInfo.type = CoverInfo::FILE;
+        coverInfo.coverLocation = "cover.jpg";
+        coverInfo.hash = 4711;
+        pTrack->setCoverInfo(coverInfo);
+        return pTrack;
+    }
+
+    QVariantList selectLibraryRow(TrackId trackId) const {
+        QVariantList values;
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT " + kLibraryColumns + " FROM library WHERE id=:id");
+        query.bindValue(":id", trackId.toVariant());
+        if (query.exec() && query.next()) {
+            for (int i = 0; i < query.record().count(); ++i) {
+                values << query.value(i);
+            }
+        }
+        return values;
+    }
+
+    QString m_supportedFileExt;
+};
+
+TEST_F(TrackDAOTest, addTracksBulk) {
+    TrackDAO &trackDAO = collection()->getTrackDAO();
+
+    trackDAO.addTracksPrepare();
+    TrackId existingId = trackDAO.addTracksAddTrack(newTrack("b"), false);
+    trackDAO.addTracksFinish(false);
+    ASSERT_TRUE(existingId.isValid());
+
+    QList<TrackPointer> tracks;
+    for (const QString& fileName : QStringList() << "c" << "a" << "b" << "a") {
+        tracks.append(newTrack(fileName));
+    }
+    QList<TrackId> ids = trackDAO.addTracksBulk(tracks, false);
+    ASSERT_EQ(4, ids.size());
+    for (int i = 0; i < ids.size(); ++i) {
+        EXPECT_TRUE(ids[i].isValid());
+        EXPECT_EQ(ids[i], tracks[i]->getId());
+    }
+    // Duplicate and existing tracks are not inserted again
+    EXPECT_EQ(ids[1], ids[3]);
+    EXPECT_EQ(existingId, ids[2]);
+    // Only the inserted tracks are clean
+    EXPECT_FALSE(tracks[0]->isDirty());
+    EXPECT_FALSE(tracks[1]->isDirty());
+    EXPECT_TRUE(tracks[2]->isDirty());
+    EXPECT_TRUE(tracks[3]->isDirty());
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM library"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(3, query.value(0).toInt());
+    ASSERT_TRUE(query.exec("SELECT COUNT(*) FROM track_locations"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(3, query.value(0).toInt());
+
+    TrackPointer pTrack = trackDAO.getTrack(ids[0], false);
+    ASSERT_FALSE(pTrack.isNull());
+    EXPECT_QSTRING_EQ("c", pTrack->getTitle());
+}
+
+TEST_F(TrackDAOTest, addTracksBulkFillsAllColumns) {
+    TrackDAO &trackDAO = collection()->getTrackDAO();
+
+    // Both tracks only differ by their title
+    trackDAO.addTracksPrepare();
+    const TrackPointer pSingleTrack = newTrack("single");
+    pSingleTrack->setTitle("Title");
+    const TrackId singleId = trackDAO.addTracksAddTrack(pSingleTrack, false);
+    trackDAO.addTracksFinish(false);
+    ASSERT_TRUE(singleId.isValid());
+
+    const TrackPointer pBulkTrack = newTrack("bulk");
+    pBulkTrack->setTitle("Title");
+    const QList<TrackId> bulkIds = trackDAO.addTracksBulk(
+            QList<TrackPointer>() << pBulkTrack, false);
+    ASSERT_EQ(1, bulkIds.size());
+    ASSERT_TRUE(bulkIds[0].isValid());
+
+    const QVariantList singleRow = selectLibraryRow(singleId);
+    const QVariantList bulkRow = selectLibraryRow(bulkIds[0]);
+    ASSERT_FALSE(singleRow.isEmpty());
+    ASSERT_EQ(singleRow.size(), bulkRow.size());
+    for (int i = 0; i < singleRow.size(); ++i) {
+        EXPECT_EQ(singleRow[i], bulkRow[i]) << i;
+    }
+
+    TrackPointer pTrack = trackDAO.getTrack(bulkIds[0], false);
+    ASSERT_FALSE(pTrack.isNull());
+    EXPECT_QSTRING_EQ("http://www.mixxx.org", pTrack->getURL());
+    EXPECT_EQ(4, pTrack->getRating());
+    EXPECT_FLOAT_EQ(4711.0, pTrack->getCuePoint());
+    EXPECT_FLOAT_EQ(128.0, pTrack->getBpm());
+    EXPECT_QSTRING_EQ("cover.jpg", pTrack->getCoverInfo().coverLocation);
+}
+
+const int kNumBenchmarkTracks = 100000;
+
+// Provides a fresh database for each iteration of a benchmark
+class TrackDAOBenchmark : public LibraryTest {
+  public:
+    QList<TrackPointer> newTracks(int count) const {
+        QList<TrackPointer> tracks;
+        tracks.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            TrackPointer pTrack(Track::newTemporary(QString(
+                    "/music/artist %1/track %2.mp3").arg(
+                            QString::number(i / 100), QString::number(i))));
+            pTrack->setArtist(QString("Artist %1").arg(i / 100));
+            pTrack->setTitle(QString("Title %1").arg(i));
+            pTrack->setAlbum(QString("Album %1").arg(i / 10));
+            tracks.append(pTrack);
+        }
+        return tracks;
+    }
+
+    using LibraryTest::collection;
+
+  private:
+    void TestBody() override {
+    }
+};
+
+static void BM_TrackDAO_AddTracksSingleRow(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        {
+            TrackDAOBenchmark library;
+            TrackDAO& trackDAO = library.collection()->getTrackDAO();
+            const QList<TrackPointer> tracks = library.newTracks(kNumBenchmarkTracks);
+            state.ResumeTiming();
+            trackDAO.addTracksPrepare();
+            for (const auto& pTrack: tracks) {
+                trackDAO.addTracksAddTrack(pTrack, false);
+            }
+            trackDAO.addTracksFinish(false);
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * kNumBenchmarkTracks);
+}
+BENCHMARK(BM_TrackDAO_AddTracksSingleRow);
+
+static void BM_TrackDAO_AddTracksBulk(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        {
+            TrackDAOBenchmark library;
+            TrackDAO& trackDAO = library.collection()->getTrackDAO();
+            const QList<TrackPointer> tracks = library.newTracks(kNumBenchmarkTracks);
+            state.ResumeTiming();
+            trackDAO.addTracksBulk(tracks, false);
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * kNumBenchmarkTracks);
+}
+BENCHMARK(BM_TrackDAO_AddTracksBulk);
+
+}  // namespace
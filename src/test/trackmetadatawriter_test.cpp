@@ -0,0 +1,168 @@
+#include <QDir>
+#include <QMutexLocker>
+#include <QSet>
+
+#include "test/mixxxtest.h"
+#include "library/trackmetadatawriter.h"
+
+namespace {
+
+const int kTimeoutMillis = 5000;
+
+// Records writes instead of modifying any files
+class TestTrackMetadataWriter : public TrackMetadataWriter {
+  public:
+    explicit TestTrackMetadataWriter(const QString& journalFilePath)
+            : TrackMetadataWriter(journalFilePath) {
+    }
+    ~TestTrackMetadataWriter() override {
+        // Don't call the overridden functions after destruction
+        stop();
+        wait();
+    }
+
+    // Must be called before starting the thread
+    void setFileInUse(const QString& location) {
+        m_filesInUse.insert(location);
+    }
+
+    QList<QPair<QString, QString>> writtenTitles() const {
+        QMutexLocker locker(&m_writtenMutex);
+        return m_writtenTitles;
+    }
+
+    bool waitForWrites(int count) const {
+        for (int i = 0; i < kTimeoutMillis / 10; ++i) {
+            if (writtenTitles().size() >= count) {
+                return true;
+            }
+            QThread::msleep(10);
+        }
+        return false;
+    }
+
+  protected:
+    bool isPlaybackActive() const override {
+        return false;
+    }
+    bool isFileInUse(const QString& location) const override {
+        return m_filesInUse.contains(location);
+    }
+    bool writeTrackMetadata(const QString& location,
+            const mixxx::TrackMetadata& trackMetadata,
+            const SecurityTokenPointer& /*pSecurityToken*/) override {
+        QMutexLocker locker(&m_writtenMutex);
+        m_writtenTitles.append(qMakePair(location, trackMetadata.getTitle()));
+        return true;
+    }
+
+  private:
+    QSet<QString> m_filesInUse;
+    mutable QMutex m_writtenMutex;
+    QList<QPair<QString, QString>> m_writtenTitles;
+};
+
+class TrackMetadataWriterTest : public MixxxTest {
+  protected:
+    TrackMetadataWriterTest()
+            : m_journalFilePath(QDir::temp().filePath(
+                      "TrackMetadataWriterTest.journal")) {
+        QFile::remove(m_journalFilePath);
+    }
+
+    ~TrackMetadataWriterTest() override {
+        QFile::remove(m_journalFilePath);
+    }
+
+    static TrackPointer newTrack(const QString& location, const QString& title,
+            bool parsedFromFile = true) {
+        TrackPointer pTrack = Track::newTemporary(QFileInfo(location));
+        mixxx::TrackMetadata trackMetadata;
+        trackMetadata.setTitle(title);
+        pTrack->setTrackMetadata(trackMetadata, parsedFromFile);
+        return pTrack;
+    }
+
+    QStringList journalLines() const {
+        QFile journal(m_journalFilePath);
+        if (!journal.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            return QStringList();
+        }
+        return QString::fromUtf8(journal.readAll()).split('\n',
+                QString::SkipEmptyParts);
+    }
+
+    const QString m_journalFilePath;
+};
+
+TEST_F(TrackMetadataWriterTest, CoalesceEdits) {
+    TestTrackMetadataWriter writer(m_journalFilePath);
+    writer.enqueue(*newTrack("/music/a.mp3", "A1"));
+    writer.enqueue(*newTrack("/music/b.mp3", "B1"));
+    writer.enqueue(*newTrack("/music/a.mp3", "A2"));
+    EXPECT_EQ(2, writer.pendingCount());
+
+    writer.start();
+    ASSERT_TRUE(writer.waitForWrites(2));
+    const auto writtenTitles = writer.writtenTitles();
+    EXPECT_EQ(2, writtenTitles.size());
+    EXPECT_QSTRING_EQ("/music/a.mp3", writtenTitles[0].first);
+    EXPECT_QSTRING_EQ("A2", writtenTitles[0].second);
+    EXPECT_QSTRING_EQ("/music/b.mp3", writtenTitles[1].first);
+    EXPECT_QSTRING_EQ("B1", writtenTitles[1].second);
+}
+
+TEST_F(TrackMetadataWriterTest, SkipUnparsedMetadata) {
+    TestTrackMetadataWriter writer(m_journalFilePath);
+    writer.enqueue(*newTrack("/music/a.mp3", "A", false));
+    EXPECT_EQ(0, writer.pendingCount());
+}
+
+TEST_F(TrackMetadataWriterTest, DeferFilesInUse) {
+    TestTrackMetadataWriter writer(m_journalFilePath);
+    writer.setFileInUse("/music/a.mp3");
+    writer.enqueue(*newTrack("/music/a.mp3", "A"));
+    writer.enqueue(*newTrack("/music/b.mp3", "B"));
+
+    writer.start();
+    ASSERT_TRUE(writer.waitForWrites(1));
+    writer.stop();
+    writer.wait();
+    const auto writtenTitles = writer.writtenTitles();
+    EXPECT_EQ(1, writtenTitles.size());
+    EXPECT_QSTRING_EQ("/music/b.mp3", writtenTitles[0].first);
+    EXPECT_EQ(1, writer.pendingCount());
+}
+
+TEST_F(TrackMetadataWriterTest, RecoverFromJournal) {
+    {
+        TestTrackMetadataWriter writer(m_journalFilePath);
+        EXPECT_TRUE(writer.recoveredLocations().isEmpty());
+        writer.enqueue(*newTrack("/music/a.mp3", "A1"));
+        writer.enqueue(*newTrack("/music/b.mp3", "B"));
+        writer.enqueue(*newTrack("/music/a.mp3", "A2"));
+        // Quit without writing
+    }
+
+    TestTrackMetadataWriter writer(m_journalFilePath);
+    const QStringList recoveredLocations = writer.recoveredLocations();
+    ASSERT_EQ(2, recoveredLocations.size());
+    EXPECT_QSTRING_EQ("/music/a.mp3", recoveredLocations[0]);
+    EXPECT_QSTRING_EQ("/music/b.mp3", recoveredLocations[1]);
+    // Only the locations that are queued again are journaled again
+    EXPECT_TRUE(journalLines().isEmpty());
+    writer.enqueue(*newTrack("/music/a.mp3", "A2"));
+    writer.enqueue(*newTrack("/music/b.mp3", "B"));
+    EXPECT_EQ(QStringList() << "/music/a.mp3" << "/music/b.mp3",
+              journalLines());
+
+    // The journal is cleared after all files have been written
+    writer.start();
+    ASSERT_TRUE(writer.waitForWrites(2));
+    writer.stop();
+    writer.wait();
+    EXPECT_TRUE(TestTrackMetadataWriter(m_journalFilePath)
+            .recoveredLocations().isEmpty());
+}
+
+}  // namespace
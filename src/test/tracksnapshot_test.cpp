@@ -0,0 +1,76 @@
+#include <QtDebug>
+
+#include "test/mixxxtest.h"
+
+#include "library/dao/weaktrackcache.h"
+#include "track/track.h"
+
+namespace {
+
+class TrackSnapshotTest : public MixxxTest {
+  protected:
+    static TrackPointer newTestTrack(int trackId) {
+        return Track::newDummy(
+                QFileInfo(QString("/music/track%1.mp3").arg(trackId)),
+                TrackId(trackId));
+    }
+};
+
+TEST_F(TrackSnapshotTest, SnapshotIsSharedUntilModified) {
+    TrackPointer pTrack = newTestTrack(1);
+    pTrack->setArtist("Artist");
+    pTrack->setRating(3);
+
+    TrackSnapshotPointer pSnapshot = pTrack->getSnapshot();
+    EXPECT_EQ(TrackId(1), pSnapshot->id);
+    EXPECT_QSTRING_EQ("Artist", pSnapshot->metadata.getArtist());
+    EXPECT_EQ(3, pSnapshot->rating);
+    EXPECT_EQ(pSnapshot, pTrack->getSnapshot());
+
+    pTrack->setArtist("Other Artist");
+    TrackSnapshotPointer pModifiedSnapshot = pTrack->getSnapshot();
+    EXPECT_NE(pSnapshot, pModifiedSnapshot);
+    EXPECT_QSTRING_EQ("Other Artist", pModifiedSnapshot->metadata.getArtist());
+    // The previous snapshot is immutable
+    EXPECT_QSTRING_EQ("Artist", pSnapshot->metadata.getArtist());
+}
+
+TEST_F(TrackSnapshotTest, SnapshotContainsKeyAndBpm) {
+    TrackPointer pTrack = newTestTrack(1);
+    pTrack->setSampleRate(44100);
+    pTrack->setBpm(128.0);
+    pTrack->setKeyText("Am");
+
+    TrackSnapshotPointer pSnapshot = pTrack->getSnapshot();
+    EXPECT_DOUBLE_EQ(pTrack->getBpm(), pSnapshot->bpm);
+    EXPECT_EQ(pTrack->getKey(), pSnapshot->key);
+    EXPECT_QSTRING_EQ(pTrack->getKeyText(), pSnapshot->keyText);
+}
+
+TEST_F(TrackSnapshotTest, WeakTrackCache) {
+    WeakTrackCache cache;
+    TrackPointer pTrack1 = newTestTrack(1);
+    TrackPointer pTrack2 = newTestTrack(2);
+    cache.insert(TrackId(1), pTrack1);
+    cache.insert(TrackId(2), pTrack2);
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(pTrack1, cache.lookup(TrackId(1)));
+    EXPECT_EQ(pTrack2, cache.lookup(TrackId(2)));
+    EXPECT_FALSE(cache.lookup(TrackId(3)));
+
+    // Tracks that are still alive are not removed
+    cache.removeExpired(TrackId(1));
+    EXPECT_EQ(pTrack1, cache.lookup(TrackId(1)));
+
+    pTrack2.reset();
+    EXPECT_FALSE(cache.lookup(TrackId(2)));
+    cache.removeExpired(TrackId(2));
+    EXPECT_EQ(1, cache.size());
+
+    QList<TrackPointer> tracks = cache.takeAll();
+    ASSERT_EQ(1, tracks.size());
+    EXPECT_EQ(pTrack1, tracks.first());
+    EXPECT_EQ(0, cache.size());
+}
+
+} // anonymous namespace
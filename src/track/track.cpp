@@ -380,6 +380,7 @@ QDateTime Track::getDateAdded() const {
 void Track::setDateAdded(const QDateTime& dateAdded) {
     QMutexLocker lock(&m_qMutex);
     m_dateAdded = dateAdded;
+    invalidateSnapshot();
 }
 
 void Track::setDuration(double duration) {
@@ -661,6 +662,7 @@ void Track::initId(TrackId id) {
         return; // abort
     }
     m_id = id;
+    invalidateSnapshot();
     // Changing the Id does not make the track dirty because the Id is always
     // generated by the Database itself.
 }
@@ -807,6 +809,9 @@ void Track::markDirtyAndUnlock(QMutexLocker* pLock, bool bDirty) {
 void Track::setDirtyAndUnlock(QMutexLocker* pLock, bool bDirty) {
     const bool dirtyChanged = m_bDirty != bDirty;
     m_bDirty = bDirty;
+    if (bDirty) {
+        invalidateSnapshot();
+    }
 
     // Unlock before emitting any signals!
     pLock->unlock();
@@ -824,6 +829,44 @@ void Track::setDirtyAndUnlock(QMutexLocker* pLock, bool bDirty) {
     }
 }
 
+void Track::invalidateSnapshot() {
+    std::atomic_store(&m_pSnapshot, TrackSnapshotPointer());
+}
+
+TrackSnapshotPointer Track::getSnapshot() const {
+    TrackSnapshotPointer pSnapshot = std::atomic_load(&m_pSnapshot);
+    if (pSnapshot) {
+        return pSnapshot;
+    }
+    auto pNewSnapshot = std::make_shared<TrackSnapshot>();
+    QMutexLocker lock(&m_qMutex);
+    pNewSnapshot->id = m_id;
+    pNewSnapshot->location = m_fileInfo.absoluteFilePath();
+    pNewSnapshot->type = m_sType;
+    pNewSnapshot->metadata = m_metadata;
+    if (m_pBeats) {
+        const double beatsBpm = m_pBeats->getBpm();
+        if (mixxx::Bpm::isValidValue(beatsBpm)) {
+            pNewSnapshot->bpm = beatsBpm;
+        }
+    }
+    pNewSnapshot->bpmLocked = m_bBpmLocked;
+    pNewSnapshot->keyText = KeyUtils::getGlobalKeyText(m_keys);
+    if (m_keys.isValid()) {
+        pNewSnapshot->key = m_keys.getGlobalKey();
+    }
+    pNewSnapshot->rating = m_iRating;
+    pNewSnapshot->playCounter = m_playCounter;
+    pNewSnapshot->dateAdded = m_dateAdded;
+    pNewSnapshot->headerParsed = m_bHeaderParsed;
+    pNewSnapshot->coverInfo = CoverInfo(m_coverInfoRelative, pNewSnapshot->location);
+    // Publish the snapshot while still holding the lock. Otherwise a
+    // concurrent modification might be overwritten by a stale snapshot.
+    pSnapshot = std::move(pNewSnapshot);
+    std::atomic_store(&m_pSnapshot, pSnapshot);
+    return pSnapshot;
+}
+
 bool Track::isDirty() {
     QMutexLocker lock(&m_qMutex);
     return m_bDirty;
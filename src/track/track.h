@@ -14,6 +14,7 @@
 #include "track/trackid.h"
 #include "track/playcounter.h"
 #include "track/trackmetadata.h"
+#include "track/tracksnapshot.h"
 #include "util/memory.h"
 #include "util/sandbox.h"
 #include "util/duration.h"
@@ -289,6 +290,11 @@ class Track : public QObject {
             bool* pHeaderParsed = nullptr,
             bool* pDirty = nullptr) const;
 
+    // Returns an immutable copy of the track properties. Repeated
+    // invocations return the same snapshot without locking the track
+    // until it is modified.
+    TrackSnapshotPointer getSnapshot() const;
+
     // Mark the track dirty if it isn't already.
     void markDirty();
     // Mark the track clean if it isn't already.
@@ -341,6 +347,11 @@ class Track : public QObject {
     void setDirtyAndUnlock(QMutexLocker* pLock, bool bDirty);
 
     void setBeatsAndUnlock(QMutexLocker* pLock, BeatsPointer pBeats);
+
+    // Discards the current snapshot after the track has been modified.
+    // This must only be called from member functions while the TIO is
+    // locked.
+    void invalidateSnapshot();
     void setKeysAndUnlock(QMutexLocker* pLock, const Keys& keys);
 
     enum class DurationRounding {
@@ -411,6 +422,10 @@ class Track : public QObject {
 
     CoverInfoRelative m_coverInfoRelative;
 
+    // Lazily created by getSnapshot(). Only accessed with the atomic
+    // operations for std::shared_ptr.
+    mutable TrackSnapshotPointer m_pSnapshot;
+
     friend class TrackDAO;
 };
 
@@ -0,0 +1,41 @@
+#ifndef MIXXX_TRACKSNAPSHOT_H
+#define MIXXX_TRACKSNAPSHOT_H
+
+#include <QDateTime>
+#include <QString>
+
+#include "library/coverart.h"
+#include "proto/keys.pb.h"
+#include "track/playcounter.h"
+#include "track/trackid.h"
+#include "track/trackmetadata.h"
+#include "util/memory.h"
+
+// An immutable copy of the track properties that are displayed in the
+// library. Readers that need many properties of a track at once should
+// use a snapshot instead of invoking the individual getters of Track
+// that each need to lock the track.
+//
+// A snapshot is created lazily on the first request after the track has
+// been modified and shared by all readers until the next modification.
+struct TrackSnapshot {
+    TrackId id;
+    // Absolute path of the file
+    QString location;
+    QString type;
+    mixxx::TrackMetadata metadata;
+    // BPM of the beat grid, undefined if the track has no valid beats
+    double bpm = mixxx::Bpm::kValueUndefined;
+    bool bpmLocked = false;
+    QString keyText;
+    mixxx::track::io::key::ChromaticKey key = mixxx::track::io::key::INVALID;
+    int rating = 0;
+    PlayCounter playCounter;
+    QDateTime dateAdded;
+    bool headerParsed = false;
+    CoverInfo coverInfo;
+};
+
+typedef std::shared_ptr<const TrackSnapshot> TrackSnapshotPointer;
+
+#endif // MIXXX_TRACKSNAPSHOT_H
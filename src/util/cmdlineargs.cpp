@@ -12,6 +12,7 @@ CmdlineArgs::CmdlineArgs()
       m_developer(false),
       m_safeMode(false),
       m_debugAssertBreak(false),
+      m_startupProfile(false),
       m_settingsPathSet(false),
       m_logLevel(mixxx::LogLevel::Default),
 // We are not ready to switch to XDG folders under Linux, so keeping $HOME/.mixxx as preferences folder. see lp:1463273
@@ -55,6 +56,12 @@ bool CmdlineArgs::Parse(int &argc, char **argv) {
         } else if (argv[i] == QString("--timelinePath") && i+1 < argc) {
             m_timelinePath = QString::fromLocal8Bit(argv[i+1]);
             i++;
+        } else if (argv[i] == QString("--renderScript") && i+1 < argc) {
+            m_renderScriptPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--renderOutput") && i+1 < argc) {
+            m_renderOutputPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
         } else if (argv[i] == QString("--logLevel") && i+1 < argc) {
             logLevelSet = true;
             auto level = QLatin1String(argv[i+1]);
@@ -82,6 +89,9 @@ warnings and errors to the console unless this is set properly.\n", stdout);
             m_safeMode = true;
         } else if (QString::fromLocal8Bit(argv[i]).contains("--debugAssertBreak", Qt::CaseInsensitive)) {
             m_debugAssertBreak = true;
+        } else if (QString::fromLocal8Bit(argv[i]).contains("--startupProfile", Qt::CaseInsensitive) ||
+                   argv[i] == QString("--startup-profile")) {
+            m_startupProfile = true;
         } else {
             m_musicFiles += QString::fromLocal8Bit(argv[i]);
         }
@@ -92,6 +102,10 @@ warnings and errors to the console unless this is set properly.\n", stdout);
     if (m_developer && !logLevelSet) {
         m_logLevel = mixxx::LogLevel::Debug;
     }
+    // The startup timeline is logged as info messages.
+    if (m_startupProfile && !logLevelSet && (m_logLevel < mixxx::LogLevel::Info)) {
+        m_logLevel = mixxx::LogLevel::Info;
+    }
 
     return true;
 }
@@ -137,6 +151,18 @@ void CmdlineArgs::printUsage() {
                         and spinning vinyl widgets. Try this option if\n\
                         Mixxx is crashing on startup.\n\
 \n\
+--startupProfile        Logs how long each stage of the startup took\n\
+                        and which stages ran concurrently.\n\
+\n\
+--renderScript PATH     Renders the timeline in the script faster than\n\
+                        realtime without a sound device or GUI and\n\
+                        prints the realtime factor. See\n\
+                        src/mixer/offlinerenderer.h for the format.\n\
+\n\
+--renderOutput PATH     File for the master output of --renderScript.\n\
+                        The extension selects the format (wav, aiff,\n\
+                        flac, ogg or mp3). Without it nothing is written.\n\
+\n\
 --locale LOCALE         Use a custom locale for loading translations\n\
                         (e.g 'fr')\n\
 \n\
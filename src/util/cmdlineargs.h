@@ -25,6 +25,7 @@ class CmdlineArgs final {
     bool getDeveloper() const { return m_developer; }
     bool getSafeMode() const { return m_safeMode; }
     bool getDebugAssertBreak() const { return m_debugAssertBreak; }
+    bool getStartupProfile() const { return m_startupProfile; }
     bool getSettingsPathSet() const { return m_settingsPathSet; }
     mixxx::LogLevel getLogLevel() const { return m_logLevel; }
     bool getTimelineEnabled() const { return !m_timelinePath.isEmpty(); }
@@ -36,6 +37,9 @@ class CmdlineArgs final {
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getPluginPath() const { return m_pluginPath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    bool getRenderEnabled() const { return !m_renderScriptPath.isEmpty(); }
+    const QString& getRenderScriptPath() const { return m_renderScriptPath; }
+    const QString& getRenderOutputPath() const { return m_renderOutputPath; }
 
   private:
     CmdlineArgs();
@@ -46,6 +50,7 @@ class CmdlineArgs final {
     bool m_developer; // Developer Mode
     bool m_safeMode;
     bool m_debugAssertBreak;
+    bool m_startupProfile; // Log a timeline of the startup stages
     bool m_settingsPathSet; // has --settingsPath been set on command line ?
     mixxx::LogLevel m_logLevel; // Level of logging message verbosity
     QString m_locale;
@@ -53,6 +58,8 @@ class CmdlineArgs final {
     QString m_resourcePath;
     QString m_pluginPath;
     QString m_timelinePath;
+    QString m_renderScriptPath; // Render the script offline instead of starting the GUI
+    QString m_renderOutputPath;
 };
 
 #endif /* CMDLINEARGS_H */
@@ -1,5 +1,6 @@
 #include <QSqlDriver>
 #include <QSqlError>
+#include <QSqlQuery>
 
 #ifdef __SQLITE3__
 #include <sqlite3.h>
@@ -215,6 +216,57 @@ void sqliteLike(sqlite3_context *context,
 
 #endif // __SQLITE3__
 
+// Returns the current value of the pragma after the update, which
+// might differ from the requested value.
+QVariant execPragma(
+        const QSqlDatabase& database,
+        const QString& statement) {
+    QSqlQuery query(database);
+    if (!query.exec(statement)) {
+        kLogger.warning()
+                << "Failed to execute"
+                << statement
+                << query.lastError();
+        return QVariant();
+    }
+    if (query.next()) {
+        return query.value(0);
+    }
+    return QVariant();
+}
+
+void applySqliteParams(
+        const QSqlDatabase& database,
+        const DbConnection::Params::Sqlite& params) {
+    DEBUG_ASSERT(database.isOpen());
+    if (!params.journalMode.isEmpty()) {
+        const QVariant journalMode = execPragma(database,
+                QString("PRAGMA journal_mode=%1").arg(params.journalMode));
+        // SQLite silently keeps the previous journal mode if the new
+        // one is not supported, e.g. WAL on some network file systems.
+        if (journalMode.toString().compare(params.journalMode, Qt::CaseInsensitive) != 0) {
+            kLogger.warning()
+                    << "Journal mode"
+                    << params.journalMode
+                    << "not available, using"
+                    << journalMode.toString();
+        }
+    }
+    if (!params.synchronous.isEmpty()) {
+        execPragma(database,
+                QString("PRAGMA synchronous=%1").arg(params.synchronous));
+    }
+    if (params.cacheSizeKiB > 0) {
+        // Negative values are interpreted as KiB instead of pages
+        execPragma(database,
+                QString("PRAGMA cache_size=-%1").arg(params.cacheSizeKiB));
+    }
+    if (params.mmapSizeBytes > 0) {
+        execPragma(database,
+                QString("PRAGMA mmap_size=%1").arg(params.mmapSizeBytes));
+    }
+}
+
 bool initDatabase(QSqlDatabase database) {
     DEBUG_ASSERT(database.isOpen());
 #ifdef __SQLITE3__
@@ -285,13 +337,15 @@ bool initDatabase(QSqlDatabase database) {
 DbConnection::DbConnection(
         const Params& params,
         const QString& connectionName)
-    : m_sqlDatabase(createDatabase(params, connectionName)) {
+    : m_sqliteParams(params.sqlite),
+      m_sqlDatabase(createDatabase(params, connectionName)) {
 }
 
 DbConnection::DbConnection(
         const DbConnection& prototype,
         const QString& connectionName)
-    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)) {
+    : m_sqliteParams(prototype.m_sqliteParams),
+      m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)) {
 }
 
 DbConnection::~DbConnection() {
@@ -317,6 +371,9 @@ bool DbConnection::open() {
         m_sqlDatabase.close();
         return false; // abort
     }
+    if (m_sqlDatabase.driverName() == "QSQLITE") {
+        applySqliteParams(m_sqlDatabase, m_sqliteParams);
+    }
     return true;
 }
 
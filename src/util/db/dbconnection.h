@@ -28,6 +28,21 @@ class DbConnection final {
         QString filePath;
         QString userName;
         QString password;
+
+        // Tuning parameters that are only applied to SQLite
+        // databases when opening a connection. Empty strings and
+        // non-positive numbers keep the defaults of SQLite.
+        // See also: https://www.sqlite.org/pragma.html
+        struct Sqlite {
+            // PRAGMA journal_mode, e.g. "DELETE" or "WAL"
+            QString journalMode;
+            // PRAGMA synchronous, e.g. "FULL" or "NORMAL"
+            QString synchronous;
+            // PRAGMA cache_size
+            int cacheSizeKiB = 0;
+            // PRAGMA mmap_size
+            qint64 mmapSizeBytes = 0;
+        } sqlite;
     };
 
     // All constructors are reserved for DbConnectionPool!!
@@ -60,6 +75,7 @@ class DbConnection final {
     DbConnection(const DbConnection&) = delete;
     DbConnection(const DbConnection&&) = delete;
 
+    Params::Sqlite m_sqliteParams;
     QSqlDatabase m_sqlDatabase;
 };
 
@@ -0,0 +1,111 @@
+#include "util/db/sqlmultirowinsert.h"
+
+#include <QSqlError>
+
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/assert.h"
+
+
+namespace {
+
+const mixxx::Logger kLogger("SqlMultiRowInsert");
+
+// The maximum number of host parameters in a single SQLite
+// statement (SQLITE_MAX_VARIABLE_NUMBER) is 999 by default in
+// all versions prior to 3.32.0.
+const int kMaxHostParameters = 999;
+
+} // anonymous namespace
+
+SqlMultiRowInsert::SqlMultiRowInsert(
+        QSqlDatabase database,
+        const QString& statementPrefix,
+        const QStringList& columns)
+    : m_database(database),
+      m_statementPrefix(statementPrefix),
+      m_columns(columns),
+      m_rowsPerStatement(math_max(1, kMaxHostParameters / math_max(1, columns.size()))),
+      m_batchQuery(database),
+      m_batchQueryPrepared(false),
+      m_insertedRows(0) {
+    DEBUG_ASSERT(!m_columns.isEmpty());
+    m_pendingValues.reserve(m_rowsPerStatement * m_columns.size());
+}
+
+SqlMultiRowInsert::~SqlMultiRowInsert() {
+    DEBUG_ASSERT(m_pendingValues.isEmpty());
+}
+
+QString SqlMultiRowInsert::buildStatement(int rows) const {
+    QStringList placeholders;
+    for (int i = 0; i < m_columns.size(); ++i) {
+        placeholders << "?";
+    }
+    const QString rowPlaceholder = QString("(%1)").arg(placeholders.join(","));
+    QStringList rowPlaceholders;
+    for (int i = 0; i < rows; ++i) {
+        rowPlaceholders << rowPlaceholder;
+    }
+    return QString("%1 (%2) VALUES %3").arg(
+            m_statementPrefix,
+            m_columns.join(","),
+            rowPlaceholders.join(","));
+}
+
+bool SqlMultiRowInsert::addRow(const QVariantList& values) {
+    VERIFY_OR_DEBUG_ASSERT(values.size() == m_columns.size()) {
+        return false;
+    }
+    m_pendingValues += values;
+    if (m_pendingValues.size() < m_rowsPerStatement * m_columns.size()) {
+        return true;
+    }
+    if (!m_batchQueryPrepared) {
+        m_batchQueryPrepared =
+                m_batchQuery.prepare(buildStatement(m_rowsPerStatement));
+        VERIFY_OR_DEBUG_ASSERT(m_batchQueryPrepared) {
+            kLogger.warning()
+                    << "Failed to prepare statement"
+                    << m_batchQuery.lastError();
+            m_pendingValues.clear();
+            return false;
+        }
+    }
+    return execPending(&m_batchQuery);
+}
+
+bool SqlMultiRowInsert::flush() {
+    if (m_pendingValues.isEmpty()) {
+        return true;
+    }
+    const int rows = m_pendingValues.size() / m_columns.size();
+    QSqlQuery query(m_database);
+    if (!query.prepare(buildStatement(rows))) {
+        kLogger.warning()
+                << "Failed to prepare statement"
+                << query.lastError();
+        m_pendingValues.clear();
+        return false;
+    }
+    return execPending(&query);
+}
+
+bool SqlMultiRowInsert::execPending(QSqlQuery* pQuery) {
+    DEBUG_ASSERT(pQuery);
+    for (int i = 0; i < m_pendingValues.size(); ++i) {
+        pQuery->bindValue(i, m_pendingValues.at(i));
+    }
+    const int rows = m_pendingValues.size() / m_columns.size();
+    m_pendingValues.clear();
+    if (!pQuery->exec()) {
+        kLogger.warning()
+                << "Failed to insert"
+                << rows
+                << "rows:"
+                << pQuery->lastError();
+        return false;
+    }
+    m_insertedRows += rows;
+    return true;
+}
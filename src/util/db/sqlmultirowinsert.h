@@ -0,0 +1,69 @@
+#ifndef MIXXX_SQLMULTIROWINSERT_H
+#define MIXXX_SQLMULTIROWINSERT_H
+
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariantList>
+
+
+// Inserts rows into a table with multi-row INSERT statements, i.e.
+// "INSERT INTO table (a,b) VALUES (?,?),(?,?),...". This saves most of
+// the per-statement overhead of inserting rows one by one. Rows are
+// buffered until enough rows for a complete statement are available.
+// The prepared statement for complete batches is reused, only the
+// final partial batch needs a separate statement.
+//
+// The caller is responsible for wrapping the inserts into a
+// transaction.
+class SqlMultiRowInsert final {
+  public:
+    // The statement prefix is usually "INSERT INTO <table>", but may
+    // also contain conflict clauses like "INSERT OR IGNORE INTO".
+    SqlMultiRowInsert(
+            QSqlDatabase database,
+            const QString& statementPrefix,
+            const QStringList& columns);
+    ~SqlMultiRowInsert();
+
+    int rowsPerStatement() const {
+        return m_rowsPerStatement;
+    }
+
+    // Adds a row with one value per column. The row is inserted into the
+    // database either immediately or when invoking flush(). Returns false
+    // if executing the statement failed.
+    bool addRow(const QVariantList& values);
+
+    // Inserts all pending rows. Must be called after the last row has
+    // been added. Returns false if executing the statement failed.
+    bool flush();
+
+    // The total number of rows that have been inserted successfully.
+    int insertedRows() const {
+        return m_insertedRows;
+    }
+
+    // Disable copy construction and copy/move assignment
+    SqlMultiRowInsert(const SqlMultiRowInsert&) = delete;
+    SqlMultiRowInsert& operator=(const SqlMultiRowInsert&) = delete;
+
+  private:
+    QString buildStatement(int rows) const;
+    bool execPending(QSqlQuery* pQuery);
+
+    const QSqlDatabase m_database;
+    const QString m_statementPrefix;
+    const QStringList m_columns;
+    const int m_rowsPerStatement;
+
+    QSqlQuery m_batchQuery;
+    bool m_batchQueryPrepared;
+
+    QVariantList m_pendingValues;
+    int m_insertedRows;
+};
+
+
+#endif // MIXXX_SQLMULTIROWINSERT_H
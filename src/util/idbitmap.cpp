@@ -0,0 +1,169 @@
+#include <algorithm>
+
+#include "util/idbitmap.h"
+
+#include "util/assert.h"
+
+namespace {
+
+inline quint16 highBits(IdBitmap::value_type id) {
+    return static_cast<quint16>(id >> 16);
+}
+
+inline quint16 lowBits(IdBitmap::value_type id) {
+    return static_cast<quint16>(id & 0xFFFF);
+}
+
+inline bool testBit(const std::vector<quint64>& bits, quint16 low) {
+    return (bits[low >> 6] & (Q_UINT64_C(1) << (low & 63))) != 0;
+}
+
+} // anonymous namespace
+
+// static
+int IdBitmap::countTrailingZeros(quint64 word) {
+    DEBUG_ASSERT(word != 0);
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+void IdBitmap::clear() {
+    m_chunks.clear();
+    m_size = 0;
+}
+
+std::vector<IdBitmap::Chunk>::iterator IdBitmap::findChunk(quint16 key) {
+    return std::lower_bound(m_chunks.begin(), m_chunks.end(), key,
+            [](const Chunk& chunk, quint16 key) {
+                return chunk.key < key;
+            });
+}
+
+std::vector<IdBitmap::Chunk>::const_iterator IdBitmap::findChunk(quint16 key) const {
+    return std::lower_bound(m_chunks.begin(), m_chunks.end(), key,
+            [](const Chunk& chunk, quint16 key) {
+                return chunk.key < key;
+            });
+}
+
+bool IdBitmap::insert(value_type id) {
+    const quint16 key = highBits(id);
+    const quint16 low = lowBits(id);
+    auto i = findChunk(key);
+    if ((i == m_chunks.end()) || (i->key != key)) {
+        i = m_chunks.insert(i, Chunk(key));
+    }
+    Chunk& chunk = *i;
+    if (chunk.bits.empty()) {
+        const auto j = std::lower_bound(chunk.array.begin(), chunk.array.end(), low);
+        if ((j != chunk.array.end()) && (*j == low)) {
+            return false;
+        }
+        chunk.array.insert(j, low);
+        ++chunk.size;
+        if (chunk.size > kMaxArraySize) {
+            convertToBitset(&chunk);
+        }
+    } else {
+        quint64& word = chunk.bits[low >> 6];
+        const quint64 mask = Q_UINT64_C(1) << (low & 63);
+        if ((word & mask) != 0) {
+            return false;
+        }
+        word |= mask;
+        ++chunk.size;
+    }
+    ++m_size;
+    return true;
+}
+
+bool IdBitmap::remove(value_type id) {
+    const quint16 key = highBits(id);
+    const quint16 low = lowBits(id);
+    const auto i = findChunk(key);
+    if ((i == m_chunks.end()) || (i->key != key)) {
+        return false;
+    }
+    Chunk& chunk = *i;
+    if (chunk.bits.empty()) {
+        const auto j = std::lower_bound(chunk.array.begin(), chunk.array.end(), low);
+        if ((j == chunk.array.end()) || (*j != low)) {
+            return false;
+        }
+        chunk.array.erase(j);
+        --chunk.size;
+    } else {
+        quint64& word = chunk.bits[low >> 6];
+        const quint64 mask = Q_UINT64_C(1) << (low & 63);
+        if ((word & mask) == 0) {
+            return false;
+        }
+        word &= ~mask;
+        --chunk.size;
+        if (chunk.size < kMinBitsetSize) {
+            convertToArray(&chunk);
+        }
+    }
+    --m_size;
+    if (chunk.size == 0) {
+        m_chunks.erase(i);
+    }
+    return true;
+}
+
+bool IdBitmap::contains(value_type id) const {
+    const quint16 key = highBits(id);
+    const quint16 low = lowBits(id);
+    const auto i = findChunk(key);
+    if ((i == m_chunks.end()) || (i->key != key)) {
+        return false;
+    }
+    if (i->bits.empty()) {
+        return std::binary_search(i->array.begin(), i->array.end(), low);
+    } else {
+        return testBit(i->bits, low);
+    }
+}
+
+void IdBitmap::unite(const IdBitmap& other) {
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
+    other.forEach([this](value_type id) {
+        insert(id);
+    });
+}
+
+// static
+void IdBitmap::convertToBitset(Chunk* pChunk) {
+    DEBUG_ASSERT(pChunk->bits.empty());
+    pChunk->bits.assign(kBitsetWords, 0);
+    for (auto low: pChunk->array) {
+        pChunk->bits[low >> 6] |= Q_UINT64_C(1) << (low & 63);
+    }
+    std::vector<quint16>().swap(pChunk->array);
+}
+
+// static
+void IdBitmap::convertToArray(Chunk* pChunk) {
+    DEBUG_ASSERT(pChunk->array.empty());
+    pChunk->array.reserve(pChunk->size);
+    for (int i = 0; i < kBitsetWords; ++i) {
+        quint64 word = pChunk->bits[i];
+        while (word != 0) {
+            const int bit = countTrailingZeros(word);
+            pChunk->array.push_back(static_cast<quint16>((i << 6) | bit));
+            word &= word - 1;
+        }
+    }
+    std::vector<quint64>().swap(pChunk->bits);
+}
@@ -0,0 +1,100 @@
+#ifndef MIXXX_IDBITMAP_H
+#define MIXXX_IDBITMAP_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+// A compressed set of non-negative integer ids, e.g. the ids of tracks
+// stored in the database.
+//
+// The ids are partitioned into chunks of 2^16 consecutive ids that share
+// the upper 16 bits, analogous to roaring bitmaps. Sparse chunks store
+// the lower 16 bits of their ids in a sorted array, dense chunks use a
+// bitset with one bit per id. A sparse chunk becomes dense when the number
+// of its ids exceeds kMaxArraySize, i.e. each chunk occupies at most 8 KiB.
+// A dense chunk only becomes sparse again below kMinBitsetSize, so that
+// adding and removing the same id near the limit does not convert the
+// chunk back and forth.
+class IdBitmap {
+  public:
+    typedef quint32 value_type;
+
+    IdBitmap()
+            : m_size(0) {
+    }
+
+    bool isEmpty() const {
+        return m_size == 0;
+    }
+    // The number of ids
+    int size() const {
+        return m_size;
+    }
+
+    void clear();
+
+    // Returns true if the id has been added or removed respectively,
+    // false if it was already present or absent.
+    bool insert(value_type id);
+    bool remove(value_type id);
+
+    bool contains(value_type id) const;
+
+    // Adds all ids of the other bitmap.
+    void unite(const IdBitmap& other);
+
+    // Invokes the function for each id in ascending order.
+    template<typename F>
+    void forEach(F function) const {
+        for (const auto& chunk: m_chunks) {
+            const value_type high = static_cast<value_type>(chunk.key) << 16;
+            if (chunk.bits.empty()) {
+                for (auto low: chunk.array) {
+                    function(high | low);
+                }
+            } else {
+                for (int i = 0; i < kBitsetWords; ++i) {
+                    quint64 word = chunk.bits[i];
+                    while (word != 0) {
+                        const int bit = countTrailingZeros(word);
+                        function(high | static_cast<value_type>((i << 6) | bit));
+                        word &= word - 1;
+                    }
+                }
+            }
+        }
+    }
+
+  private:
+    static const int kMaxArraySize = 4096;
+    static const int kMinBitsetSize = kMaxArraySize / 2;
+    static const int kBitsetWords = (1 << 16) / 64;
+
+    struct Chunk {
+        explicit Chunk(quint16 key)
+                : key(key),
+                  size(0) {
+        }
+
+        quint16 key;
+        int size;
+        // Sorted lower 16 bits of the ids if sparse
+        std::vector<quint16> array;
+        // One bit for each of the 2^16 ids if dense
+        std::vector<quint64> bits;
+    };
+
+    static int countTrailingZeros(quint64 word);
+
+    std::vector<Chunk>::iterator findChunk(quint16 key);
+    std::vector<Chunk>::const_iterator findChunk(quint16 key) const;
+
+    static void convertToBitset(Chunk* pChunk);
+    static void convertToArray(Chunk* pChunk);
+
+    std::vector<Chunk> m_chunks;
+    int m_size;
+};
+
+#endif // MIXXX_IDBITMAP_H
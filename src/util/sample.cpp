@@ -385,6 +385,71 @@ SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
     return clipping;
 }
 
+// static
+SampleUtil::CLIP_STATUS SampleUtil::measureLevels(Levels* pLevels,
+        const CSAMPLE* pBuffer, SINT numSamples) {
+    CSAMPLE sumAbsL = CSAMPLE_ZERO;
+    CSAMPLE sumAbsR = CSAMPLE_ZERO;
+    CSAMPLE peakL = CSAMPLE_ZERO;
+    CSAMPLE peakR = CSAMPLE_ZERO;
+    CSAMPLE peakMid = CSAMPLE_ZERO;
+
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples / 2; ++i) {
+        const CSAMPLE l = pBuffer[i * 2];
+        const CSAMPLE r = pBuffer[i * 2 + 1];
+        const CSAMPLE absl = fabs(l);
+        const CSAMPLE absr = fabs(r);
+        sumAbsL += absl;
+        sumAbsR += absr;
+        peakL = math_max(peakL, absl);
+        peakR = math_max(peakR, absr);
+        peakMid = math_max(peakMid, (l + r) / 2);
+    }
+
+    pLevels->sumAbsL = sumAbsL;
+    pLevels->sumAbsR = sumAbsR;
+    pLevels->peakL = peakL;
+    pLevels->peakR = peakR;
+    pLevels->peakMid = peakMid;
+
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (peakL > CSAMPLE_PEAK) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (peakR > CSAMPLE_PEAK) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+// static
+bool SampleUtil::isSilent(const CSAMPLE* pBuffer, SINT numSamples) {
+    // -120 dBFS
+    const CSAMPLE kSilenceThreshold = 0.000001f;
+    // Small enough to return early, large enough to vectorize the inner loop
+    const SINT kBlockSize = 64;
+
+    SINT i = 0;
+    for (; i + kBlockSize <= numSamples; i += kBlockSize) {
+        CSAMPLE absMax = CSAMPLE_ZERO;
+        // note: LOOP VECTORIZED.
+        for (SINT j = i; j < i + kBlockSize; ++j) {
+            const CSAMPLE absSample = fabs(pBuffer[j]);
+            absMax = math_max(absMax, absSample);
+        }
+        if (absMax > kSilenceThreshold) {
+            return false;
+        }
+    }
+    for (; i < numSamples; ++i) {
+        if (fabs(pBuffer[i]) > kSilenceThreshold) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // static
 void SampleUtil::copyClampBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
@@ -199,6 +199,27 @@ class SampleUtil {
     static CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
             const CSAMPLE* pBuffer, SINT numSamples);
 
+    // Returns true if no sample in pBuffer exceeds -120 dBFS. Returns at the
+    // first block with an audible sample, so it is cheap for non-silent
+    // buffers.
+    static bool isSilent(const CSAMPLE* pBuffer, SINT numSamples);
+
+    // The levels of the left and the right channel of a stereo buffer
+    struct Levels {
+        CSAMPLE sumAbsL;
+        CSAMPLE sumAbsR;
+        CSAMPLE peakL;
+        CSAMPLE peakR;
+        // The maximum of the signed mid signal (L + R) / 2, not below zero
+        CSAMPLE peakMid;
+    };
+
+    // Measures all levels of pBuffer in a single pass, for meters and
+    // side chain keys that need more than the sum of the absolute values.
+    // The return value tells whether there is clipping in pBuffer or not.
+    static CLIP_STATUS measureLevels(Levels* pLevels,
+            const CSAMPLE* pBuffer, SINT numSamples);
+
     // Copies every sample in pSrc to pDest, limiting the values in pDest
     // to the valid range of CSAMPLE. If pDest and pSrc are aliases, will
     // not copy will only clamp. Returns true if any samples in pSrc were
@@ -0,0 +1,72 @@
+#include "util/startupprofiler.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+#include "util/cmdlineargs.h"
+#include "util/logger.h"
+#include "util/time.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("StartupProfiler");
+
+} // anonymous namespace
+
+// static
+QMutex StartupProfiler::s_mutex;
+// static
+QList<StartupProfiler::StageInfo> StartupProfiler::s_stages;
+
+StartupProfiler::Stage::Stage(const QString& name)
+        : m_name(name),
+          m_begin(Time::elapsed()) {
+}
+
+StartupProfiler::Stage::~Stage() {
+    recordStage(m_name, m_begin, Time::elapsed());
+}
+
+// static
+void StartupProfiler::recordStage(const QString& name,
+        Duration begin, Duration end) {
+    StageInfo stage;
+    stage.name = name;
+    stage.threadName = QThread::currentThread()->objectName();
+    stage.begin = begin;
+    stage.end = end;
+    QMutexLocker locker(&s_mutex);
+    s_stages.append(stage);
+}
+
+// static
+void StartupProfiler::report() {
+    if (!CmdlineArgs::Instance().getStartupProfile()) {
+        return;
+    }
+    QList<StageInfo> stages;
+    {
+        QMutexLocker locker(&s_mutex);
+        stages = s_stages;
+    }
+    std::stable_sort(stages.begin(), stages.end(),
+            [](const StageInfo& lhs, const StageInfo& rhs) {
+                return lhs.begin < rhs.begin;
+            });
+    kLogger.info() << "Startup timeline (begin, end, duration in ms):";
+    for (const auto& stage: stages) {
+        const QString threadName = stage.threadName.isEmpty() ?
+                QString("Worker") : stage.threadName;
+        kLogger.info() << qPrintable(QString("%1 %2 %3  %4 [%5]").arg(
+                stage.begin.toIntegerMillis(), 6).arg(
+                stage.end.toIntegerMillis(), 6).arg(
+                (stage.end - stage.begin).toIntegerMillis(), 6).arg(
+                stage.name, threadName));
+    }
+}
+
+} // namespace mixxx
@@ -0,0 +1,50 @@
+#ifndef MIXXX_UTIL_STARTUPPROFILER_H
+#define MIXXX_UTIL_STARTUPPROFILER_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "util/duration.h"
+
+namespace mixxx {
+
+// Records when each stage of the application startup begins and ends,
+// relative to mixxx::Time::start(). Stages may run concurrently on
+// different threads. The timeline is logged by report() if profiling
+// has been requested with --startupProfile.
+class StartupProfiler {
+  public:
+    // Records a stage for the lifetime of the object.
+    class Stage final {
+      public:
+        explicit Stage(const QString& name);
+        ~Stage();
+
+      private:
+        QString m_name;
+        Duration m_begin;
+    };
+
+    static void recordStage(const QString& name,
+            Duration begin, Duration end);
+
+    // Logs all stages that have been recorded so far, ordered by
+    // their begin time.
+    static void report();
+
+  private:
+    struct StageInfo {
+        QString name;
+        QString threadName;
+        Duration begin;
+        Duration end;
+    };
+
+    static QMutex s_mutex;
+    static QList<StageInfo> s_stages;
+};
+
+} // namespace mixxx
+
+#endif // MIXXX_UTIL_STARTUPPROFILER_H
@@ -7,6 +7,7 @@
 
 #include "util/math.h"
 #include "skin/imgloader.h"
+#include "skin/skinimagecache.h"
 
 // static
 Paintable::DrawMode Paintable::DrawModeFromString(const QString& str) {
@@ -68,11 +69,18 @@ Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFact
 #endif
             // The SVG renderer doesn't directly support tiling, so we render
             // it to a pixmap which will then get tiled.
-            QImage copy_buffer(m_pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
-            copy_buffer.fill(0x00000000);  // Transparent black.
-            QPainter painter(&copy_buffer);
-            m_pSvg->render(&painter);
-            WPixmapStore::correctImageColors(&copy_buffer);
+            QImage copy_buffer;
+            if (source.getData().isEmpty()) {
+                copy_buffer = SkinImageCache::image(source.getPath(), scaleFactor);
+            }
+            if (copy_buffer.isNull()) {
+                copy_buffer = QImage(m_pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
+                copy_buffer.fill(0x00000000);  // Transparent black.
+                QPainter painter(&copy_buffer);
+                m_pSvg->render(&painter);
+                painter.end();
+                WPixmapStore::correctImageColors(&copy_buffer);
+            }
 
             m_pPixmap.reset(new QPixmap(copy_buffer.size()));
             m_pPixmap->convertFromImage(copy_buffer);
@@ -5,6 +5,7 @@
 #include <QPainter>
 
 #include "skin/imgloader.h"
+#include "skin/skinimagecache.h"
 
 // static
 QHash<QString, WImageStore::ImageInfoType*> WImageStore::m_dictionary;
@@ -74,7 +75,13 @@ QImage* WImageStore::getImageNoCache(const PixmapSource& source, double scaleFac
         QPainter painter(pImage);
         renderer.render(&painter);
     } else {
-        pImage = m_loader->getImage(source.getPath(), scaleFactor);
+        const QImage prefetchedImage =
+                SkinImageCache::image(source.getPath(), scaleFactor);
+        if (prefetchedImage.isNull()) {
+            pImage = m_loader->getImage(source.getPath(), scaleFactor);
+        } else {
+            pImage = new QImage(prefetchedImage);
+        }
     }
     return pImage;
 }
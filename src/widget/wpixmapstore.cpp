@@ -6,6 +6,7 @@
 
 #include "util/math.h"
 #include "skin/imgloader.h"
+#include "skin/skinimagecache.h"
 
 // static
 QHash<QString, WeakPaintablePointer> WPixmapStore::m_paintableCache;
@@ -37,7 +38,13 @@ QPixmap* WPixmapStore::getPixmapNoCache(
         const QString& fileName,
         double scaleFactor) {
     QPixmap* pPixmap = nullptr;
-    QImage* img = m_loader->getImage(fileName, scaleFactor);
+    QImage* img;
+    const QImage prefetchedImage = SkinImageCache::image(fileName, scaleFactor);
+    if (prefetchedImage.isNull()) {
+        img = m_loader->getImage(fileName, scaleFactor);
+    } else {
+        img = new QImage(prefetchedImage);
+    }
 #if QT_VERSION >= 0x040700
     pPixmap = new QPixmap();
     pPixmap->convertFromImage(*img);
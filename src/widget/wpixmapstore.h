@@ -44,6 +44,9 @@ class WPixmapStore {
             double scaleFactor);
     static QPixmap* getPixmapNoCache(const QString& fileName, double scaleFactor);
     static void setLoader(QSharedPointer<ImgSource> ld);
+    static QSharedPointer<ImgSource> getLoader() {
+        return m_loader;
+    }
     static void correctImageColors(QImage* p);
     static bool willCorrectColors();
 
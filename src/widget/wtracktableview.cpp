@@ -827,11 +827,24 @@ void WTrackTableView::contextMenuEvent(QContextMenuEvent* event) {
 
     if (modelHasCapabilities(TrackModel::TRACKMODELCAPS_ADDTOCRATE)) {
         m_pCrateMenu->clear();
-        CrateSelectResult allCrates(m_pTrackCollection->crates().selectCrates());
+        const CrateStorage& crateStorage = m_pTrackCollection->crates();
+        const QList<TrackId> selectedTrackIds = getSelectedTrackIds();
+        CrateSelectResult allCrates(crateStorage.selectCrates());
         Crate crate;
         while (allCrates.populateNext(&crate)) {
             auto pAction = std::make_unique<QAction>(crate.getName(), m_pCrateMenu);
             pAction->setEnabled(!crate.isLocked());
+            // Check crates that already contain all selected tracks,
+            // unchecking removes them from the crate
+            bool crateContainsSelectedTracks = !selectedTrackIds.isEmpty();
+            for (const auto& trackId: selectedTrackIds) {
+                if (!crateStorage.isCrateTrack(crate.getId(), trackId)) {
+                    crateContainsSelectedTracks = false;
+                    break;
+                }
+            }
+            pAction->setCheckable(true);
+            pAction->setChecked(crateContainsSelectedTracks);
             m_crateMapper.setMapping(pAction.get(), crate.getId().toInt());
             connect(pAction.get(), SIGNAL(triggered()), &m_crateMapper, SLOT(map()));
             m_pCrateMenu->addAction(pAction.get());
@@ -1474,6 +1487,14 @@ void WTrackTableView::addSelectionToCrate(int iCrateId) {
     }
 
     CrateId crateId(iCrateId);
+    // The action of a crate that contained all selected tracks has
+    // been unchecked when it was triggered
+    QAction* pAction = qobject_cast<QAction*>(m_crateMapper.mapping(iCrateId));
+    if (crateId.isValid() && pAction && pAction->isCheckable() &&
+            !pAction->isChecked()) {
+        m_pTrackCollection->removeCrateTracks(crateId, trackIds);
+        return;
+    }
     if (!crateId.isValid()) { // i.e. a new crate is suppose to be created
         crateId = CrateFeatureHelper(
                 m_pTrackCollection, m_pConfig).createEmptyCrate();